@@ -1,6 +1,6 @@
 ﻿local exports = {}
 exports.name = "workerui"
-exports.version = "0.0.1"
+exports.version = "0.0.2"
 exports.description = "worker-ui plugin"
 exports.license = "The BSD 3-Clause License"
 exports.author = { name = "Bletch" }
@@ -312,27 +312,24 @@ function get_slot_option(tag)
 	return machine_options():slot_option(tag)
 end
 
-function emit_status(light, out)
+-- collects the status as a list of root attributes and a list of sections (each being
+-- the text of a child element), so that it can either be written in full or as a delta
+function collect_status(light)
 	if light == nil then
 		light = false
 	end
-	local emit
-	local opened_file
-	if out then
-		-- we've been called with an output, likely in a debugging scenario; this
-		-- could either be a file or a file name (string)
-		if type(out) == "string" then
-			-- normalize as a file
-			opened_file = assert(io.open(out, "w"))
-			out = opened_file
-		end
-		emit = (function(s)
-			out:write(s)
-			out:write("\n")
-		end)
-	else
-		emit = print
-	end
+	local status = { attributes = {}, sections = {} }
+	local lines
+	local attribute = (function(name, value, volatile)
+		table.insert(status.attributes, { name = name, value = value, volatile = volatile })
+	end)
+	local section = (function(name)
+		lines = {}
+		table.insert(status.sections, { name = name, lines = lines })
+	end)
+	local emit = (function(s)
+		table.insert(lines, s)
+	end)
 
 	-- abstractions to hide some differences between MAME 0.227 and
 	-- previous versions, similar to get_device_tag
@@ -355,22 +352,21 @@ function emit_status(light, out)
 	-- we don't always want to send details
 	local emit_details = not light or machine().paused or is_polling_input_seq()
 
-	emit("<status");
-	emit("\tphase=\"running\"");
-	emit("\ttime=\"" .. tostring(emu.time()) .. "\"");
-	emit("\tpolling_input_seq=\"" .. tostring(is_polling_input_seq()) .. "\"");
-	emit("\tnatural_keyboard_in_use=\"" .. tostring(machine_natkeyboard().in_use) .. "\"");
-	emit("\tpaused=\"" .. tostring(machine().paused) .. "\"");
-	emit("\tstartup_text=\"\"");
-	emit("\tdebugger_present=\"" .. string_from_bool(machine_debugger()) .. "\"");
-	emit("\tshow_profiler=\"" .. tostring(ui().show_profiler) .. "\"");
+	attribute("phase", "running")
+	attribute("time", tostring(emu.time()), true)
+	attribute("polling_input_seq", tostring(is_polling_input_seq()))
+	attribute("natural_keyboard_in_use", tostring(machine_natkeyboard().in_use))
+	attribute("paused", tostring(machine().paused))
+	attribute("startup_text", "")
+	attribute("debugger_present", string_from_bool(machine_debugger()))
+	attribute("show_profiler", tostring(ui().show_profiler))
 	if (not light) then
-		emit("\thas_input_using_mouse=\"" .. tostring(has_input_using_mouse()) .. "\"");
+		attribute("has_input_using_mouse", tostring(has_input_using_mouse()))
 	end
-	emit("\thas_mouse_enabled_problem=\"" .. tostring(has_mouse_enabled_problem) .. "\"");
-	emit(">");
+	attribute("has_mouse_enabled_problem", tostring(has_mouse_enabled_problem))
 
 	-- <video> (video_manager)
+	section("video")
 	emit("\t<video");
 	emit("\t\tspeed_percent=\"" .. tostring(get_speed_percent()) .. "\"");
 	emit("\t\tframeskip=\"" .. tostring(machine_video().frameskip) .. "\"");
@@ -381,12 +377,14 @@ function emit_status(light, out)
 	emit("\t/>");
 
 	-- <sound> (sound_manager)
+	section("sound")
 	emit("\t<sound");
 	emit("\t\tattenuation=\"" .. tostring(machine_sound().attenuation) .. "\"");
 	emit("\t/>");
 
 	-- <cheats> (cheat manager)
 	if (_G and _G.emu and  _G.emu.plugin and _G.emu.plugin.cheat) then
+		section("cheats")
 		emit("\t<cheats>");
 		for id,desc in pairs(_G.emu.plugin.cheat:list()) do
 			local cheat = _G.emu.plugin.cheat.get(id)
@@ -426,6 +424,7 @@ function emit_status(light, out)
 	end
 
 	-- <images>
+	section("images")
 	emit("\t<images>")
 	for _,image in pairs(get_collection(machine().images)) do
 		local filename = get_image_filename(image)
@@ -472,6 +471,7 @@ function emit_status(light, out)
 
 	-- <cassettes>
 	if pcall(function() return machine().cassettes end) then
+		section("cassettes")
 		emit("\t<cassettes>")
 		for _,cassette in pairs(get_collection(machine().cassettes)) do
 			emit(string.format("\t\t<cassette tag=\"%s\" is_stopped=\"%s\" is_playing=\"%s\" is_recording=\"%s\" motor_state=\"%s\" speaker_state=\"%s\" position=\"%s\" length=\"%s\"/>",
@@ -490,6 +490,7 @@ function emit_status(light, out)
 	if emit_details then
 		-- <slots>
 		if pcall(function() return machine().slots end) then
+			section("slots")
 			emit("\t<slots>");
 			for name,slot in pairs(machine().slots) do
 				-- perform logic equivalent to menu_slot_devices::get_current_option()
@@ -522,6 +523,7 @@ function emit_status(light, out)
 		end
 
 		-- <inputs>
+		section("inputs")
 		emit("\t<inputs>")
 		for _,port in pairs(machine_ioport().ports) do
 			for _,field in pairs(port.fields) do
@@ -582,6 +584,7 @@ function emit_status(light, out)
 		end
 		emit("\t</inputs>")
 
+		section("input_devices")
 		emit("\t<input_devices>")
 		for _,devclass in pairs(machine_input().device_classes) do
 			emit("\t\t<class name=\"" .. xml_encode(devclass.name)
@@ -604,10 +607,79 @@ function emit_status(light, out)
 		emit("\t</input_devices>")
 	end
 
-	emit("</status>");
+	for _,section in ipairs(status.sections) do
+		section.text = table.concat(section.lines, "\n")
+		section.lines = nil
+	end
+	return status
+end
+
+-- writes a status collected by collect_status() (or a delta of one) as XML
+function write_status(status, emit)
+	emit("<status")
+	for _,attr in ipairs(status.attributes) do
+		emit("\t" .. attr.name .. "=\"" .. attr.value .. "\"")
+	end
+	emit(">")
+	for _,section in ipairs(status.sections) do
+		emit(section.text)
+	end
+	emit("</status>")
+end
+
+-- what we last emitted to the host; absent attributes and sections are simply retained by
+-- the host, so light statuses and deltas leave what they do not mention alone
+local emitted_status = { attributes = {}, sections = {} }
+function remember_status(status)
+	for _,attr in ipairs(status.attributes) do
+		emitted_status.attributes[attr.name] = attr.value
+	end
+	for _,section in ipairs(status.sections) do
+		emitted_status.sections[section.name] = section.text
+	end
+end
 
-	if opened_file then
-		opened_file:close()
+-- reduces a status to what has changed since we last emitted one; returns nil if nothing
+-- has changed other than volatile attributes
+function status_delta(status)
+	local delta = { attributes = {}, sections = {} }
+	local changed = false
+	for _,attr in ipairs(status.attributes) do
+		if emitted_status.attributes[attr.name] ~= attr.value then
+			table.insert(delta.attributes, attr)
+			changed = changed or not attr.volatile
+		end
+	end
+	for _,section in ipairs(status.sections) do
+		if emitted_status.sections[section.name] ~= section.text then
+			table.insert(delta.sections, section)
+			changed = true
+		end
+	end
+	return changed and delta or nil
+end
+
+function emit_status(light, out)
+	local status = collect_status(light)
+	if out then
+		-- we've been called with an output, likely in a debugging scenario; this
+		-- could either be a file or a file name (string)
+		local opened_file
+		if type(out) == "string" then
+			-- normalize as a file
+			opened_file = assert(io.open(out, "w"))
+			out = opened_file
+		end
+		write_status(status, function(s)
+			out:write(s)
+			out:write("\n")
+		end)
+		if opened_file then
+			opened_file:close()
+		end
+	else
+		write_status(status, print)
+		remember_status(status)
 	end
 end
 
@@ -625,6 +697,58 @@ function command_ping(args)
 	next_ping_should_be_light = true
 end
 
+-- PROTOCOL command; hosts that know about protocol version 2 ask for it, after which we
+-- push status changes on our own instead of waiting to be pinged
+local PROTOCOL_VERSION = 2
+local protocol_version = 1
+function command_protocol(args)
+	local version = tonumber(args[2])
+	if version == nil or version < 1 or version > PROTOCOL_VERSION then
+		print("@ERROR ### Unsupported protocol version '" .. tostring(args[2]) .. "'")
+		return
+	end
+	protocol_version = version
+	print("@OK ### Using protocol version " .. tostring(protocol_version))
+end
+
+-- status pushes are rate limited by wall clock time (emulated time stands still when paused); while
+-- nothing changes (typically when paused) we back off, because collecting a status is not cheap,
+-- but commands (which are what usually change things) bring the next push forward
+local STATUS_PUSH_MIN_INTERVAL = 0.25
+local STATUS_PUSH_MAX_INTERVAL = 2
+local status_push_interval = STATUS_PUSH_MIN_INTERVAL
+local next_status_push_time = nil
+local get_wall_time
+if emu.osd_ticks and emu.osd_ticks_per_second then
+	get_wall_time = function() return emu.osd_ticks() / emu.osd_ticks_per_second() end
+else
+	get_wall_time = os.clock
+end
+function hasten_status_push()
+	status_push_interval = STATUS_PUSH_MIN_INTERVAL
+	next_status_push_time = nil
+end
+function push_status()
+	local now = get_wall_time()
+	if next_status_push_time and now < next_status_push_time then
+		return
+	end
+
+	-- pushes stand in for pings, so they are light in the same way
+	local status = collect_status(next_ping_should_be_light)
+	next_ping_should_be_light = true
+	local delta = status_delta(status)
+	if delta then
+		print("@STATUS ### Status changed")
+		write_status(delta, print)
+		remember_status(delta)
+		status_push_interval = STATUS_PUSH_MIN_INTERVAL
+	elseif not is_polling_input_seq() then
+		status_push_interval = math.min(status_push_interval * 2, STATUS_PUSH_MAX_INTERVAL)
+	end
+	next_status_push_time = now + status_push_interval
+end
+
 -- SLEEP command (in practice only used by tests)
 local wake_up_time = nil
 function command_sleep(args)
@@ -1068,6 +1192,7 @@ local commands =
 {
 	["exit"]						= command_exit,
 	["ping"]						= command_ping,
+	["protocol"]					= command_protocol,
 	["sleep"]						= command_sleep,
 	["soft_reset"]					= command_soft_reset,
 	["hard_reset"]					= command_hard_reset,
@@ -1128,6 +1253,7 @@ function invoke_command_line(line)
 	end)
 
 	protected_call(invocation, "invocation")
+	hasten_status_push()
 end
 
 function startplugin()
@@ -1166,8 +1292,9 @@ function startplugin()
 		end
 
 		-- since we had a reset, we might have images that were just loaded, therefore
-		-- the status returned by the next PING should not be light
+		-- the status returned by the next PING (or push) should not be light
 		 next_ping_should_be_light = false
+		 hasten_status_push()
 	end
 	emu.register_prestart(function() 
 		protected_call(callback_prestart, "callback_prestart")
@@ -1206,6 +1333,11 @@ function startplugin()
 				wake_up_time = nil
 			end
 
+			-- has the host asked us to push status changes?
+			if protocol_version >= 2 then
+				push_status()
+			end
+
 			-- do we have a command?
 			if not (conth.yield or conth.busy) then
 				-- invoke the command line
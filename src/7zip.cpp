@@ -55,6 +55,7 @@ public:
 	std::unique_ptr<QIODevice> extract(int index);
 	int entryCount() const;
 	QString entryName(int index) const;
+	std::uint64_t entrySize(int index) const;
 	bool entryIsDirectory(int index) const;
 	std::optional<std::uint32_t> entryCrc32(int index) const;
 
@@ -150,6 +151,32 @@ bool SevenZipFile::open(const QString &path)
 //-------------------------------------------------
 
 std::unique_ptr<QIODevice> SevenZipFile::get(const QString &fileName)
+{
+	std::optional<int> index = find(fileName);
+	return index
+		? extract(*index)
+		: std::unique_ptr<QIODevice>();
+}
+
+
+//-------------------------------------------------
+//  get(std::uint32_t crc32)
+//-------------------------------------------------
+
+std::unique_ptr<QIODevice> SevenZipFile::get(std::uint32_t crc32)
+{
+	std::optional<int> index = find(crc32);
+	return index
+		? extract(*index)
+		: std::unique_ptr<QIODevice>();
+}
+
+
+//-------------------------------------------------
+//  find(const QString &)
+//-------------------------------------------------
+
+std::optional<int> SevenZipFile::find(const QString &fileName)
 {
 	ProfilerScope prof(CURRENT_FUNCTION);
 
@@ -157,30 +184,90 @@ std::unique_ptr<QIODevice> SevenZipFile::get(const QString &fileName)
 	QString normalizedFileName = normalizeFileName(fileName);
 	auto iter = m_filesByName.find(normalizedFileName);
 
-	// extract or populate as appropriate
+	// populate if we did not find it
 	std::optional<int> index = iter != m_filesByName.end()
 		? iter->second
 		: std::optional<int>();
-	return extractOrPopulate(index, normalizedFileName, { });
+	return findOrPopulate(index, normalizedFileName, { });
 }
 
 
 //-------------------------------------------------
-//  get(std::uint32_t crc32)
+//  find(std::uint32_t crc32)
 //-------------------------------------------------
 
-std::unique_ptr<QIODevice> SevenZipFile::get(std::uint32_t crc32)
+std::optional<int> SevenZipFile::find(std::uint32_t crc32)
 {
 	ProfilerScope prof(CURRENT_FUNCTION);
 
 	// find this file
 	auto iter = m_filesByCrc32.find(crc32);
 
-	// extract or populate as appropriate
+	// populate if we did not find it
 	std::optional<int> index = iter != m_filesByCrc32.end()
 		? iter->second
 		: std::optional<int>();
-	return extractOrPopulate(index, { }, crc32);
+	return findOrPopulate(index, { }, crc32);
+}
+
+
+//-------------------------------------------------
+//  entryCount
+//-------------------------------------------------
+
+int SevenZipFile::entryCount() const
+{
+	return m_impl->entryCount();
+}
+
+
+//-------------------------------------------------
+//  entryName
+//-------------------------------------------------
+
+QString SevenZipFile::entryName(int index) const
+{
+	return m_impl->entryName(index);
+}
+
+
+//-------------------------------------------------
+//  entrySize
+//-------------------------------------------------
+
+std::uint64_t SevenZipFile::entrySize(int index) const
+{
+	return m_impl->entrySize(index);
+}
+
+
+//-------------------------------------------------
+//  entryCrc32
+//-------------------------------------------------
+
+std::optional<std::uint32_t> SevenZipFile::entryCrc32(int index) const
+{
+	return m_impl->entryCrc32(index);
+}
+
+
+//-------------------------------------------------
+//  entryIsDirectory
+//-------------------------------------------------
+
+bool SevenZipFile::entryIsDirectory(int index) const
+{
+	return m_impl->entryIsDirectory(index);
+}
+
+
+//-------------------------------------------------
+//  extract
+//-------------------------------------------------
+
+std::unique_ptr<QIODevice> SevenZipFile::extract(int index)
+{
+	return m_impl->extract(index);
 }
 
 
@@ -195,10 +282,10 @@ QString SevenZipFile::normalizeFileName(const QString &fileName)
 
 
 //-------------------------------------------------
-//  extractOrPopulate
+//  findOrPopulate
 //-------------------------------------------------
 
-std::unique_ptr<QIODevice> SevenZipFile::extractOrPopulate(
+std::optional<int> SevenZipFile::findOrPopulate(
 	std::optional<int> index,
 	const std::optional<QString> &targetNormalizedFileName,
 	std::optional<std::uint32_t> targetCrc32)
@@ -233,10 +320,8 @@ std::unique_ptr<QIODevice> SevenZipFile::extractOrPopulate(
 		m_cursor++;
 	}
 
-	// we're done; do we have an index to extract?
-	return index
-		? m_impl->extract(*index)
-		: std::unique_ptr<QIODevice>();
+	// we're done
+	return index;
 }
 
 
@@ -369,6 +454,16 @@ QString SevenZipFile::Impl::entryName(int index) const
 }
 
 
+//-------------------------------------------------
+//  Impl::entrySize
+//-------------------------------------------------
+
+std::uint64_t SevenZipFile::Impl::entrySize(int index) const
+{
+	return SzArEx_GetFileSize(&m_db, index);
+}
+
+
 //-------------------------------------------------
 //  Impl::entryIsDirectory
 //-------------------------------------------------
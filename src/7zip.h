@@ -30,6 +30,16 @@ public:
 	std::unique_ptr<QIODevice> get(const QString &fileName);
 	std::unique_ptr<QIODevice> get(std::uint32_t crc32);
 
+	// finding entries without extracting them
+	std::optional<int> find(const QString &fileName);
+	std::optional<int> find(std::uint32_t crc32);
+	int entryCount() const;
+	QString entryName(int index) const;
+	std::uint64_t entrySize(int index) const;
+	std::optional<std::uint32_t> entryCrc32(int index) const;
+	bool entryIsDirectory(int index) const;
+	std::unique_ptr<QIODevice> extract(int index);
+
 private:
 	class Impl;
 
@@ -39,7 +49,7 @@ private:
 	int										m_cursor;
 
 	static QString normalizeFileName(const QString &fileName);
-	std::unique_ptr<QIODevice> extractOrPopulate(
+	std::optional<int> findOrPopulate(
 		std::optional<int> index,
 		const std::optional<QString> &normalizedFileName,
 		std::optional<std::uint32_t> crc32);
@@ -0,0 +1,584 @@
+/***************************************************************************
+
+	archivecache.cpp
+
+	Process-wide cache of parsed archive (ZIP/7-Zip) directories and open
+	archive handles, shared by all AssetFinders
+
+***************************************************************************/
+
+// bletchmame headers
+#include "archivecache.h"
+#include "perfprofiler.h"
+#include "7zip.h"
+
+// Qt headers
+#include <QDateTime>
+#include <QFileInfo>
+
+// dependency headers
+#include <quazip.h>
+#include <quazipfile.h>
+
+// standard headers
+#include <algorithm>
+#include <iterator>
+
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+// rough per-member cost of the hash table nodes in a Directory
+static const std::size_t MEMBER_INDEX_OVERHEAD = 2 * 64;
+
+
+//**************************************************************************
+//  TYPE DEFINITIONS
+//**************************************************************************
+
+// ======================> ArchiveCache::Handle
+
+class ArchiveCache::Handle
+{
+public:
+	virtual ~Handle() { }
+};
+
+
+// ======================> ArchiveCache::ZipHandle
+
+class ArchiveCache::ZipHandle : public ArchiveCache::Handle
+{
+public:
+	ZipHandle(const QString &path)
+		: m_zip(path)
+	{
+	}
+
+	bool open()
+	{
+		return m_zip.open(QuaZip::Mode::mdUnzip);
+	}
+
+	bool seek(const Directory::Member &member)
+	{
+		// QuaZip only lets us seek by name, which is a linear search; go to the first file so
+		// that QuaZip believes it has a current file, and then position minizip directly
+		unz64_file_pos filePos;
+		filePos.pos_in_zip_directory = member.m_position;
+		filePos.num_of_file = member.m_index;
+		return m_zip.goToFirstFile()
+			&& unzGoToFilePos64(m_zip.getUnzFile(), &filePos) == UNZ_OK;
+	}
+
+	QuaZip	m_zip;
+};
+
+
+// ======================> ArchiveCache::SevenZipHandle
+
+class ArchiveCache::SevenZipHandle : public ArchiveCache::Handle
+{
+public:
+	SevenZipFile	m_7zipFile;
+};
+
+
+// ======================> ArchiveCache::PooledZipFile
+
+// a QuaZipFile that returns the handle it is reading from to the pool when it is done
+class ArchiveCache::PooledZipFile : public QuaZipFile
+{
+public:
+	PooledZipFile(ArchiveCache &cache, const std::shared_ptr<Archive> &archive, std::unique_ptr<ZipHandle> &&handle)
+		: QuaZipFile(&handle->m_zip)
+		, m_cache(cache)
+		, m_archive(archive)
+		, m_handle(std::move(handle))
+	{
+	}
+
+	~PooledZipFile()
+	{
+		// we have to close before handing back the handle
+		close();
+		m_cache.returnHandle(m_archive, std::move(m_handle), true);
+	}
+
+private:
+	ArchiveCache &				m_cache;
+	std::shared_ptr<Archive>	m_archive;
+	std::unique_ptr<Handle>		m_handle;
+};
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+ArchiveCache::ArchiveCache(int maxOpenHandles, std::size_t memoryBudget)
+	: m_maxOpenHandles(maxOpenHandles)
+	, m_memoryBudget(memoryBudget)
+	, m_statistics()
+{
+}
+
+
+//-------------------------------------------------
+//  dtor - any QIODevice returned by extract() must
+//	be destroyed before the cache that produced it
+//-------------------------------------------------
+
+ArchiveCache::~ArchiveCache()
+{
+}
+
+
+//-------------------------------------------------
+//  global - the cache shared by the whole process
+//-------------------------------------------------
+
+ArchiveCache &ArchiveCache::global()
+{
+	static ArchiveCache s_global;
+	return s_global;
+}
+
+
+//-------------------------------------------------
+//  getDirectory - returns the parsed directory for
+//	the archive at the specified path, or nullptr
+//	if this is not an archive
+//-------------------------------------------------
+
+std::shared_ptr<const ArchiveCache::Directory> ArchiveCache::getDirectory(const QString &path)
+{
+	ProfilerScope prof(CURRENT_FUNCTION);
+
+	// identify the file; if it changes we have to read it again
+	QFileInfo fi(path);
+	if (!fi.isFile())
+		return { };
+	QString absolutePath = fi.absoluteFilePath();
+	std::uint64_t fileSize = fi.size();
+	qint64 lastModified = fi.lastModified().toMSecsSinceEpoch();
+
+	// do we already have it?  (declared before the lock so that closing happens after unlocking)
+	std::vector<std::unique_ptr<Handle>> handlesToClose;
+	{
+		std::unique_lock lock(m_mutex);
+		std::shared_ptr<Archive> archive = findArchive(absolutePath, fileSize, lastModified, handlesToClose);
+		if (archive)
+			return archive->m_directory;
+	}
+
+	// we don't; read the directory without holding the lock
+	std::unique_ptr<Handle> handle;
+	std::shared_ptr<const Directory> directory = readDirectory(absolutePath, fileSize, lastModified, handle);
+	if (!directory)
+		return { };
+
+	// and add it to the cache, along with the handle we used to read it
+	std::unique_lock lock(m_mutex);
+	addArchive(directory, std::move(handle), handlesToClose);
+	return directory;
+}
+
+
+//-------------------------------------------------
+//  extract - opens a member of an archive, using a
+//	pooled handle if we have one
+//-------------------------------------------------
+
+std::unique_ptr<QIODevice> ArchiveCache::extract(const std::shared_ptr<const Directory> &directory, int memberIndex)
+{
+	ProfilerScope prof(CURRENT_FUNCTION);
+
+	// find the archive that owns the pool; if the directory is no longer cached (because it
+	// was evicted or has since changed) we still extract but don't pool the handle
+	std::shared_ptr<Archive> archive;
+	{
+		std::unique_lock lock(m_mutex);
+		auto iter = m_archivesByPath.find(directory->path());
+		if (iter != m_archivesByPath.end() && (*iter->second)->m_directory == directory)
+		{
+			m_archives.splice(m_archives.begin(), m_archives, iter->second);
+			archive = *iter->second;
+		}
+	}
+	if (!archive)
+		archive = std::make_shared<Archive>(Archive { directory, { }, false });
+
+	// get a handle
+	std::unique_ptr<Handle> handle = checkOutHandle(archive);
+	if (!handle)
+		return { };
+
+	// and extract the member
+	const Directory::Member &member = directory->members()[memberIndex];
+	std::unique_ptr<QIODevice> result;
+	switch (directory->type())
+	{
+	case Directory::Type::Zip:
+		{
+			std::unique_ptr<ZipHandle> zipHandle(static_cast<ZipHandle *>(handle.release()));
+			if (zipHandle->seek(member))
+				result = std::make_unique<PooledZipFile>(*this, archive, std::move(zipHandle));
+			else
+				returnHandle(archive, std::move(zipHandle), false);
+		}
+		break;
+
+	case Directory::Type::SevenZip:
+		// 7-Zip extracts into memory, so we're done with the handle right away
+		result = static_cast<SevenZipHandle &>(*handle).m_7zipFile.extract((int)member.m_index);
+		returnHandle(archive, std::move(handle), true);
+		break;
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  setLimits
+//-------------------------------------------------
+
+void ArchiveCache::setLimits(int maxOpenHandles, std::size_t memoryBudget)
+{
+	std::vector<std::unique_ptr<Handle>> handlesToClose;
+	std::unique_lock lock(m_mutex);
+	m_maxOpenHandles = maxOpenHandles;
+	m_memoryBudget = memoryBudget;
+	enforceLimits(handlesToClose);
+}
+
+
+//-------------------------------------------------
+//  closeIdleHandles - closes pooled handles (but
+//	keeps the directories); pooled handles keep the
+//	archives open, which on some platforms stops
+//	the user from replacing them
+//-------------------------------------------------
+
+void ArchiveCache::closeIdleHandles()
+{
+	std::vector<std::unique_ptr<Handle>> handlesToClose;
+	std::unique_lock lock(m_mutex);
+	for (const std::shared_ptr<Archive> &archive : m_archives)
+	{
+		m_statistics.m_openHandles -= (int)archive->m_idleHandles.size();
+		std::move(archive->m_idleHandles.begin(), archive->m_idleHandles.end(), std::back_inserter(handlesToClose));
+		archive->m_idleHandles.clear();
+	}
+}
+
+
+//-------------------------------------------------
+//  statistics
+//-------------------------------------------------
+
+ArchiveCache::Statistics ArchiveCache::statistics() const
+{
+	std::unique_lock lock(m_mutex);
+	return m_statistics;
+}
+
+
+//-------------------------------------------------
+//  findArchive - finds a cached archive, provided
+//	that it has not changed; must be called with
+//	the lock held
+//-------------------------------------------------
+
+std::shared_ptr<ArchiveCache::Archive> ArchiveCache::findArchive(const QString &absolutePath, std::uint64_t fileSize, qint64 lastModified, std::vector<std::unique_ptr<Handle>> &handlesToClose)
+{
+	auto iter = m_archivesByPath.find(absolutePath);
+	if (iter == m_archivesByPath.end())
+		return { };
+
+	// if the archive changed, what we have is useless
+	const Directory &directory = *(*iter->second)->m_directory;
+	if (directory.fileSize() != fileSize || directory.lastModified() != lastModified)
+	{
+		removeArchive(iter->second, handlesToClose);
+		return { };
+	}
+
+	// this is now the most recently used archive
+	m_archives.splice(m_archives.begin(), m_archives, iter->second);
+	return *iter->second;
+}
+
+
+//-------------------------------------------------
+//  addArchive - must be called with the lock held
+//-------------------------------------------------
+
+void ArchiveCache::addArchive(const std::shared_ptr<const Directory> &directory, std::unique_ptr<Handle> &&handle, std::vector<std::unique_ptr<Handle>> &handlesToClose)
+{
+	// another thread may have beaten us to it
+	auto iter = m_archivesByPath.find(directory->path());
+	if (iter != m_archivesByPath.end())
+		removeArchive(iter->second, handlesToClose);
+
+	// add the archive
+	auto archive = std::make_shared<Archive>(Archive { directory, { }, true });
+	archive->m_idleHandles.push_back(std::move(handle));
+	m_archives.push_front(std::move(archive));
+	m_archivesByPath.emplace(directory->path(), m_archives.begin());
+
+	// update statistics
+	m_statistics.m_directoryReads++;
+	m_statistics.m_handleOpens++;
+	m_statistics.m_openHandles++;
+	m_statistics.m_cachedArchives++;
+	m_statistics.m_memoryUsage += directory->memoryUsage();
+
+	// and make room for it
+	enforceLimits(handlesToClose);
+}
+
+
+//-------------------------------------------------
+//  removeArchive - must be called with the lock
+//	held
+//-------------------------------------------------
+
+void ArchiveCache::removeArchive(ArchiveList::iterator iter, std::vector<std::unique_ptr<Handle>> &handlesToClose)
+{
+	// the archive may still be in use; handles returned later will be closed
+	Archive &archive = **iter;
+	archive.m_isCached = false;
+	m_statistics.m_openHandles -= (int)archive.m_idleHandles.size();
+	m_statistics.m_cachedArchives--;
+	m_statistics.m_memoryUsage -= archive.m_directory->memoryUsage();
+	std::move(archive.m_idleHandles.begin(), archive.m_idleHandles.end(), std::back_inserter(handlesToClose));
+	archive.m_idleHandles.clear();
+
+	m_archivesByPath.erase(archive.m_directory->path());
+	m_archives.erase(iter);
+}
+
+
+//-------------------------------------------------
+//  enforceLimits - evicts least recently used
+//	directories and idle handles until we are
+//	within budget; must be called with the lock held
+//-------------------------------------------------
+
+void ArchiveCache::enforceLimits(std::vector<std::unique_ptr<Handle>> &handlesToClose)
+{
+	// evict directories, but never the one most recently used
+	while (m_statistics.m_memoryUsage > m_memoryBudget && m_archives.size() > 1)
+		removeArchive(std::prev(m_archives.end()), handlesToClose);
+
+	// close idle handles; handles in use can't be closed, so the handle limit is only a goal
+	for (auto iter = m_archives.rbegin(); m_statistics.m_openHandles > m_maxOpenHandles && iter != m_archives.rend(); iter++)
+	{
+		std::vector<std::unique_ptr<Handle>> &idleHandles = (*iter)->m_idleHandles;
+		while (m_statistics.m_openHandles > m_maxOpenHandles && !idleHandles.empty())
+		{
+			handlesToClose.push_back(std::move(idleHandles.back()));
+			idleHandles.pop_back();
+			m_statistics.m_openHandles--;
+		}
+	}
+}
+
+
+//-------------------------------------------------
+//  checkOutHandle - takes a pooled handle, or opens
+//	a new one
+//-------------------------------------------------
+
+std::unique_ptr<ArchiveCache::Handle> ArchiveCache::checkOutHandle(const std::shared_ptr<Archive> &archive)
+{
+	// try the pool first
+	{
+		std::vector<std::unique_ptr<Handle>> handlesToClose;
+		std::unique_lock lock(m_mutex);
+		if (!archive->m_idleHandles.empty())
+		{
+			std::unique_ptr<Handle> handle = std::move(archive->m_idleHandles.back());
+			archive->m_idleHandles.pop_back();
+			return handle;
+		}
+
+		// we're going to open one; make room for it
+		m_statistics.m_handleOpens++;
+		m_statistics.m_openHandles++;
+		enforceLimits(handlesToClose);
+	}
+
+	// open the archive without holding the lock
+	std::unique_ptr<Handle> handle = openHandle(*archive->m_directory);
+	if (!handle)
+	{
+		std::unique_lock lock(m_mutex);
+		m_statistics.m_openHandles--;
+	}
+	return handle;
+}
+
+
+//-------------------------------------------------
+//  returnHandle - puts a handle back into the pool,
+//	or closes it
+//-------------------------------------------------
+
+void ArchiveCache::returnHandle(const std::shared_ptr<Archive> &archive, std::unique_ptr<Handle> handle, bool reusable)
+{
+	// the handle parameter outlives the lock, so any closing happens after unlocking
+	std::unique_lock lock(m_mutex);
+	if (reusable && archive->m_isCached && m_statistics.m_openHandles <= m_maxOpenHandles)
+		archive->m_idleHandles.push_back(std::move(handle));
+	else
+		m_statistics.m_openHandles--;
+}
+
+
+//-------------------------------------------------
+//  openHandle - opens an archive whose directory
+//	we've already read
+//-------------------------------------------------
+
+std::unique_ptr<ArchiveCache::Handle> ArchiveCache::openHandle(const Directory &directory)
+{
+	ProfilerScope prof(CURRENT_FUNCTION);
+
+	// if the archive has changed, the directory won't match
+	QFileInfo fi(directory.path());
+	if (fi.size() != (qint64)directory.fileSize() || fi.lastModified().toMSecsSinceEpoch() != directory.lastModified())
+		return { };
+
+	std::unique_ptr<Handle> result;
+	switch (directory.type())
+	{
+	case Directory::Type::Zip:
+		{
+			auto zipHandle = std::make_unique<ZipHandle>(directory.path());
+			if (zipHandle->open())
+				result = std::move(zipHandle);
+		}
+		break;
+
+	case Directory::Type::SevenZip:
+		{
+			auto sevenZipHandle = std::make_unique<SevenZipHandle>();
+			if (sevenZipHandle->m_7zipFile.open(directory.path()))
+				result = std::move(sevenZipHandle);
+		}
+		break;
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  readDirectory - opens an archive and reads its
+//	directory, returning the handle used so that it
+//	can be pooled
+//-------------------------------------------------
+
+std::shared_ptr<const ArchiveCache::Directory> ArchiveCache::readDirectory(const QString &absolutePath, std::uint64_t fileSize, qint64 lastModified, std::unique_ptr<Handle> &handle)
+{
+	ProfilerScope prof(CURRENT_FUNCTION);
+	std::vector<Directory::Member> members;
+
+	// is this a ZIP file?
+	auto zipHandle = std::make_unique<ZipHandle>(absolutePath);
+	if (zipHandle->open())
+	{
+		QuaZip &zip = zipHandle->m_zip;
+		members.reserve(zip.getEntriesCount());
+		for (bool more = zip.getEntriesCount() > 0 && zip.goToFirstFile(); more; more = zip.goToNextFile())
+		{
+			QuaZipFileInfo64 fileInfo;
+			unz64_file_pos filePos;
+			if (!zip.getCurrentFileInfo(&fileInfo) || unzGetFilePos64(zip.getUnzFile(), &filePos) != UNZ_OK)
+				return { };
+			members.push_back(Directory::Member { std::move(fileInfo.name), fileInfo.uncompressedSize, fileInfo.crc, filePos.num_of_file, filePos.pos_in_zip_directory });
+		}
+		if (zip.getZipError() != UNZ_OK && zip.getZipError() != UNZ_END_OF_LIST_OF_FILE)
+			return { };
+
+		handle = std::move(zipHandle);
+		return std::make_shared<Directory>(Directory::Type::Zip, QString(absolutePath), fileSize, lastModified, std::move(members));
+	}
+	zipHandle.reset();
+
+	// is this a 7-Zip file?
+	auto sevenZipHandle = std::make_unique<SevenZipHandle>();
+	SevenZipFile &sevenZipFile = sevenZipHandle->m_7zipFile;
+	if (sevenZipFile.open(absolutePath))
+	{
+		int entryCount = sevenZipFile.entryCount();
+		members.reserve(entryCount);
+		for (int i = 0; i < entryCount; i++)
+		{
+			if (!sevenZipFile.entryIsDirectory(i))
+				members.push_back(Directory::Member { sevenZipFile.entryName(i), sevenZipFile.entrySize(i), sevenZipFile.entryCrc32(i), (std::uint64_t)i, 0 });
+		}
+
+		handle = std::move(sevenZipHandle);
+		return std::make_shared<Directory>(Directory::Type::SevenZip, QString(absolutePath), fileSize, lastModified, std::move(members));
+	}
+
+	// not an archive that we know about
+	return { };
+}
+
+
+//-------------------------------------------------
+//  Directory ctor
+//-------------------------------------------------
+
+ArchiveCache::Directory::Directory(Type type, QString &&path, std::uint64_t fileSize, qint64 lastModified, std::vector<Member> &&members)
+	: m_type(type)
+	, m_path(std::move(path))
+	, m_fileSize(fileSize)
+	, m_lastModified(lastModified)
+	, m_members(std::move(members))
+{
+	ProfilerScope prof(CURRENT_FUNCTION);
+
+	// build the indexes; like MAME, names are case insensitive and if there are duplicates
+	// the first one wins
+	m_membersByName.reserve(m_members.size());
+	m_membersByCrc32.reserve(m_members.size());
+	m_memoryUsage = sizeof(*this) + m_path.size() * sizeof(QChar);
+	for (int i = 0; i < (int)m_members.size(); i++)
+	{
+		const Member &member = m_members[i];
+		m_membersByName.emplace(member.m_name.toLower(), i);
+		if (member.m_crc32)
+			m_membersByCrc32.emplace(*member.m_crc32, i);
+		m_memoryUsage += sizeof(Member) + member.m_name.size() * sizeof(QChar) * 2 + MEMBER_INDEX_OVERHEAD;
+	}
+}
+
+
+//-------------------------------------------------
+//  Directory::find - MAME looks up by CRC-32 if it
+//	has one, and falls back to the name
+//-------------------------------------------------
+
+std::optional<int> ArchiveCache::Directory::find(const QString &fileName, std::optional<std::uint32_t> crc32) const
+{
+	if (crc32)
+	{
+		auto iter = m_membersByCrc32.find(*crc32);
+		if (iter != m_membersByCrc32.end())
+			return iter->second;
+	}
+
+	auto iter = m_membersByName.find(fileName.toLower());
+	return iter != m_membersByName.end()
+		? iter->second
+		: std::optional<int>();
+}
@@ -0,0 +1,144 @@
+/***************************************************************************
+
+	archivecache.h
+
+	Process-wide cache of parsed archive (ZIP/7-Zip) directories and open
+	archive handles, shared by all AssetFinders
+
+***************************************************************************/
+
+#ifndef ARCHIVECACHE_H
+#define ARCHIVECACHE_H
+
+// Qt headers
+#include <QIODevice>
+#include <QString>
+
+// standard headers
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+// ======================> ArchiveCache
+
+class ArchiveCache
+{
+public:
+	class Test;
+
+	// the parsed directory of an archive; immutable once built, so it can be shared freely
+	// between threads
+	class Directory
+	{
+	public:
+		enum class Type
+		{
+			Zip,
+			SevenZip
+		};
+
+		struct Member
+		{
+			QString							m_name;
+			std::uint64_t					m_size;
+			std::optional<std::uint32_t>	m_crc32;
+			std::uint64_t					m_index;			// the entry number within the archive
+			std::uint64_t					m_position;			// the central directory offset (ZIP only)
+		};
+
+		// ctor
+		Directory(Type type, QString &&path, std::uint64_t fileSize, qint64 lastModified, std::vector<Member> &&members);
+		Directory(const Directory &) = delete;
+		Directory(Directory &&) = delete;
+
+		// accessors
+		Type type() const							{ return m_type; }
+		const QString &path() const					{ return m_path; }
+		std::uint64_t fileSize() const				{ return m_fileSize; }
+		qint64 lastModified() const					{ return m_lastModified; }
+		const std::vector<Member> &members() const	{ return m_members; }
+		std::size_t memoryUsage() const				{ return m_memoryUsage; }
+
+		// methods
+		std::optional<int> find(const QString &fileName, std::optional<std::uint32_t> crc32) const;
+
+	private:
+		Type									m_type;
+		QString									m_path;				// absolute path of the archive
+		std::uint64_t							m_fileSize;
+		qint64									m_lastModified;
+		std::vector<Member>						m_members;
+		std::unordered_map<QString, int>		m_membersByName;	// keyed by case folded name
+		std::unordered_map<std::uint32_t, int>	m_membersByCrc32;
+		std::size_t								m_memoryUsage;
+	};
+
+	struct Statistics
+	{
+		int				m_directoryReads;		// how many times we've parsed an archive's directory
+		int				m_handleOpens;			// how many times we've opened an archive
+		int				m_openHandles;			// archives currently open (in use or pooled)
+		int				m_cachedArchives;
+		std::size_t		m_memoryUsage;			// estimated memory used by cached directories
+	};
+
+	// ctor/dtor
+	ArchiveCache(int maxOpenHandles = 32, std::size_t memoryBudget = 32 * 1024 * 1024);
+	ArchiveCache(const ArchiveCache &) = delete;
+	ArchiveCache(ArchiveCache &&) = delete;
+	~ArchiveCache();
+
+	// methods
+	std::shared_ptr<const Directory> getDirectory(const QString &path);
+	std::unique_ptr<QIODevice> extract(const std::shared_ptr<const Directory> &directory, int memberIndex);
+	void setLimits(int maxOpenHandles, std::size_t memoryBudget);
+	void closeIdleHandles();
+	Statistics statistics() const;
+
+	// statics
+	static ArchiveCache &global();
+
+private:
+	class Handle;
+	class ZipHandle;
+	class SevenZipHandle;
+	class PooledZipFile;
+	struct Archive;
+
+	typedef std::list<std::shared_ptr<Archive>> ArchiveList;
+
+	// an archive we know about, along with any handles not presently in use
+	struct Archive
+	{
+		std::shared_ptr<const Directory>		m_directory;
+		std::vector<std::unique_ptr<Handle>>	m_idleHandles;
+		bool									m_isCached;
+	};
+
+	mutable std::mutex									m_mutex;
+	ArchiveList											m_archives;			// most recently used first
+	std::unordered_map<QString, ArchiveList::iterator>	m_archivesByPath;
+	int													m_maxOpenHandles;
+	std::size_t											m_memoryBudget;
+	Statistics											m_statistics;
+
+	std::shared_ptr<Archive> findArchive(const QString &absolutePath, std::uint64_t fileSize, qint64 lastModified, std::vector<std::unique_ptr<Handle>> &handlesToClose);
+	void addArchive(const std::shared_ptr<const Directory> &directory, std::unique_ptr<Handle> &&handle, std::vector<std::unique_ptr<Handle>> &handlesToClose);
+	void removeArchive(ArchiveList::iterator iter, std::vector<std::unique_ptr<Handle>> &handlesToClose);
+	void enforceLimits(std::vector<std::unique_ptr<Handle>> &handlesToClose);
+	std::unique_ptr<Handle> checkOutHandle(const std::shared_ptr<Archive> &archive);
+	void returnHandle(const std::shared_ptr<Archive> &archive, std::unique_ptr<Handle> handle, bool reusable);
+	static std::unique_ptr<Handle> openHandle(const Directory &directory);
+	static std::shared_ptr<const Directory> readDirectory(const QString &absolutePath, std::uint64_t fileSize, qint64 lastModified, std::unique_ptr<Handle> &handle);
+};
+
+
+#endif // ARCHIVECACHE_H
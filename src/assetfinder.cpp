@@ -8,12 +8,12 @@
 
 // bletchmame headers
 #include "assetfinder.h"
+#include "archivecache.h"
 #include "perfprofiler.h"
-#include "7zip.h"
 
-// dependency headers
-#include <quazip.h>
-#include <quazipfile.h>
+// Qt headers
+#include <QDateTime>
+#include <QFileInfo>
 
 
 //**************************************************************************
@@ -32,6 +32,13 @@ public:
 
 	virtual ~Lookup() { }
 	virtual std::unique_ptr<QIODevice> getAsset(const QString &fileName, std::optional<std::uint32_t> crc32) = 0;
+	virtual std::optional<Identity> getAssetIdentity(const QString &fileName, std::optional<std::uint32_t> crc32) = 0;
+
+protected:
+	static qint64 lastModified(const QFileInfo &fi)
+	{
+		return fi.lastModified().toMSecsSinceEpoch();
+	}
 };
 
 
@@ -49,115 +56,58 @@ public:
 		return std::make_unique<QFile>(m_path + "/" + fileName);
 	}
 
+	virtual std::optional<Identity> getAssetIdentity(const QString &fileName, std::optional<std::uint32_t> crc32) override
+	{
+		QFileInfo fi(m_path + "/" + fileName);
+		if (!fi.isFile())
+			return { };
+		return Identity { fi.absoluteFilePath(), QString(), (std::uint64_t)fi.size(), lastModified(fi) };
+	}
+
 private:
 	QString		m_path;
 };
 
 
-// ======================> AssetFinder::ZipFileLookup
-class AssetFinder::ZipFileLookup : public AssetFinder::Lookup
+// ======================> AssetFinder::ArchiveLookup
+class AssetFinder::ArchiveLookup : public AssetFinder::Lookup
 {
 public:
-	ZipFileLookup(const QString &path)
-		: m_zip(path)
+	ArchiveLookup(std::shared_ptr<const ArchiveCache::Directory> &&directory)
+		: m_directory(std::move(directory))
 	{
 	}
 
-	bool openZip()
-	{
-		return m_zip.open(QuaZip::Mode::mdUnzip);
-	}
-
 	virtual std::unique_ptr<QIODevice> getAsset(const QString &fileName, std::optional<std::uint32_t> crc32) override
 	{
-		// find the file
-		if (!findFileInZip(fileName, crc32))
-			return { };
-
-		// and return a QuaZipFile
-		return std::make_unique<QuaZipFile>(&m_zip);
-	}
-
-	static Lookup::ptr tryOpen(const QString &path)
-	{
-		auto lookup = std::make_unique<ZipFileLookup>(path);
-		return lookup->openZip()
-			? std::move(lookup)
-			: nullptr;
+		// find the file, and extract it with one of the cache's pooled handles
+		std::optional<int> index = m_directory->find(fileName, crc32);
+		return index
+			? ArchiveCache::global().extract(m_directory, *index)
+			: std::unique_ptr<QIODevice>();
 	}
 
-private:
-	QuaZip														m_zip;
-	std::optional<std::unordered_map<std::uint32_t, QString>>	m_crc32Map;
-
-	bool findFileInZip(const QString &fileName, std::optional<std::uint32_t> crc32)
+	virtual std::optional<Identity> getAssetIdentity(const QString &fileName, std::optional<std::uint32_t> crc32) override
 	{
-		// if we have a crc32, we have an opportunity to lookup by CRC-32
-		if (crc32)
-		{
-			// did we build the CRC-32 map?
-			if (!m_crc32Map)
-				buildCrc32Map();
-
-			// perform a file lookup by CRC-32
-			auto iter = m_crc32Map->find(*crc32);
-			if (iter != m_crc32Map->end() && setCurrentFile(iter->second, QuaZip::CaseSensitivity::csSensitive))
-				return true;
-		}
-
-		// perform a file lookup by name
-		return setCurrentFile(fileName, QuaZip::CaseSensitivity::csInsensitive);
-	}
-
-	void buildCrc32Map()
-	{
-		ProfilerScope prof(CURRENT_FUNCTION);
-		m_crc32Map.emplace();
-		QList<QuaZipFileInfo64> allFiles = m_zip.getFileInfoList64();
-		for (QuaZipFileInfo64 &fi : allFiles)
-			m_crc32Map->emplace(fi.crc, std::move(fi.name));
-	}
-
-	bool setCurrentFile(const QString &fileName, QuaZip::CaseSensitivity cs)
-	{
-		ProfilerScope prof(CURRENT_FUNCTION);
-		return m_zip.setCurrentFile(fileName, cs);
-	}
-};
-
-
-// ======================> AssetFinder::SevenZipFileLookup
-class AssetFinder::SevenZipFileLookup : public AssetFinder::Lookup
-{
-public:
-	bool open(const QString &path)
-	{
-		return m_7zipFile.open(path);
-	}
+		// same logic as getAsset(), but the directory has everything we need
+		std::optional<int> index = m_directory->find(fileName, crc32);
+		if (!index)
+			return { };
 
-	virtual std::unique_ptr<QIODevice> getAsset(const QString &fileName, std::optional<std::uint32_t> crc32) override
-	{
-		// try the CRC-32 if present
-		std::unique_ptr<QIODevice> file;
-		if (crc32)
-			file = m_7zipFile.get(*crc32);
-
-		// otherwise try the file name
-		if (!file)
-			file = m_7zipFile.get(fileName);
-		return file;
+		const ArchiveCache::Directory::Member &member = m_directory->members()[*index];
+		return Identity { m_directory->path(), member.m_name, member.m_size, m_directory->lastModified(), member.m_crc32 };
 	}
 
 	static Lookup::ptr tryOpen(const QString &path)
 	{
-		auto lookup = std::make_unique<SevenZipFileLookup>();
-		return lookup->open(path)
-			? std::move(lookup)
+		std::shared_ptr<const ArchiveCache::Directory> directory = ArchiveCache::global().getDirectory(path);
+		return directory
+			? std::make_unique<ArchiveLookup>(std::move(directory))
 			: nullptr;
 	}
 
 private:
-	SevenZipFile	m_7zipFile;
+	std::shared_ptr<const ArchiveCache::Directory>	m_directory;
 };
 
 
@@ -228,9 +178,7 @@ void AssetFinder::setPaths(QStringList &&paths)
 		else if (fi.isFile())
 		{
 			// is this an archive (ZIP or 7-Zip) file?
-			lookup = ZipFileLookup::tryOpen(path);
-			if (!lookup)
-				lookup = SevenZipFileLookup::tryOpen(path);
+			lookup = ArchiveLookup::tryOpen(path);
 		}
 
 		// if successful, add it
@@ -285,12 +233,30 @@ std::optional<QByteArray> AssetFinder::findAssetBytes(const QString &fileName, s
 }
 
 
+//-------------------------------------------------
+//  findAssetIdentity - identifies the asset that
+//	findAsset() would return, without opening it
+//-------------------------------------------------
+
+std::optional<AssetFinder::Identity> AssetFinder::findAssetIdentity(const QString &fileName, std::optional<std::uint32_t> crc32) const
+{
+	ProfilerScope prof(CURRENT_FUNCTION);
+	for (const Lookup::ptr &lookup : m_lookups)
+	{
+		std::optional<Identity> identity = lookup->getAssetIdentity(fileName, crc32);
+		if (identity)
+			return identity;
+	}
+	return { };
+}
+
+
 //-------------------------------------------------
 //  isValidArchive - utility method housed here
-//	to insulate rest of app from QuaZip
+//	to insulate rest of app from the archive cache
 //-------------------------------------------------
 
 bool AssetFinder::isValidArchive(const QString &path)
 {
-	return ZipFileLookup::tryOpen(path) || SevenZipFileLookup::tryOpen(path);
+	return ArchiveCache::global().getDirectory(path) != nullptr;
 }
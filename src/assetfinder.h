@@ -25,6 +25,17 @@
 class AssetFinder
 {
 public:
+	// identifies an asset by where it lives and what the file system says about it; if any of
+	// this changes, the contents are presumed to have changed
+	struct Identity
+	{
+		QString							m_path;				// the file, or the archive containing it
+		QString							m_member;			// the name within the archive (empty if not in one)
+		std::uint64_t					m_size;
+		qint64							m_lastModified;		// modification time of m_path, in msecs since the epoch
+		std::optional<std::uint32_t>	m_crc32 = { };		// the CRC-32 recorded by the archive (if any)
+	};
+
 	// ctor/dtor
 	AssetFinder();
 	AssetFinder(QStringList &&paths);
@@ -38,6 +49,7 @@ public:
 	void setPaths(const Preferences &prefs, Preferences::global_path_type pathType);
 	std::unique_ptr<QIODevice> findAsset(const QString &fileName, std::optional<std::uint32_t> crc32 = { }) const;
 	std::optional<QByteArray> findAssetBytes(const QString &fileName, std::optional<std::uint32_t> crc32 = { }) const;
+	std::optional<Identity> findAssetIdentity(const QString &fileName, std::optional<std::uint32_t> crc32 = { }) const;
 
 	// statics
 	static bool isValidArchive(const QString &path);
@@ -45,8 +57,7 @@ public:
 private:
 	class Lookup;
 	class DirectoryLookup;
-	class ZipFileLookup;
-	class SevenZipFileLookup;
+	class ArchiveLookup;
 
 	// members
 	std::vector<std::unique_ptr<Lookup>> m_lookups;
@@ -8,8 +8,8 @@
 
 // bletchmame headers
 #include "audit.h"
-#include "assetfinder.h"
 #include "chd.h"
+#include "hashcache.h"
 
 
 //**************************************************************************
@@ -46,6 +46,7 @@ private:
 //-------------------------------------------------
 
 Audit::Audit()
+	: m_isForSoftware(false)
 {
 }
 
@@ -148,6 +149,9 @@ QStringList Audit::buildMachinePaths(const Preferences &prefs, Preferences::glob
 
 void Audit::addMediaForSoftware(const Preferences &prefs, const software_list::software &software)
 {
+	// the hash cache needs to know that software list media is not covered by machine sweeps
+	m_isForSoftware = true;
+
 	// get base paths from preferences
 	QStringList basePaths = prefs.getSplitPaths(Preferences::global_path_type::ROMS);
 
@@ -196,7 +200,7 @@ int Audit::appendPaths(QStringList &&paths)
 //  run
 //-------------------------------------------------
 
-std::optional<AuditStatus> Audit::run(ICallback &callback) const
+std::optional<AuditStatus> Audit::run(ICallback &callback, HashCache *hashCache, Mode mode) const
 {
 	Session session(callback);
 	std::vector<std::unique_ptr<AssetFinder>> assetFinders;
@@ -204,7 +208,7 @@ std::optional<AuditStatus> Audit::run(ICallback &callback) const
 	// loop through all entries
 	int i = 0;
 	for (i = 0; !session.hasAborted() && i < m_entries.size(); i++)
-		auditSingleMedia(session, i, assetFinders);
+		auditSingleMedia(session, i, assetFinders, hashCache, mode);
 
 	// report the results accordingly - note that hypothetically we could have been
 	// aborted after we completed, in which case we want to report complete results
@@ -218,7 +222,7 @@ std::optional<AuditStatus> Audit::run(ICallback &callback) const
 //  auditSingleMedia
 //-------------------------------------------------
 
-void Audit::auditSingleMedia(Session &session, int entryIndex, std::vector<std::unique_ptr<AssetFinder>> &assetFinders) const
+void Audit::auditSingleMedia(Session &session, int entryIndex, std::vector<std::unique_ptr<AssetFinder>> &assetFinders, HashCache *hashCache, Mode mode) const
 {
 	// find the entry
 	const Entry &entry = m_entries[entryIndex];
@@ -238,11 +242,61 @@ void Audit::auditSingleMedia(Session &session, int entryIndex, std::vector<std::
 	// identify the AssetFinder
 	const AssetFinder &assetFinder = *assetFinders[entry.pathsPosition()];
 
+	// see if we can reach a verdict without hashing the asset
+	std::optional<AssetFinder::Identity> identity;
+	if (needsIdentity(entry, hashCache, mode))
+	{
+		identity = assetFinder.findAssetIdentity(entry.name(), entry.expectedHash().crc32());
+		std::optional<Verdict> verdict = identity
+			? tryGetVerdictWithoutHashing(entry, *identity, hashCache, m_isForSoftware, mode)
+			: std::optional<Verdict>();
+		if (verdict)
+		{
+			session.verdictReached(getAuditStatus(entry, *verdict), entryIndex, *verdict);
+			return;
+		}
+	}
+
 	// try to find the asset
 	std::unique_ptr<QIODevice> stream = assetFinder.findAsset(
 		entry.name(),
 		entry.expectedHash().crc32());
 
+	// we're going to calculate the hash - prep a callback
+	std::uint64_t streamSize = stream ? stream->size() : 0;
+	auto calculateHashCallback = [&session, entryIndex, streamSize](std::uint64_t bytesProcessed)
+	{
+		return session.reportProgress(entryIndex, bytesProcessed, streamSize);
+	};
+
+	// and time to get a verdict
+	std::optional<Verdict> verdict = calculateVerdict(entry, stream.get(), streamSize, calculateHashCallback);
+	if (!verdict)
+	{
+		// user cancelled; bail
+		return;
+	}
+
+	// remember the hash if we can
+	if (identity && stream && hashCache)
+		hashCache->add(*identity, verdict->actualHash(), m_isForSoftware);
+
+	// determine the audit status
+	AuditStatus status = getAuditStatus(entry, *verdict);
+
+	// and report this stuff
+	session.verdictReached(status, entryIndex, *verdict);
+}
+
+
+//-------------------------------------------------
+//  calculateVerdict - hashes an asset (if found)
+//	and reaches a verdict; returns an empty result
+//	if cancelled
+//-------------------------------------------------
+
+std::optional<Audit::Verdict> Audit::calculateVerdict(const Entry &entry, QIODevice *stream, std::uint64_t streamSize, const Hash::CalculateCallback &callback)
+{
 	// get critical information
 	std::optional<std::uint64_t> actualSize;
 	Hash actualHash;
@@ -257,25 +311,16 @@ void Audit::auditSingleMedia(Session &session, int entryIndex, std::vector<std::
 	}
 	else
 	{
-		// we're going to calculate the hash - prep a callback
-		std::uint64_t streamSize = stream->size();
-		auto calculateHashCallback = [&session, entryIndex, streamSize](std::uint64_t bytesProcessed)
-		{
-			return session.reportProgress(entryIndex, bytesProcessed, streamSize);
-		};
-
 		// calculate the hash
-		switch (entry.calculateHashFunc()(*stream, calculateHashCallback, actualHash))
+		switch (entry.calculateHashFunc()(*stream, callback, actualHash))
 		{
 		case Entry::CalculateHashStatus::Success:
 			// we've successfully processed the hash - now evaluate them
-			actualSize = streamSize;
-			verdictType = evaluateHashes(entry.expectedSize(), entry.expectedHash(), *actualSize, actualHash, entry.dumpStatus());
-			break;
+			return getVerdictForHash(entry, streamSize, actualHash);
 
 		case Entry::CalculateHashStatus::Cancelled:
 			// user cancelled; bail
-			return;
+			return { };
 
 		case Entry::CalculateHashStatus::CantProcess:
 			// we couldn't process the asset (corrupt CHD?)
@@ -286,19 +331,87 @@ void Audit::auditSingleMedia(Session &session, int entryIndex, std::vector<std::
 	}
 
 	// build the actual verdict
-	Verdict verdict(*verdictType, *actualSize, actualHash);
+	return Verdict(*verdictType, *actualSize, actualHash);
+}
 
-	// determine the audit status
+
+//-------------------------------------------------
+//  getAuditStatus
+//-------------------------------------------------
+
+AuditStatus Audit::getAuditStatus(const Entry &entry, const Verdict &verdict)
+{
 	AuditStatus status;
-	if (isVerdictSuccessful(*verdictType))
+	if (isVerdictSuccessful(verdict.type()))
 		status = AuditStatus::Found;
 	else if (entry.optional())
 		status = AuditStatus::MissingOptional;
 	else
 		status = AuditStatus::Missing;
+	return status;
+}
 
-	// and report this stuff
-	session.verdictReached(status, entryIndex, verdict);
+
+//-------------------------------------------------
+//  getVerdictForHash - reaches a verdict on an
+//	asset whose hash we know
+//-------------------------------------------------
+
+Audit::Verdict Audit::getVerdictForHash(const Entry &entry, std::uint64_t actualSize, const Hash &actualHash)
+{
+	Verdict::Type verdictType = evaluateHashes(entry.expectedSize(), entry.expectedHash(), actualSize, actualHash, entry.dumpStatus());
+	return Verdict(verdictType, actualSize, actualHash);
+}
+
+
+//-------------------------------------------------
+//  isHashCacheable - can the hash for this entry
+//	be kept in a HashCache?
+//-------------------------------------------------
+
+bool Audit::isHashCacheable(const Entry &entry)
+{
+	// only cache hashes that came from the whole asset; CHDs are already cheap
+	return !entry.hashReadLength();
+}
+
+
+//-------------------------------------------------
+//  needsIdentity - do we want to look up this
+//	entry's AssetFinder::Identity before hashing?
+//-------------------------------------------------
+
+bool Audit::needsIdentity(const Entry &entry, const HashCache *hashCache, Mode mode)
+{
+	return isHashCacheable(entry) && (hashCache || mode == Mode::Fast);
+}
+
+
+//-------------------------------------------------
+//  tryGetVerdictWithoutHashing - attempts to reach
+//	a verdict from what we know about the asset
+//	without reading it
+//-------------------------------------------------
+
+std::optional<Audit::Verdict> Audit::tryGetVerdictWithoutHashing(const Entry &entry, const AssetFinder::Identity &identity, const HashCache *hashCache, bool forSoftware, Mode mode)
+{
+	// in fast mode we trust the archive's directory; note that we only take its word for it
+	// if everything matches, and fall back to hashing so that mismatches have full details
+	if (mode == Mode::Fast && identity.m_crc32 && entry.expectedHash().crc32())
+	{
+		Hash actualHash(identity.m_crc32);
+		Verdict::Type verdictType = evaluateHashes(entry.expectedSize(), entry.expectedHash().mask(true, false), identity.m_size, actualHash, entry.dumpStatus());
+		if (isVerdictSuccessful(verdictType))
+			return Verdict(verdictType, identity.m_size, actualHash);
+	}
+
+	// have we hashed this asset before?
+	std::optional<Hash> cachedHash = hashCache
+		? hashCache->find(identity, forSoftware)
+		: std::optional<Hash>();
+	return cachedHash
+		? getVerdictForHash(entry, identity.m_size, *cachedHash)
+		: std::optional<Verdict>();
 }
 
 
@@ -390,6 +503,20 @@ Audit::Entry::Entry(Type type, const QString &name, int pathsPosition, Calculate
 }
 
 
+//-------------------------------------------------
+//  Entry::hashReadLength
+//-------------------------------------------------
+
+std::optional<qint64> Audit::Entry::hashReadLength() const
+{
+	// CHDs carry their hash in the header, so there is no need to read the (potentially
+	// massive) rest of the file
+	return m_type == Type::Disk
+		? CHD_HEADER_READ_LENGTH
+		: std::optional<qint64>();
+}
+
+
 //-------------------------------------------------
 //  Session ctor
 //-------------------------------------------------
@@ -10,6 +10,7 @@
 #define AUDIT_H
 
 // bletchmame headers
+#include "assetfinder.h"
 #include "info.h"
 #include "prefs.h"
 #include "hash.h"
@@ -20,7 +21,7 @@
 //  TYPE DECLARATIONS
 //**************************************************************************
 
-class AssetFinder;
+class HashCache;
 
 
 // ======================> Audit
@@ -30,6 +31,16 @@ class Audit
 public:
 	class Test;
 
+	enum class Mode
+	{
+		// trusts the sizes and CRC-32s recorded in archives, and only hashes assets when
+		// that is inconclusive
+		Fast,
+
+		// always hashes the asset
+		Thorough
+	};
+
 	// ======================> Audit::Verdict
 
 	class Verdict
@@ -103,6 +114,9 @@ public:
 		const Hash &expectedHash() const					{ return m_expectedHash; }
 		bool optional() const								{ return m_optional; }
 
+		// how much of the asset calculateHashFunc() needs to see (empty for all of it)
+		std::optional<qint64> hashReadLength() const;
+
 	private:
 		Type							m_type;
 		QString							m_name;
@@ -126,15 +140,23 @@ public:
 	Audit();
 
 	// accessors
-	const std::vector<Entry> &entries() const	{ return m_entries; }
+	const std::vector<Entry> &entries() const				{ return m_entries; }
+	const QStringList &entryPaths(const Entry &entry) const	{ return m_pathList[entry.pathsPosition()]; }
+	bool isForSoftware() const								{ return m_isForSoftware; }
 
 	// methods
 	void addMediaForMachine(const Preferences &prefs, const info::machine &machine);
 	void addMediaForSoftware(const Preferences &prefs, const software_list::software &software);
-	std::optional<AuditStatus> run(ICallback &callback) const;
+	std::optional<AuditStatus> run(ICallback &callback, HashCache *hashCache = nullptr, Mode mode = Mode::Thorough) const;
 
 	// statics
 	static bool isVerdictSuccessful(Audit::Verdict::Type verdictType);
+	static std::optional<Verdict> calculateVerdict(const Entry &entry, QIODevice *stream, std::uint64_t streamSize, const Hash::CalculateCallback &callback);
+	static AuditStatus getAuditStatus(const Entry &entry, const Verdict &verdict);
+	static Verdict getVerdictForHash(const Entry &entry, std::uint64_t actualSize, const Hash &actualHash);
+	static bool isHashCacheable(const Entry &entry);
+	static bool needsIdentity(const Entry &entry, const HashCache *hashCache, Mode mode);
+	static std::optional<Verdict> tryGetVerdictWithoutHashing(const Entry &entry, const AssetFinder::Identity &identity, const HashCache *hashCache, bool forSoftware, Mode mode);
 
 private:
 	class Session;
@@ -142,11 +164,12 @@ private:
 	// variables
 	std::vector<QStringList>				m_pathList;
 	std::vector<Entry>						m_entries;
+	bool									m_isForSoftware;
 
 	// methods
 	QStringList buildMachinePaths(const Preferences &prefs, Preferences::global_path_type pathType, std::optional<info::machine> machine);
 	int appendPaths(QStringList &&paths);
-	void auditSingleMedia(Session &session, int entryIndex, std::vector<std::unique_ptr<AssetFinder>> &assetFinders) const;
+	void auditSingleMedia(Session &session, int entryIndex, std::vector<std::unique_ptr<AssetFinder>> &assetFinders, HashCache *hashCache, Mode mode) const;
 	static Verdict::Type evaluateHashes(const std::optional<std::uint32_t> &expectedSize, const Hash &expectedHash,
 		std::uint64_t actualSize, const Hash &actualHash, info::rom::dump_status_t dumpStatus);
 };
@@ -0,0 +1,390 @@
+/***************************************************************************
+
+	auditengine.cpp
+
+	Engine for running background audits on a fixed pool of threads
+
+***************************************************************************/
+
+// bletchmame headers
+#include "auditengine.h"
+#include "archivecache.h"
+#include "hashcache.h"
+#include "perfprofiler.h"
+
+// Qt headers
+#include <QBuffer>
+#include <QThread>
+
+// standard headers
+#include <algorithm>
+#include <thread>
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+AuditEngine::AuditEngine(EventHandlerFunc &&eventHandler, HashCache *hashCache, Audit::Mode mode, int hashThreadCount, qint64 readAheadBudget)
+	: m_eventHandler(std::move(eventHandler))
+	, m_hashCache(hashCache)
+	, m_mode(mode)
+	, m_readAheadBudget(readAheadBudget)
+	, m_bytesInFlight(0)
+	, m_aborting(false)
+{
+	// if we were not told how many hashing threads to use, use one per core
+	if (hashThreadCount <= 0)
+		hashThreadCount = (int)std::max(std::thread::hardware_concurrency(), 1U);
+
+	// we're a background activity, so lower the priority (lets be nice!)
+	m_ioThread.reset(QThread::create([this] { ioThreadProc(); }));
+	m_ioThread->start(QThread::LowestPriority);
+	m_hashThreads.reserve(hashThreadCount);
+	for (int i = 0; i < hashThreadCount; i++)
+	{
+		auto &thread = m_hashThreads.emplace_back(QThread::create([this] { hashThreadProc(); }));
+		thread->start(QThread::LowestPriority);
+	}
+}
+
+
+//-------------------------------------------------
+//  dtor
+//-------------------------------------------------
+
+AuditEngine::~AuditEngine()
+{
+	stop();
+}
+
+
+//-------------------------------------------------
+//  stop - aborts whatever is in flight and waits
+//	for all threads to finish; no results are posted
+//	and no hashes are cached after this returns
+//-------------------------------------------------
+
+void AuditEngine::stop()
+{
+	// instruct everything to abort
+	{
+		std::unique_lock lock(m_mutex);
+		m_aborting = true;
+	}
+	m_readCondition.notify_all();
+	m_hashCondition.notify_all();
+
+	// and join all threads
+	m_ioThread->wait();
+	for (const std::unique_ptr<QThread> &thread : m_hashThreads)
+		thread->wait();
+}
+
+
+//-------------------------------------------------
+//  submit - queues up a batch of audits; an
+//	AuditResultEvent is posted when all of them
+//	have completed
+//-------------------------------------------------
+
+void AuditEngine::submit(AuditBatch::ptr &&batch)
+{
+	std::unique_ptr<AuditResultEvent> resultEvent;
+	{
+		std::unique_lock lock(m_mutex);
+		BatchState &batchState = m_batches.emplace_back(std::move(batch));
+
+		// queue up a read for every entry of every audit
+		const std::vector<AuditBatch::Entry> &entries = batchState.m_batch->entries();
+		for (int auditIndex = 0; auditIndex < entries.size(); auditIndex++)
+		{
+			for (int entryIndex = 0; entryIndex < entries[auditIndex].m_audit.entries().size(); entryIndex++)
+				m_readRequests.emplace_back(&batchState, auditIndex, entryIndex);
+		}
+
+		// it is possible that there is nothing to read at all
+		if (batchState.m_remainingEntries == 0)
+			resultEvent = retireBatch(batchState);
+	}
+
+	if (resultEvent)
+		m_eventHandler(std::move(resultEvent));
+	else
+		m_readCondition.notify_one();
+}
+
+
+//-------------------------------------------------
+//  pendingBatchCount
+//-------------------------------------------------
+
+std::size_t AuditEngine::pendingBatchCount() const
+{
+	std::unique_lock lock(m_mutex);
+	return m_batches.size();
+}
+
+
+//-------------------------------------------------
+//  ioThreadProc - the I/O scheduler; this is the
+//	only thread that touches the disk
+//-------------------------------------------------
+
+void AuditEngine::ioThreadProc()
+{
+	std::vector<ReadRequest> requests;
+	for (;;)
+	{
+		// wait for reads to show up, and take all of them
+		{
+			std::unique_lock lock(m_mutex);
+			m_readCondition.wait(lock, [this] { return m_aborting || !m_readRequests.empty(); });
+			if (m_aborting)
+				return;
+			std::swap(requests, m_readRequests);
+		}
+
+		// order the reads by path, so that each archive is opened once and directories are
+		// visited in order rather than us seeking all over the place
+		std::ranges::stable_sort(requests, [](const ReadRequest &a, const ReadRequest &b)
+		{
+			const QStringList &aPaths = a.audit().entryPaths(a.entry());
+			const QStringList &bPaths = b.audit().entryPaths(b.entry());
+			return aPaths != bPaths
+				? aPaths < bPaths
+				: a.entry().name() < b.entry().name();
+		});
+
+		// and process the reads
+		std::unique_ptr<AssetFinder> assetFinder;
+		std::optional<QStringList> assetFinderPaths;
+		for (const ReadRequest &request : requests)
+		{
+			if (m_aborting)
+				return;
+
+			// we only need a new AssetFinder when the paths change; note that we can't hold on
+			// to the batch's paths because the batch can be retired once we've read from it
+			const Audit::Entry &entry = request.entry();
+			const QStringList &paths = request.audit().entryPaths(entry);
+			if (!assetFinderPaths || *assetFinderPaths != paths)
+			{
+				assetFinder = std::make_unique<AssetFinder>(QStringList(paths));
+				assetFinderPaths = paths;
+			}
+
+			// if the archive's directory or the hash cache can tell us what we need, we don't
+			// need to read the asset at all
+			std::optional<AssetFinder::Identity> identity;
+			if (Audit::needsIdentity(entry, m_hashCache, m_mode))
+			{
+				identity = assetFinder->findAssetIdentity(entry.name(), entry.expectedHash().crc32());
+				std::optional<Audit::Verdict> verdict = identity
+					? Audit::tryGetVerdictWithoutHashing(entry, *identity, m_hashCache, request.audit().isForSoftware(), m_mode)
+					: std::optional<Audit::Verdict>();
+				if (verdict)
+				{
+					reportVerdict(request, *verdict);
+					continue;
+				}
+			}
+
+			// try to find the asset
+			std::unique_ptr<QIODevice> stream = assetFinder->findAsset(entry.name(), entry.expectedHash().crc32());
+			if (!stream)
+			{
+				queueHashJob(HashJob{ request, false });
+				continue;
+			}
+
+			// how much do we need to read?
+			std::uint64_t assetSize = stream->size();
+			qint64 readLength = std::min((qint64)assetSize, entry.hashReadLength().value_or(assetSize));
+			if (readLength > m_readAheadBudget)
+			{
+				// this asset is bigger than our whole read-ahead budget; hash it here as it is
+				// read, since it would not overlap with anything else anyway
+				completeRequest(request, stream.get(), assetSize, identity);
+				continue;
+			}
+
+			// wait until there is room in the read-ahead budget
+			{
+				std::unique_lock lock(m_mutex);
+				m_readCondition.wait(lock, [this, readLength] { return m_aborting || m_bytesInFlight + readLength <= m_readAheadBudget; });
+				m_bytesInFlight += readLength;
+			}
+
+			// and read it
+			QByteArray data;
+			{
+				ProfilerScope prof(CURRENT_FUNCTION);
+				data = stream->read(readLength);
+			}
+			queueHashJob(HashJob{ request, true, std::move(data), assetSize, readLength, std::move(identity) });
+		}
+		requests.clear();
+
+		// if that was all of the reading for now, don't hold archives open while we're idle
+		bool isIdle;
+		{
+			std::unique_lock lock(m_mutex);
+			isIdle = m_readRequests.empty();
+		}
+		if (isIdle)
+			ArchiveCache::global().closeIdleHandles();
+	}
+}
+
+
+//-------------------------------------------------
+//  hashThreadProc
+//-------------------------------------------------
+
+void AuditEngine::hashThreadProc()
+{
+	for (;;)
+	{
+		// wait for a job
+		std::optional<HashJob> job;
+		{
+			std::unique_lock lock(m_mutex);
+			m_hashCondition.wait(lock, [this] { return m_aborting || !m_hashJobs.empty(); });
+			if (m_aborting)
+				return;
+			job.emplace(std::move(m_hashJobs.front()));
+			m_hashJobs.pop_front();
+		}
+
+		// hash what the I/O thread read for us
+		if (job->m_found)
+		{
+			QBuffer buffer(&job->m_data);
+			buffer.open(QIODevice::ReadOnly);
+			completeRequest(job->m_request, &buffer, job->m_assetSize, job->m_identity);
+		}
+		else
+		{
+			completeRequest(job->m_request, nullptr, 0, std::nullopt);
+		}
+
+		// give the bytes back to the read-ahead budget
+		if (job->m_reservedBytes > 0)
+		{
+			{
+				std::unique_lock lock(m_mutex);
+				m_bytesInFlight -= job->m_reservedBytes;
+			}
+			m_readCondition.notify_one();
+		}
+	}
+}
+
+
+//-------------------------------------------------
+//  queueHashJob
+//-------------------------------------------------
+
+void AuditEngine::queueHashJob(HashJob &&job)
+{
+	{
+		std::unique_lock lock(m_mutex);
+		m_hashJobs.push_back(std::move(job));
+	}
+	m_hashCondition.notify_one();
+}
+
+
+//-------------------------------------------------
+//  completeRequest - hashes a single entry and
+//	reaches a verdict on it
+//-------------------------------------------------
+
+void AuditEngine::completeRequest(const ReadRequest &request, QIODevice *stream, std::uint64_t assetSize, const std::optional<AssetFinder::Identity> &identity)
+{
+	// calculate the verdict
+	const Audit::Entry &entry = request.entry();
+	auto callback = [this](std::uint64_t)
+	{
+		return m_aborting.load();
+	};
+	std::optional<Audit::Verdict> verdict = Audit::calculateVerdict(entry, stream, assetSize, callback);
+	if (!verdict)
+		return;
+
+	// remember the hash for next time
+	if (identity && m_hashCache)
+		m_hashCache->add(*identity, verdict->actualHash(), request.audit().isForSoftware());
+
+	reportVerdict(request, *verdict);
+}
+
+
+//-------------------------------------------------
+//  reportVerdict - aggregates the verdict on a
+//	single entry, and posts the results if this
+//	was the last one in its batch
+//-------------------------------------------------
+
+void AuditEngine::reportVerdict(const ReadRequest &request, const Audit::Verdict &verdict)
+{
+	// aggregate the status
+	AuditStatus status = Audit::getAuditStatus(request.entry(), verdict);
+	std::unique_ptr<AuditResultEvent> resultEvent;
+	{
+		std::unique_lock lock(m_mutex);
+		BatchState &batchState = *request.m_batchState;
+		AuditStatus &auditStatus = batchState.m_statuses[request.m_auditIndex];
+		if (status > auditStatus)
+			auditStatus = status;
+
+		// was this the last one?
+		if (--batchState.m_remainingEntries == 0)
+			resultEvent = retireBatch(batchState);
+	}
+
+	// if so, report the results
+	if (resultEvent)
+		m_eventHandler(std::move(resultEvent));
+}
+
+
+//-------------------------------------------------
+//  retireBatch - builds the results for a batch
+//	and gets rid of it; the lock must be held
+//-------------------------------------------------
+
+std::unique_ptr<AuditResultEvent> AuditEngine::retireBatch(BatchState &batchState)
+{
+	// build the results
+	const std::vector<AuditBatch::Entry> &entries = batchState.m_batch->entries();
+	std::vector<AuditResult> results;
+	results.reserve(entries.size());
+	for (std::size_t i = 0; i < entries.size(); i++)
+		results.emplace_back(Identifier(entries[i].m_identifier), batchState.m_statuses[i]);
+	auto resultEvent = std::make_unique<AuditResultEvent>(std::move(results), batchState.m_batch->cookie());
+
+	// and remove the batch
+	auto iter = std::ranges::find_if(m_batches, [&batchState](const BatchState &x) { return &x == &batchState; });
+	m_batches.erase(iter);
+	return resultEvent;
+}
+
+
+//-------------------------------------------------
+//  BatchState ctor
+//-------------------------------------------------
+
+AuditEngine::BatchState::BatchState(AuditBatch::ptr &&batch)
+	: m_batch(std::move(batch))
+	, m_statuses(m_batch->entries().size(), AuditStatus::Found)
+	, m_remainingEntries(0)
+{
+	for (const AuditBatch::Entry &entry : m_batch->entries())
+		m_remainingEntries += entry.m_audit.entries().size();
+}
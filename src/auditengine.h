@@ -0,0 +1,123 @@
+/***************************************************************************
+
+	auditengine.h
+
+	Engine for running background audits on a fixed pool of threads
+
+***************************************************************************/
+
+#ifndef AUDITENGINE_H
+#define AUDITENGINE_H
+
+// bletchmame headers
+#include "assetfinder.h"
+#include "audittask.h"
+
+// Qt headers
+#include <QByteArray>
+
+// standard headers
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QThread;
+QT_END_NAMESPACE
+
+class HashCache;
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+// ======================> AuditEngine
+
+// Background audits used to be run by spinning up an AuditTask per handful of audits, which
+// resulted in dozens of threads each opening their own archives and competing for the disk.
+// Instead, the AuditEngine has a single I/O thread that sorts reads by path (so archives are
+// opened once and read front to back) and hands the bytes off to a fixed pool of threads that
+// do the hashing.
+class AuditEngine
+{
+public:
+	class Test;
+
+	typedef std::function<void(std::unique_ptr<QEvent> &&)> EventHandlerFunc;
+
+	// ctor/dtor
+	AuditEngine(EventHandlerFunc &&eventHandler, HashCache *hashCache = nullptr, Audit::Mode mode = Audit::Mode::Fast, int hashThreadCount = 0, qint64 readAheadBudget = 64 * 1024 * 1024);
+	AuditEngine(const AuditEngine &) = delete;
+	AuditEngine(AuditEngine &&) = delete;
+	~AuditEngine();
+
+	// methods
+	void submit(AuditBatch::ptr &&batch);
+	void stop();
+
+	// accessors
+	std::size_t pendingBatchCount() const;
+
+private:
+	struct BatchState
+	{
+		BatchState(AuditBatch::ptr &&batch);
+
+		AuditBatch::ptr					m_batch;
+		std::vector<AuditStatus>		m_statuses;
+		std::size_t						m_remainingEntries;
+	};
+
+	struct ReadRequest
+	{
+		BatchState *					m_batchState;
+		int								m_auditIndex;
+		int								m_entryIndex;
+
+		const Audit &audit() const				{ return m_batchState->m_batch->entries()[m_auditIndex].m_audit; }
+		const Audit::Entry &entry() const		{ return audit().entries()[m_entryIndex]; }
+	};
+
+	struct HashJob
+	{
+		ReadRequest								m_request;
+		bool									m_found;
+		QByteArray								m_data;				// this might only be the start of the asset
+		std::uint64_t							m_assetSize;
+		qint64									m_reservedBytes;
+		std::optional<AssetFinder::Identity>	m_identity;			// present if the hash should be cached
+	};
+
+	// variables
+	EventHandlerFunc						m_eventHandler;
+	HashCache *								m_hashCache;
+	Audit::Mode								m_mode;
+	qint64									m_readAheadBudget;
+	mutable std::mutex						m_mutex;
+	std::condition_variable					m_readCondition;
+	std::condition_variable					m_hashCondition;
+	std::list<BatchState>					m_batches;
+	std::vector<ReadRequest>				m_readRequests;
+	std::deque<HashJob>						m_hashJobs;
+	qint64									m_bytesInFlight;
+	std::atomic<bool>						m_aborting;
+	std::unique_ptr<QThread>				m_ioThread;
+	std::vector<std::unique_ptr<QThread>>	m_hashThreads;
+
+	// methods
+	void ioThreadProc();
+	void hashThreadProc();
+	void queueHashJob(HashJob &&job);
+	void completeRequest(const ReadRequest &request, QIODevice *stream, std::uint64_t assetSize, const std::optional<AssetFinder::Identity> &identity);
+	void reportVerdict(const ReadRequest &request, const Audit::Verdict &verdict);
+	std::unique_ptr<AuditResultEvent> retireBatch(BatchState &batchState);
+};
+
+
+#endif // AUDITENGINE_H
@@ -67,12 +67,12 @@ void AuditQueue::push(Identifier &&identifier, bool isPrioritized)
 
 
 //-------------------------------------------------
-//  tryCreateAuditTask
+//  tryCreateAuditBatch
 //-------------------------------------------------
 
-AuditTask::ptr AuditQueue::tryCreateAuditTask()
+AuditBatch::ptr AuditQueue::tryCreateAuditBatch()
 {
-	// we want a rough maximum media size for any given task (though
+	// we want a rough maximum media size for any given batch (though
 	// we will tolerate a single media above that size)
 	const std::uint64_t MAX_MEDIA_SIZE_PER_TASK = 50000000;
 
@@ -102,8 +102,8 @@ AuditTask::ptr AuditQueue::tryCreateAuditTask()
 		m_undispatchedAudits.pop_front();
 	}
 
-	// create a teask for these entries
-	AuditTask::ptr result = createAuditTask(entries);
+	// create a batch for these entries
+	AuditBatch::ptr result = createAuditBatch(entries);
 
 	// only return something if we're not empty
 	if (result->isEmpty())
@@ -156,35 +156,35 @@ std::uint64_t AuditQueue::getExpectedMediaSize(const Identifier &auditIdentifier
 
 
 //-------------------------------------------------
-//  createAuditTask
+//  createAuditBatch
 //-------------------------------------------------
 
-AuditTask::ptr AuditQueue::createAuditTask(const std::vector<Identifier> &auditIdentifiers) const
+AuditBatch::ptr AuditQueue::createAuditBatch(const std::vector<Identifier> &auditIdentifiers) const
 {
-	// create an audit task with a single audit
-	AuditTask::ptr auditTask = std::make_shared<AuditTask>(false, currentCookie());
+	// create an audit batch
+	AuditBatch::ptr auditBatch = std::make_unique<AuditBatch>(currentCookie());
 
 	for (const Identifier &identifier : auditIdentifiers)
 	{
 		std::visit(util::overloaded
 		{
-			[this, &auditTask](const MachineIdentifier &x)
+			[this, &auditBatch](const MachineIdentifier &x)
 			{
 				// machine audit
 				std::optional<info::machine> machine = m_infoDb.find_machine(x.machineName());
 				if (machine)
-					auditTask->addMachineAudit(m_prefs, *machine);
+					auditBatch->addMachineAudit(m_prefs, *machine);
 			},
-			[this, &auditTask](const SoftwareIdentifier &x)
+			[this, &auditBatch](const SoftwareIdentifier &x)
 			{
 				// software audit
 				const software_list::software *software = findSoftware(x.softwareList(), x.software());
 				if (software)
-					auditTask->addSoftwareAudit(m_prefs, *software);
+					auditBatch->addSoftwareAudit(m_prefs, *software);
 			}
 		}, identifier);
 	}
-	return auditTask;
+	return auditBatch;
 }
 
 
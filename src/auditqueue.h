@@ -36,7 +36,7 @@ public:
 
 	// methods
 	void push(Identifier &&identifier, bool isPrioritized);
-	AuditTask::ptr tryCreateAuditTask();
+	AuditBatch::ptr tryCreateAuditBatch();
 	void bumpCookie();
 
 private:
@@ -52,7 +52,7 @@ private:
 
 	// private methods
 	std::uint64_t getExpectedMediaSize(const Identifier &auditIdentifier) const;
-	AuditTask::ptr createAuditTask(const std::vector<Identifier> &auditIdentifiers) const;
+	AuditBatch::ptr createAuditBatch(const std::vector<Identifier> &auditIdentifiers) const;
 	const software_list::software *findSoftware(std::u8string_view softwareList, std::u8string_view software) const;
 };
 
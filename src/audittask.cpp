@@ -8,6 +8,7 @@
 
 // bletchmame headers
 #include "audittask.h"
+#include "archivecache.h"
 #include "prefs.h"
 
 // Qt headers
@@ -46,7 +47,8 @@ private:
 //-------------------------------------------------
 
 AuditTask::AuditTask(bool reportProgress, int cookie)
-	: m_cookie(cookie)
+	: m_batch(cookie)
+	, m_hashCache(nullptr)
 {
 	using namespace std::chrono_literals;
 
@@ -56,47 +58,6 @@ AuditTask::AuditTask(bool reportProgress, int cookie)
 }
 
 
-//-------------------------------------------------
-//  addMachineAudit
-//-------------------------------------------------
-
-const Audit &AuditTask::addMachineAudit(const Preferences &prefs, const info::machine &machine)
-{
-	Entry &entry = *m_entries.emplace(
-		m_entries.end(),
-		MachineIdentifier(machine.name()));
-	entry.m_audit.addMediaForMachine(prefs, machine);
-	return entry.m_audit;
-}
-
-
-//-------------------------------------------------
-//  addSoftwareAudit
-//-------------------------------------------------
-
-const Audit &AuditTask::addSoftwareAudit(const Preferences &prefs, const software_list::software &software)
-{
-	Entry &entry = *m_entries.emplace(
-		m_entries.end(),
-		SoftwareIdentifier(software.parent().name(), software.name()));
-	entry.m_audit.addMediaForSoftware(prefs, software);
-	return entry.m_audit;
-}
-
-
-//-------------------------------------------------
-//  getIdentifiers
-//-------------------------------------------------
-
-std::vector<Identifier> AuditTask::getIdentifiers() const
-{
-	std::vector<Identifier> result;
-	for (const Entry &entry : m_entries)
-		result.push_back(entry.m_identifier);
-	return result;
-}
-
-
 //-------------------------------------------------
 //  run
 //-------------------------------------------------
@@ -113,10 +74,10 @@ void AuditTask::run()
 		setPriority(QThread::LowestPriority);
 
 	// run all the audits
-	for (const Entry &entry : m_entries)
+	for (const AuditBatch::Entry &entry : m_batch.entries())
 	{
 		// run the audit
-		std::optional<AuditStatus> status = entry.m_audit.run(callback);
+		std::optional<AuditStatus> status = entry.m_audit.run(callback, m_hashCache);
 
 		// if we didn't get complete results, we've been aborted and bail
 		if (!status)
@@ -126,22 +87,15 @@ void AuditTask::run()
 		results.emplace_back(Identifier(entry.m_identifier), *status);
 	}
 
+	// we're done with the archives for now; don't hold them open
+	ArchiveCache::global().closeIdleHandles();
+
 	// and respond with the event
-	auto evt = std::make_unique<AuditResultEvent>(std::move(results), m_cookie);
+	auto evt = std::make_unique<AuditResultEvent>(std::move(results), m_batch.cookie());
 	postEventToHost(std::move(evt));
 }
 
 
-//-------------------------------------------------
-//  Entry ctor
-//-------------------------------------------------
-
-AuditTask::Entry::Entry(Identifier &&identifier)
-	: m_identifier(std::move(identifier))
-{
-}
-
-
 
 //-------------------------------------------------
 //  Callback ctor
@@ -190,6 +144,67 @@ void AuditTask::Callback::postProgressEvent(int entryIndex, std::uint64_t bytesP
 }
 
 
+//-------------------------------------------------
+//  AuditBatch ctor
+//-------------------------------------------------
+
+AuditBatch::AuditBatch(int cookie)
+	: m_cookie(cookie)
+{
+}
+
+
+//-------------------------------------------------
+//  AuditBatch::addMachineAudit
+//-------------------------------------------------
+
+const Audit &AuditBatch::addMachineAudit(const Preferences &prefs, const info::machine &machine)
+{
+	Entry &entry = *m_entries.emplace(
+		m_entries.end(),
+		MachineIdentifier(machine.name()));
+	entry.m_audit.addMediaForMachine(prefs, machine);
+	return entry.m_audit;
+}
+
+
+//-------------------------------------------------
+//  AuditBatch::addSoftwareAudit
+//-------------------------------------------------
+
+const Audit &AuditBatch::addSoftwareAudit(const Preferences &prefs, const software_list::software &software)
+{
+	Entry &entry = *m_entries.emplace(
+		m_entries.end(),
+		SoftwareIdentifier(software.parent().name(), software.name()));
+	entry.m_audit.addMediaForSoftware(prefs, software);
+	return entry.m_audit;
+}
+
+
+//-------------------------------------------------
+//  AuditBatch::getIdentifiers
+//-------------------------------------------------
+
+std::vector<Identifier> AuditBatch::getIdentifiers() const
+{
+	std::vector<Identifier> result;
+	for (const Entry &entry : m_entries)
+		result.push_back(entry.m_identifier);
+	return result;
+}
+
+
+//-------------------------------------------------
+//  AuditBatch::Entry ctor
+//-------------------------------------------------
+
+AuditBatch::Entry::Entry(Identifier &&identifier)
+	: m_identifier(std::move(identifier))
+{
+}
+
+
 //-------------------------------------------------
 //  AuditResult ctor
 //-------------------------------------------------
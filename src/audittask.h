@@ -82,6 +82,42 @@ private:
 };
 
 
+// ======================> AuditBatch
+
+class AuditBatch
+{
+public:
+	typedef std::unique_ptr<AuditBatch> ptr;
+
+	struct Entry
+	{
+		Entry(Identifier &&identifier);
+
+		Identifier		m_identifier;
+		Audit			m_audit;
+	};
+
+	// ctor
+	AuditBatch(int cookie);
+	AuditBatch(const AuditBatch &) = delete;
+	AuditBatch(AuditBatch &&) = default;
+
+	// methods
+	const Audit &addMachineAudit(const Preferences &prefs, const info::machine &machine);
+	const Audit &addSoftwareAudit(const Preferences &prefs, const software_list::software &software);
+
+	// accessors
+	const std::vector<Entry> &entries() const { return m_entries; }
+	bool isEmpty() const { return m_entries.empty(); }
+	int cookie() const { return m_cookie; }
+	std::vector<Identifier> getIdentifiers() const;
+
+private:
+	std::vector<Entry>			m_entries;
+	int							m_cookie;
+};
+
+
 // ======================> AuditTask
 
 class AuditTask : public Task
@@ -95,12 +131,13 @@ public:
 	AuditTask(bool reportProgress, int cookie);
 
 	// methods
-	const Audit &addMachineAudit(const Preferences &prefs, const info::machine &machine);
-	const Audit &addSoftwareAudit(const Preferences &prefs, const software_list::software &software);
+	const Audit &addMachineAudit(const Preferences &prefs, const info::machine &machine)				{ return m_batch.addMachineAudit(prefs, machine); }
+	const Audit &addSoftwareAudit(const Preferences &prefs, const software_list::software &software)	{ return m_batch.addSoftwareAudit(prefs, software); }
 
 	// accessors
-	bool isEmpty() const { return m_entries.empty(); }
-	std::vector<Identifier> getIdentifiers() const;
+	bool isEmpty() const { return m_batch.isEmpty(); }
+	std::vector<Identifier> getIdentifiers() const { return m_batch.getIdentifiers(); }
+	void setHashCache(HashCache *hashCache) { m_hashCache = hashCache; }
 
 protected:
 	// virtuals
@@ -109,17 +146,9 @@ protected:
 private:
 	class Callback;
 
-	struct Entry
-	{
-		Entry(Identifier &&identifier);
-
-		Identifier		m_identifier;
-		Audit			m_audit;
-	};
-
-	std::vector<Entry>			m_entries;
+	AuditBatch					m_batch;
 	std::optional<Throttler>	m_reportThrottler;
-	int							m_cookie;
+	HashCache *					m_hashCache;
 };
 
 #endif // AUDITTASK_H
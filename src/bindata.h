@@ -21,6 +21,7 @@
 #include <compare>
 #include <optional>
 #include <span>
+#include <string_view>
 
 
 //**************************************************************************
@@ -49,6 +50,7 @@ namespace bindata
 		const TDatabase &db() const { return *m_db; }
 		const TBinary &inner() const { return *m_inner; }
 		const QString &get_string(std::uint32_t strindex) const { return db().get_string(strindex); }
+		template<typename TBuffer> std::u8string_view get_string_u8(std::uint32_t strindex, TBuffer &buffer) const { return db().get_string_u8(strindex, buffer); }
 
 	private:
 		const TDatabase *	m_db;
@@ -56,31 +58,6 @@ namespace bindata
 	};
 
 
-	// ======================> view_position
-	class view_position
-	{
-	public:
-		view_position(std::size_t offset = 0, std::size_t count = 0)
-			: m_offset(util::safe_static_cast<std::uint32_t>(offset))
-			, m_count(util::safe_static_cast<std::uint32_t>(count))
-		{
-		}
-
-		void clear()
-		{
-			m_offset = 0;
-			m_count = 0;
-		}
-
-		std::uint32_t offset() const { return m_offset; }
-		std::uint32_t count() const { return m_count; }
-
-	private:
-		std::uint32_t	m_offset;
-		std::uint32_t	m_count;
-	};
-
-
 	// ======================> view
 	template<typename TDatabase, typename TPublic, typename TBinary>
 	class view
@@ -90,10 +67,10 @@ namespace bindata
 		{
 		}
 
-		view(const TDatabase &db, const view_position &pos)
+		view(const TDatabase &db, std::span<const TBinary> span)
 			: m_db(&db)
+			, m_span(span)
 		{
-			m_db->getDataSpan(m_span, pos.offset(), pos.count());
 		}
 
 		view(const view &) = default;
@@ -43,7 +43,7 @@ std::optional<Hash> getHashForChd(QIODevice &stream)
 	union
 	{
 		ChdHeader	hdr;
-		char		buffer[256];
+		char		buffer[CHD_HEADER_READ_LENGTH];
 	} u;
 
 	// try to read headers
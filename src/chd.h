@@ -18,6 +18,9 @@
 //  INTERFACE
 //**************************************************************************
 
+// the number of bytes at the start of a CHD that getHashForChd() looks at
+const qint64 CHD_HEADER_READ_LENGTH = 256;
+
 std::optional<Hash> getHashForChd(QIODevice &stzream);
 
 
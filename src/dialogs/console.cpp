@@ -120,7 +120,8 @@ void ConsoleDialog::onChatter(const ChatterEvent &evt)
 
 bool ConsoleDialog::isChatterPing(const ChatterEvent &evt)
 {
-	// hack, but good enough for now
+	// hack, but good enough for now; status pushes are every bit as chatty as pings
 	return (evt.type() == MameWorkerController::ChatterType::Command && evt.text() == "ping")
-		|| (evt.type() == MameWorkerController::ChatterType::GoodResponse && evt.text().contains("pong"));
+		|| (evt.type() == MameWorkerController::ChatterType::GoodResponse && evt.text().contains("pong"))
+		|| (evt.type() == MameWorkerController::ChatterType::GoodResponse && evt.text().startsWith("@STATUS"));
 }
@@ -46,13 +46,17 @@ LoadingDialog::~LoadingDialog()
 //	progress
 //-------------------------------------------------
 
-void LoadingDialog::progress(const QString &machineName, const QString &machineDescription)
+void LoadingDialog::progress(const QString &machineName, const QString &machineDescription, int machineCount, int reusedMachineCount)
 {
-	// update the progress label
+	// update the progress label; machines reused from the previous info DB are called out
+	// because they go by much faster than the rest
 	QString text = machineName == machineDescription
 		? machineDescription
 		: QString("%1 (%2)").arg(machineDescription, machineName);
-	m_ui->progressLabel->setText(text);
+	QString countText = reusedMachineCount > 0
+		? QString("%1 machines (%2 reused)").arg(QString::number(machineCount), QString::number(reusedMachineCount))
+		: QString("%1 machines").arg(QString::number(machineCount));
+	m_ui->progressLabel->setText(QString("%1 - %2").arg(text, countText));
 
 	// invoke the callback
 	if (m_progressCallback)
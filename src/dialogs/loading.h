@@ -30,7 +30,7 @@ public:
 	~LoadingDialog();
 
 	// methods
-	void progress(const QString &machineName, const QString &machineDescription);
+	void progress(const QString &machineName, const QString &machineDescription, int machineCount, int reusedMachineCount);
 
 private:
 	std::unique_ptr<Ui::LoadingDialog>	m_ui;
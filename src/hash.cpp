@@ -8,17 +8,27 @@
 
 // bletchmame headers
 #include "hash.h"
+#include "hashbackend.h"
 
 // Qt headers
-#include <QCryptographicHash>
 #include <QIODevice>
 
+// standard headers
+#include <memory>
+
 
 //**************************************************************************
-//  IMPLEMENTATION
+//  CONSTANTS
 //**************************************************************************
 
-std::array<quint32, 256> Hash::s_crcTable = calculateCrc32Table();
+// big reads mean fewer trips through QIODevice (and through decompressors), but we
+// still want to report progress regularly
+static const std::size_t CALCULATE_BUFFER_SIZE = 256 * 1024;
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
 
 //-------------------------------------------------
 //  ctor
@@ -44,32 +54,27 @@ std::optional<Hash> Hash::calculate(QIODevice &stream, const CalculateCallback &
 	if (!callback)
 		throw false;
 
-	// setup
-	std::uint32_t crc32 = ~0;
+	// setup; the backends pick the fastest implementation the CPU supports
+	Crc32 crc32;
+	Sha1 sha1;
 	std::uint64_t bytesProcessed = 0;
-
-	// Qt has SHA-1 functionality
-	QCryptographicHash cryptographicHash(QCryptographicHash::Algorithm::Sha1);
+	struct alignas(64) Buffer
+	{
+		char m_data[CALCULATE_BUFFER_SIZE];
+	};
+	auto buffer = std::make_unique<Buffer>();
 
 	while (!stream.atEnd())
 	{
 		// read into a buffer
-		char buffer[15000];
-		int len = (int)stream.read(buffer, std::size(buffer));
+		qint64 len = stream.read(buffer->m_data, std::size(buffer->m_data));
 		if (len <= 0)
 			break;
 		bytesProcessed += len;
 
-		// CRC32 processing
-		for (int i = 0; i < len; i++)
-			crc32 = s_crcTable[(crc32 ^ buffer[i]) & 0xFF] ^ (crc32 >> 8);
-
-		// SHA-1 processing
-#if QT_VERSION < 0x060300
-		cryptographicHash.addData(buffer, len);
-#else // !QT_VERSION < 0x060300
-		cryptographicHash.addData(QByteArrayView(buffer, len));
-#endif // QT_VERSION < 0x060300
+		// CRC32 and SHA-1 processing
+		crc32.update(buffer->m_data, (std::size_t)len);
+		sha1.update(buffer->m_data, (std::size_t)len);
 
 		// invoke callback if appropriate
 		if (callback(bytesProcessed))
@@ -77,8 +82,7 @@ std::optional<Hash> Hash::calculate(QIODevice &stream, const CalculateCallback &
 	}
 
 	// we're done; return the right results
-	crc32 ^= ~0;
-	return Hash(crc32, cryptographicHash.result());
+	return Hash(crc32.result(), sha1.result());
 }
 
 
@@ -125,25 +129,3 @@ QString Hash::hexString(const void *ptr, size_t sz)
 }
 
 
-//-------------------------------------------------
-//  calculateCrc32Table
-//-------------------------------------------------
-
-std::array<quint32, 256> Hash::calculateCrc32Table()
-{
-	std::array<quint32, 256> result;
-
-	// initialize CRC table
-	for (int i = 0; i < std::size(result); i++)
-	{
-		quint32 crc = i;
-		for (int j = 0; j < 8; j++)
-			crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320UL : crc >> 1;
-
-		result[i] = crc;
-	}
-
-	return result;
-}
-
-
@@ -64,13 +64,9 @@ public:
 	const std::optional<std::array<uint8_t, 20>> &sha1() const	{ return m_sha1; }
 
 private:
-	// static variables
-	static std::array<quint32, 256>         s_crcTable;
-
 	std::optional<std::uint32_t>			m_crc32;
 	std::optional<std::array<uint8_t, 20>>	m_sha1;
 
-	static std::array<quint32, 256> calculateCrc32Table();
 	static QString hexString(const void *ptr, size_t sz);
 };
 
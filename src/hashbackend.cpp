@@ -0,0 +1,637 @@
+/***************************************************************************
+
+	hashbackend.cpp
+
+	CRC-32 and SHA-1 implementations, selected at runtime based on what the
+	CPU supports
+
+***************************************************************************/
+
+// bletchmame headers
+#include "hashbackend.h"
+
+// standard headers
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define HASHBACKEND_X86		1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else // !_MSC_VER
+#include <cpuid.h>
+#endif // _MSC_VER
+#else // !x86
+#define HASHBACKEND_X86		0
+#endif // x86
+
+#if defined(__ARM_FEATURE_CRC32)
+#define HASHBACKEND_ARMV8	1
+#include <arm_acle.h>
+#else // !__ARM_FEATURE_CRC32
+#define HASHBACKEND_ARMV8	0
+#endif // __ARM_FEATURE_CRC32
+
+// GCC and Clang need to be told that a function uses instructions beyond the baseline
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET(x)			__attribute__((target(x)))
+#else // !defined(__GNUC__) && !defined(__clang__)
+#define TARGET(x)
+#endif // defined(__GNUC__) || defined(__clang__)
+
+
+//**************************************************************************
+//  LOCALS
+//**************************************************************************
+
+namespace
+{
+	// ======================> CpuFeatures
+
+	struct CpuFeatures
+	{
+		CpuFeatures();
+
+		bool	m_pclmul;
+		bool	m_shaNi;
+	};
+
+
+	// ======================> Crc32Tables
+
+	// the bytewise implementation uses the first table; slice-by-16 uses all of them
+	struct Crc32Tables
+	{
+		Crc32Tables();
+
+		std::array<std::array<std::uint32_t, 256>, 16>	m_tables;
+	};
+}
+
+static const CpuFeatures s_cpuFeatures;
+static const Crc32Tables s_crc32Tables;
+
+static const std::array<std::uint32_t, 5> SHA1_INITIAL_STATE = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+
+
+//**************************************************************************
+//  CPU FEATURE DETECTION
+//**************************************************************************
+
+//-------------------------------------------------
+//  CpuFeatures ctor
+//-------------------------------------------------
+
+CpuFeatures::CpuFeatures()
+	: m_pclmul(false)
+	, m_shaNi(false)
+{
+#if HASHBACKEND_X86
+	auto cpuid = [](unsigned int leaf, unsigned int subleaf)
+	{
+		std::array<unsigned int, 4> result = { };
+#ifdef _MSC_VER
+		__cpuidex((int *)result.data(), (int)leaf, (int)subleaf);
+#else // !_MSC_VER
+		if (leaf <= __get_cpuid_max(0, nullptr))
+			__cpuid_count(leaf, subleaf, result[0], result[1], result[2], result[3]);
+#endif // _MSC_VER
+		return result;
+	};
+
+	std::array<unsigned int, 4> leaf1 = cpuid(1, 0);
+	std::array<unsigned int, 4> leaf7 = cpuid(7, 0);
+	bool ssse3 = (leaf1[2] & (1 << 9)) != 0;
+	bool sse41 = (leaf1[2] & (1 << 19)) != 0;
+	bool pclmul = (leaf1[2] & (1 << 1)) != 0;
+	bool sha = (leaf7[1] & (1 << 29)) != 0;
+
+	m_pclmul = pclmul && sse41;
+	m_shaNi = sha && ssse3 && sse41;
+#endif // HASHBACKEND_X86
+}
+
+
+//**************************************************************************
+//  CRC-32 IMPLEMENTATIONS
+//**************************************************************************
+
+//-------------------------------------------------
+//  Crc32Tables ctor
+//-------------------------------------------------
+
+Crc32Tables::Crc32Tables()
+{
+	// the classic table
+	for (std::uint32_t i = 0; i < 256; i++)
+	{
+		std::uint32_t crc = i;
+		for (int j = 0; j < 8; j++)
+			crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320UL : crc >> 1;
+		m_tables[0][i] = crc;
+	}
+
+	// and each subsequent table advances the previous one by a byte of zeros
+	for (std::size_t table = 1; table < m_tables.size(); table++)
+	{
+		for (std::size_t i = 0; i < 256; i++)
+			m_tables[table][i] = (m_tables[table - 1][i] >> 8) ^ m_tables[0][m_tables[table - 1][i] & 0xFF];
+	}
+}
+
+
+//-------------------------------------------------
+//  updateCrc32Bytewise
+//-------------------------------------------------
+
+static std::uint32_t updateCrc32Bytewise(std::uint32_t state, const std::uint8_t *data, std::size_t length)
+{
+	const std::array<std::uint32_t, 256> &table = s_crc32Tables.m_tables[0];
+	for (std::size_t i = 0; i < length; i++)
+		state = table[(state ^ data[i]) & 0xFF] ^ (state >> 8);
+	return state;
+}
+
+
+//-------------------------------------------------
+//  updateCrc32SliceBy16
+//-------------------------------------------------
+
+static std::uint32_t updateCrc32SliceBy16(std::uint32_t state, const std::uint8_t *data, std::size_t length)
+{
+	// the word loads below assume little endian
+	if constexpr (std::endian::native == std::endian::little)
+	{
+		const auto &t = s_crc32Tables.m_tables;
+		while (length >= 16)
+		{
+			std::uint32_t words[4];
+			memcpy(words, data, sizeof(words));
+			words[0] ^= state;
+
+			state = t[15][words[0] & 0xFF] ^ t[14][(words[0] >> 8) & 0xFF] ^ t[13][(words[0] >> 16) & 0xFF] ^ t[12][words[0] >> 24]
+				^ t[11][words[1] & 0xFF] ^ t[10][(words[1] >> 8) & 0xFF] ^ t[9][(words[1] >> 16) & 0xFF] ^ t[8][words[1] >> 24]
+				^ t[7][words[2] & 0xFF] ^ t[6][(words[2] >> 8) & 0xFF] ^ t[5][(words[2] >> 16) & 0xFF] ^ t[4][words[2] >> 24]
+				^ t[3][words[3] & 0xFF] ^ t[2][(words[3] >> 8) & 0xFF] ^ t[1][(words[3] >> 16) & 0xFF] ^ t[0][words[3] >> 24];
+
+			data += 16;
+			length -= 16;
+		}
+	}
+
+	// and the stragglers
+	return updateCrc32Bytewise(state, data, length);
+}
+
+
+#if HASHBACKEND_X86
+//-------------------------------------------------
+//  load
+//-------------------------------------------------
+
+TARGET("sse4.1")
+static inline __m128i load(const std::uint8_t *data)
+{
+	return _mm_loadu_si128((const __m128i *)data);
+}
+
+
+//-------------------------------------------------
+//  pclmulFold - folds x into y
+//-------------------------------------------------
+
+TARGET("pclmul,sse4.1")
+static inline __m128i pclmulFold(__m128i x, __m128i y, __m128i constants)
+{
+	__m128i lo = _mm_clmulepi64_si128(x, constants, 0x00);
+	__m128i hi = _mm_clmulepi64_si128(x, constants, 0x11);
+	return _mm_xor_si128(_mm_xor_si128(hi, y), lo);
+}
+
+
+//-------------------------------------------------
+//  updateCrc32Pclmul - folds 64 bytes at a time
+//	with carry-less multiplication, as described
+//	in Intel's "Fast CRC Computation for Generic
+//	Polynomials Using PCLMULQDQ Instruction"
+//-------------------------------------------------
+
+TARGET("pclmul,sse4.1")
+static std::uint32_t updateCrc32Pclmul(std::uint32_t state, const std::uint8_t *data, std::size_t length)
+{
+	// we need at least 64 bytes to get started
+	if (length < 64)
+		return updateCrc32SliceBy16(state, data, length);
+
+	// folding constants for the (bit reflected) CRC-32 polynomial
+	const __m128i k1k2 = _mm_set_epi64x(0x01C6E41596, 0x0154442BD4);
+	const __m128i k3k4 = _mm_set_epi64x(0x00CCAA009E, 0x01751997D0);
+	const __m128i k5k0 = _mm_set_epi64x(0x0000000000, 0x0163CD6124);
+	const __m128i poly = _mm_set_epi64x(0x01F7011641, 0x01DB710641);
+	const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+	// load the first 64 bytes, and fold in the existing state
+	__m128i x1 = _mm_xor_si128(load(data + 0x00), _mm_cvtsi32_si128((int)state));
+	__m128i x2 = load(data + 0x10);
+	__m128i x3 = load(data + 0x20);
+	__m128i x4 = load(data + 0x30);
+	data += 64;
+	length -= 64;
+
+	// fold 64 bytes at a time
+	while (length >= 64)
+	{
+		__m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+		__m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+		__m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+		__m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+		x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k1k2, 0x11), x5), load(data + 0x00));
+		x2 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x2, k1k2, 0x11), x6), load(data + 0x10));
+		x3 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x3, k1k2, 0x11), x7), load(data + 0x20));
+		x4 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x4, k1k2, 0x11), x8), load(data + 0x30));
+		data += 64;
+		length -= 64;
+	}
+
+	// fold the four lanes into one, and then fold any remaining 16 byte blocks
+	x1 = pclmulFold(x1, x2, k3k4);
+	x1 = pclmulFold(x1, x3, k3k4);
+	x1 = pclmulFold(x1, x4, k3k4);
+	while (length >= 16)
+	{
+		x1 = pclmulFold(x1, load(data), k3k4);
+		data += 16;
+		length -= 16;
+	}
+
+	// fold 128 bits down to 64 bits
+	x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+	x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, mask32);
+	x1 = _mm_xor_si128(_mm_clmulepi64_si128(x1, k5k0, 0x00), x2);
+
+	// Barrett reduction down to 32 bits
+	x2 = _mm_and_si128(x1, mask32);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+	x2 = _mm_and_si128(x2, mask32);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+	state = (std::uint32_t)_mm_extract_epi32(x1, 1);
+
+	// and the stragglers
+	return updateCrc32SliceBy16(state, data, length);
+}
+#endif // HASHBACKEND_X86
+
+
+#if HASHBACKEND_ARMV8
+//-------------------------------------------------
+//  updateCrc32Armv8
+//-------------------------------------------------
+
+static std::uint32_t updateCrc32Armv8(std::uint32_t state, const std::uint8_t *data, std::size_t length)
+{
+	while (length >= 8)
+	{
+		std::uint64_t word;
+		memcpy(&word, data, sizeof(word));
+		state = __crc32d(state, word);
+		data += 8;
+		length -= 8;
+	}
+	while (length-- > 0)
+		state = __crc32b(state, *data++);
+	return state;
+}
+#endif // HASHBACKEND_ARMV8
+
+
+//**************************************************************************
+//  SHA-1 IMPLEMENTATIONS
+//**************************************************************************
+
+#if HASHBACKEND_X86
+//-------------------------------------------------
+//  sha1ShaNiRounds - performs four rounds of SHA-1
+//	using the SHA extensions; ROUND is the index of
+//	the first round divided by four
+//-------------------------------------------------
+
+template<int ROUND>
+TARGET("sha,ssse3,sse4.1")
+static inline void sha1ShaNiRounds(__m128i &abcd, __m128i &e0, __m128i &e1, __m128i (&msg)[4])
+{
+	// the E values alternate between rounds
+	__m128i &e = (ROUND % 2) == 0 ? e0 : e1;
+	__m128i &nextE = (ROUND % 2) == 0 ? e1 : e0;
+	__m128i &m = msg[ROUND % 4];
+
+	// the first four rounds are a special case
+	if constexpr (ROUND == 0)
+		e = _mm_add_epi32(e, m);
+	else
+		e = _mm_sha1nexte_epu32(e, m);
+	nextE = abcd;
+
+	// as we go, we expand the message schedule for future rounds
+	if constexpr (ROUND >= 3 && ROUND <= 18)
+		msg[(ROUND + 1) % 4] = _mm_sha1msg2_epu32(msg[(ROUND + 1) % 4], m);
+	abcd = _mm_sha1rnds4_epu32(abcd, e, ROUND / 5);
+	if constexpr (ROUND >= 1 && ROUND <= 16)
+		msg[(ROUND + 3) % 4] = _mm_sha1msg1_epu32(msg[(ROUND + 3) % 4], m);
+	if constexpr (ROUND >= 2 && ROUND <= 17)
+		msg[(ROUND + 2) % 4] = _mm_xor_si128(msg[(ROUND + 2) % 4], m);
+}
+
+
+//-------------------------------------------------
+//  sha1ShaNiBlock
+//-------------------------------------------------
+
+template<std::size_t... ROUNDS>
+TARGET("sha,ssse3,sse4.1")
+static inline void sha1ShaNiBlock(__m128i &abcd, __m128i &e0, const std::uint8_t *data, std::index_sequence<ROUNDS...>)
+{
+	const __m128i byteSwap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090A0B0C0D0E0FULL);
+
+	__m128i abcdSave = abcd;
+	__m128i e0Save = e0;
+	__m128i e1 = _mm_setzero_si128();
+	__m128i msg[4];
+	for (int i = 0; i < 4; i++)
+		msg[i] = _mm_shuffle_epi8(load(data + i * 16), byteSwap);
+
+	(sha1ShaNiRounds<ROUNDS>(abcd, e0, e1, msg), ...);
+
+	e0 = _mm_sha1nexte_epu32(e0, e0Save);
+	abcd = _mm_add_epi32(abcd, abcdSave);
+}
+
+
+//-------------------------------------------------
+//  sha1ShaNiProcessBlocks
+//-------------------------------------------------
+
+TARGET("sha,ssse3,sse4.1")
+static void sha1ShaNiProcessBlocks(std::array<std::uint32_t, 5> &state, const std::uint8_t *data, std::size_t blockCount)
+{
+	// load the state; the SHA instructions want A in the most significant lane
+	__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)state.data()), 0x1B);
+	__m128i e0 = _mm_set_epi32((int)state[4], 0, 0, 0);
+
+	for (std::size_t i = 0; i < blockCount; i++)
+		sha1ShaNiBlock(abcd, e0, data + i * 64, std::make_index_sequence<20>());
+
+	// and store it back
+	_mm_storeu_si128((__m128i *)state.data(), _mm_shuffle_epi32(abcd, 0x1B));
+	state[4] = (std::uint32_t)_mm_extract_epi32(e0, 3);
+}
+#endif // HASHBACKEND_X86
+
+
+//**************************************************************************
+//  CRC-32
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+Crc32::Crc32(Implementation implementation)
+	: m_updateFunc(updateCrc32Bytewise)
+	, m_state(~0)
+{
+	assert(isSupported(implementation));
+	switch (implementation)
+	{
+	case Implementation::Bytewise:
+		m_updateFunc = updateCrc32Bytewise;
+		break;
+	case Implementation::SliceBy16:
+		m_updateFunc = updateCrc32SliceBy16;
+		break;
+#if HASHBACKEND_X86
+	case Implementation::Pclmul:
+		m_updateFunc = updateCrc32Pclmul;
+		break;
+#endif // HASHBACKEND_X86
+#if HASHBACKEND_ARMV8
+	case Implementation::Armv8:
+		m_updateFunc = updateCrc32Armv8;
+		break;
+#endif // HASHBACKEND_ARMV8
+	default:
+		m_updateFunc = updateCrc32SliceBy16;
+		break;
+	}
+}
+
+
+//-------------------------------------------------
+//  update
+//-------------------------------------------------
+
+void Crc32::update(const void *data, std::size_t length)
+{
+	m_state = m_updateFunc(m_state, (const std::uint8_t *)data, length);
+}
+
+
+//-------------------------------------------------
+//  bestImplementation
+//-------------------------------------------------
+
+Crc32::Implementation Crc32::bestImplementation()
+{
+	for (Implementation implementation : { Implementation::Pclmul, Implementation::Armv8 })
+	{
+		if (isSupported(implementation))
+			return implementation;
+	}
+	return Implementation::SliceBy16;
+}
+
+
+//-------------------------------------------------
+//  isSupported
+//-------------------------------------------------
+
+bool Crc32::isSupported(Implementation implementation)
+{
+	bool result;
+	switch (implementation)
+	{
+	case Implementation::Bytewise:
+	case Implementation::SliceBy16:
+		result = true;
+		break;
+	case Implementation::Pclmul:
+		result = HASHBACKEND_X86 && s_cpuFeatures.m_pclmul;
+		break;
+	case Implementation::Armv8:
+		result = HASHBACKEND_ARMV8;
+		break;
+	default:
+		result = false;
+		break;
+	}
+	return result;
+}
+
+
+//**************************************************************************
+//  SHA-1
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+Sha1::Sha1(Implementation implementation)
+	: m_state(SHA1_INITIAL_STATE)
+	, m_blockLength(0)
+	, m_totalLength(0)
+{
+	assert(isSupported(implementation));
+	if (implementation == Implementation::Qt || !isSupported(implementation))
+		m_cryptographicHash.emplace(QCryptographicHash::Algorithm::Sha1);
+}
+
+
+//-------------------------------------------------
+//  update
+//-------------------------------------------------
+
+void Sha1::update(const void *data, std::size_t length)
+{
+	const std::uint8_t *bytes = (const std::uint8_t *)data;
+
+	// are we deferring to Qt?
+	if (m_cryptographicHash)
+	{
+#if QT_VERSION < 0x060300
+		m_cryptographicHash->addData((const char *)bytes, (int)length);
+#else // !QT_VERSION < 0x060300
+		m_cryptographicHash->addData(QByteArrayView(bytes, (qsizetype)length));
+#endif // QT_VERSION < 0x060300
+		return;
+	}
+	m_totalLength += length;
+
+	// top off a partial block
+	if (m_blockLength > 0)
+	{
+		std::size_t copyLength = std::min(length, m_block.size() - m_blockLength);
+		memcpy(&m_block[m_blockLength], bytes, copyLength);
+		m_blockLength += copyLength;
+		bytes += copyLength;
+		length -= copyLength;
+		if (m_blockLength < m_block.size())
+			return;
+		processBlocks(m_block.data(), 1);
+		m_blockLength = 0;
+	}
+
+	// process whole blocks straight from the caller's buffer
+	std::size_t blockCount = length / m_block.size();
+	processBlocks(bytes, blockCount);
+	bytes += blockCount * m_block.size();
+	length -= blockCount * m_block.size();
+
+	// and hold on to what is left
+	memcpy(m_block.data(), bytes, length);
+	m_blockLength = length;
+}
+
+
+//-------------------------------------------------
+//  result
+//-------------------------------------------------
+
+std::array<std::uint8_t, 20> Sha1::result()
+{
+	std::array<std::uint8_t, 20> result;
+
+	// are we deferring to Qt?
+	if (m_cryptographicHash)
+	{
+		QByteArray qtResult = m_cryptographicHash->result();
+		assert(qtResult.size() == result.size());
+		memcpy(result.data(), qtResult.constData(), result.size());
+		return result;
+	}
+
+	// append the padding and the message length (in bits, big endian)
+	std::uint64_t bitLength = m_totalLength * 8;
+	std::array<std::uint8_t, 72> padding = { 0x80 };
+	std::size_t paddingLength = (m_blockLength < 56 ? 56 : 120) - m_blockLength;
+	for (int i = 0; i < 8; i++)
+		padding[paddingLength + i] = (std::uint8_t)(bitLength >> (56 - i * 8));
+	update(padding.data(), paddingLength + 8);
+	assert(m_blockLength == 0);
+
+	// and emit the state big endian
+	for (std::size_t i = 0; i < m_state.size(); i++)
+	{
+		result[i * 4 + 0] = (std::uint8_t)(m_state[i] >> 24);
+		result[i * 4 + 1] = (std::uint8_t)(m_state[i] >> 16);
+		result[i * 4 + 2] = (std::uint8_t)(m_state[i] >> 8);
+		result[i * 4 + 3] = (std::uint8_t)(m_state[i] >> 0);
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  processBlocks
+//-------------------------------------------------
+
+void Sha1::processBlocks(const std::uint8_t *data, std::size_t blockCount)
+{
+#if HASHBACKEND_X86
+	if (blockCount > 0)
+		sha1ShaNiProcessBlocks(m_state, data, blockCount);
+#else // !HASHBACKEND_X86
+	// we only get here with the SHA extensions
+	assert(false);
+#endif // HASHBACKEND_X86
+}
+
+
+//-------------------------------------------------
+//  bestImplementation
+//-------------------------------------------------
+
+Sha1::Implementation Sha1::bestImplementation()
+{
+	return isSupported(Implementation::ShaNi)
+		? Implementation::ShaNi
+		: Implementation::Qt;
+}
+
+
+//-------------------------------------------------
+//  isSupported
+//-------------------------------------------------
+
+bool Sha1::isSupported(Implementation implementation)
+{
+	bool result;
+	switch (implementation)
+	{
+	case Implementation::Qt:
+		result = true;
+		break;
+	case Implementation::ShaNi:
+		result = HASHBACKEND_X86 && s_cpuFeatures.m_shaNi;
+		break;
+	default:
+		result = false;
+		break;
+	}
+	return result;
+}
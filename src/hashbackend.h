@@ -0,0 +1,95 @@
+/***************************************************************************
+
+	hashbackend.h
+
+	CRC-32 and SHA-1 implementations, selected at runtime based on what the
+	CPU supports
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef HASHBACKEND_H
+#define HASHBACKEND_H
+
+// Qt headers
+#include <QCryptographicHash>
+
+// standard headers
+#include <array>
+#include <cstdint>
+#include <optional>
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+// ======================> Crc32
+
+class Crc32
+{
+public:
+	enum class Implementation
+	{
+		Bytewise,			// the classic table driven implementation; slow but simple
+		SliceBy16,			// portable, processes 16 bytes per iteration
+		Pclmul,				// x86 carry-less multiplication folding
+		Armv8				// ARMv8 CRC32 instructions
+	};
+
+	// ctor
+	Crc32(Implementation implementation = bestImplementation());
+
+	// methods
+	void update(const void *data, std::size_t length);
+	std::uint32_t result() const	{ return ~m_state; }
+
+	// statics
+	static Implementation bestImplementation();
+	static bool isSupported(Implementation implementation);
+
+private:
+	typedef std::uint32_t (*UpdateFunc)(std::uint32_t state, const std::uint8_t *data, std::size_t length);
+
+	UpdateFunc		m_updateFunc;
+	std::uint32_t	m_state;
+};
+
+
+// ======================> Sha1
+
+class Sha1
+{
+public:
+	enum class Implementation
+	{
+		Qt,					// QCryptographicHash
+		ShaNi				// x86 SHA extensions
+	};
+
+	// ctor
+	Sha1(Implementation implementation = bestImplementation());
+	Sha1(const Sha1 &) = delete;
+	Sha1(Sha1 &&) = delete;
+
+	// methods
+	void update(const void *data, std::size_t length);
+	std::array<std::uint8_t, 20> result();
+
+	// statics
+	static Implementation bestImplementation();
+	static bool isSupported(Implementation implementation);
+
+private:
+	std::optional<QCryptographicHash>	m_cryptographicHash;
+	std::array<std::uint32_t, 5>		m_state;
+	std::array<std::uint8_t, 64>		m_block;
+	std::size_t							m_blockLength;
+	std::uint64_t						m_totalLength;
+
+	void processBlocks(const std::uint8_t *data, std::size_t blockCount);
+};
+
+
+#endif // HASHBACKEND_H
@@ -0,0 +1,249 @@
+/***************************************************************************
+
+	hashcache.cpp
+
+	Persistent cache of asset hashes, so that audits do not have to rehash
+	files that have not changed
+
+***************************************************************************/
+
+// bletchmame headers
+#include "hashcache.h"
+#include "perfprofiler.h"
+
+// Qt headers
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+
+
+//**************************************************************************
+//  LOCALS
+//**************************************************************************
+
+static const quint32 MAGIC_HASHCACHE = 0x42534843;		// 'BSHC'
+static const quint32 HASHCACHE_VERSION = 1;
+
+enum : quint8
+{
+	FLAG_HAS_CRC32	= 0x01,
+	FLAG_HAS_SHA1	= 0x02,
+	FLAG_SOFTWARE	= 0x04
+};
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+HashCache::HashCache()
+	: m_isDirty(false)
+{
+}
+
+
+//-------------------------------------------------
+//  load
+//-------------------------------------------------
+
+bool HashCache::load(const QString &fileName)
+{
+	QFile file(fileName);
+	return file.open(QIODevice::ReadOnly)
+		&& load(file);
+}
+
+
+//-------------------------------------------------
+//  load
+//-------------------------------------------------
+
+bool HashCache::load(QIODevice &input)
+{
+	ProfilerScope prof(CURRENT_FUNCTION);
+	QDataStream stream(&input);
+	stream.setVersion(QDataStream::Qt_6_0);
+
+	// check the header
+	quint32 magic, version, count;
+	stream >> magic >> version >> count;
+	if (stream.status() != QDataStream::Ok || magic != MAGIC_HASHCACHE || version != HASHCACHE_VERSION)
+		return false;
+
+	// read all entries
+	std::unordered_map<Key, Entry, KeyHash> entries;
+	entries.reserve(count);
+	for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++)
+	{
+		QString path, member;
+		quint64 size;
+		qint64 lastModified;
+		quint8 flags;
+		quint32 crc32;
+		std::array<uint8_t, 20> sha1;
+		stream >> path >> member >> size >> lastModified >> flags >> crc32;
+		if (stream.readRawData((char *)sha1.data(), (int)sha1.size()) != (int)sha1.size())
+			stream.setStatus(QDataStream::ReadPastEnd);
+
+		Hash hash(
+			(flags & FLAG_HAS_CRC32) ? crc32 : std::optional<std::uint32_t>(),
+			(flags & FLAG_HAS_SHA1) ? sha1 : std::optional<std::array<uint8_t, 20>>());
+		entries.insert_or_assign(Key(std::move(path), std::move(member)), Entry { size, lastModified, hash, true, (flags & FLAG_SOFTWARE) != 0 });
+	}
+
+	// bail if anything went wrong
+	if (stream.status() != QDataStream::Ok)
+		return false;
+
+	// we've succeeded; put the entries in place
+	std::unique_lock lock(m_mutex);
+	m_entries = std::move(entries);
+	m_isDirty = false;
+	return true;
+}
+
+
+//-------------------------------------------------
+//  save
+//-------------------------------------------------
+
+bool HashCache::save(const QString &fileName)
+{
+	QSaveFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+
+	save(file);
+	return file.commit();
+}
+
+
+//-------------------------------------------------
+//  save
+//-------------------------------------------------
+
+void HashCache::save(QIODevice &output)
+{
+	ProfilerScope prof(CURRENT_FUNCTION);
+	QDataStream stream(&output);
+	stream.setVersion(QDataStream::Qt_6_0);
+
+	std::unique_lock lock(m_mutex);
+	stream << MAGIC_HASHCACHE << HASHCACHE_VERSION << (quint32)m_entries.size();
+	for (const auto &[key, entry] : m_entries)
+	{
+		const std::optional<std::uint32_t> &crc32 = entry.m_hash.crc32();
+		const std::optional<std::array<uint8_t, 20>> &sha1 = entry.m_hash.sha1();
+		quint8 flags = (crc32 ? FLAG_HAS_CRC32 : 0) | (sha1 ? FLAG_HAS_SHA1 : 0) | (entry.m_usedBySoftware ? FLAG_SOFTWARE : 0);
+		std::array<uint8_t, 20> sha1Bytes = sha1.value_or(std::array<uint8_t, 20>());
+
+		stream << key.first << key.second << (quint64)entry.m_size << entry.m_lastModified << flags << crc32.value_or(0);
+		stream.writeRawData((const char *)sha1Bytes.data(), (int)sha1Bytes.size());
+	}
+	m_isDirty = false;
+}
+
+
+//-------------------------------------------------
+//  find
+//-------------------------------------------------
+
+std::optional<Hash> HashCache::find(const AssetFinder::Identity &identity, bool forSoftware) const
+{
+	std::unique_lock lock(m_mutex);
+	auto iter = m_entries.find(Key(identity.m_path, identity.m_member));
+
+	// only a hit if the asset has not changed since we hashed it
+	if (iter == m_entries.end() || iter->second.m_size != identity.m_size || iter->second.m_lastModified != identity.m_lastModified)
+		return { };
+
+	iter->second.m_used = true;
+	if (forSoftware)
+		iter->second.m_usedBySoftware = true;
+	return iter->second.m_hash;
+}
+
+
+//-------------------------------------------------
+//  add
+//-------------------------------------------------
+
+void HashCache::add(const AssetFinder::Identity &identity, const Hash &hash, bool forSoftware)
+{
+	std::unique_lock lock(m_mutex);
+	Key key(identity.m_path, identity.m_member);
+
+	// an asset that a software list audit has used stays that way when it is rehashed
+	auto iter = m_entries.find(key);
+	bool usedBySoftware = forSoftware || (iter != m_entries.end() && iter->second.m_usedBySoftware);
+	m_entries.insert_or_assign(std::move(key), Entry { identity.m_size, identity.m_lastModified, hash, true, usedBySoftware });
+	m_isDirty = true;
+}
+
+
+//-------------------------------------------------
+//  beginSweep - starts keeping track of which
+//	entries get used, typically because everything
+//	is about to be audited
+//-------------------------------------------------
+
+void HashCache::beginSweep()
+{
+	std::unique_lock lock(m_mutex);
+	for (auto &[key, entry] : m_entries)
+		entry.m_used = false;
+}
+
+
+//-------------------------------------------------
+//  prune - drops the entries that have not been
+//	used since beginSweep(); returns how many.  A
+//	sweep only covers machines, so entries that
+//	software list audits use are always kept
+//-------------------------------------------------
+
+std::size_t HashCache::prune()
+{
+	std::unique_lock lock(m_mutex);
+	std::size_t count = std::erase_if(m_entries, [](const auto &pair) { return !pair.second.m_used && !pair.second.m_usedBySoftware; });
+	if (count > 0)
+		m_isDirty = true;
+	return count;
+}
+
+
+//-------------------------------------------------
+//  isDirty
+//-------------------------------------------------
+
+bool HashCache::isDirty() const
+{
+	std::unique_lock lock(m_mutex);
+	return m_isDirty;
+}
+
+
+//-------------------------------------------------
+//  size
+//-------------------------------------------------
+
+std::size_t HashCache::size() const
+{
+	std::unique_lock lock(m_mutex);
+	return m_entries.size();
+}
+
+
+//-------------------------------------------------
+//  KeyHash::operator()
+//-------------------------------------------------
+
+std::size_t HashCache::KeyHash::operator()(const Key &key) const
+{
+	return qHash(key);
+}
@@ -0,0 +1,77 @@
+/***************************************************************************
+
+	hashcache.h
+
+	Persistent cache of asset hashes, so that audits do not have to rehash
+	files that have not changed
+
+***************************************************************************/
+
+#ifndef HASHCACHE_H
+#define HASHCACHE_H
+
+// bletchmame headers
+#include "assetfinder.h"
+#include "hash.h"
+
+// standard headers
+#include <mutex>
+#include <unordered_map>
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+// ======================> HashCache
+
+class HashCache
+{
+public:
+	class Test;
+
+	// ctor
+	HashCache();
+	HashCache(const HashCache &) = delete;
+	HashCache(HashCache &&) = delete;
+
+	// methods
+	bool load(const QString &fileName);
+	bool load(QIODevice &input);
+	bool save(const QString &fileName);
+	void save(QIODevice &output);
+	std::optional<Hash> find(const AssetFinder::Identity &identity, bool forSoftware = false) const;
+	void add(const AssetFinder::Identity &identity, const Hash &hash, bool forSoftware = false);
+	void beginSweep();
+	std::size_t prune();
+
+	// accessors
+	bool isDirty() const;
+	std::size_t size() const;
+
+private:
+	// entries are keyed by path and archive member; the rest of the identity has to match
+	// for the entry to be used, and is replaced when the asset changes
+	typedef std::pair<QString, QString> Key;
+
+	struct KeyHash
+	{
+		std::size_t operator()(const Key &key) const;
+	};
+
+	struct Entry
+	{
+		std::uint64_t	m_size;
+		qint64			m_lastModified;
+		Hash			m_hash;
+		mutable bool	m_used;				// looked up (or added) since beginSweep()
+		mutable bool	m_usedBySoftware;	// ever looked up (or added) by a software list audit
+	};
+
+	mutable std::mutex							m_mutex;
+	std::unordered_map<Key, Entry, KeyHash>		m_entries;
+	bool										m_isDirty;
+};
+
+
+#endif // HASHCACHE_H
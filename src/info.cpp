@@ -14,7 +14,11 @@
 #include <QBuffer>
 #include <QDataStream>
 
+// zlib headers
+#include <zlib.h>
+
 // standard headers
+#include <bit>
 #include <cassert>
 #include <stdexcept>
 
@@ -39,6 +43,8 @@ static_assert(std::ranges::random_access_range<info::configuration_setting::view
 static_assert(std::ranges::random_access_range<info::configuration_condition::view>);
 static_assert(std::ranges::random_access_range<info::software_list::view>);
 static_assert(std::ranges::random_access_range<info::ram_option::view>);
+static_assert(std::ranges::random_access_range<info::posting_list::view>);
+static_assert(std::ranges::random_access_range<info::rom_hash::view>);
 
 // and more asserts to ensure that we can use our views as C++20 sized_range
 static_assert(std::ranges::sized_range<info::machine::view>);
@@ -57,6 +63,8 @@ static_assert(std::ranges::sized_range<info::configuration_setting::view>);
 static_assert(std::ranges::sized_range<info::configuration_condition::view>);
 static_assert(std::ranges::sized_range<info::software_list::view>);
 static_assert(std::ranges::sized_range<info::ram_option::view>);
+static_assert(std::ranges::sized_range<info::posting_list::view>);
+static_assert(std::ranges::sized_range<info::rom_hash::view>);
 
 // and more asserts to ensure that we can use our views as C++20 borrowed_range
 static_assert(std::ranges::borrowed_range<info::machine::view>);
@@ -75,6 +83,13 @@ static_assert(std::ranges::borrowed_range<info::configuration_setting::view>);
 static_assert(std::ranges::borrowed_range<info::configuration_condition::view>);
 static_assert(std::ranges::borrowed_range<info::software_list::view>);
 static_assert(std::ranges::borrowed_range<info::ram_option::view>);
+static_assert(std::ranges::borrowed_range<info::posting_list::view>);
+static_assert(std::ranges::borrowed_range<info::rom_hash::view>);
+
+// the header and machine summaries are written verbatim; padding would make the output nondeterministic
+static_assert(sizeof(info::binaries::machine_summary) == sizeof(std::uint32_t) * 6 + sizeof(std::uint8_t) * 8);
+static_assert(sizeof(info::binaries::rom_hash) == sizeof(std::uint8_t) * 24 + sizeof(std::uint32_t) * 2);
+static_assert(sizeof(info::binaries::header) == sizeof(std::uint64_t) * 2 + sizeof(std::uint32_t) * 3 + sizeof(info::binaries::section) * (int)info::binaries::section_type::COUNT);
 
 
 //**************************************************************************
@@ -150,15 +165,89 @@ static std::vector<std::uint8_t> load_data(QIODevice &input, info::binaries::hea
 
 
 //-------------------------------------------------
-//  getPosition
+//  map_data - the zero-copy alternative to
+//	load_data(); maps the file read-only and points
+//	into the mapping
+//-------------------------------------------------
+
+static std::optional<std::span<const std::uint8_t>> map_data(QFile &file, info::binaries::header &header) noexcept
+{
+	// get the file size
+	qint64 size = file.size();
+	if (size <= (qint64)sizeof(header))
+		return { };
+
+	// map the file
+	const std::uint8_t *ptr = file.map(0, size);
+	if (!ptr)
+		return { };
+
+	// the header may not be aligned relative to what follows, so copy it out
+	memcpy(&header, ptr, sizeof(header));
+
+	// and return everything after the header
+	return std::span<const std::uint8_t>(ptr + sizeof(header), util::safe_static_cast<size_t>(size) - sizeof(header));
+}
+
+
+//-------------------------------------------------
+//  sectionRecordSize
+//-------------------------------------------------
+
+static std::size_t sectionRecordSize(info::binaries::section_type type) noexcept
+{
+	using namespace info::binaries;
+	switch (type)
+	{
+	case section_type::MACHINES:					return sizeof(machine);
+	case section_type::MACHINE_SUMMARIES:			return sizeof(machine_summary);
+	case section_type::BIOSSETS:					return sizeof(biosset);
+	case section_type::ROMS:						return sizeof(rom);
+	case section_type::DISKS:						return sizeof(disk);
+	case section_type::DEVICES:						return sizeof(device);
+	case section_type::SLOTS:						return sizeof(slot);
+	case section_type::SLOT_OPTIONS:				return sizeof(slot_option);
+	case section_type::FEATURES:					return sizeof(feature);
+	case section_type::CHIPS:						return sizeof(chip);
+	case section_type::DISPLAYS:					return sizeof(display);
+	case section_type::SAMPLES:						return sizeof(sample);
+	case section_type::CONFIGURATIONS:				return sizeof(configuration);
+	case section_type::CONFIGURATION_SETTINGS:		return sizeof(configuration_setting);
+	case section_type::CONFIGURATION_CONDITIONS:	return sizeof(configuration_condition);
+	case section_type::SOFTWARE_LISTS:				return sizeof(software_list);
+	case section_type::RAM_OPTIONS:					return sizeof(ram_option);
+	case section_type::POSTING_LISTS:				return sizeof(posting_list);
+	case section_type::POSTINGS:					return sizeof(std::uint32_t);
+	case section_type::MACHINE_NAME_BUCKETS:		return sizeof(std::uint32_t);
+	case section_type::MACHINE_NAME_SLOTS:			return sizeof(std::uint32_t);
+	case section_type::ROM_HASHES:					return sizeof(rom_hash);
+	case section_type::ROM_HASH_USES:				return sizeof(rom_hash_use);
+	case section_type::ROM_HASH_SLOTS:				return sizeof(std::uint32_t);
+	case section_type::STRINGS:						return sizeof(char);
+	default:										return 0;
+	}
+}
+
+
+//-------------------------------------------------
+//  database ctor
 //-------------------------------------------------
 
-template<class T>
-bindata::view_position getPosition(size_t &cursor, std::uint32_t count) noexcept
+info::database::database()
+	: m_state(empty_state())
+{
+}
+
+
+//-------------------------------------------------
+//  database ctor - creates a database over an
+//	existing snapshot, typically so that another
+//	thread can read from it
+//-------------------------------------------------
+
+info::database::database(snapshot &&snap)
+	: m_state(snap ? std::move(snap.m_state) : empty_state())
 {
-	std::uint32_t offset = util::safe_static_cast<std::uint32_t>(cursor);
-	cursor += sizeof(T) * count;
-	return bindata::view_position(offset, count);
 }
 
 
@@ -168,13 +257,11 @@ bindata::view_position getPosition(size_t &cursor, std::uint32_t count) noexcept
 
 bool info::database::load(const QString &file_name, const QString &expected_version) noexcept
 {
-	// check for file existance
-	QFile file(file_name);
-	if (!file.open(QIODevice::ReadOnly))
+	snapshot snap = prepare(file_name, expected_version);
+	if (!snap)
 		return false;
-
-	// open up the file
-	return load(file, expected_version);
+	publish(std::move(snap));
+	return true;
 }
 
 
@@ -185,9 +272,11 @@ bool info::database::load(const QString &file_name, const QString &expected_vers
 
 bool info::database::load(const QByteArray &byteArray, const QString &expected_version) noexcept
 {
-	QBuffer buffer((QByteArray *) &byteArray);
-	return buffer.open(QIODevice::ReadOnly)
-		&& load(buffer, expected_version);
+	snapshot snap = prepare(byteArray, expected_version);
+	if (!snap)
+		return false;
+	publish(std::move(snap));
+	return true;
 }
 
 
@@ -196,74 +285,169 @@ bool info::database::load(const QByteArray &byteArray, const QString &expected_v
 //-------------------------------------------------
 
 bool info::database::load(QIODevice &input, const QString &expected_version) noexcept
+{
+	snapshot snap = prepare(input, expected_version);
+	if (!snap)
+		return false;
+	publish(std::move(snap));
+	return true;
+}
+
+
+//-------------------------------------------------
+//  database::prepare - loads and validates an info
+//	DB without publishing it; safe to call from any
+//	thread
+//-------------------------------------------------
+
+info::database::snapshot info::database::prepare(const QString &file_name, const QString &expected_version) noexcept
+{
+	// check for file existance
+	std::unique_ptr<QFile> file = std::make_unique<QFile>(file_name);
+	if (!file->open(QIODevice::ReadOnly))
+		return snapshot();
+
+	// try to map the file; if we can't (unlikely), fall back to reading it
+	binaries::header salted_hdr;
+	std::optional<std::span<const std::uint8_t>> data = map_data(*file, salted_hdr);
+	if (!data)
+		return prepare(*file, expected_version);
+
+	// the state takes ownership of the file, keeping the mapping alive
+	info::database::State newState;
+	newState.m_data = *data;
+	newState.m_dataFile = std::move(file);
+	return prepare(std::move(newState), salted_hdr, expected_version);
+}
+
+
+//-------------------------------------------------
+//  database::prepare
+//-------------------------------------------------
+
+info::database::snapshot info::database::prepare(const QByteArray &byteArray, const QString &expected_version) noexcept
+{
+	QBuffer buffer((QByteArray *) &byteArray);
+	return buffer.open(QIODevice::ReadOnly)
+		? prepare(buffer, expected_version)
+		: snapshot();
+}
+
+
+//-------------------------------------------------
+//  database::prepare
+//-------------------------------------------------
+
+info::database::snapshot info::database::prepare(QIODevice &input, const QString &expected_version) noexcept
 {
 	info::database::State newState;
 
 	// try to load the data
 	binaries::header salted_hdr;
-	newState.m_data = load_data(input, salted_hdr);
-	if (newState.m_data.empty())
-		return false;
+	newState.m_dataBuffer = load_data(input, salted_hdr);
+	if (newState.m_dataBuffer.empty())
+		return snapshot();
+	newState.m_data = newState.m_dataBuffer;
+
+	// and process it
+	return prepare(std::move(newState), salted_hdr, expected_version);
+}
+
 
+//-------------------------------------------------
+//  database::prepare - common logic for loading
+//	from either a mapping or a buffer
+//-------------------------------------------------
+
+info::database::snapshot info::database::prepare(State &&newState, const binaries::header &salted_hdr, const QString &expected_version) noexcept
+{
 	// unsalt the header
 	binaries::header hdr = util::salt(salted_hdr, info::binaries::salt());
 
 	// check the header
 	if ((hdr.m_magic != info::binaries::MAGIC_HDR) || (hdr.m_sizes_hash != calculate_sizes_hash()))
-		return false;
-
-	// positions
-	size_t cursor = 0;
-	newState.m_machines_position					= getPosition<binaries::machine>(cursor, hdr.m_machines_count);
-	newState.m_biossets_position					= getPosition<binaries::biosset>(cursor, hdr.m_biossets_count);
-	newState.m_roms_position						= getPosition<binaries::rom>(cursor, hdr.m_roms_count);
-	newState.m_disks_position						= getPosition<binaries::disk>(cursor, hdr.m_disks_count);
-	newState.m_devices_position						= getPosition<binaries::device>(cursor, hdr.m_devices_count);
-	newState.m_slots_position						= getPosition<binaries::slot>(cursor, hdr.m_slots_count);
-	newState.m_slot_options_position				= getPosition<binaries::slot_option>(cursor, hdr.m_slot_options_count);
-	newState.m_features_position					= getPosition<binaries::feature>(cursor, hdr.m_features_count);
-	newState.m_chips_position						= getPosition<binaries::chip>(cursor, hdr.m_chips_count);
-	newState.m_displays_position					= getPosition<binaries::display>(cursor, hdr.m_displays_count);
-	newState.m_samples_position						= getPosition<binaries::sample>(cursor, hdr.m_samples_count);
-	newState.m_configurations_position				= getPosition<binaries::configuration>(cursor, hdr.m_configurations_count);
-	newState.m_configuration_settings_position		= getPosition<binaries::configuration_setting>(cursor, hdr.m_configuration_settings_count);
-	newState.m_configuration_conditions_position	= getPosition<binaries::configuration_condition>(cursor, hdr.m_configuration_conditions_count);
-	newState.m_software_lists_position				= getPosition<binaries::software_list>(cursor, hdr.m_software_lists_count);
-	newState.m_ram_options_position					= getPosition<binaries::ram_option>(cursor, hdr.m_ram_options_count);
-	newState.m_string_table_offset					= static_cast<std::uint32_t>(cursor);
-
-	// sanity check the string table
-	if (newState.m_data.size() < (size_t)newState.m_string_table_offset + 1)
-		return false;
-	if (!unaligned_check(&newState.m_data[(size_t)newState.m_string_table_offset], binaries::MAGIC_STRINGTABLE_BEGIN))
-		return false;
-	if (newState.m_data[newState.m_data.size() - sizeof(binaries::MAGIC_STRINGTABLE_END) - 1] != '\0')
-		return false;
-	if (!unaligned_check(&newState.m_data[newState.m_data.size() - sizeof(binaries::MAGIC_STRINGTABLE_END)], binaries::MAGIC_STRINGTABLE_END))
-		return false;
-	if (newState.m_string_table_offset != cursor)
-		return false;
+		return snapshot();
+
+	// locate the sections; this only checks that they are where the header says (nothing
+	// gets decompressed until it is needed)
+	if (hdr.m_section_count != (std::uint32_t)binaries::section_type::COUNT)
+		return snapshot();
+	if (!newState.m_sections->locate(newState.m_data, hdr))
+		return snapshot();
+	if (hdr.m_sections[(int)binaries::section_type::MACHINE_SUMMARIES].m_count != hdr.m_sections[(int)binaries::section_type::MACHINES].m_count)
+		return snapshot();
+
+	// the machine name index is optional, but if present needs a slot for every machine (and
+	// hence some machines; otherwise there are no slots for the hash to be taken modulo)
+	if (hdr.m_sections[(int)binaries::section_type::MACHINE_NAME_BUCKETS].m_count != 0
+		&& (hdr.m_sections[(int)binaries::section_type::MACHINES].m_count == 0
+			|| hdr.m_sections[(int)binaries::section_type::MACHINE_NAME_SLOTS].m_count != hdr.m_sections[(int)binaries::section_type::MACHINES].m_count))
+		return snapshot();
+
+	// likewise the ROM hash index, which is an open addressing table that has to have room to spare
+	std::uint32_t romHashSlotCount = hdr.m_sections[(int)binaries::section_type::ROM_HASH_SLOTS].m_count;
+	if (romHashSlotCount != 0
+		&& (!std::has_single_bit(romHashSlotCount) || romHashSlotCount <= hdr.m_sections[(int)binaries::section_type::ROM_HASHES].m_count))
+		return snapshot();
+
+	// sanity check the string table, which we always need and is never compressed
+	std::span<const std::uint8_t> stringTable = newState.m_sections->stored(binaries::section_type::STRINGS);
+	if (hdr.m_sections[(int)binaries::section_type::STRINGS].m_compression != (std::uint32_t)binaries::section_compression::NONE)
+		return snapshot();
+	if (stringTable.size() < sizeof(binaries::MAGIC_STRINGTABLE_BEGIN) + sizeof(binaries::MAGIC_STRINGTABLE_END) + 1)
+		return snapshot();
+	if (!unaligned_check(&stringTable[0], binaries::MAGIC_STRINGTABLE_BEGIN))
+		return snapshot();
+	if (stringTable[stringTable.size() - sizeof(binaries::MAGIC_STRINGTABLE_END) - 1] != '\0')
+		return snapshot();
+	if (!unaligned_check(&stringTable[stringTable.size() - sizeof(binaries::MAGIC_STRINGTABLE_END)], binaries::MAGIC_STRINGTABLE_END))
+		return snapshot();
+
+	// drop the ending magic bytes
+	newState.m_stringTable = std::span<const char>((const char *)stringTable.data(), stringTable.size() - sizeof(binaries::MAGIC_STRINGTABLE_END));
 
 	// version check if appropriate
-	std::optional<std::span<const char>> buildVersion = tryGetDataSpan<char>(newState, newState.m_string_table_offset + hdr.m_build_strindex);
+	if (hdr.m_build_strindex >= newState.m_stringTable.size())
+		return snapshot();
+	std::optional<QString> buildVersion = tryGetQStringFromCharSpan(newState.m_stringTable.subspan(hdr.m_build_strindex));
 	if (!buildVersion)
-		return false;
-	if (!expected_version.isEmpty() && expected_version != tryGetQStringFromCharSpan(*buildVersion))
-		return false;
-
-	// finally things look good - first shrink the data array to drop the ending magic bytes
-	newState.m_data.resize(newState.m_data.size() - sizeof(binaries::MAGIC_STRINGTABLE_END));
+		return snapshot();
+	if (!expected_version.isEmpty() && expected_version != *buildVersion)
+		return snapshot();
 
-	// ...set the state
-	m_state = std::move(newState);
+	// finally things look good - index the string table
+	newState.m_strings = std::make_unique<string_cache>(newState.m_stringTable);
 
 	// ...and set up other incidental state
-	m_loaded_strings.clear();
-	m_version = &get_string(hdr.m_build_strindex);
+	newState.m_version = &newState.m_strings->get(hdr.m_build_strindex);
+
+	// and we're done; from here on the state is immutable
+	return snapshot(std::make_shared<const State>(std::move(newState)));
+}
+
 
-	// signal that we've changed and we're done
+//-------------------------------------------------
+//  database::publish - replaces the current state
+//	with a prepared snapshot; should be called from
+//	the thread that owns this database
+//-------------------------------------------------
+
+void info::database::publish(snapshot &&snap) noexcept
+{
+	m_state = snap ? std::move(snap.m_state) : empty_state();
 	onChanged();
-	return true;
+}
+
+
+//-------------------------------------------------
+//  database::snapshot::version
+//-------------------------------------------------
+
+const QString &info::database::snapshot::version() const noexcept
+{
+	return m_state
+		? *m_state->m_version
+		: util::g_empty_string;
 }
 
 
@@ -276,9 +460,13 @@ uint64_t info::database::calculate_sizes_hash() noexcept
 	static const uint64_t sizes[] =
 	{
 		sizeof(info::binaries::header),
+		sizeof(info::binaries::section),
 		sizeof(info::binaries::machine),
+		sizeof(info::binaries::machine_summary),
 		sizeof(info::binaries::biosset),
 		sizeof(info::binaries::rom),
+		sizeof(info::binaries::rom_hash),
+		sizeof(info::binaries::rom_hash_use),
 		sizeof(info::binaries::disk),
 		sizeof(info::binaries::device),
 		sizeof(info::binaries::slot),
@@ -291,7 +479,8 @@ uint64_t info::database::calculate_sizes_hash() noexcept
 		sizeof(info::binaries::configuration_setting),
 		sizeof(info::binaries::configuration_condition),
 		sizeof(info::binaries::software_list),
-		sizeof(info::binaries::ram_option)
+		sizeof(info::binaries::ram_option),
+		sizeof(info::binaries::posting_list)
 	};
 
 	uint64_t result = 0;
@@ -304,16 +493,65 @@ uint64_t info::database::calculate_sizes_hash() noexcept
 }
 
 
+//-------------------------------------------------
+//  database::machine_name_hash - hashes a machine
+//	name for the perfect hash index; this is part
+//	of the info DB format, so it cannot change
+//	without invalidating existing info DBs
+//-------------------------------------------------
+
+std::uint64_t info::database::machine_name_hash(std::u8string_view machine_name) noexcept
+{
+	// FNV-1a...
+	std::uint64_t result = 0xCBF29CE484222325;
+	for (char8_t ch : machine_name)
+	{
+		result ^= (std::uint8_t)ch;
+		result *= 0x100000001B3;
+	}
+
+	// ...with a final mix so that all bits are usable
+	result ^= result >> 33;
+	result *= 0xFF51AFD7ED558CCD;
+	result ^= result >> 33;
+	return result;
+}
+
+
+//-------------------------------------------------
+//  database::machine_name_slot - determines the
+//	slot of a machine name within the perfect hash
+//	index, given the displacement of its bucket
+//-------------------------------------------------
+
+std::uint32_t info::database::machine_name_slot(std::uint64_t hash, std::uint32_t displacement, std::uint32_t slot_count) noexcept
+{
+	std::uint64_t x = hash + ((std::uint64_t)displacement + 1) * 0x9E3779B97F4A7C15;
+	x ^= x >> 33;
+	x *= 0xC4CEB9FE1A85EC53;
+	x ^= x >> 33;
+	return (std::uint32_t)(x % slot_count);
+}
+
+
 //-------------------------------------------------
 //  database::reset
 //-------------------------------------------------
 
 void info::database::reset() noexcept
 {
-	m_state = State();
-	m_loaded_strings.clear();
-	m_version = &util::g_empty_string;
-	onChanged();
+	publish(snapshot());
+}
+
+
+//-------------------------------------------------
+//  database::empty_state
+//-------------------------------------------------
+
+const std::shared_ptr<const info::database::State> &info::database::empty_state() noexcept
+{
+	static const std::shared_ptr<const State> s_emptyState = std::make_shared<const State>();
+	return s_emptyState;
 }
 
 
@@ -344,30 +582,96 @@ void info::database::onChanged() noexcept
 
 const QString &info::database::get_string(std::uint32_t offset) const noexcept
 {
-	// do we have this string in our loaded string cache?
-	auto iter = m_loaded_strings.find(offset);
-	if (iter != m_loaded_strings.end())
-		return iter->second;
+	return m_state->m_strings->get(offset);
+}
 
-	QString string;
+
+//-------------------------------------------------
+//  database::get_string_u8 - returns a string as
+//	UTF-8 without decoding it into a QString
+//-------------------------------------------------
+
+std::u8string_view info::database::get_string_u8(std::uint32_t offset, sso_buffer &buffer) const noexcept
+{
 	std::optional<std::array<char8_t, 6>> smallString = tryDecodeAsSmallString(offset);
 	if (smallString)
 	{
-		// this was a small string
-		string = QString::fromUtf8(&(*smallString)[0]);
+		// small strings are decoded into the caller's buffer
+		buffer = *smallString;
+		return std::u8string_view(buffer.data());
 	}
-	else
+	else if (offset < m_state->m_stringTable.size())
 	{
-		// perform a string table lookup
-		std::span<const char> utf8String = getDataSpan<char>(m_state.m_string_table_offset + offset);
-		string = getQStringFromCharSpan(utf8String);
+		// everything else comes straight out of the string table, which is known to end with a NUL
+		return std::u8string_view((const char8_t *)&m_state->m_stringTable[offset]);
 	}
+	return std::u8string_view();
+}
+
+
+//-------------------------------------------------
+//  database::get_postings
+//-------------------------------------------------
+
+std::span<const std::uint32_t> info::database::get_postings(std::uint32_t index, std::uint32_t count) const
+{
+	std::span<const std::uint32_t> postings = get_section<std::uint32_t>(binaries::section_type::POSTINGS);
+	if ((std::uint64_t)index + count > postings.size())
+		throw std::out_of_range("info::database::get_postings");
+	return postings.subspan(index, count);
+}
+
 
-	// deposit this image in our cache
-	m_loaded_strings.emplace(offset, std::move(string));
+//-------------------------------------------------
+//  database::get_rom_hash
+//-------------------------------------------------
 
-	// and return a reference out of our cache
-	return m_loaded_strings.find(offset)->second;
+std::optional<info::rom_hash> info::database::get_rom_hash(std::uint32_t index) const
+{
+	auto hashes = rom_hashes();
+	return index < hashes.size()
+		? hashes[index]
+		: std::optional<info::rom_hash>();
+}
+
+
+//-------------------------------------------------
+//  database::get_rom_hash_uses
+//-------------------------------------------------
+
+std::span<const info::binaries::rom_hash_use> info::database::get_rom_hash_uses(std::uint32_t index, std::uint32_t count) const
+{
+	std::span<const binaries::rom_hash_use> uses = get_section<binaries::rom_hash_use>(binaries::section_type::ROM_HASH_USES);
+	if ((std::uint64_t)index + count > uses.size())
+		throw std::out_of_range("info::database::get_rom_hash_uses");
+	return uses.subspan(index, count);
+}
+
+
+//-------------------------------------------------
+//  database::get_machine_details - finds the full
+//	record that parallels a machine summary
+//-------------------------------------------------
+
+const info::binaries::machine &info::database::get_machine_details(const binaries::machine_summary &summary) const
+{
+	std::span<const binaries::machine_summary> summaries = get_section<binaries::machine_summary>(binaries::section_type::MACHINE_SUMMARIES);
+	std::span<const binaries::machine> machines = get_section<binaries::machine>(binaries::section_type::MACHINES);
+	std::size_t index = &summary - summaries.data();
+	if (index >= machines.size())
+		throw std::out_of_range("info::database::get_machine_details");
+	return machines[index];
+}
+
+
+//-------------------------------------------------
+//  database::is_section_paged_in - mostly for
+//	diagnostics and unit tests
+//-------------------------------------------------
+
+bool info::database::is_section_paged_in(binaries::section_type type) const noexcept
+{
+	return m_state->m_sections->is_paged_in(type);
 }
 
 
@@ -444,11 +748,25 @@ std::optional<std::array<char8_t, 6>> info::database::tryDecodeAsSmallString(std
 //-------------------------------------------------
 
 std::optional<info::device> info::machine::find_device(const QString &tag) const noexcept
+{
+	return find_device(util::toU8String(tag));
+}
+
+
+//-------------------------------------------------
+//  machine::find_device
+//-------------------------------------------------
+
+std::optional<info::device> info::machine::find_device(std::u8string_view tag) const noexcept
 {
 	// find the device
 	auto iter = std::ranges::find_if(
 		devices(),
-		[&tag](info::device dev) { return tag == dev.tag(); });
+		[tag](info::device dev)
+		{
+			sso_buffer buffer;
+			return tag == dev.tag_u8(buffer);
+		});
 
 	// if we found a device, return the interface
 	return iter != devices().cend()
@@ -462,11 +780,25 @@ std::optional<info::device> info::machine::find_device(const QString &tag) const
 //-------------------------------------------------
 
 std::optional<info::chip> info::machine::find_chip(const QString &chipName) const noexcept
+{
+	return find_chip(util::toU8String(chipName));
+}
+
+
+//-------------------------------------------------
+//  machine::find_chip
+//-------------------------------------------------
+
+std::optional<info::chip> info::machine::find_chip(std::u8string_view chipName) const noexcept
 {
 	// find the device
 	auto iter = std::ranges::find_if(
 		chips(),
-		[&chipName](info::chip chip) { return chipName == chip.name(); });
+		[chipName](info::chip chip)
+		{
+			sso_buffer buffer;
+			return chipName == chip.name_u8(buffer);
+		});
 
 	// if we found a device, return the interface
 	return iter != chips().cend()
@@ -493,8 +825,8 @@ std::optional<info::machine> info::machine::clone_of() const noexcept
 
 std::optional<info::machine> info::machine::rom_of() const noexcept
 {
-	return inner().m_rom_of_machindex < db().machines().size()
-		? db().machines()[inner().m_rom_of_machindex]
+	return details().m_rom_of_machindex < db().machines().size()
+		? db().machines()[details().m_rom_of_machindex]
 		: std::optional<info::machine>();
 }
 
@@ -505,7 +837,8 @@ std::optional<info::machine> info::machine::rom_of() const noexcept
 
 std::optional<info::machine> info::slot_option::machine() const noexcept
 {
-	return db().find_machine(devname());
+	sso_buffer buffer;
+	return db().find_machine(devname_u8(buffer));
 
 }
 
@@ -514,17 +847,36 @@ std::optional<info::machine> info::slot_option::machine() const noexcept
 //  database::find_machine_index
 //-------------------------------------------------
 
-std::optional<int> info::database::find_machine_index(const QString &machine_name) const noexcept
+std::optional<int> info::database::find_machine_index(std::u8string_view machine_name) const noexcept
 {
+	// if we have a perfect hash index, the name can only be in one place
+	std::span<const std::uint32_t> buckets = get_section<std::uint32_t>(binaries::section_type::MACHINE_NAME_BUCKETS);
+	if (!buckets.empty())
+	{
+		std::span<const std::uint32_t> slots = get_section<std::uint32_t>(binaries::section_type::MACHINE_NAME_SLOTS);
+		std::uint64_t hash = machine_name_hash(machine_name);
+		std::uint32_t displacement = buckets[hash % buckets.size()];
+		std::uint32_t machineIndex = slots[machine_name_slot(hash, displacement, (std::uint32_t)slots.size())];
+
+		sso_buffer buffer;
+		return machineIndex < machines().size() && machines()[machineIndex].name_u8(buffer) == machine_name
+			? util::safe_static_cast<int>(machineIndex)
+			: std::optional<int>();
+	}
+
+	// otherwise machines are sorted by the UTF-8 text of their names, so we can binary
+	// search and compare against the string table directly
 	auto iter = std::lower_bound(
 		machines().begin(),
 		machines().end(),
 		machine_name,
-		[](const info::machine &a, const QString &b)
+		[](const info::machine &a, std::u8string_view b)
 		{
-			return a.name() < b;
+			sso_buffer buffer;
+			return a.name_u8(buffer) < b;
 		});
-	return iter != machines().end() && iter->name() == machine_name
+	sso_buffer buffer;
+	return iter != machines().end() && iter->name_u8(buffer) == machine_name
 		? util::safe_static_cast<int>(iter - machines().begin())
 		: std::optional<int>();
 }
@@ -535,6 +887,16 @@ std::optional<int> info::database::find_machine_index(const QString &machine_nam
 //-------------------------------------------------
 
 std::optional<info::machine> info::database::find_machine(const QString &machine_name) const noexcept
+{
+	return find_machine(util::toU8String(machine_name));
+}
+
+
+//-------------------------------------------------
+//  database::find_machine
+//-------------------------------------------------
+
+std::optional<info::machine> info::database::find_machine(std::u8string_view machine_name) const noexcept
 {
 	std::optional<int> index = find_machine_index(machine_name);
 	return index
@@ -544,13 +906,92 @@ std::optional<info::machine> info::database::find_machine(const QString &machine
 
 
 //-------------------------------------------------
-//  database::find_machine
+//  database::find_rom_hashes - identifies a file by
+//	its CRC-32; there is usually one hash at most,
+//	but nothing stops different SHA-1s from sharing
+//	a CRC-32
 //-------------------------------------------------
 
-std::optional<info::machine> info::database::find_machine(std::u8string_view machine_name) const noexcept
+std::vector<info::rom_hash> info::database::find_rom_hashes(std::uint32_t crc32) const noexcept
+{
+	// the slots are an open addressing table with linear probing; CRC-32s are uniformly
+	// distributed, so their low bits make for a perfectly good hash
+	std::vector<rom_hash> result;
+	std::span<const std::uint32_t> slots = get_section<std::uint32_t>(binaries::section_type::ROM_HASH_SLOTS);
+	auto hashes = rom_hashes();
+	std::size_t mask = slots.size() - 1;
+	for (std::size_t i = 0; i < slots.size() && slots[(crc32 + i) & mask] != (std::uint32_t)~0; i++)
+	{
+		std::uint32_t hashIndex = slots[(crc32 + i) & mask];
+		if (hashIndex < hashes.size() && hashes[hashIndex].crc32() == crc32)
+			result.push_back(hashes[hashIndex]);
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  database::posting_lists - returns all posting
+//	lists of a particular type
+//-------------------------------------------------
+
+info::posting_list::view info::database::posting_lists(posting_list::type_t type) const
 {
-	QString machineNameQString = util::toQString(machine_name);
-	return find_machine(machineNameQString);
+	// posting lists are sorted by type, and then by key
+	auto lists = posting_lists();
+	auto begin = std::partition_point(lists.begin(), lists.end(), [type](const info::posting_list &x) { return x.type() < type; });
+	auto end = std::partition_point(begin, lists.end(), [type](const info::posting_list &x) { return x.type() <= type; });
+	return lists.subview(begin - lists.begin(), end - begin);
+}
+
+
+//-------------------------------------------------
+//  database::find_posting_list
+//-------------------------------------------------
+
+std::optional<info::posting_list> info::database::find_posting_list(const posting_list::id &id) const noexcept
+{
+	// like machines, posting lists are sorted by the UTF-8 text of their keys
+	std::u8string key = util::toU8String(id.m_key);
+	auto lists = posting_lists(id.m_type);
+	auto iter = std::lower_bound(
+		lists.begin(),
+		lists.end(),
+		std::u8string_view(key),
+		[](const info::posting_list &a, std::u8string_view b)
+		{
+			sso_buffer buffer;
+			return a.key_u8(buffer) < b;
+		});
+	sso_buffer buffer;
+	return iter != lists.end() && iter->key_u8(buffer) == key
+		? *iter
+		: std::optional<info::posting_list>();
+}
+
+
+//-------------------------------------------------
+//  posting_list::contains
+//-------------------------------------------------
+
+bool info::posting_list::contains(const info::machine &machine) const noexcept
+{
+	// machines are sorted by name, so the machines referenced by a posting list
+	// are too, and we can binary search
+	std::span<const std::uint32_t> indexes = machine_indexes();
+	sso_buffer nameBuffer;
+	std::u8string_view name = machine.name_u8(nameBuffer);
+	auto iter = std::lower_bound(
+		indexes.begin(),
+		indexes.end(),
+		name,
+		[this](std::uint32_t a, std::u8string_view b)
+		{
+			sso_buffer buffer;
+			return db().machines()[a].name_u8(buffer) < b;
+		});
+	sso_buffer buffer;
+	return iter != indexes.end() && db().machines()[*iter].name_u8(buffer) == name;
 }
 
 
@@ -559,6 +1000,276 @@ std::optional<info::machine> info::database::find_machine(std::u8string_view mac
 //-------------------------------------------------
 
 info::database::State::State()
-	: m_string_table_offset(0)
+	: m_sections(std::make_unique<section_table>())
+	, m_strings(std::make_unique<string_cache>())
+	, m_version(&util::g_empty_string)
+{
+}
+
+
+//-------------------------------------------------
+//  section_table::locate - points our sections at
+//	the data as described by the header
+//-------------------------------------------------
+
+bool info::database::section_table::locate(std::span<const std::uint8_t> data, const binaries::header &hdr) noexcept
+{
+	for (int i = 0; i < (int)binaries::section_type::COUNT; i++)
+	{
+		const binaries::section &section = hdr.m_sections[i];
+		entry &e = m_entries[i];
+
+		// the section has to be within the data, and have the size its records imply
+		if ((std::uint64_t)section.m_offset + section.m_stored_size > data.size())
+			return false;
+		if ((std::uint64_t)section.m_count * sectionRecordSize((binaries::section_type)i) != section.m_size)
+			return false;
+
+		e.m_stored = data.subspan(section.m_offset, section.m_stored_size);
+		e.m_size = section.m_size;
+		e.m_count = section.m_count;
+		e.m_compression = (binaries::section_compression)section.m_compression;
+		switch (e.m_compression)
+		{
+		case binaries::section_compression::NONE:
+			// uncompressed sections are used in place
+			if (section.m_stored_size != section.m_size)
+				return false;
+			e.m_data.store(e.m_stored.data(), std::memory_order_relaxed);
+			break;
+
+		case binaries::section_compression::ZLIB:
+			e.m_data.store(nullptr, std::memory_order_relaxed);
+			break;
+
+		default:
+			return false;
+		}
+	}
+	return true;
+}
+
+
+//-------------------------------------------------
+//  section_table::stored - returns the section as
+//	it appears in the data
+//-------------------------------------------------
+
+std::span<const std::uint8_t> info::database::section_table::stored(binaries::section_type type) const noexcept
+{
+	return m_entries[(int)type].m_stored;
+}
+
+
+//-------------------------------------------------
+//  section_table::is_paged_in
+//-------------------------------------------------
+
+bool info::database::section_table::is_paged_in(binaries::section_type type) const noexcept
+{
+	return m_entries[(int)type].m_data.load(std::memory_order_acquire) != nullptr;
+}
+
+
+//-------------------------------------------------
+//  section_table::page_in - decompresses a section
+//	on first access; this is reached from accessors
+//	that cannot fail, so a section that does not
+//	decompress (which prepare() has no way of knowing
+//	without decompressing everything) reads as zeroed
+//	records, which the accessors bounds check like
+//	any other
+//-------------------------------------------------
+
+const std::uint8_t *info::database::section_table::page_in(const entry &e) const noexcept
+{
+	// empty sections (including all of them in an empty database) need no data
+	static const std::uint64_t s_empty = 0;
+	if (e.m_size == 0)
+		return (const std::uint8_t *)&s_empty;
+
+	std::lock_guard lock(m_mutex);
+	const std::uint8_t *data = e.m_data.load(std::memory_order_acquire);
+	if (!data)
+	{
+		// allocate in units of std::uint64_t to ensure alignment of the records
+		std::size_t bufferLength = (e.m_size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+		std::unique_ptr<std::uint64_t[]> buffer(new std::uint64_t[bufferLength]);
+		uLongf destLength = e.m_size;
+		int rc = uncompress((Bytef *)buffer.get(), &destLength, (const Bytef *)e.m_stored.data(), (uLong)e.m_stored.size());
+		if (rc != Z_OK || destLength != e.m_size)
+			std::fill(buffer.get(), buffer.get() + bufferLength, 0);
+
+		e.m_buffer = std::move(buffer);
+		data = (const std::uint8_t *)e.m_buffer.get();
+		e.m_data.store(data, std::memory_order_release);
+	}
+	return data;
+}
+
+
+//-------------------------------------------------
+//  string_cache ctor
+//-------------------------------------------------
+
+info::database::string_cache::string_cache(std::span<const char> stringTable)
+	: m_stringTable(stringTable)
+	, m_slotCount(0)
+	, m_buckets(std::make_unique<std::atomic<const Node *>[]>(BUCKET_COUNT))
+{
+	// mark every position that begins a string; the first string follows the
+	// leading magic bytes and every other string follows a NUL terminator
+	m_startBits.resize((stringTable.size() + 63) / 64);
+	auto markStart = [this](std::size_t offset)
+	{
+		if (offset < m_stringTable.size())
+			m_startBits[offset / 64] |= std::uint64_t(1) << (offset % 64);
+	};
+	markStart(sizeof(binaries::MAGIC_STRINGTABLE_BEGIN));
+	for (std::size_t offset = sizeof(binaries::MAGIC_STRINGTABLE_BEGIN); offset < stringTable.size(); offset++)
+	{
+		const char *nul = (const char *)memchr(&stringTable[offset], '\0', stringTable.size() - offset);
+		if (!nul)
+			break;
+		offset = nul - stringTable.data();
+		markStart(offset + 1);
+	}
+
+	// precompute the ranks at each word boundary, so that any string's slot is
+	// a prefix count plus a single popcount
+	m_startRanks.resize(m_startBits.size());
+	for (std::size_t i = 0; i < m_startBits.size(); i++)
+	{
+		m_startRanks[i] = util::safe_static_cast<std::uint32_t>(m_slotCount);
+		m_slotCount += std::popcount(m_startBits[i]);
+	}
+
+	// and allocate the (empty) slots
+	m_slots = std::make_unique<std::atomic<const QString *>[]>(m_slotCount);
+}
+
+
+//-------------------------------------------------
+//  string_cache dtor
+//-------------------------------------------------
+
+info::database::string_cache::~string_cache()
+{
+	for (std::size_t i = 0; i < m_slotCount; i++)
+		delete m_slots[i].load(std::memory_order_relaxed);
+
+	for (std::size_t i = 0; i < BUCKET_COUNT; i++)
+	{
+		const Node *node = m_buckets[i].load(std::memory_order_relaxed);
+		while (node)
+		{
+			const Node *next = node->m_next;
+			delete node;
+			node = next;
+		}
+	}
+}
+
+
+//-------------------------------------------------
+//  string_cache::get
+//-------------------------------------------------
+
+const QString &info::database::string_cache::get(std::uint32_t offset) const noexcept
 {
+	std::optional<std::size_t> index = slotIndex(offset);
+	return index
+		? getSlot(m_slots[*index], offset)
+		: getChained(offset);
+}
+
+
+//-------------------------------------------------
+//  string_cache::slotIndex
+//-------------------------------------------------
+
+std::optional<std::size_t> info::database::string_cache::slotIndex(std::uint32_t offset) const noexcept
+{
+	// small strings (and anything else not beginning a string) have no slot
+	if (offset >= m_stringTable.size())
+		return { };
+	std::uint64_t word = m_startBits[offset / 64];
+	std::uint64_t bit = std::uint64_t(1) << (offset % 64);
+	if (!(word & bit))
+		return { };
+
+	return m_startRanks[offset / 64] + std::popcount(word & (bit - 1));
+}
+
+
+//-------------------------------------------------
+//  string_cache::getSlot
+//-------------------------------------------------
+
+const QString &info::database::string_cache::getSlot(std::atomic<const QString *> &slot, std::uint32_t offset) const noexcept
+{
+	// the common case - the string was already decoded
+	const QString *result = slot.load(std::memory_order_acquire);
+	if (!result)
+	{
+		// decode and try to publish; if another thread beat us to it, use theirs
+		auto string = std::make_unique<QString>(decode(offset));
+		if (slot.compare_exchange_strong(result, string.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+			result = string.release();
+	}
+	return *result;
+}
+
+
+//-------------------------------------------------
+//  string_cache::getChained
+//-------------------------------------------------
+
+const QString &info::database::string_cache::getChained(std::uint32_t offset) const noexcept
+{
+	std::atomic<const Node *> &bucket = m_buckets[(offset * 2654435761U) % BUCKET_COUNT];
+
+	// look for this string in the chain
+	const Node *head = bucket.load(std::memory_order_acquire);
+	for (const Node *node = head; node; node = node->m_next)
+	{
+		if (node->m_offset == offset)
+			return node->m_string;
+	}
+
+	// not present; prepend a new node
+	auto newNode = std::make_unique<Node>(Node{ offset, decode(offset), head });
+	while (!bucket.compare_exchange_weak(newNode->m_next, newNode.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+	{
+		// somebody else prepended; check that they did not publish this very string
+		for (const Node *node = newNode->m_next; node != head; node = node->m_next)
+		{
+			if (node->m_offset == offset)
+				return node->m_string;
+		}
+		head = newNode->m_next;
+	}
+	return newNode.release()->m_string;
+}
+
+
+//-------------------------------------------------
+//  string_cache::decode
+//-------------------------------------------------
+
+QString info::database::string_cache::decode(std::uint32_t offset) const noexcept
+{
+	QString result;
+	std::optional<std::array<char8_t, 6>> smallString = tryDecodeAsSmallString(offset);
+	if (smallString)
+	{
+		// this was a small string
+		result = QString::fromUtf8(&(*smallString)[0]);
+	}
+	else if (offset < m_stringTable.size())
+	{
+		// perform a string table lookup; the table is known to end with a NUL
+		result = getQStringFromCharSpan(m_stringTable.subspan(offset));
+	}
+	return result;
 }
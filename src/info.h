@@ -15,8 +15,14 @@
 #include "bindata.h"
 #include "utility.h"
 
+// Qt headers
+#include <QFile>
+
 // standard headers
 #include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <unordered_map>
 #include <iterator>
@@ -34,31 +40,67 @@ namespace info
 		const std::uint16_t MAGIC_STRINGTABLE_BEGIN = 0x9D9B;
 		const std::uint16_t MAGIC_STRINGTABLE_END = 0x9F99;
 
+		// every table (and the string table) is a separate section, independently located
+		// by the header, so that each one can be paged in when first accessed
+		enum class section_type
+		{
+			MACHINES,
+			MACHINE_SUMMARIES,
+			BIOSSETS,
+			ROMS,
+			DISKS,
+			DEVICES,
+			SLOTS,
+			SLOT_OPTIONS,
+			FEATURES,
+			CHIPS,
+			DISPLAYS,
+			SAMPLES,
+			CONFIGURATIONS,
+			CONFIGURATION_SETTINGS,
+			CONFIGURATION_CONDITIONS,
+			SOFTWARE_LISTS,
+			RAM_OPTIONS,
+			POSTING_LISTS,
+			POSTINGS,
+			MACHINE_NAME_BUCKETS,
+			MACHINE_NAME_SLOTS,
+			ROM_HASHES,
+			ROM_HASH_USES,
+			ROM_HASH_SLOTS,
+			STRINGS,
+
+			COUNT
+		};
+
+		enum class section_compression
+		{
+			NONE,
+			ZLIB
+		};
+
+		struct section
+		{
+			std::uint32_t	m_offset;				// relative to the end of the header
+			std::uint32_t	m_stored_size;			// size within the file
+			std::uint32_t	m_size;					// size once decompressed
+			std::uint32_t	m_count;				// number of records
+			std::uint32_t	m_compression;			// wider than needed so that the structure has no padding
+		};
+
 		struct header
 		{
 			std::uint64_t	m_magic;
 			std::uint64_t	m_sizes_hash;
 			std::uint32_t	m_build_strindex;
-			std::uint32_t	m_machines_count;
-			std::uint32_t	m_biossets_count;
-			std::uint32_t	m_roms_count;
-			std::uint32_t	m_disks_count;
-			std::uint32_t	m_devices_count;
-			std::uint32_t	m_slots_count;
-			std::uint32_t	m_slot_options_count;
-			std::uint32_t	m_features_count;
-			std::uint32_t	m_chips_count;
-			std::uint32_t	m_displays_count;
-			std::uint32_t	m_samples_count;
-			std::uint32_t	m_configurations_count;
-			std::uint32_t	m_configuration_settings_count;
-			std::uint32_t	m_configuration_conditions_count;
-			std::uint32_t	m_software_lists_count;
-			std::uint32_t	m_ram_options_count;
+			std::uint32_t	m_section_count;
+			std::uint32_t	m_reserved;				// always zero; keeps the structure free of trailing padding
+			section			m_sections[(int)section_type::COUNT];
 		};
 
 		struct machine
 		{
+			std::uint64_t	m_xml_hash;				// hash of the raw -listxml element, to identify unchanged machines
 			std::uint32_t	m_name_strindex;
 			std::uint32_t	m_sourcefile_strindex;
 			std::uint32_t	m_clone_of_machindex;
@@ -103,6 +145,27 @@ namespace info
 			std::uint8_t	m_sound_channels;
 		};
 
+		// the subset of a machine used for sorting, filtering and display in the machine
+		// list, stored as a parallel table so that scanning all machines does not drag the
+		// rest of each record through the cache; two of these fit in a cache line
+		struct machine_summary
+		{
+			std::uint32_t	m_name_strindex;
+			std::uint32_t	m_sourcefile_strindex;
+			std::uint32_t	m_clone_of_machindex;
+			std::uint32_t	m_description_strindex;
+			std::uint32_t	m_year_strindex;
+			std::uint32_t	m_manufacturer_strindex;
+			std::uint8_t	m_runnable;
+			std::uint8_t	m_is_bios;
+			std::uint8_t	m_is_device;
+			std::uint8_t	m_is_mechanical;
+			std::uint8_t	m_quality_status;
+			std::uint8_t	m_quality_emulation;
+			std::uint8_t	m_save_state_supported;
+			std::uint8_t	m_unofficial;
+		};
+
 		struct biosset
 		{
 			std::uint32_t	m_name_strindex;
@@ -115,8 +178,7 @@ namespace info
 			std::uint32_t	m_name_strindex;
 			std::uint32_t	m_bios_strindex;
 			std::uint32_t	m_size;
-			std::uint8_t	m_crc32[4];
-			std::uint8_t	m_sha1[20];
+			std::uint32_t	m_rom_hash_index;		// ~0 if the ROM has no hashes (e.g. - a "nodump")
 			std::uint32_t	m_merge_strindex;
 			std::uint32_t	m_region_strindex;
 			std::uint32_t	m_offset;
@@ -124,6 +186,22 @@ namespace info
 			std::uint8_t	m_optional;
 		};
 
+		// the distinct CRC-32/SHA-1 pairs of all ROMs; the ROMs (and machines) using each of
+		// these are a run of rom_hash_use records
+		struct rom_hash
+		{
+			std::uint8_t	m_crc32[4];
+			std::uint8_t	m_sha1[20];
+			std::uint32_t	m_uses_index;
+			std::uint32_t	m_uses_count;
+		};
+
+		struct rom_hash_use
+		{
+			std::uint32_t	m_machine_index;
+			std::uint32_t	m_rom_index;
+		};
+
 		struct disk
 		{
 			std::uint32_t	m_name_strindex;
@@ -236,6 +314,14 @@ namespace info
 			std::uint8_t	m_is_default;
 		};
 
+		struct posting_list
+		{
+			std::uint32_t	m_key_strindex;
+			std::uint32_t	m_postings_index;
+			std::uint32_t	m_postings_count;
+			std::uint32_t	m_type;			// wider than needed so that the structure has no padding
+		};
+
 		class salt
 		{
 		public:
@@ -268,6 +354,10 @@ namespace info
 	class database_builder;
 	class machine;
 
+	// buffer for the *_u8() accessors; those return views straight into the string table, but
+	// small strings (which are encoded within the string index itself) get decoded into this
+	typedef std::array<char8_t, 6> sso_buffer;
+
 	// ======================> biosset
 	class biosset : public bindata::entry<database, biosset, binaries::biosset>
 	{
@@ -278,11 +368,39 @@ namespace info
 		}
 
 		const QString &name() const { return get_string(inner().m_name_strindex); }
+		std::u8string_view name_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_name_strindex, buffer); }
 		const QString &description() const { return get_string(inner().m_description_strindex); }
+		std::u8string_view description_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_description_strindex, buffer); }
 		bool is_default() const { return inner().m_default != 0; }
 	};
 
 
+	// ======================> rom_hash
+	// a distinct CRC-32/SHA-1 pair; parents and clones mostly share ROMs, and those all refer
+	// to the same one of these
+	class rom_hash : public bindata::entry<database, rom_hash, binaries::rom_hash>
+	{
+	public:
+		rom_hash(const database &db, const binaries::rom_hash &inner)
+			: entry(db, inner)
+		{
+		}
+
+		std::uint32_t crc32() const
+		{
+			// doing this to avoid a silly Info DB breakage
+			return ((std::uint32_t)inner().m_crc32[0]) << 24
+				| ((std::uint32_t)inner().m_crc32[1]) << 16
+				| ((std::uint32_t)inner().m_crc32[2]) << 8
+				| ((std::uint32_t)inner().m_crc32[3]) << 0;
+		}
+		std::array<uint8_t, 20> sha1() const { return std::to_array(inner().m_sha1); }
+
+		// every ROM with this hash, and the machine it belongs to; sorted by machine index
+		std::span<const binaries::rom_hash_use> uses() const;
+	};
+
+
 	// ======================> rom
 	class rom : public bindata::entry<database, rom, binaries::rom>
 	{
@@ -301,19 +419,17 @@ namespace info
 		}
 
 		const QString &name() const { return get_string(inner().m_name_strindex); }
+		std::u8string_view name_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_name_strindex, buffer); }
 		const QString &bios() const { return get_string(inner().m_bios_strindex); }
+		std::u8string_view bios_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_bios_strindex, buffer); }
 		std::uint32_t size() const { return inner().m_size; }
-		std::uint32_t crc32() const
-		{
-			// doing this to avoid a silly Info DB breakage
-			return ((std::uint32_t)inner().m_crc32[0]) << 24
-				| ((std::uint32_t)inner().m_crc32[1]) << 16
-				| ((std::uint32_t)inner().m_crc32[2]) << 8
-				| ((std::uint32_t)inner().m_crc32[3]) << 0;
-		}
-		std::array<uint8_t, 20> sha1() const { return std::to_array(inner().m_sha1); }
+		std::optional<rom_hash> hash() const;
+		std::uint32_t crc32() const { std::optional<rom_hash> h = hash(); return h ? h->crc32() : 0; }
+		std::array<uint8_t, 20> sha1() const { std::optional<rom_hash> h = hash(); return h ? h->sha1() : std::array<uint8_t, 20>(); }
 		const QString &merge() const { return get_string(inner().m_merge_strindex); }
+		std::u8string_view merge_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_merge_strindex, buffer); }
 		const QString &region() const { return get_string(inner().m_region_strindex); }
+		std::u8string_view region_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_region_strindex, buffer); }
 		std::uint32_t offset() const { return inner().m_offset; }
 		dump_status_t status() const { return (dump_status_t)inner().m_status; }
 		bool optional() const { return inner().m_optional != 0; }
@@ -332,9 +448,12 @@ namespace info
 		}
 
 		const QString &name() const { return get_string(inner().m_name_strindex); }
+		std::u8string_view name_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_name_strindex, buffer); }
 		std::array<uint8_t, 20> sha1() const { return std::to_array(inner().m_sha1); }
 		const QString &merge() const { return get_string(inner().m_merge_strindex); }
+		std::u8string_view merge_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_merge_strindex, buffer); }
 		const QString &region() const { return get_string(inner().m_region_strindex); }
+		std::u8string_view region_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_region_strindex, buffer); }
 		std::uint32_t index() const { return inner().m_index; }
 		bool writable() const { return inner().m_writable != 0; }
 		dump_status_t status() const { return (dump_status_t)inner().m_status; }
@@ -352,10 +471,15 @@ namespace info
 		}
 
 		const QString &type() const { return get_string(inner().m_type_strindex); }
+		std::u8string_view type_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_type_strindex, buffer); }
 		const QString &tag() const { return get_string(inner().m_tag_strindex); }
+		std::u8string_view tag_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_tag_strindex, buffer); }
 		const QString &devinterface() const { return get_string(inner().m_interface_strindex); }
+		std::u8string_view devinterface_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_interface_strindex, buffer); }
 		const QString &instance_name() const { return get_string(inner().m_instance_name_strindex); }
+		std::u8string_view instance_name_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_instance_name_strindex, buffer); }
 		const QString &extensions() const { return get_string(inner().m_extensions_strindex); }
+		std::u8string_view extensions_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_extensions_strindex, buffer); }
 		bool mandatory() const { return inner().m_mandatory != 0; }
 	};
 
@@ -370,7 +494,9 @@ namespace info
 		}
 
 		const QString &name() const { return get_string(inner().m_name_strindex); }
+		std::u8string_view name_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_name_strindex, buffer); }
 		const QString &devname() const { return get_string(inner().m_devname_strindex); }
+		std::u8string_view devname_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_devname_strindex, buffer); }
 		bool is_default() const { return inner().m_is_default; }
 		std::optional<info::machine> machine() const noexcept;
 	};
@@ -386,6 +512,7 @@ namespace info
 		}
 
 		const QString &name() const { return get_string(inner().m_name_strindex); }
+		std::u8string_view name_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_name_strindex, buffer); }
 		slot_option::view options() const;
 	};
 
@@ -400,6 +527,7 @@ namespace info
 		}
 
 		const QString &name() const { return get_string(inner().m_name_strindex); }
+		std::u8string_view name_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_name_strindex, buffer); }
 		std::uint32_t value() const { return inner().m_value; }
 	};
 
@@ -425,6 +553,7 @@ namespace info
 		}
 
 		const QString &tag() const { return get_string(inner().m_tag_strindex); }
+		std::u8string_view tag_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_tag_strindex, buffer); }
 		std::uint32_t mask() const { return inner().m_mask; }
 		std::uint32_t value() const { return inner().m_value; }
 		relation_t relation() const { return static_cast<relation_t>(inner().m_relation); }
@@ -449,7 +578,9 @@ namespace info
 
 		type_t type() const			{ return (type_t) inner().m_type; }
 		const QString &name() const	{ return get_string(inner().m_name_strindex); }
+		std::u8string_view name_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_name_strindex, buffer); }
 		const QString &tag() const	{ return get_string(inner().m_tag_strindex); }
+		std::u8string_view tag_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_tag_strindex, buffer); }
 		std::uint64_t clock() const	{ return inner().m_clock; }
 	};
 
@@ -495,6 +626,7 @@ namespace info
 		}
 
 		const QString &name() const { return get_string(inner().m_name_strindex); }
+		std::u8string_view name_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_name_strindex, buffer); }
 	};
 
 
@@ -508,7 +640,9 @@ namespace info
 		}
 
 		const QString &name() const { return get_string(inner().m_name_strindex); }
+		std::u8string_view name_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_name_strindex, buffer); }
 		const QString &tag() const { return get_string(inner().m_tag_strindex); }
+		std::u8string_view tag_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_tag_strindex, buffer); }
 		std::uint32_t mask() const { return inner().m_mask; }
 		configuration_setting::view settings() const;
 	};
@@ -530,7 +664,9 @@ namespace info
 		}
 
 		const QString &name() const { return get_string(inner().m_name_strindex); }
+		std::u8string_view name_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_name_strindex, buffer); }
 		const QString &filter() const { return get_string(inner().m_filter_strindex); }
+		std::u8string_view filter_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_filter_strindex, buffer); }
 		status_type status() const { return static_cast<status_type>(inner().m_status); }
 	};
 
@@ -551,6 +687,7 @@ namespace info
 		}
 
 		const QString &name() const { return get_string(inner().m_name_strindex); }
+		std::u8string_view name_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_name_strindex, buffer); }
 		std::uint32_t value() const { return inner().m_value; }
 		bool is_default() const { return inner().m_is_default; }
 	};
@@ -606,7 +743,9 @@ namespace info
 	};
 
 	// ======================> machine
-	class machine : public bindata::entry<database, machine, binaries::machine>
+	// machines are addressed by their summary; everything else is in the (parallel)
+	// binaries::machine record, which is only touched when needed
+	class machine : public bindata::entry<database, machine, binaries::machine_summary>
 	{
 	public:
 		enum class driver_quality_t
@@ -617,14 +756,16 @@ namespace info
 			PRELIMINARY
 		};
 
-		machine(const database &db, const binaries::machine &inner)
+		machine(const database &db, const binaries::machine_summary &inner)
 			: entry(db, inner)
 		{
 		}
 
 		// methods
 		std::optional<info::device> find_device(const QString &tag) const noexcept;
+		std::optional<info::device> find_device(std::u8string_view tag) const noexcept;
 		std::optional<info::chip> find_chip(const QString &chipName) const noexcept;
+		std::optional<info::chip> find_chip(std::u8string_view chipName) const noexcept;
 		std::optional<info::machine> clone_of() const noexcept;
 		std::optional<info::machine> rom_of() const noexcept;
 
@@ -636,14 +777,19 @@ namespace info
 		std::optional<bool> unofficial() const				{ return decode_optional_bool(inner().m_unofficial); }
 		driver_quality_t quality_status() const				{ return (driver_quality_t)inner().m_quality_status; }
 		driver_quality_t quality_emulation() const			{ return (driver_quality_t)inner().m_quality_emulation; }
-		driver_quality_t quality_cocktail() const			{ return (driver_quality_t)inner().m_quality_cocktail; }
+		driver_quality_t quality_cocktail() const			{ return (driver_quality_t)details().m_quality_cocktail; }
 		std::optional<bool> save_state_supported() const	{ return decode_optional_bool(inner().m_save_state_supported); }
-		std::optional<int> sound_channels() const			{ return inner().m_sound_channels != (std::uint8_t)~0 ? inner().m_sound_channels : std::optional<int>(); }
+		std::optional<int> sound_channels() const			{ return details().m_sound_channels != (std::uint8_t)~0 ? details().m_sound_channels : std::optional<int>(); }
 		const QString &name() const							{ return get_string(inner().m_name_strindex); }
 		const QString &sourcefile() const					{ return get_string(inner().m_sourcefile_strindex); }
 		const QString &description() const					{ return get_string(inner().m_description_strindex); }
 		const QString &year() const							{ return get_string(inner().m_year_strindex); }
 		const QString &manufacturer() const					{ return get_string(inner().m_manufacturer_strindex); }
+		std::u8string_view name_u8(sso_buffer &buffer) const			{ return get_string_u8(inner().m_name_strindex, buffer); }
+		std::u8string_view sourcefile_u8(sso_buffer &buffer) const		{ return get_string_u8(inner().m_sourcefile_strindex, buffer); }
+		std::u8string_view description_u8(sso_buffer &buffer) const		{ return get_string_u8(inner().m_description_strindex, buffer); }
+		std::u8string_view year_u8(sso_buffer &buffer) const			{ return get_string_u8(inner().m_year_strindex, buffer); }
+		std::u8string_view manufacturer_u8(sso_buffer &buffer) const	{ return get_string_u8(inner().m_manufacturer_strindex, buffer); }
 
 		// operators
 		bool operator==(const info::machine &that) const
@@ -665,6 +811,8 @@ namespace info
 		ram_option::view			ram_options() const;
 
 	private:
+		const binaries::machine &details() const;
+
 		static std::optional<bool> decode_optional_bool(std::uint8_t b)
 		{
 			return b <= 1
@@ -674,131 +822,260 @@ namespace info
 	};
 
 
+	// ======================> posting_list
+	// precomputed inverted index; the indexes (in ascending order) of all machines that
+	// share a particular CPU, sound chip, manufacturer, year, source file or BIOS
+	class posting_list : public bindata::entry<database, posting_list, binaries::posting_list>
+	{
+	public:
+		enum class type_t
+		{
+			CPU,
+			SOUND,
+			MANUFACTURER,
+			YEAR,
+			SOURCEFILE,
+			BIOS
+		};
+
+		struct id
+		{
+			type_t		m_type;
+			QString		m_key;		// for BIOS lists, this is the name of the BIOS machine
+		};
+
+		posting_list(const database &db, const binaries::posting_list &inner)
+			: entry(db, inner)
+		{
+		}
+
+		// methods
+		bool contains(const machine &machine) const noexcept;
+
+		// properties
+		type_t type() const { return (type_t)inner().m_type; }
+		const QString &key() const { return get_string(inner().m_key_strindex); }
+		std::u8string_view key_u8(sso_buffer &buffer) const { return get_string_u8(inner().m_key_strindex, buffer); }
+		std::span<const std::uint32_t> machine_indexes() const;
+	};
+
+
 	// ======================> database
 	class database
 	{
-		template<typename TDatabase, typename TPublic, typename TBinary>
-		friend class ::bindata::view;
 		friend class database_builder;
+		struct State;
 	public:
-		database()
-			: m_version(&util::g_empty_string)
+		// ======================> snapshot
+		// an immutable and fully validated info DB; these can be prepared on any thread, and
+		// because ownership is shared anybody holding one (or a database constructed over one)
+		// is unaffected when something newer is published
+		class snapshot
 		{
-		}
+			friend class database;
+		public:
+			snapshot() = default;
+
+			explicit operator bool() const noexcept { return (bool)m_state; }
+			const QString &version() const noexcept;
+
+		private:
+			std::shared_ptr<const State>	m_state;
+
+			snapshot(std::shared_ptr<const State> &&state) : m_state(std::move(state)) { }
+		};
+
+		// ctor
+		database();
+		explicit database(snapshot &&snap);
+		database(const database &) = delete;
+		database(database &&) = delete;
 
 		// publically usable functions
 		bool load(const QString &file_name, const QString &expected_version = "") noexcept;
 		bool load(QIODevice &input, const QString &expected_version = "") noexcept;
 		bool load(const QByteArray &byteArray, const QString &expected_version = "") noexcept;
 		void reset() noexcept;
+		void publish(snapshot &&snap) noexcept;
+		snapshot current() const noexcept { return snapshot(std::shared_ptr<const State>(m_state)); }
 		std::optional<machine> find_machine(const QString &machine_name) const noexcept;
 		std::optional<machine> find_machine(std::u8string_view machine_name) const noexcept;
-		const QString &version() const noexcept { return *m_version; }
+		std::optional<posting_list> find_posting_list(const posting_list::id &id) const noexcept;
+		std::vector<rom_hash> find_rom_hashes(std::uint32_t crc32) const noexcept;
+		const QString &version() const noexcept { return *m_state->m_version; }
 		void addOnChangedHandler(std::function<void()> &&onChanged) noexcept;
 
 		// views
-		auto machines() const					{ return machine::view(*this, m_state.m_machines_position); }
-		auto biossets() const					{ return biosset::view(*this, m_state.m_biossets_position); }
-		auto roms() const						{ return rom::view(*this, m_state.m_roms_position); }
-		auto disks() const						{ return disk::view(*this, m_state.m_disks_position); }
-		auto devices() const					{ return device::view(*this, m_state.m_devices_position); }
-		auto devslots() const					{ return slot::view(*this, m_state.m_slots_position); }
-		auto slot_options() const				{ return slot_option::view(*this, m_state.m_slot_options_position); }
-		auto chips() const						{ return chip::view(*this, m_state.m_chips_position); }
-		auto displays() const					{ return display::view(*this, m_state.m_displays_position); }
-		auto samples() const					{ return sample::view(*this, m_state.m_samples_position); }
-		auto configurations() const				{ return configuration::view(*this, m_state.m_configurations_position); }
-		auto configuration_settings() const		{ return configuration_setting::view(*this, m_state.m_configuration_settings_position); }
-		auto configuration_conditions() const	{ return configuration_condition::view(*this, m_state.m_configuration_conditions_position); }
-		auto software_lists() const				{ return software_list::view(*this, m_state.m_software_lists_position); }
-		auto ram_options() const				{ return ram_option::view(*this, m_state.m_ram_options_position); }
+		auto machines() const					{ return machine::view(*this, get_section<binaries::machine_summary>(binaries::section_type::MACHINE_SUMMARIES)); }
+		auto biossets() const					{ return biosset::view(*this, get_section<binaries::biosset>(binaries::section_type::BIOSSETS)); }
+		auto roms() const						{ return rom::view(*this, get_section<binaries::rom>(binaries::section_type::ROMS)); }
+		auto disks() const						{ return disk::view(*this, get_section<binaries::disk>(binaries::section_type::DISKS)); }
+		auto devices() const					{ return device::view(*this, get_section<binaries::device>(binaries::section_type::DEVICES)); }
+		auto devslots() const					{ return slot::view(*this, get_section<binaries::slot>(binaries::section_type::SLOTS)); }
+		auto slot_options() const				{ return slot_option::view(*this, get_section<binaries::slot_option>(binaries::section_type::SLOT_OPTIONS)); }
+		auto chips() const						{ return chip::view(*this, get_section<binaries::chip>(binaries::section_type::CHIPS)); }
+		auto displays() const					{ return display::view(*this, get_section<binaries::display>(binaries::section_type::DISPLAYS)); }
+		auto samples() const					{ return sample::view(*this, get_section<binaries::sample>(binaries::section_type::SAMPLES)); }
+		auto configurations() const				{ return configuration::view(*this, get_section<binaries::configuration>(binaries::section_type::CONFIGURATIONS)); }
+		auto configuration_settings() const		{ return configuration_setting::view(*this, get_section<binaries::configuration_setting>(binaries::section_type::CONFIGURATION_SETTINGS)); }
+		auto configuration_conditions() const	{ return configuration_condition::view(*this, get_section<binaries::configuration_condition>(binaries::section_type::CONFIGURATION_CONDITIONS)); }
+		auto software_lists() const				{ return software_list::view(*this, get_section<binaries::software_list>(binaries::section_type::SOFTWARE_LISTS)); }
+		auto ram_options() const				{ return ram_option::view(*this, get_section<binaries::ram_option>(binaries::section_type::RAM_OPTIONS)); }
+		auto posting_lists() const				{ return posting_list::view(*this, get_section<binaries::posting_list>(binaries::section_type::POSTING_LISTS)); }
+		auto rom_hashes() const					{ return rom_hash::view(*this, get_section<binaries::rom_hash>(binaries::section_type::ROM_HASHES)); }
+		posting_list::view posting_lists(posting_list::type_t type) const;
+
+		// diagnostics
+		bool is_section_paged_in(binaries::section_type type) const noexcept;
 
 		// statics
+		static snapshot prepare(const QString &file_name, const QString &expected_version = "") noexcept;
+		static snapshot prepare(QIODevice &input, const QString &expected_version = "") noexcept;
+		static snapshot prepare(const QByteArray &byteArray, const QString &expected_version = "") noexcept;
 		static uint64_t calculate_sizes_hash() noexcept;
+		static std::uint64_t machine_name_hash(std::u8string_view machine_name) noexcept;
+		static std::uint32_t machine_name_slot(std::uint64_t hash, std::uint32_t displacement, std::uint32_t slot_count) noexcept;
 
 		// should only be called by info classes
 		const QString &get_string(std::uint32_t offset) const noexcept;
+		std::u8string_view get_string_u8(std::uint32_t offset, sso_buffer &buffer) const noexcept;
+		std::span<const std::uint32_t> get_postings(std::uint32_t index, std::uint32_t count) const;
+		std::optional<rom_hash> get_rom_hash(std::uint32_t index) const;
+		std::span<const binaries::rom_hash_use> get_rom_hash_uses(std::uint32_t index, std::uint32_t count) const;
+		const binaries::machine &get_machine_details(const binaries::machine_summary &summary) const;
 
 	private:
-		struct State
+		// ======================> string_cache
+		// lock-free cache of decoded strings; offsets that begin a string in the string
+		// table are addressed through a rank bitmap into a dense slot array, and anything
+		// else (small strings, principally) goes into an insert-only chained table
+		class string_cache
 		{
-			State();
+		public:
+			string_cache(std::span<const char> stringTable = { });
+			string_cache(const string_cache &) = delete;
+			string_cache(string_cache &&) = delete;
+			~string_cache();
 
-			std::vector<std::uint8_t>						m_data;
-			bindata::view_position							m_machines_position;
-			bindata::view_position							m_biossets_position;
-			bindata::view_position							m_roms_position;
-			bindata::view_position							m_disks_position;
-			bindata::view_position							m_devices_position;
-			bindata::view_position							m_slots_position;
-			bindata::view_position							m_slot_options_position;
-			bindata::view_position							m_features_position;
-			bindata::view_position							m_chips_position;
-			bindata::view_position							m_displays_position;
-			bindata::view_position							m_samples_position;
-			bindata::view_position							m_configurations_position;
-			bindata::view_position							m_configuration_settings_position;
-			bindata::view_position							m_configuration_conditions_position;
-			bindata::view_position							m_software_lists_position;
-			bindata::view_position							m_ram_options_position;
-			std::uint32_t									m_string_table_offset;
-		};
-
-		// member variables
-		State												m_state;
-		mutable std::unordered_map<std::uint32_t, QString>	m_loaded_strings;
-		const QString *										m_version;
-		std::vector<std::function<void()>>					m_onChangedHandlers;
+			const QString &get(std::uint32_t offset) const noexcept;
 
-		// data access
-		template<typename T>
-		void getDataSpan(std::span<const T> &span, size_t offset, std::optional<size_t> count = { }) const noexcept
+		private:
+			struct Node
+			{
+				std::uint32_t		m_offset;
+				QString				m_string;
+				const Node *		m_next;
+			};
+
+			static const std::size_t BUCKET_COUNT = 4096;
+
+			std::span<const char>								m_stringTable;
+			std::vector<std::uint64_t>							m_startBits;
+			std::vector<std::uint32_t>							m_startRanks;
+			std::unique_ptr<std::atomic<const QString *>[]>		m_slots;
+			std::size_t											m_slotCount;
+			std::unique_ptr<std::atomic<const Node *>[]>		m_buckets;
+
+			std::optional<std::size_t> slotIndex(std::uint32_t offset) const noexcept;
+			const QString &getSlot(std::atomic<const QString *> &slot, std::uint32_t offset) const noexcept;
+			const QString &getChained(std::uint32_t offset) const noexcept;
+			QString decode(std::uint32_t offset) const noexcept;
+		};
+
+		// ======================> section_table
+		// the sections of a loaded info DB; uncompressed sections point straight into the
+		// data (so a mapped file only gets paged in as it is touched), and compressed ones
+		// get decompressed the first time anybody asks for them
+		class section_table
 		{
-			span = getDataSpan<T>(offset, count);
-		}
+		public:
+			section_table() = default;
+			section_table(const section_table &) = delete;
+			section_table(section_table &&) = delete;
 
-		// data access
-		template<typename T>
-		std::span<const T> getDataSpan(size_t offset, std::optional<size_t> count = { }) const
+			bool locate(std::span<const std::uint8_t> data, const binaries::header &hdr) noexcept;
+			std::span<const std::uint8_t> stored(binaries::section_type type) const noexcept;
+			bool is_paged_in(binaries::section_type type) const noexcept;
+
+			template<typename T>
+			std::span<const T> get(binaries::section_type type) const noexcept
+			{
+				const entry &e = m_entries[(int)type];
+				const std::uint8_t *data = e.m_data.load(std::memory_order_acquire);
+				if (!data)
+					data = page_in(e);
+				return std::span<const T>(reinterpret_cast<const T *>(data), e.m_count);
+			}
+
+		private:
+			struct entry
+			{
+				std::span<const std::uint8_t>					m_stored;
+				std::uint32_t									m_size = 0;
+				std::uint32_t									m_count = 0;
+				binaries::section_compression					m_compression = binaries::section_compression::NONE;
+				mutable std::atomic<const std::uint8_t *>		m_data = nullptr;
+				mutable std::unique_ptr<std::uint64_t[]>		m_buffer;
+			};
+
+			std::array<entry, (int)binaries::section_type::COUNT>	m_entries;
+			mutable std::mutex										m_mutex;
+
+			const std::uint8_t *page_in(const entry &e) const noexcept;
+		};
+
+		struct State
 		{
-			std::optional<std::span<const T>> span = tryGetDataSpan<T>(m_state, offset, count);
-			if (!span)
-				throw false;
-			return *span;
-		}
+			State();
+
+			std::span<const std::uint8_t>					m_data;
+			std::vector<std::uint8_t>						m_dataBuffer;
+			std::unique_ptr<QFile>							m_dataFile;
+			std::unique_ptr<section_table>					m_sections;
+			std::unique_ptr<string_cache>					m_strings;
+			std::span<const char>							m_stringTable;
+			const QString *									m_version;
+		};
+
+		// member variables; the state is only ever replaced wholesale, so the thread that owns
+		// this database never observes anything partially loaded
+		std::shared_ptr<const State>						m_state;
+		std::vector<std::function<void()>>					m_onChangedHandlers;
 
 		// data access
 		template<typename T>
-		static std::optional<std::span<const T>> tryGetDataSpan(const State &state, size_t offset, std::optional<size_t> count = { }) noexcept
+		std::span<const T> get_section(binaries::section_type type) const noexcept
 		{
-			size_t actualCount = count.value_or(state.m_data.size() - offset);
-			if (offset > state.m_data.size() || (offset + actualCount * sizeof(T) > state.m_data.size()))
-				return { };
-			const T *ptr = reinterpret_cast<const T *>(&state.m_data.data()[offset]);
-			return std::span(ptr, ptr + actualCount);
+			return m_state->m_sections->get<T>(type);
 		}
 
 		// private functions
+		static snapshot prepare(State &&newState, const binaries::header &salted_hdr, const QString &expected_version) noexcept;
+		static const std::shared_ptr<const State> &empty_state() noexcept;
 		void onChanged() noexcept;
-		std::optional<int> find_machine_index(const QString &machine_name) const noexcept;
+		std::optional<int> find_machine_index(std::u8string_view machine_name) const noexcept;
 		static std::optional<std::uint32_t> tryEncodeSmallStringChar(std::u8string_view s, std::size_t i) noexcept;
 		static std::optional<std::uint32_t> tryEncodeAsSmallString(std::u8string_view s) noexcept;
 		static std::optional<std::array<char8_t, 6>> tryDecodeAsSmallString(std::uint32_t value) noexcept;
 	};
 
-	inline biosset::view				machine::biossets() const		{ return db().biossets().subview(inner().m_biossets_index, inner().m_biossets_count); }
-	inline rom::view					machine::roms() const			{ return db().roms().subview(inner().m_roms_index, inner().m_roms_count); }
-	inline disk::view					machine::disks() const			{ return db().disks().subview(inner().m_disks_index, inner().m_disks_count); }
-	inline device::view					machine::devices() const		{ return db().devices().subview(inner().m_devices_index, inner().m_devices_count); }
-	inline slot::view					machine::devslots() const		{ return db().devslots().subview(inner().m_slots_index, inner().m_slots_count); }
+	inline const binaries::machine &	machine::details() const		{ return db().get_machine_details(inner()); }
+	inline biosset::view				machine::biossets() const		{ return db().biossets().subview(details().m_biossets_index, details().m_biossets_count); }
+	inline rom::view					machine::roms() const			{ return db().roms().subview(details().m_roms_index, details().m_roms_count); }
+	inline disk::view					machine::disks() const			{ return db().disks().subview(details().m_disks_index, details().m_disks_count); }
+	inline device::view					machine::devices() const		{ return db().devices().subview(details().m_devices_index, details().m_devices_count); }
+	inline slot::view					machine::devslots() const		{ return db().devslots().subview(details().m_slots_index, details().m_slots_count); }
 	inline slot_option::view			slot::options() const			{ return db().slot_options().subview(inner().m_slot_options_index, inner().m_slot_options_count); }
-	inline chip::view					machine::chips() const			{ return db().chips().subview(inner().m_chips_index, inner().m_chips_count); }
-	inline display::view				machine::displays() const		{ return db().displays().subview(inner().m_displays_index, inner().m_displays_count); }
-	inline sample::view					machine::samples() const		{ return db().samples().subview(inner().m_samples_index, inner().m_samples_count); }
-	inline configuration::view			machine::configurations() const	{ return db().configurations().subview(inner().m_configurations_index, inner().m_configurations_count); }
+	inline chip::view					machine::chips() const			{ return db().chips().subview(details().m_chips_index, details().m_chips_count); }
+	inline display::view				machine::displays() const		{ return db().displays().subview(details().m_displays_index, details().m_displays_count); }
+	inline sample::view					machine::samples() const		{ return db().samples().subview(details().m_samples_index, details().m_samples_count); }
+	inline configuration::view			machine::configurations() const	{ return db().configurations().subview(details().m_configurations_index, details().m_configurations_count); }
 	inline configuration_setting::view	configuration::settings() const	{ return db().configuration_settings().subview(inner().m_configuration_settings_index, inner().m_configuration_settings_count); }
-	inline software_list::view			machine::software_lists() const	{ return db().software_lists().subview(inner().m_software_lists_index, inner().m_software_lists_count); }
-	inline ram_option::view				machine::ram_options() const	{ return db().ram_options().subview(inner().m_ram_options_index, inner().m_ram_options_count); }
+	inline software_list::view			machine::software_lists() const	{ return db().software_lists().subview(details().m_software_lists_index, details().m_software_lists_count); }
+	inline ram_option::view				machine::ram_options() const	{ return db().ram_options().subview(details().m_ram_options_index, details().m_ram_options_count); }
+	inline std::span<const std::uint32_t>	posting_list::machine_indexes() const	{ return db().get_postings(inner().m_postings_index, inner().m_postings_count); }
+	inline std::optional<rom_hash>			rom::hash() const						{ return db().get_rom_hash(inner().m_rom_hash_index); }
+	inline std::span<const binaries::rom_hash_use>	rom_hash::uses() const			{ return db().get_rom_hash_uses(inner().m_uses_index, inner().m_uses_count); }
 }
 
 
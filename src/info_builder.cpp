@@ -11,10 +11,27 @@
 #include "perfprofiler.h"
 #include "throttler.h"
 
+// Qt headers
+#include <QBuffer>
+#include <QDir>
+
+// zlib headers
+#include <zlib.h>
+
 // standard headers
+#include <atomic>
+#include <bit>
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <numeric>
 #include <ranges>
+#include <thread>
+#include <tuple>
 
 
 //**************************************************************************
@@ -121,6 +138,672 @@ static const util::enum_parser<bool> s_supported_parser =
 };
 
 
+// this is folded into the hashes that identify unchanged machines; bump it whenever the way that
+// <machine> elements get parsed changes, so that records built by older code are not reused
+static const int s_machine_parse_revision = 1;
+
+
+//**************************************************************************
+//  TYPE DEFINITIONS
+//**************************************************************************
+
+// ======================> info::database_builder::worker_pool
+class info::database_builder::worker_pool
+{
+public:
+	worker_pool(int workerCount)
+	{
+		for (int i = 0; i < workerCount; i++)
+			m_threads.emplace_back([this] { workerThreadProc(); });
+	}
+
+	~worker_pool()
+	{
+		// abandon anything that has not started, and wait for the rest
+		{
+			std::unique_lock lock(m_mutex);
+			m_jobs.clear();
+			m_stopping = true;
+		}
+		m_condition.notify_all();
+		for (std::thread &thread : m_threads)
+			thread.join();
+	}
+
+	// runs a job on a worker thread, or immediately if there are no workers
+	std::future<void> submit(std::function<void()> &&job)
+	{
+		std::packaged_task<void()> task(std::move(job));
+		std::future<void> result = task.get_future();
+		if (m_threads.empty())
+		{
+			task();
+		}
+		else
+		{
+			{
+				std::unique_lock lock(m_mutex);
+				m_jobs.push_back(std::move(task));
+			}
+			m_condition.notify_one();
+		}
+		return result;
+	}
+
+private:
+	std::vector<std::thread>				m_threads;
+	std::mutex								m_mutex;
+	std::condition_variable					m_condition;
+	std::deque<std::packaged_task<void()>>	m_jobs;
+	bool									m_stopping = false;
+
+	void workerThreadProc()
+	{
+		for (;;)
+		{
+			std::packaged_task<void()> task;
+			{
+				std::unique_lock lock(m_mutex);
+				m_condition.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+				if (m_jobs.empty())
+					return;
+				task = std::move(m_jobs.front());
+				m_jobs.pop_front();
+			}
+			task();
+		}
+	}
+};
+
+
+// ======================> info::database_builder::listxml_splitter
+// splits -listxml output into documents holding runs of whole machines, so that they
+// can be parsed independently; each document is the original prologue (so DTD defaults
+// still apply), the machine elements and then the closing tag of the root element
+class info::database_builder::listxml_splitter
+{
+public:
+	listxml_splitter(std::size_t chunkSize)
+		: m_chunkSize(chunkSize)
+		, m_state(state::Prologue)
+		, m_depth(0)
+		, m_scanPos(0)
+		, m_chunkStart(0)
+		, m_lastMachineEnd(0)
+		, m_rootStart(0)
+		, m_machineStart(0)
+	{
+	}
+
+	// reading into the buffer
+	char *prepareAppend(std::size_t size)
+	{
+		m_buffer.resize(m_buffer.size() + size);
+		return m_buffer.data() + m_buffer.size() - size;
+	}
+
+	void commitAppend(std::size_t preparedSize, std::size_t actualSize)
+	{
+		m_buffer.resize(m_buffer.size() - preparedSize + actualSize);
+	}
+
+	// accessors
+	bool hasPrologue() const					{ return !m_prologue.isEmpty(); }
+	const QByteArray &prologue() const			{ return m_prologue; }
+	const QByteArray &rootEndTag() const		{ return m_rootEndTag; }
+	QByteArray prologueDocument() const			{ return m_prologue + m_rootEndTag; }
+
+	// the prologue up to the root element; unlike the root element itself, this does not
+	// change from one MAME version to the next (unless the DTD does)
+	QByteArray declarations() const				{ return m_prologue.left(m_rootStart); }
+
+	// whatever follows the last chunk; at the end of input this should just be the root end tag
+	QByteArray remainderDocument() const
+	{
+		return m_prologue + m_buffer.mid(m_chunkStart);
+	}
+
+	// scans the buffer, splitting off any documents that are ready
+	template<typename TFunc>
+	void scan(bool eof, TFunc &&chunkFunc)
+	{
+		while (m_state != state::Remainder)
+		{
+			// find the next piece of markup
+			const char *markup = (const char *)memchr(m_buffer.constData() + m_scanPos, '<', m_buffer.size() - m_scanPos);
+			if (!markup)
+			{
+				m_scanPos = m_buffer.size();
+				break;
+			}
+			m_scanPos = markup - m_buffer.constData();
+
+			// and find where it ends; if we can't we need more data
+			std::optional<std::pair<markup_type, std::size_t>> markupEnd = findMarkupEnd(m_scanPos);
+			if (!markupEnd)
+				break;
+			auto [type, end] = *markupEnd;
+
+			if (m_state == state::Prologue)
+			{
+				if (type == markup_type::StartTag)
+				{
+					// this is the root element; everything up to this point is the prologue
+					std::size_t nameEnd = m_scanPos + 1;
+					while (nameEnd < end && !isspace((unsigned char)m_buffer[nameEnd]) && m_buffer[nameEnd] != '/' && m_buffer[nameEnd] != '>')
+						nameEnd++;
+					m_prologue = m_buffer.left(end);
+					m_rootEndTag = "</" + m_buffer.mid(m_scanPos + 1, nameEnd - m_scanPos - 1) + ">";
+					m_rootStart = m_scanPos;
+					m_state = state::Body;
+					m_depth = 1;
+					m_chunkStart = m_lastMachineEnd = end;
+				}
+				else if (type != markup_type::Other)
+				{
+					// an empty root element or a stray end tag; leave it to expat to make sense of it
+					m_state = state::Remainder;
+					break;
+				}
+			}
+			else
+			{
+				if (m_depth == 1 && (type == markup_type::StartTag || type == markup_type::EmptyElementTag))
+					m_machineStart = m_scanPos;
+
+				if (type == markup_type::StartTag)
+					m_depth++;
+				else if (type == markup_type::EndTag)
+					m_depth--;
+
+				if (m_depth == 1 && (type == markup_type::EndTag || type == markup_type::EmptyElementTag))
+				{
+					// we've completed a machine
+					m_machineSpans.emplace_back(m_machineStart, end);
+					m_lastMachineEnd = end;
+				}
+				else if (m_depth <= 0)
+				{
+					// we've hit the end of the root element
+					emitChunk(m_scanPos, chunkFunc);
+					m_state = state::Remainder;
+					break;
+				}
+			}
+			m_scanPos = end;
+
+			// is this chunk big enough?
+			if (m_lastMachineEnd - m_chunkStart >= m_chunkSize)
+				emitChunk(m_lastMachineEnd, chunkFunc);
+		}
+
+		// at the end of the input, anything whole goes out in a final chunk
+		if (eof)
+		{
+			if (m_state == state::Body)
+				emitChunk(m_lastMachineEnd, chunkFunc);
+			m_state = state::Remainder;
+		}
+
+		// discard whatever we don't need anymore
+		if (m_state != state::Prologue && m_chunkStart > 0)
+		{
+			m_buffer.remove(0, m_chunkStart);
+			m_scanPos -= std::min(m_scanPos, m_chunkStart);
+			m_lastMachineEnd -= std::min(m_lastMachineEnd, m_chunkStart);
+			m_machineStart -= std::min(m_machineStart, m_chunkStart);
+			for (auto &[machineStart, machineEnd] : m_machineSpans)
+			{
+				machineStart -= m_chunkStart;
+				machineEnd -= m_chunkStart;
+			}
+			m_chunkStart = 0;
+		}
+	}
+
+private:
+	enum class state
+	{
+		Prologue,
+		Body,
+		Remainder
+	};
+
+	enum class markup_type
+	{
+		StartTag,
+		EmptyElementTag,
+		EndTag,
+		Other
+	};
+
+	std::size_t		m_chunkSize;
+	state			m_state;
+	int				m_depth;
+	QByteArray		m_buffer;
+	QByteArray		m_prologue;
+	QByteArray		m_rootEndTag;
+	std::size_t		m_scanPos;
+	std::size_t		m_chunkStart;
+	std::size_t		m_lastMachineEnd;
+	std::size_t		m_rootStart;
+	std::size_t		m_machineStart;
+	std::vector<std::pair<std::size_t, std::size_t>>	m_machineSpans;
+
+	template<typename TFunc>
+	void emitChunk(std::size_t end, TFunc &&chunkFunc)
+	{
+		if (end > m_chunkStart)
+		{
+			// the machine spans go out relative to the start of the chunk
+			std::vector<std::pair<std::size_t, std::size_t>> machineSpans = std::move(m_machineSpans);
+			for (auto &[machineStart, machineEnd] : machineSpans)
+			{
+				machineStart -= m_chunkStart;
+				machineEnd -= m_chunkStart;
+			}
+			m_machineSpans.clear();
+
+			chunkFunc(m_buffer.mid(m_chunkStart, end - m_chunkStart), std::move(machineSpans));
+			m_chunkStart = end;
+		}
+	}
+
+	std::optional<std::size_t> find(std::size_t pos, std::string_view target) const
+	{
+		std::size_t result = std::string_view(m_buffer.constData(), m_buffer.size()).find(target, pos);
+		return result != std::string_view::npos
+			? result + target.size()
+			: std::optional<std::size_t>();
+	}
+
+	std::optional<std::pair<markup_type, std::size_t>> findMarkupEnd(std::size_t pos) const
+	{
+		using namespace std::literals;
+		std::string_view text(m_buffer.constData() + pos, m_buffer.size() - pos);
+		if (text.size() < 2)
+			return { };
+
+		// identify what sort of markup this is
+		markup_type type;
+		std::optional<std::size_t> end;
+		switch (text[1])
+		{
+		case '?':
+			// processing instruction
+			type = markup_type::Other;
+			end = find(pos + 2, "?>"sv);
+			break;
+
+		case '/':
+			// end tag
+			type = markup_type::EndTag;
+			end = find(pos + 2, ">"sv);
+			break;
+
+		case '!':
+			// comment, CDATA section or declaration
+			type = markup_type::Other;
+			if (text.starts_with("<!--"sv))
+				end = find(pos + 4, "-->"sv);
+			else if (text.starts_with("<![CDATA["sv))
+				end = find(pos + 9, "]]>"sv);
+			else if (!"<!--"sv.starts_with(text) && !"<![CDATA["sv.starts_with(text))
+				end = findDeclarationEnd(pos);
+			break;
+
+		default:
+			// start tag; be mindful of quoted attribute values
+			char quote = '\0';
+			for (std::size_t i = 1; !end && i < text.size(); i++)
+			{
+				if (quote)
+				{
+					if (text[i] == quote)
+						quote = '\0';
+				}
+				else if (text[i] == '\"' || text[i] == '\'')
+				{
+					quote = text[i];
+				}
+				else if (text[i] == '>')
+				{
+					end = pos + i + 1;
+				}
+			}
+			type = end && text[*end - pos - 2] == '/'
+				? markup_type::EmptyElementTag
+				: markup_type::StartTag;
+			break;
+		}
+
+		return end
+			? std::make_pair(type, *end)
+			: std::optional<std::pair<markup_type, std::size_t>>();
+	}
+
+	std::optional<std::size_t> findDeclarationEnd(std::size_t pos) const
+	{
+		// declarations (principally the DOCTYPE) can have an internal subset in brackets, with its
+		// own quoted strings and comments
+		char quote = '\0';
+		int bracketDepth = 0;
+		for (std::size_t i = pos + 2; i < (std::size_t)m_buffer.size(); i++)
+		{
+			char ch = m_buffer.at(i);
+			if (quote)
+			{
+				if (ch == quote)
+					quote = '\0';
+			}
+			else if (ch == '\"' || ch == '\'')
+			{
+				quote = ch;
+			}
+			else if (ch == '[')
+			{
+				bracketDepth++;
+			}
+			else if (ch == ']')
+			{
+				bracketDepth--;
+			}
+			else if (ch == '<' && std::string_view(m_buffer.constData() + i, m_buffer.size() - i).starts_with("<!--"))
+			{
+				std::optional<std::size_t> commentEnd = find(i + 4, "-->");
+				if (!commentEnd)
+					return { };
+				i = *commentEnd - 1;
+			}
+			else if (ch == '>' && bracketDepth <= 0)
+			{
+				return i + 1;
+			}
+		}
+		return { };
+	}
+};
+
+
+// ======================> info::database_builder::machine_tables
+// the tables holding the records of a set of machines; these are either those of a chunk or
+// those of the previous info DB
+struct info::database_builder::machine_tables
+{
+	std::span<const info::binaries::machine>					m_machines;
+	std::span<const info::binaries::biosset>					m_biossets;
+	std::span<const info::binaries::rom>						m_roms;
+	std::span<const info::binaries::rom_hash>					m_rom_hashes;
+	std::span<const info::binaries::disk>						m_disks;
+	std::span<const info::binaries::device>						m_devices;
+	std::span<const info::binaries::slot>						m_slots;
+	std::span<const info::binaries::slot_option>				m_slot_options;
+	std::span<const info::binaries::feature>					m_features;
+	std::span<const info::binaries::chip>						m_chips;
+	std::span<const info::binaries::display>					m_displays;
+	std::span<const info::binaries::sample>						m_samples;
+	std::span<const info::binaries::configuration>				m_configurations;
+	std::span<const info::binaries::configuration_condition>	m_configuration_conditions;
+	std::span<const info::binaries::configuration_setting>		m_configuration_settings;
+	std::span<const info::binaries::software_list>				m_software_lists;
+	std::span<const info::binaries::ram_option>					m_ram_options;
+
+	bool contains(const info::binaries::machine &machine) const noexcept;
+	std::uint32_t conditionsEnd(std::uint32_t settingIndex) const noexcept;
+};
+
+
+// ======================> info::database_builder::machine_chunk
+// a run of machines parsed independently of all others; strings are interned into a
+// chunk-local table and table indexes are relative to the chunk until merge_chunk()
+// folds the results into the builder
+struct info::database_builder::machine_chunk
+{
+	// ======================> local_string_table
+	class local_string_table
+	{
+	public:
+		std::uint32_t get(const char8_t *string) noexcept
+		{
+			return get(std::u8string(string));
+		}
+
+		std::uint32_t get(const std::u8string &string) noexcept
+		{
+			// small strings are self contained; no need to intern them
+			std::optional<std::uint32_t> ssoResult = info::database::tryEncodeAsSmallString(string);
+			if (ssoResult)
+				return *ssoResult;
+
+			// note the order in which strings first appear; that is the order they get merged in
+			auto [iter, inserted] = m_map.try_emplace(string, util::safe_static_cast<std::uint32_t>(m_strings.size()));
+			if (inserted)
+			{
+				m_strings.push_back(&iter->first);
+				m_stringBytes += string.capacity() + 1;
+			}
+			return iter->second;
+		}
+
+		std::uint32_t get(const XmlParser::Attribute &attribute) noexcept
+		{
+			std::optional<const char8_t *> attributeValue = attribute.as<const char8_t *>();
+			return attributeValue
+				? get(*attributeValue)
+				: ~0;
+		}
+
+		const std::vector<const std::u8string *> &strings() const noexcept
+		{
+			return m_strings;
+		}
+
+		std::size_t memory_usage() const noexcept;
+
+	private:
+		std::unordered_map<std::u8string, std::uint32_t>	m_map;
+		std::vector<const std::u8string *>					m_strings;
+		std::size_t											m_stringBytes = 0;
+	};
+
+	// ======================> entry
+	// a <machine> within the chunk, in document order; either parsed or reused from the previous info DB
+	struct entry
+	{
+		std::uint64_t								m_xmlHash;
+		std::optional<std::uint32_t>				m_previousMachineIndex;
+		std::pair<std::size_t, std::size_t>			m_span;		// where the machine is in m_body
+	};
+
+	typedef std::unordered_map<std::uint64_t, std::uint32_t> previous_machine_map;
+
+	machine_chunk(const listxml_splitter &splitter, QByteArray &&body, std::vector<std::pair<std::size_t, std::size_t>> &&machineSpans,
+		std::uint64_t xmlHashSeed, const previous_machine_map &previousMachines, bool keepBody, XmlParser::Backend xmlBackend)
+		: m_prologue(splitter.prologue())
+		, m_body(std::move(body))
+		, m_rootEndTag(splitter.rootEndTag())
+		, m_machineSpans(std::move(machineSpans))
+		, m_xmlHashSeed(xmlHashSeed)
+		, m_previousMachines(previousMachines)
+		, m_keepBody(keepBody)
+		, m_xmlBackend(xmlBackend)
+		, m_success(false)
+		, m_memoryUsage(m_prologue.capacity() + m_body.capacity() + m_rootEndTag.capacity() + m_machineSpans.capacity() * sizeof(m_machineSpans[0]))
+	{
+	}
+
+	QByteArray												m_prologue;
+	QByteArray												m_body;
+	QByteArray												m_rootEndTag;
+	std::vector<std::pair<std::size_t, std::size_t>>		m_machineSpans;
+	std::uint64_t											m_xmlHashSeed;
+	const previous_machine_map &							m_previousMachines;
+	bool													m_keepBody;
+	XmlParser::Backend										m_xmlBackend;
+	bool													m_success;
+	QString													m_errorMessage;
+	std::vector<entry>										m_entries;
+	std::vector<info::binaries::machine>					m_machines;
+	std::vector<info::binaries::biosset>					m_biossets;
+	std::vector<info::binaries::rom>						m_roms;
+	std::vector<info::binaries::rom_hash>					m_rom_hashes;		// one per ROM; these get deduplicated when merged
+	std::vector<info::binaries::disk>						m_disks;
+	std::vector<info::binaries::device>						m_devices;
+	std::vector<info::binaries::slot>						m_slots;
+	std::vector<info::binaries::slot_option>				m_slot_options;
+	std::vector<info::binaries::feature>					m_features;
+	std::vector<info::binaries::chip>						m_chips;
+	std::vector<info::binaries::display>					m_displays;
+	std::vector<info::binaries::sample>						m_samples;
+	std::vector<info::binaries::configuration>				m_configurations;
+	std::vector<info::binaries::configuration_condition>	m_configuration_conditions;
+	std::vector<info::binaries::configuration_setting>		m_configuration_settings;
+	std::vector<info::binaries::software_list>				m_software_lists;
+	std::vector<info::binaries::ram_option>					m_ram_options;
+	local_string_table										m_strings;
+	std::atomic<std::size_t>								m_memoryUsage;		// the text until parsed, then the records too
+
+	machine_tables tables() const noexcept;
+	void parse() noexcept;
+
+private:
+	QByteArray prepareDocument();
+	std::size_t memory_usage() const noexcept;
+};
+
+
+// ======================> info::database_builder::listxml_shard
+// the -listxml output of one MAME process, split into chunks that are queued up for the
+// workers and then merged in order; every shard but the first is read on a thread of its own
+class info::database_builder::listxml_shard
+{
+public:
+	typedef std::pair<std::unique_ptr<machine_chunk>, std::future<void>> pending_chunk;
+
+	listxml_shard(std::size_t chunkSize, std::size_t maximumPendingCount, worker_pool &workerPool, const machine_chunk::previous_machine_map &previousMachines, bool keepBodies, XmlParser::Backend xmlBackend)
+		: m_splitter(chunkSize)
+		, m_maximumPendingCount(maximumPendingCount)
+		, m_workerPool(workerPool)
+		, m_previousMachines(previousMachines)
+		, m_keepBodies(keepBodies)
+		, m_xmlBackend(xmlBackend)
+		, m_done(false)
+		, m_abandoned(false)
+	{
+	}
+
+	~listxml_shard()
+	{
+		// stop reading, and let the workers finish with any chunks that are still ours
+		{
+			std::unique_lock lock(m_mutex);
+			m_abandoned = true;
+		}
+		m_condition.notify_all();
+		join();
+		for (pending_chunk &pendingChunk : m_pendingChunks)
+			pendingChunk.second.wait();
+	}
+
+	// accessors
+	const listxml_splitter &splitter() const	{ return m_splitter; }
+	const QString &errorMessage() const			{ return m_errorMessage; }
+
+	// reads what is available and hands off any chunks that are ready; returns false at the end of the input
+	bool read(QIODevice &input);
+
+	// reads the whole shard on a thread of its own; shards are merged in order, so this holds
+	// off reading while it is too far ahead of the merging (otherwise every shard but the
+	// first would end up being held in memory in its entirety)
+	void start(const ShardFunc &shardFunc, int shardIndex)
+	{
+		m_thread = std::thread([this, &shardFunc, shardIndex]
+		{
+			try
+			{
+				shardFunc(shardIndex, [this](QIODevice &input)
+				{
+					while (waitForRoom() && read(input))
+						;
+				});
+			}
+			catch (std::exception &ex)
+			{
+				m_errorMessage = ex.what();
+			}
+
+			{
+				std::unique_lock lock(m_mutex);
+				m_done = true;
+			}
+			m_condition.notify_all();
+		});
+	}
+
+	void join()
+	{
+		if (m_thread.joinable())
+			m_thread.join();
+	}
+
+	// takes the oldest chunk once it has been parsed, or straight away if too many are pending;
+	// if asked to, waits for the reading thread to produce one (or to finish)
+	std::optional<pending_chunk> takeChunk(std::size_t maximumPendingCount, bool waitForInput)
+	{
+		using namespace std::chrono_literals;
+		std::unique_lock lock(m_mutex);
+		if (waitForInput)
+			m_condition.wait(lock, [this] { return m_done || !m_pendingChunks.empty(); });
+
+		if (m_pendingChunks.empty()
+			|| (m_pendingChunks.size() <= maximumPendingCount && m_pendingChunks.front().second.wait_for(0s) != std::future_status::ready))
+		{
+			return { };
+		}
+
+		std::optional<pending_chunk> result = std::move(m_pendingChunks.front());
+		m_pendingChunks.pop_front();
+		lock.unlock();
+		m_condition.notify_all();
+		return result;
+	}
+
+	// the memory held by the chunks that have yet to be merged
+	std::size_t memory_usage()
+	{
+		std::unique_lock lock(m_mutex);
+		std::size_t result = 0;
+		for (const pending_chunk &pendingChunk : m_pendingChunks)
+			result += pendingChunk.first->m_memoryUsage;
+		return result;
+	}
+
+private:
+	listxml_splitter								m_splitter;
+	std::size_t										m_maximumPendingCount;
+	worker_pool &									m_workerPool;
+	const machine_chunk::previous_machine_map &		m_previousMachines;
+	bool											m_keepBodies;
+	XmlParser::Backend								m_xmlBackend;
+	std::optional<std::uint64_t>					m_xmlHashSeed;
+	std::thread										m_thread;
+	std::mutex										m_mutex;
+	std::condition_variable							m_condition;
+	std::deque<pending_chunk>						m_pendingChunks;
+	bool											m_done;
+	std::atomic<bool>								m_abandoned;
+	QString											m_errorMessage;
+
+	// waits until we can read more; returns false if we have been abandoned
+	bool waitForRoom()
+	{
+		std::unique_lock lock(m_mutex);
+		m_condition.wait(lock, [this] { return m_abandoned || m_pendingChunks.size() < m_maximumPendingCount; });
+		return !m_abandoned;
+	}
+};
+
+
 //**************************************************************************
 //  IMPLEMENTATION
 //**************************************************************************
@@ -140,24 +823,16 @@ static std::uint32_t to_uint32(T &&value)
 
 
 //-------------------------------------------------
-//  writeContainerData
-//-------------------------------------------------
-
-template<typename T>
-static void writeContainerData(QIODevice &stream, std::span<const T> container)
-{
-	stream.write((const char *)container.data(), container.size() * sizeof(T));
-}
-
-
-//-------------------------------------------------
-//  writeContainerData
+//  hashMemoryUsage - a rough estimate of the memory
+//	held by an unordered container, whose elements
+//	each get a node of their own
 //-------------------------------------------------
 
 template<typename T>
-static void writeContainerData(QIODevice &stream, const std::vector<T> &container)
+static std::size_t hashMemoryUsage(const T &container) noexcept
 {
-	writeContainerData(stream, std::span<const T>(container));
+	return container.bucket_count() * sizeof(void *)
+		+ container.size() * (sizeof(typename T::value_type) + sizeof(void *) + sizeof(std::size_t));
 }
 
 
@@ -220,30 +895,120 @@ static void binaryWipe(T &x)
 }
 
 
+//-------------------------------------------------
+//  romHashCrc32
+//-------------------------------------------------
+
+static std::uint32_t romHashCrc32(const info::binaries::rom_hash &hash)
+{
+	return ((std::uint32_t)hash.m_crc32[0]) << 24
+		| ((std::uint32_t)hash.m_crc32[1]) << 16
+		| ((std::uint32_t)hash.m_crc32[2]) << 8
+		| ((std::uint32_t)hash.m_crc32[3]) << 0;
+}
+
+
+//-------------------------------------------------
+//  hashXml - 64-bit FNV-1a; unlike std::hash this
+//	is stable across runs and platforms
+//-------------------------------------------------
+
+static std::uint64_t hashXml(std::string_view text, std::uint64_t hash = 0xCBF29CE484222325)
+{
+	for (char ch : text)
+	{
+		hash ^= (std::uint8_t)ch;
+		hash *= 0x00000100000001B3;
+	}
+	return hash;
+}
+
+
+//-------------------------------------------------
+//  listxml_shard::read
+//-------------------------------------------------
+
+bool info::database_builder::listxml_shard::read(QIODevice &input)
+{
+	const int bufferSize = 1048576;
+
+	// this seems to be necssary when reading from a QProcess; we wait in slices so that we
+	// notice being abandoned even if MAME stalls
+	while (!m_abandoned && input.isSequential() && input.bytesAvailable() == 0 && !input.atEnd() && !input.waitForReadyRead(100))
+		;
+
+	// read data; as with XmlParser, we treat errors as the end of input because QProcess can
+	// return '-1' without ever returning '0'
+	qint64 lastRead = input.read(m_splitter.prepareAppend(bufferSize), bufferSize);
+	m_splitter.commitAppend(bufferSize, (std::size_t)std::max(lastRead, (qint64)0));
+	bool done = lastRead <= 0;
+
+	// split off any chunks that are ready and hand them to the workers
+	m_splitter.scan(done, [this](QByteArray &&body, std::vector<std::pair<std::size_t, std::size_t>> &&machineSpans)
+	{
+		// the hashes identifying machines also cover the DTD, in case changes to it affect how machines are interpreted
+		if (!m_xmlHashSeed)
+		{
+			QByteArray seedText = QByteArray::number(s_machine_parse_revision) + m_splitter.declarations();
+			m_xmlHashSeed = hashXml(std::string_view(seedText.constData(), seedText.size()));
+		}
+
+		auto chunk = std::make_unique<machine_chunk>(m_splitter, std::move(body), std::move(machineSpans), *m_xmlHashSeed, m_previousMachines, m_keepBodies, m_xmlBackend);
+		std::future<void> future = m_workerPool.submit([chunkPtr = chunk.get()] { chunkPtr->parse(); });
+		{
+			std::unique_lock lock(m_mutex);
+			m_pendingChunks.emplace_back(std::move(chunk), std::move(future));
+		}
+		m_condition.notify_all();
+	});
+	return !done;
+}
+
+
 //-------------------------------------------------
 //  process_xml()
 //-------------------------------------------------
 
 bool info::database_builder::process_xml(QIODevice &input, QString &error_message, const ProcessXmlCallback &progressCallback) noexcept
+{
+	auto shardFunc = [&input](int, const std::function<void(QIODevice &)> &readFunc)
+	{
+		readFunc(input);
+	};
+	return process_xml(1, shardFunc, error_message, progressCallback);
+}
+
+
+//-------------------------------------------------
+//  process_xml() - processes -listxml output that
+//	has been split into shards (one per MAME process,
+//	each listing different drivers); machines that
+//	appear in more than one shard (devices, in
+//	practice) are only kept the first time
+//-------------------------------------------------
+
+bool info::database_builder::process_xml(int shardCount, const ShardFunc &shardFunc, QString &error_message, const ProcessXmlCallback &progressCallback) noexcept
 {
 	using namespace std::chrono_literals;
 
 	// sanity check; ensure we're fresh
+	assert(shardCount >= 1);
 	assert(m_machines.empty());
-	assert(m_devices.empty());
+	assert(m_devices.size() == 0);
 
 	// progress reporting
 	Throttler throttler(100ms);
-	auto reportProgressIfAppropriate = [this, &throttler, &progressCallback](const info::binaries::machine &machine)
+	auto reportProgressIfAppropriate = [this, &throttler, &progressCallback]()
 	{
 		// is it time to report progress?
-		if (throttler.check() && progressCallback)
+		if (!m_machines.empty() && throttler.check() && progressCallback)
 		{
 			// it is, report it
+			const info::binaries::machine &machine = util::last(m_machines);
 			info::database_builder::string_table::SsoBuffer nameSso, descSso;
 			const char8_t *name = m_strings.lookup(machine.m_name_strindex, nameSso);
 			const char8_t *desc = m_strings.lookup(machine.m_description_strindex, descSso);
-			progressCallback(util::safe_static_cast<int>(m_machines.size()), name, desc);
+			progressCallback(util::safe_static_cast<int>(m_machines.size()), m_reused_machine_count, name, desc);
 		}
 	};
 
@@ -252,6 +1017,26 @@ bool info::database_builder::process_xml(QIODevice &input, QString &error_messag
 	header.m_magic = info::binaries::MAGIC_HDR;
 	header.m_sizes_hash = info::database::calculate_sizes_hash();
 
+	// if we have somewhere to spill to, the tables that nothing looks at until emit_info() go
+	// to temporary files in blocks as machines are merged, and reserving space for them is moot
+	if (!m_spill_directory.isEmpty())
+	{
+		m_biossets.spill(m_spill_directory, m_spill_block_size);
+		m_roms.spill(m_spill_directory, m_spill_block_size);
+		m_disks.spill(m_spill_directory, m_spill_block_size);
+		m_devices.spill(m_spill_directory, m_spill_block_size);
+		m_slots.spill(m_spill_directory, m_spill_block_size);
+		m_slot_options.spill(m_spill_directory, m_spill_block_size);
+		m_features.spill(m_spill_directory, m_spill_block_size);
+		m_displays.spill(m_spill_directory, m_spill_block_size);
+		m_samples.spill(m_spill_directory, m_spill_block_size);
+		m_configurations.spill(m_spill_directory, m_spill_block_size);
+		m_configuration_conditions.spill(m_spill_directory, m_spill_block_size);
+		m_configuration_settings.spill(m_spill_directory, m_spill_block_size);
+		m_software_lists.spill(m_spill_directory, m_spill_block_size);
+		m_ram_options.spill(m_spill_directory, m_spill_block_size);
+	}
+
 	// reserve space based on what we know about MAME 0.239
 	m_biossets.reserve(36000);					// 34067 bios sets
 	m_roms.reserve(350000);						// 329670 roms
@@ -268,16 +1053,215 @@ bool info::database_builder::process_xml(QIODevice &input, QString &error_messag
 	m_software_lists.reserve(6800);				// 6337 software lists
 	m_ram_options.reserve(6800);				// 6383 ram options
 
-	// parse the -listxml output
+	// if we have an info DB from a previous run, index its machines by the hash of their XML so
+	// that we can spot the ones that did not change
+	std::optional<machine_tables> previousTables;
+	machine_chunk::previous_machine_map previousMachines;
+	if (m_previous_db)
+	{
+		previousTables = previous_tables();
+		previousMachines.reserve(previousTables->m_machines.size());
+		for (std::size_t i = 0; i < previousTables->m_machines.size(); i++)
+		{
+			if (previousTables->contains(previousTables->m_machines[i]))
+				previousMachines.emplace(previousTables->m_machines[i].m_xml_hash, to_uint32(i));
+		}
+	}
+
+	// we process -listxml output in three stages; this thread reads the input and splits it
+	// into chunks of whole machines, the worker pool parses those chunks and then this thread
+	// merges the results in document order, so that the string table (and hence the info DB
+	// as a whole) comes out identically to parsing everything in one go; any other shards are
+	// read on threads of their own and merged in turn after the first one
+	int workerCount = m_worker_count.value_or((int)std::max(std::thread::hardware_concurrency(), 1U) - 1);
+	std::size_t maximumPendingCount = std::max((std::size_t)workerCount * 4, (std::size_t)1);
+	std::size_t previousMachinesMemoryUsage = hashMemoryUsage(previousMachines);
+	worker_pool workerPool(workerCount);
+	std::vector<std::unique_ptr<listxml_shard>> shards;
+	for (int i = 0; i < shardCount; i++)
+		shards.push_back(std::make_unique<listxml_shard>(m_chunk_size, maximumPendingCount, workerPool, previousMachines, m_xml_copy != nullptr, m_xml_backend));
+	bool prologueParsed = false;
+
+	// merges chunks that are ready, waiting on the workers if we have too many pending
+	auto mergeChunks = [this, &previousTables, &previousMachinesMemoryUsage, &shards, &error_message, &reportProgressIfAppropriate](listxml_shard &shard, std::size_t maximumPendingCount, bool waitForInput)
+	{
+		while (std::optional<listxml_shard::pending_chunk> pendingChunk = shard.takeChunk(maximumPendingCount, waitForInput))
+		{
+			machine_chunk &chunk = *pendingChunk->first;
+			pendingChunk->second.wait();
+			if (!chunk.m_success)
+			{
+				error_message = std::move(chunk.m_errorMessage);
+				return false;
+			}
+			merge_chunk(chunk, previousTables ? &*previousTables : nullptr);
+
+			// what is in flight counts towards the peak as much as what we have merged
+			std::size_t transientMemoryUsage = previousMachinesMemoryUsage + chunk.m_memoryUsage;
+			for (const std::unique_ptr<listxml_shard> &otherShard : shards)
+				transientMemoryUsage += otherShard->memory_usage();
+			update_peak_memory_usage(transientMemoryUsage);
+			reportProgressIfAppropriate();
+		}
+		return true;
+	};
+
+	// parses what surrounds the chunks (the prologue and the end of the root element)
+	auto parseOutline = [this, &header, &error_message](QByteArray &&document, bool handleRoot)
+	{
+		XmlParser xml;
+		if (handleRoot)
+		{
+			xml.onElementBegin({ "mame" }, [this, &header](const XmlParser::Attributes &attributes)
+			{
+				ProfilerScope prof(CURRENT_FUNCTION);
+				const auto [build] = attributes.get("build");
+				header.m_build_strindex = m_strings.get(build);
+			});
+		}
+
+		QBuffer buffer(&document);
+		if (!buffer.open(QIODevice::ReadOnly) || !xml.parse(buffer))
+		{
+			// now check for XML parsing errors; this is likely the result of somebody aborting the DB rebuild, but
+			// it is the caller's responsibility to handle that situation
+			error_message = xml.errorMessagesSingleString();
+			return false;
+		}
+		return true;
+	};
+
+	// parse!
+	try
+	{
+		for (int i = 1; i < shardCount; i++)
+			shards[i]->start(shardFunc, i);
+
+		// read the first shard, merging as we go
+		listxml_shard &firstShard = *shards[0];
+		bool success = true;
+		shardFunc(0, [&](QIODevice &input)
+		{
+			bool more = true;
+			while (success && more)
+			{
+				more = firstShard.read(input);
+
+				// the prologue has to be processed before we merge any machines
+				if (!prologueParsed && firstShard.splitter().hasPrologue())
+				{
+					success = parseOutline(firstShard.splitter().prologueDocument(), true);
+					prologueParsed = true;
+					if (success && m_xml_copy)
+						m_xml_copy->write(firstShard.splitter().prologue() + "\n");
+				}
+
+				// merge what we can, holding off on reading if the workers are falling behind
+				success = success && mergeChunks(firstShard, maximumPendingCount, false);
+			}
+		});
+		if (!success)
+			return false;
+
+		for (int i = 0; i < shardCount; i++)
+		{
+			// merge everything that is left, waiting on the shard's thread as need be
+			listxml_shard &shard = *shards[i];
+			if (!mergeChunks(shard, 0, i > 0))
+				return false;
+			shard.join();
+			if (!shard.errorMessage().isEmpty())
+			{
+				error_message = shard.errorMessage();
+				return false;
+			}
+
+			// and finally process what remains, which should be the end of the root element (or if we never
+			// found a root element, everything)
+			if (!parseOutline(shard.splitter().remainderDocument(), i == 0 && !prologueParsed))
+				return false;
+		}
+
+		if (m_xml_copy)
+		{
+			m_xml_copy->write(prologueParsed
+				? firstShard.splitter().rootEndTag() + "\n"
+				: firstShard.splitter().remainderDocument());
+		}
+	}
+	catch (std::exception &ex)
+	{
+		// did an exception (probably thrown by to_uint32) get thrown?
+		error_message = ex.what();
+		return false;
+	}
+
+	// final magic bytes on string table
+	m_strings.embed_value(info::binaries::MAGIC_STRINGTABLE_END);
+
+	// sort machines by name to facilitate lookups
+	std::sort(
+		m_machines.begin(),
+		m_machines.end(),
+		[this](const binaries::machine &a, const binaries::machine &b)
+		{
+			string_table::SsoBuffer ssoBufferA, ssoBufferB;
+			std::u8string_view aText = m_strings.lookup(a.m_name_strindex, ssoBufferA);
+			std::u8string_view bText = m_strings.lookup(b.m_name_strindex, ssoBufferB);
+			return aText < bText;
+		});
+
+	// build a machine index map
+	std::unordered_map<std::uint32_t, std::uint32_t> machineIndexMap;
+	machineIndexMap.reserve(m_machines.size() + 1);
+	machineIndexMap.emplace(m_strings.get(std::u8string()), ~0);
+	for (auto iter = m_machines.begin(); iter != m_machines.end(); iter++)
+	{
+		machineIndexMap.emplace(iter->m_name_strindex, iter - m_machines.begin());
+	}
+
+	// helper to perform machine index lookups
+	auto machineIndexFromStringIndex = [&machineIndexMap](std::uint32_t stringIndex)
+	{
+		auto iter = machineIndexMap.find(stringIndex);
+		return iter != machineIndexMap.end()
+			? iter->second
+			: ~0;	// should never happen unless -listxml is returning bad results
+	};
+
+	// and change clone_of and rom_of to be machine indexes, using the map we have above
+	for (info::binaries::machine &machine : m_machines)
+	{
+		machine.m_clone_of_machindex = machineIndexFromStringIndex(machine.m_clone_of_machindex);
+		machine.m_rom_of_machindex = machineIndexFromStringIndex(machine.m_rom_of_machindex);
+	}
+
+	// now that machines are in their final places, build the posting lists and summaries
+	build_posting_lists();
+	build_machine_summaries();
+	build_machine_name_index();
+	build_rom_hash_index();
+	update_peak_memory_usage();
+
+	// hold on to the header; the section directory gets filled in by emit_info()
+	m_header = header;
+
+	// success!
+	error_message.clear();
+	return true;
+}
+
+
+//-------------------------------------------------
+//  machine_chunk::parse
+//-------------------------------------------------
+
+void info::database_builder::machine_chunk::parse() noexcept
+{
 	XmlParser xml;
+	xml.setBackend(m_xmlBackend);
 	std::u8string current_device_extensions;
 	std::uint32_t empty_strindex = m_strings.get(u8"");
-	xml.onElementBegin({ "mame" }, [this, &header](const XmlParser::Attributes &attributes)
-	{
-		ProfilerScope prof(CURRENT_FUNCTION);
-		const auto [build] = attributes.get("build");
-		header.m_build_strindex = m_strings.get(build);
-	});
 	xml.onElementBegin({ "mame", "machine" }, [this, empty_strindex](const XmlParser::Attributes &attributes)
 	{
 		ProfilerScope prof(CURRENT_FUNCTION);
@@ -330,11 +1314,10 @@ bool info::database_builder::process_xml(QIODevice &input, QString &error_messag
 		machine.m_incomplete			= encodeBool(std::nullopt);
 		machine.m_sound_channels		= ~0;
 	});
-	xml.onElementEnd({ "mame", "machine", "description" }, [this, &reportProgressIfAppropriate](std::u8string &&content)
+	xml.onElementEnd({ "mame", "machine", "description" }, [this](std::u8string &&content)
 	{
 		ProfilerScope prof(CURRENT_FUNCTION);
 		util::last(m_machines).m_description_strindex = m_strings.get(content);
-		reportProgressIfAppropriate(util::last(m_machines));
 	});
 	xml.onElementEnd({ "mame", "machine", "year" }, [this](std::u8string &&content)
 	{
@@ -364,18 +1347,24 @@ bool info::database_builder::process_xml(QIODevice &input, QString &error_messag
 		const auto [name, bios, size, crc, sha1, merge, region, offset, status, optional] = attributes.get(
 			"name", "bios", "size", "crc", "sha1", "merge", "region", "offset", "status", "optional");
 
+		info::binaries::rom_hash hash;
+		binaryWipe(hash);
+		bool hasCrc = binaryFromHex(hash.m_crc32, crc);
+		bool hasSha1 = binaryFromHex(hash.m_sha1, sha1);
+
 		info::binaries::rom &rom = m_roms.emplace_back();
 		binaryWipe(rom);
 		rom.m_name_strindex					= m_strings.get(name);
 		rom.m_bios_strindex					= m_strings.get(bios);
 		rom.m_size							= size.as<std::uint32_t>().value_or(0);
-		binaryFromHex(rom.m_crc32,			  crc);
-		binaryFromHex(rom.m_sha1,			  sha1);
+		rom.m_rom_hash_index				= hasCrc || hasSha1 ? util::safe_static_cast<std::uint32_t>(m_rom_hashes.size()) : ~0;
 		rom.m_merge_strindex				= m_strings.get(merge);
 		rom.m_region_strindex				= m_strings.get(region);
 		rom.m_offset						= offset.as<std::uint64_t>(16).value_or(0);
 		rom.m_status						= encodeEnum(status.as<info::rom::dump_status_t>(s_dump_status_parser));
 		rom.m_optional						= encodeBool(optional.as<bool>().value_or(false));
+		if (hasCrc || hasSha1)
+			m_rom_hashes.push_back(hash);
 		util::last(m_machines).m_roms_count++;
 	});
 	xml.onElementBegin({ "mame", "machine", "disk" }, [this](const XmlParser::Attributes &attributes)
@@ -610,124 +1599,898 @@ bool info::database_builder::process_xml(QIODevice &input, QString &error_messag
 	});
 	xml.onElementBegin({ "mame", "machine", "sound" }, [this](const XmlParser::Attributes &attributes)
 	{
-		ProfilerScope prof(CURRENT_FUNCTION);
-		const auto [channels] = attributes.get("channels");
+		ProfilerScope prof(CURRENT_FUNCTION);
+		const auto [channels] = attributes.get("channels");
+
+		info::binaries::machine &machine = util::last(m_machines);
+		machine.m_sound_channels		= channels.as<std::uint8_t>().value_or(~0);
+	});
+
+	// parse!
+	try
+	{
+		QByteArray document = prepareDocument();
+		QBuffer buffer(&document);
+		m_success = buffer.open(QIODevice::ReadOnly) && xml.parse(buffer);
+		if (!m_success)
+			m_errorMessage = xml.errorMessagesSingleString();
+	}
+	catch (std::exception &ex)
+	{
+		m_success = false;
+		m_errorMessage = ex.what();
+	}
+
+	// we're done with the text, unless somebody wants a copy of it
+	if (!m_keepBody)
+		m_body = QByteArray();
+	m_memoryUsage = memory_usage();
+}
+
+
+//-------------------------------------------------
+//  machine_chunk::memory_usage
+//-------------------------------------------------
+
+std::size_t info::database_builder::machine_chunk::memory_usage() const noexcept
+{
+	auto usage = []<typename T>(const std::vector<T> &table)
+	{
+		return table.capacity() * sizeof(T);
+	};
+	return m_prologue.capacity() + m_body.capacity() + m_rootEndTag.capacity() + usage(m_machineSpans)
+		+ usage(m_entries) + usage(m_machines) + usage(m_biossets) + usage(m_roms) + usage(m_rom_hashes)
+		+ usage(m_disks) + usage(m_devices) + usage(m_slots) + usage(m_slot_options) + usage(m_features)
+		+ usage(m_chips) + usage(m_displays) + usage(m_samples) + usage(m_configurations)
+		+ usage(m_configuration_conditions) + usage(m_configuration_settings) + usage(m_software_lists)
+		+ usage(m_ram_options) + m_strings.memory_usage();
+}
+
+
+//-------------------------------------------------
+//  machine_chunk::local_string_table::memory_usage
+//-------------------------------------------------
+
+std::size_t info::database_builder::machine_chunk::local_string_table::memory_usage() const noexcept
+{
+	return hashMemoryUsage(m_map) + m_strings.capacity() * sizeof(m_strings[0]) + m_stringBytes;
+}
+
+
+//-------------------------------------------------
+//  machine_chunk::prepareDocument - identifies the
+//	machines that can be reused from the previous
+//	info DB, and puts the rest into a document
+//-------------------------------------------------
+
+QByteArray info::database_builder::machine_chunk::prepareDocument()
+{
+	using namespace std::literals;
+
+	QByteArray document;
+	document.reserve(m_prologue.size() + m_body.size() + m_rootEndTag.size());
+	document.append(m_prologue);
+
+	for (auto [machineStart, machineEnd] : m_machineSpans)
+	{
+		std::string_view text(m_body.constData() + machineStart, machineEnd - machineStart);
+
+		// only <machine> elements get entries; anything else goes straight to the parser
+		bool isMachine = text.size() > 8
+			&& text.starts_with("<machine"sv)
+			&& (isspace((unsigned char)text[8]) || text[8] == '>' || text[8] == '/');
+		if (isMachine)
+		{
+			entry &entry = m_entries.emplace_back();
+			entry.m_xmlHash = hashXml(text, m_xmlHashSeed);
+			entry.m_span = std::make_pair(machineStart, machineEnd);
+
+			auto iter = m_previousMachines.find(entry.m_xmlHash);
+			if (iter != m_previousMachines.end())
+			{
+				entry.m_previousMachineIndex = iter->second;
+				continue;
+			}
+		}
+		document.append(text.data(), text.size());
+	}
+
+	document.append(m_rootEndTag);
+	return document;
+}
+
+
+//-------------------------------------------------
+//  machine_chunk::tables
+//-------------------------------------------------
+
+info::database_builder::machine_tables info::database_builder::machine_chunk::tables() const noexcept
+{
+	machine_tables result;
+	result.m_machines					= m_machines;
+	result.m_biossets					= m_biossets;
+	result.m_roms						= m_roms;
+	result.m_rom_hashes					= m_rom_hashes;
+	result.m_disks						= m_disks;
+	result.m_devices					= m_devices;
+	result.m_slots						= m_slots;
+	result.m_slot_options				= m_slot_options;
+	result.m_features					= m_features;
+	result.m_chips						= m_chips;
+	result.m_displays					= m_displays;
+	result.m_samples					= m_samples;
+	result.m_configurations				= m_configurations;
+	result.m_configuration_conditions	= m_configuration_conditions;
+	result.m_configuration_settings		= m_configuration_settings;
+	result.m_software_lists				= m_software_lists;
+	result.m_ram_options				= m_ram_options;
+	return result;
+}
+
+
+//-------------------------------------------------
+//  machine_tables::contains - sanity checks that
+//	all records for a machine are present
+//-------------------------------------------------
+
+bool info::database_builder::machine_tables::contains(const info::binaries::machine &machine) const noexcept
+{
+	auto isInRange = [](const auto &span, std::uint32_t index, std::uint32_t count)
+	{
+		return (std::uint64_t)index + count <= span.size();
+	};
+
+	if (!isInRange(m_biossets, machine.m_biossets_index, machine.m_biossets_count)
+		|| !isInRange(m_roms, machine.m_roms_index, machine.m_roms_count)
+		|| !isInRange(m_disks, machine.m_disks_index, machine.m_disks_count)
+		|| !isInRange(m_features, machine.m_features_index, machine.m_features_count)
+		|| !isInRange(m_chips, machine.m_chips_index, machine.m_chips_count)
+		|| !isInRange(m_displays, machine.m_displays_index, machine.m_displays_count)
+		|| !isInRange(m_samples, machine.m_samples_index, machine.m_samples_count)
+		|| !isInRange(m_configurations, machine.m_configurations_index, machine.m_configurations_count)
+		|| !isInRange(m_software_lists, machine.m_software_lists_index, machine.m_software_lists_count)
+		|| !isInRange(m_ram_options, machine.m_ram_options_index, machine.m_ram_options_count)
+		|| !isInRange(m_devices, machine.m_devices_index, machine.m_devices_count)
+		|| !isInRange(m_slots, machine.m_slots_index, machine.m_slots_count))
+	{
+		return false;
+	}
+
+	for (const info::binaries::rom &rom : m_roms.subspan(machine.m_roms_index, machine.m_roms_count))
+	{
+		if (rom.m_rom_hash_index != (std::uint32_t)~0 && rom.m_rom_hash_index >= m_rom_hashes.size())
+			return false;
+	}
+
+	for (const info::binaries::slot &slot : m_slots.subspan(machine.m_slots_index, machine.m_slots_count))
+	{
+		if (!isInRange(m_slot_options, slot.m_slot_options_index, slot.m_slot_options_count))
+			return false;
+	}
+
+	for (const info::binaries::configuration &configuration : m_configurations.subspan(machine.m_configurations_index, machine.m_configurations_count))
+	{
+		if (!isInRange(m_configuration_settings, configuration.m_configuration_settings_index, configuration.m_configuration_settings_count))
+			return false;
+
+		for (std::uint32_t i = 0; i < configuration.m_configuration_settings_count; i++)
+		{
+			std::uint32_t settingIndex = configuration.m_configuration_settings_index + i;
+			std::uint32_t conditionsIndex = m_configuration_settings[settingIndex].m_conditions_index;
+			if (conditionsIndex > conditionsEnd(settingIndex) || conditionsEnd(settingIndex) > m_configuration_conditions.size())
+				return false;
+		}
+	}
+	return true;
+}
+
+
+//-------------------------------------------------
+//  machine_tables::conditionsEnd - conditions do
+//	not have a count; they run until those of the
+//	next setting
+//-------------------------------------------------
+
+std::uint32_t info::database_builder::machine_tables::conditionsEnd(std::uint32_t settingIndex) const noexcept
+{
+	return settingIndex + 1 < m_configuration_settings.size()
+		? m_configuration_settings[settingIndex + 1].m_conditions_index
+		: (std::uint32_t)m_configuration_conditions.size();
+}
+
+
+//-------------------------------------------------
+//  merge_chunk - folds the results of a chunk into
+//	what we've built so far, along with whatever
+//	machines the chunk found unchanged from the
+//	previous info DB
+//-------------------------------------------------
+
+void info::database_builder::merge_chunk(machine_chunk &chunk, const machine_tables *previousTables)
+{
+	// small strings (and missing attributes) never make it into the chunk's string table
+	const std::vector<const std::u8string *> &chunkStrings = chunk.m_strings.strings();
+	auto chunkString = [this, &chunkStrings](std::uint32_t strindex)
+	{
+		return (strindex & 0xC0000000) != 0xC0000000
+			? m_strings.get(*chunkStrings[strindex])
+			: strindex;
+	};
+
+	// ...or the previous info DB's string table
+	auto previousString = [this](std::uint32_t strindex)
+	{
+		return (strindex & 0xC0000000) != 0xC0000000
+			? m_strings.get(previous_string(strindex))
+			: strindex;
+	};
+
+	// clone_of and rom_of are turned into machine indexes at the very end; until then they are
+	// string indexes of the machine's name
+	auto previousMachineName = [previousTables](std::uint32_t machineIndex)
+	{
+		return machineIndex < previousTables->m_machines.size()
+			? previousTables->m_machines[machineIndex].m_name_strindex
+			: ~0;
+	};
+
+	// when there are several shards, each of them lists every device; only the first one counts
+	// (interning the name here does not change the order of the string table, because the name
+	// is the first thing append_machine() interns)
+	auto isNewMachine = [this](std::uint32_t nameStrindex)
+	{
+		return m_merged_machine_names.insert(nameStrindex).second;
+	};
+
+	// and append the machines in document order
+	machine_tables chunkTables = chunk.tables();
+	std::size_t parsedMachineIndex = 0;
+	for (const machine_chunk::entry &entry : chunk.m_entries)
+	{
+		bool appended = false;
+		if (entry.m_previousMachineIndex && previousTables)
+		{
+			const info::binaries::machine &previousMachine = previousTables->m_machines[*entry.m_previousMachineIndex];
+			if (isNewMachine(previousString(previousMachine.m_name_strindex)))
+			{
+				append_machine(previousMachine, *previousTables, previousString, [&](info::binaries::machine &machine)
+				{
+					machine.m_clone_of_machindex = previousMachineName(machine.m_clone_of_machindex);
+					machine.m_rom_of_machindex = previousMachineName(machine.m_rom_of_machindex);
+				});
+				m_reused_machine_count++;
+				appended = true;
+			}
+		}
+		else if (parsedMachineIndex < chunk.m_machines.size())
+		{
+			const info::binaries::machine &parsedMachine = chunk.m_machines[parsedMachineIndex++];
+			if (isNewMachine(chunkString(parsedMachine.m_name_strindex)))
+			{
+				append_machine(parsedMachine, chunkTables, chunkString, [&entry](info::binaries::machine &machine)
+				{
+					machine.m_xml_hash = entry.m_xmlHash;
+				});
+				appended = true;
+			}
+		}
+
+		// keep a copy of the XML of whatever made it in
+		if (appended && m_xml_copy)
+		{
+			auto [machineStart, machineEnd] = entry.m_span;
+			m_xml_copy->write("\t");
+			m_xml_copy->write(chunk.m_body.constData() + machineStart, machineEnd - machineStart);
+			m_xml_copy->write("\n");
+		}
+	}
+}
+
+
+//-------------------------------------------------
+//  append_machine - appends a machine and all of
+//	its records; strings get interned in a fixed
+//	order (as opposed to the order they appear in
+//	the XML) so that it makes no difference whether
+//	a machine was parsed or reused
+//-------------------------------------------------
+
+template<typename TStringFunc, typename TMachineFunc>
+void info::database_builder::append_machine(const info::binaries::machine &sourceMachine, const machine_tables &source, TStringFunc &&str, TMachineFunc &&machineFunc)
+{
+	// copies a record byte for byte (padding included, so that the output stays deterministic)
+	// and lets the caller fix it up
+	auto appendRecord = [](auto &dest, const auto &sourceRecord, auto &&fixup)
+	{
+		auto &record = dest.emplace_back();
+		std::memcpy(&record, &sourceRecord, sizeof(record));
+		fixup(record);
+	};
+
+	// copies records from the source, letting the caller fix them up along the way
+	auto appendRecords = [&appendRecord](auto &dest, const auto &sourceSpan, std::uint32_t &index, std::uint32_t count, auto &&fixup)
+	{
+		std::uint32_t sourceIndex = index;
+		index = to_uint32(dest.size());
+		for (std::uint32_t i = sourceIndex; i < sourceIndex + count; i++)
+			appendRecord(dest, sourceSpan[i], [&fixup, i](auto &record) { fixup(record, i); });
+	};
+
+	// nothing else gets appended to m_machines while we hold on to this
+	appendRecord(m_machines, sourceMachine, machineFunc);
+	info::binaries::machine &machine = m_machines.back();
+
+	machine.m_name_strindex				= str(machine.m_name_strindex);
+	machine.m_sourcefile_strindex		= str(machine.m_sourcefile_strindex);
+	machine.m_clone_of_machindex		= str(machine.m_clone_of_machindex);
+	machine.m_rom_of_machindex			= str(machine.m_rom_of_machindex);
+	machine.m_description_strindex		= str(machine.m_description_strindex);
+	machine.m_year_strindex				= str(machine.m_year_strindex);
+	machine.m_manufacturer_strindex		= str(machine.m_manufacturer_strindex);
+
+	appendRecords(m_biossets, source.m_biossets, machine.m_biossets_index, machine.m_biossets_count, [&str](info::binaries::biosset &biosset, std::uint32_t)
+	{
+		biosset.m_name_strindex			= str(biosset.m_name_strindex);
+		biosset.m_description_strindex	= str(biosset.m_description_strindex);
+	});
+	appendRecords(m_roms, source.m_roms, machine.m_roms_index, machine.m_roms_count, [this, &str, &source](info::binaries::rom &rom, std::uint32_t)
+	{
+		rom.m_name_strindex				= str(rom.m_name_strindex);
+		rom.m_bios_strindex				= str(rom.m_bios_strindex);
+		rom.m_rom_hash_index			= rom.m_rom_hash_index < source.m_rom_hashes.size() ? intern_rom_hash(source.m_rom_hashes[rom.m_rom_hash_index]) : ~0;
+		rom.m_merge_strindex			= str(rom.m_merge_strindex);
+		rom.m_region_strindex			= str(rom.m_region_strindex);
+		m_rom_hash_indexes.push_back(rom.m_rom_hash_index);
+	});
+	appendRecords(m_disks, source.m_disks, machine.m_disks_index, machine.m_disks_count, [&str](info::binaries::disk &disk, std::uint32_t)
+	{
+		disk.m_name_strindex			= str(disk.m_name_strindex);
+		disk.m_merge_strindex			= str(disk.m_merge_strindex);
+		disk.m_region_strindex			= str(disk.m_region_strindex);
+	});
+	appendRecords(m_features, source.m_features, machine.m_features_index, machine.m_features_count, [](info::binaries::feature &, std::uint32_t) { });
+	appendRecords(m_chips, source.m_chips, machine.m_chips_index, machine.m_chips_count, [&str](info::binaries::chip &chip, std::uint32_t)
+	{
+		chip.m_tag_strindex				= str(chip.m_tag_strindex);
+		chip.m_name_strindex			= str(chip.m_name_strindex);
+	});
+	appendRecords(m_displays, source.m_displays, machine.m_displays_index, machine.m_displays_count, [&str](info::binaries::display &display, std::uint32_t)
+	{
+		display.m_tag_strindex			= str(display.m_tag_strindex);
+	});
+	appendRecords(m_samples, source.m_samples, machine.m_samples_index, machine.m_samples_count, [&str](info::binaries::sample &sample, std::uint32_t)
+	{
+		sample.m_name_strindex			= str(sample.m_name_strindex);
+	});
+	appendRecords(m_configurations, source.m_configurations, machine.m_configurations_index, machine.m_configurations_count, [&](info::binaries::configuration &configuration, std::uint32_t)
+	{
+		configuration.m_name_strindex	= str(configuration.m_name_strindex);
+		configuration.m_tag_strindex	= str(configuration.m_tag_strindex);
+		appendRecords(m_configuration_settings, source.m_configuration_settings, configuration.m_configuration_settings_index, configuration.m_configuration_settings_count, [&](info::binaries::configuration_setting &setting, std::uint32_t settingIndex)
+		{
+			setting.m_name_strindex		= str(setting.m_name_strindex);
+			std::uint32_t conditionsCount = source.conditionsEnd(settingIndex) - setting.m_conditions_index;
+			appendRecords(m_configuration_conditions, source.m_configuration_conditions, setting.m_conditions_index, conditionsCount, [&str](info::binaries::configuration_condition &condition, std::uint32_t)
+			{
+				condition.m_tag_strindex	= str(condition.m_tag_strindex);
+			});
+		});
+	});
+	appendRecords(m_software_lists, source.m_software_lists, machine.m_software_lists_index, machine.m_software_lists_count, [&str](info::binaries::software_list &software_list, std::uint32_t)
+	{
+		software_list.m_name_strindex	= str(software_list.m_name_strindex);
+		software_list.m_filter_strindex	= str(software_list.m_filter_strindex);
+	});
+	appendRecords(m_ram_options, source.m_ram_options, machine.m_ram_options_index, machine.m_ram_options_count, [&str](info::binaries::ram_option &ram_option, std::uint32_t)
+	{
+		ram_option.m_name_strindex		= str(ram_option.m_name_strindex);
+	});
+	appendRecords(m_devices, source.m_devices, machine.m_devices_index, machine.m_devices_count, [&str](info::binaries::device &device, std::uint32_t)
+	{
+		device.m_type_strindex			= str(device.m_type_strindex);
+		device.m_tag_strindex			= str(device.m_tag_strindex);
+		device.m_interface_strindex		= str(device.m_interface_strindex);
+		device.m_instance_name_strindex	= str(device.m_instance_name_strindex);
+		device.m_extensions_strindex	= str(device.m_extensions_strindex);
+	});
+	appendRecords(m_slots, source.m_slots, machine.m_slots_index, machine.m_slots_count, [&](info::binaries::slot &slot, std::uint32_t)
+	{
+		slot.m_name_strindex			= str(slot.m_name_strindex);
+		appendRecords(m_slot_options, source.m_slot_options, slot.m_slot_options_index, slot.m_slot_options_count, [&str](info::binaries::slot_option &slot_option, std::uint32_t)
+		{
+			slot_option.m_name_strindex		= str(slot_option.m_name_strindex);
+			slot_option.m_devname_strindex	= str(slot_option.m_devname_strindex);
+		});
+	});
+}
+
+
+//-------------------------------------------------
+//  previous_tables
+//-------------------------------------------------
+
+info::database_builder::machine_tables info::database_builder::previous_tables() const
+{
+	auto getSpan = [this]<typename T>(std::span<const T> &span, info::binaries::section_type type)
+	{
+		span = m_previous_db->get_section<T>(type);
+	};
+
+	machine_tables result;
+	getSpan(result.m_machines,					info::binaries::section_type::MACHINES);
+	getSpan(result.m_biossets,					info::binaries::section_type::BIOSSETS);
+	getSpan(result.m_roms,						info::binaries::section_type::ROMS);
+	getSpan(result.m_rom_hashes,				info::binaries::section_type::ROM_HASHES);
+	getSpan(result.m_disks,						info::binaries::section_type::DISKS);
+	getSpan(result.m_devices,					info::binaries::section_type::DEVICES);
+	getSpan(result.m_slots,						info::binaries::section_type::SLOTS);
+	getSpan(result.m_slot_options,				info::binaries::section_type::SLOT_OPTIONS);
+	getSpan(result.m_features,					info::binaries::section_type::FEATURES);
+	getSpan(result.m_chips,						info::binaries::section_type::CHIPS);
+	getSpan(result.m_displays,					info::binaries::section_type::DISPLAYS);
+	getSpan(result.m_samples,					info::binaries::section_type::SAMPLES);
+	getSpan(result.m_configurations,			info::binaries::section_type::CONFIGURATIONS);
+	getSpan(result.m_configuration_conditions,	info::binaries::section_type::CONFIGURATION_CONDITIONS);
+	getSpan(result.m_configuration_settings,	info::binaries::section_type::CONFIGURATION_SETTINGS);
+	getSpan(result.m_software_lists,			info::binaries::section_type::SOFTWARE_LISTS);
+	getSpan(result.m_ram_options,				info::binaries::section_type::RAM_OPTIONS);
+	return result;
+}
+
+
+//-------------------------------------------------
+//  previous_string - gets the text of a string in
+//	the previous info DB's string table
+//-------------------------------------------------
+
+const char8_t *info::database_builder::previous_string(std::uint32_t strindex) const noexcept
+{
+	std::span<const char> stringTable = m_previous_db->m_state->m_stringTable;
+	std::span<const char> span = strindex < stringTable.size() ? stringTable.subspan(strindex) : std::span<const char>();
+	return std::ranges::find(span, '\0') != span.end()
+		? (const char8_t *)span.data()
+		: u8"";
+}
+
+
+//-------------------------------------------------
+//  build_machine_summaries - builds the table
+//	parallel to m_machines with what the machine
+//	list needs
+//-------------------------------------------------
+
+void info::database_builder::build_machine_summaries()
+{
+	m_machine_summaries.clear();
+	m_machine_summaries.reserve(m_machines.size());
+	for (const binaries::machine &machine : m_machines)
+	{
+		binaries::machine_summary &summary = m_machine_summaries.emplace_back();
+		summary.m_name_strindex				= machine.m_name_strindex;
+		summary.m_sourcefile_strindex		= machine.m_sourcefile_strindex;
+		summary.m_clone_of_machindex		= machine.m_clone_of_machindex;
+		summary.m_description_strindex		= machine.m_description_strindex;
+		summary.m_year_strindex				= machine.m_year_strindex;
+		summary.m_manufacturer_strindex		= machine.m_manufacturer_strindex;
+		summary.m_runnable					= machine.m_runnable;
+		summary.m_is_bios					= machine.m_is_bios;
+		summary.m_is_device					= machine.m_is_device;
+		summary.m_is_mechanical				= machine.m_is_mechanical;
+		summary.m_quality_status			= machine.m_quality_status;
+		summary.m_quality_emulation			= machine.m_quality_emulation;
+		summary.m_save_state_supported		= machine.m_save_state_supported;
+		summary.m_unofficial				= machine.m_unofficial;
+	}
+}
+
+
+//-------------------------------------------------
+//  build_machine_name_index - builds a minimal
+//	perfect hash over machine names (hash and
+//	displace), so that find_machine() is a hash and
+//	a single compare
+//-------------------------------------------------
+
+void info::database_builder::build_machine_name_index()
+{
+	ProfilerScope prof(CURRENT_FUNCTION);
+	m_machine_name_buckets.clear();
+	m_machine_name_slots.clear();
+	const std::uint32_t machineCount = to_uint32(m_machines.size());
+	if (machineCount == 0)
+		return;
+
+	// hash all names, and distribute them into buckets of four names on average
+	std::vector<std::uint64_t> hashes;
+	hashes.reserve(machineCount);
+	for (const binaries::machine &machine : m_machines)
+	{
+		string_table::SsoBuffer ssoBuffer;
+		hashes.push_back(info::database::machine_name_hash(m_strings.lookup(machine.m_name_strindex, ssoBuffer)));
+	}
+	const std::uint32_t bucketCount = (machineCount + 3) / 4;
+	std::vector<std::vector<std::uint32_t>> buckets(bucketCount);
+	for (std::uint32_t machineIndex = 0; machineIndex < machineCount; machineIndex++)
+		buckets[hashes[machineIndex] % bucketCount].push_back(machineIndex);
+
+	// place the biggest buckets first, while the slots are mostly free
+	std::vector<std::uint32_t> bucketOrder(bucketCount);
+	std::iota(bucketOrder.begin(), bucketOrder.end(), 0);
+	std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&buckets](std::uint32_t a, std::uint32_t b)
+	{
+		return buckets[a].size() > buckets[b].size();
+	});
+
+	// for each bucket find a displacement that puts all of its names into free slots
+	std::vector<std::uint32_t> displacements(bucketCount, 0);
+	std::vector<std::uint32_t> slots(machineCount, ~0);
+	std::vector<std::uint32_t> bucketSlots;
+	for (std::uint32_t bucketIndex : bucketOrder)
+	{
+		const std::vector<std::uint32_t> &bucket = buckets[bucketIndex];
+		bool placed = bucket.empty();
+		for (std::uint32_t displacement = 0; !placed && displacement < 0x1000000; displacement++)
+		{
+			bucketSlots.clear();
+			for (std::uint32_t machineIndex : bucket)
+			{
+				std::uint32_t slot = info::database::machine_name_slot(hashes[machineIndex], displacement, machineCount);
+				if (slots[slot] != ~0 || std::ranges::find(bucketSlots, slot) != bucketSlots.end())
+					break;
+				bucketSlots.push_back(slot);
+			}
+
+			placed = bucketSlots.size() == bucket.size();
+			if (placed)
+			{
+				displacements[bucketIndex] = displacement;
+				for (std::size_t i = 0; i < bucket.size(); i++)
+					slots[bucketSlots[i]] = bucket[i];
+			}
+		}
+
+		// this should only happen if two names have the same 64-bit hash; find_machine() will
+		// fall back to a binary search
+		if (!placed)
+			return;
+	}
+
+	m_machine_name_buckets = std::move(displacements);
+	m_machine_name_slots = std::move(slots);
+}
+
+
+//-------------------------------------------------
+//  intern_rom_hash - finds or adds a CRC-32/SHA-1
+//	pair in the shared table of ROM hashes
+//-------------------------------------------------
+
+std::uint32_t info::database_builder::intern_rom_hash(const info::binaries::rom_hash &hash)
+{
+	std::uint32_t crc32 = romHashCrc32(hash);
+	auto [begin, end] = m_rom_hashes_by_crc32.equal_range(crc32);
+	for (auto iter = begin; iter != end; iter++)
+	{
+		if (!std::memcmp(m_rom_hashes[iter->second].m_sha1, hash.m_sha1, sizeof(hash.m_sha1)))
+			return iter->second;
+	}
 
-		info::binaries::machine &machine = util::last(m_machines);
-		machine.m_sound_channels		= channels.as<std::uint8_t>().value_or(~0);
-	});
+	// the uses get filled in by build_rom_hash_index()
+	std::uint32_t index = to_uint32(m_rom_hashes.size());
+	info::binaries::rom_hash &newHash = m_rom_hashes.emplace_back();
+	binaryWipe(newHash);
+	std::memcpy(newHash.m_crc32, hash.m_crc32, sizeof(hash.m_crc32));
+	std::memcpy(newHash.m_sha1, hash.m_sha1, sizeof(hash.m_sha1));
+	m_rom_hashes_by_crc32.emplace(crc32, index);
+	return index;
+}
 
-	// parse!
-	bool success;
-	try
+
+//-------------------------------------------------
+//  build_rom_hash_index - builds the reverse index
+//	from ROM hashes to the ROMs (and machines) that
+//	use them, and the table that looks them up by
+//	CRC-32; like the posting lists, this refers to
+//	machine indexes and has to happen after the
+//	machines are sorted
+//-------------------------------------------------
+
+void info::database_builder::build_rom_hash_index()
+{
+	ProfilerScope prof(CURRENT_FUNCTION);
+
+	// accumulate (hash, machine, rom) for every ROM that has a hash
+	std::vector<std::tuple<std::uint32_t, std::uint32_t, std::uint32_t>> uses;
+	uses.reserve(m_rom_hash_indexes.size());
+	for (std::uint32_t machineIndex = 0; machineIndex < m_machines.size(); machineIndex++)
 	{
-		success = xml.parse(input);
+		const binaries::machine &machine = m_machines[machineIndex];
+		for (std::uint32_t romIndex = machine.m_roms_index; romIndex < machine.m_roms_index + machine.m_roms_count; romIndex++)
+		{
+			std::uint32_t hashIndex = m_rom_hash_indexes[romIndex];
+			if (hashIndex != (std::uint32_t)~0)
+				uses.emplace_back(hashIndex, machineIndex, romIndex);
+		}
 	}
-	catch (std::exception &ex)
+
+	// sort them, and group them by hash
+	std::sort(uses.begin(), uses.end());
+	m_rom_hash_uses.clear();
+	m_rom_hash_uses.reserve(uses.size());
+	for (auto iter = uses.begin(); iter != uses.end(); )
 	{
-		// did an exception (probably thrown by to_uint32) get thrown?
-		error_message = ex.what();
-		return false;
+		binaries::rom_hash &hash = m_rom_hashes[std::get<0>(*iter)];
+		hash.m_uses_index = to_uint32(m_rom_hash_uses.size());
+		for (auto hashIndex = std::get<0>(*iter); iter != uses.end() && std::get<0>(*iter) == hashIndex; iter++)
+			m_rom_hash_uses.push_back({ std::get<1>(*iter), std::get<2>(*iter) });
+		hash.m_uses_count = to_uint32(m_rom_hash_uses.size() - hash.m_uses_index);
 	}
-	if (!success)
+
+	// finally the open addressing table keyed by CRC-32, which we keep at least half empty
+	// so that probe sequences stay short
+	m_rom_hash_slots.assign(m_rom_hashes.empty() ? 0 : std::bit_ceil(m_rom_hashes.size() * 2), ~0);
+	std::size_t mask = m_rom_hash_slots.size() - 1;
+	for (std::uint32_t hashIndex = 0; hashIndex < m_rom_hashes.size(); hashIndex++)
 	{
-		// now check for XML parsing errors; this is likely the result of somebody aborting the DB rebuild, but
-		// it is the caller's responsibility to handle that situation
-		error_message = xml.errorMessagesSingleString();
-		return false;
+		std::size_t slot = romHashCrc32(m_rom_hashes[hashIndex]) & mask;
+		while (m_rom_hash_slots[slot] != (std::uint32_t)~0)
+			slot = (slot + 1) & mask;
+		m_rom_hash_slots[slot] = hashIndex;
 	}
+}
 
-	// final magic bytes on string table
-	m_strings.embed_value(info::binaries::MAGIC_STRINGTABLE_END);
 
-	// finalize the header
-	header.m_machines_count					= to_uint32(m_machines.size());
-	header.m_biossets_count					= to_uint32(m_biossets.size());
-	header.m_roms_count						= to_uint32(m_roms.size());
-	header.m_disks_count					= to_uint32(m_disks.size());
-	header.m_devices_count					= to_uint32(m_devices.size());
-	header.m_slots_count					= to_uint32(m_slots.size());
-	header.m_slot_options_count				= to_uint32(m_slot_options.size());
-	header.m_features_count					= to_uint32(m_features.size());
-	header.m_chips_count					= to_uint32(m_chips.size());
-	header.m_displays_count					= to_uint32(m_displays.size());
-	header.m_samples_count					= to_uint32(m_samples.size());
-	header.m_configurations_count			= to_uint32(m_configurations.size());
-	header.m_configuration_settings_count	= to_uint32(m_configuration_settings.size());
-	header.m_configuration_conditions_count	= to_uint32(m_configuration_conditions.size());
-	header.m_software_lists_count			= to_uint32(m_software_lists.size());
-	header.m_ram_options_count				= to_uint32(m_ram_options.size());
-
-	// and salt it
-	m_salted_header = util::salt(header, info::binaries::salt());
+//-------------------------------------------------
+//  build_posting_lists - builds the inverted
+//	indexes used for folder filters; these are
+//	keyed by string indexes and refer to machine
+//	indexes, so this has to happen after machines
+//	are sorted
+//-------------------------------------------------
 
-	// sort machines by name to facilitate lookups
-	std::sort(
-		m_machines.begin(),
-		m_machines.end(),
-		[this](const binaries::machine &a, const binaries::machine &b)
-		{
-			string_table::SsoBuffer ssoBufferA, ssoBufferB;
-			std::u8string_view aText = m_strings.lookup(a.m_name_strindex, ssoBufferA);
-			std::u8string_view bText = m_strings.lookup(b.m_name_strindex, ssoBufferB);
-			return aText < bText;
-		});
+void info::database_builder::build_posting_lists()
+{
+	ProfilerScope prof(CURRENT_FUNCTION);
 
-	// build a machine index map
-	std::unordered_map<std::uint32_t, std::uint32_t> machineIndexMap;
-	machineIndexMap.reserve(m_machines.size() + 1);
-	machineIndexMap.emplace(m_strings.get(std::u8string()), ~0);
-	for (auto iter = m_machines.begin(); iter != m_machines.end(); iter++)
+	// accumulate (type, key, machine) for every machine
+	std::vector<std::tuple<std::uint8_t, std::uint32_t, std::uint32_t>> postings;
+	postings.reserve(m_machines.size() * 4 + m_chips.size());
+	for (std::uint32_t machineIndex = 0; machineIndex < m_machines.size(); machineIndex++)
 	{
-		machineIndexMap.emplace(iter->m_name_strindex, iter - m_machines.begin());
+		const binaries::machine &machine = m_machines[machineIndex];
+		auto addPosting = [&postings, machineIndex](posting_list::type_t type, std::uint32_t keyStrIndex)
+		{
+			postings.emplace_back((std::uint8_t)type, keyStrIndex, machineIndex);
+		};
+
+		// manufacturer/source/year
+		addPosting(posting_list::type_t::MANUFACTURER, machine.m_manufacturer_strindex);
+		addPosting(posting_list::type_t::SOURCEFILE, machine.m_sourcefile_strindex);
+		addPosting(posting_list::type_t::YEAR, machine.m_year_strindex);
+
+		// cpu/sound
+		for (std::uint32_t i = 0; i < machine.m_chips_count; i++)
+		{
+			const binaries::chip &chip = m_chips[machine.m_chips_index + i];
+			switch ((info::chip::type_t)chip.m_type)
+			{
+			case info::chip::type_t::CPU:
+				addPosting(posting_list::type_t::CPU, chip.m_name_strindex);
+				break;
+
+			case info::chip::type_t::AUDIO:
+				addPosting(posting_list::type_t::SOUND, chip.m_name_strindex);
+				break;
+
+			default:
+				// ignore anything we don't know about
+				break;
+			}
+		}
+
+		// the BIOS is what the root of the clone hierarchy is a "rom of", if that is a BIOS
+		std::uint32_t rootIndex = machineIndex;
+		for (std::size_t depth = 0; depth < m_machines.size() && m_machines[rootIndex].m_clone_of_machindex < m_machines.size(); depth++)
+			rootIndex = m_machines[rootIndex].m_clone_of_machindex;
+		std::uint32_t biosIndex = m_machines[rootIndex].m_rom_of_machindex;
+		if (biosIndex < m_machines.size() && m_machines[biosIndex].m_is_bios == encodeBool(true))
+			addPosting(posting_list::type_t::BIOS, m_machines[biosIndex].m_name_strindex);
 	}
 
-	// helper to perform machine index lookups
-	auto machineIndexFromStringIndex = [&machineIndexMap](std::uint32_t stringIndex)
-	{
-		auto iter = machineIndexMap.find(stringIndex);
-		return iter != machineIndexMap.end()
-			? iter->second
-			: ~0;	// should never happen unless -listxml is returning bad results
-	};
+	// sort and remove duplicates (e.g. - machines with multiple identical CPUs); this leaves
+	// the machine indexes within each list sorted
+	std::sort(postings.begin(), postings.end());
+	postings.erase(std::unique(postings.begin(), postings.end()), postings.end());
 
-	// and change clone_of and rom_of to be machine indexes, using the map we have above
-	for (info::binaries::machine &machine : m_machines)
+	// and group them into lists
+	m_posting_lists.clear();
+	m_postings.clear();
+	m_postings.reserve(postings.size());
+	for (auto iter = postings.begin(); iter != postings.end(); )
 	{
-		machine.m_clone_of_machindex = machineIndexFromStringIndex(machine.m_clone_of_machindex);
-		machine.m_rom_of_machindex = machineIndexFromStringIndex(machine.m_rom_of_machindex);
+		binaries::posting_list &list = m_posting_lists.emplace_back();
+		list.m_type = std::get<0>(*iter);
+		list.m_key_strindex = std::get<1>(*iter);
+		list.m_postings_index = to_uint32(m_postings.size());
+		for (; iter != postings.end() && std::get<0>(*iter) == list.m_type && std::get<1>(*iter) == list.m_key_strindex; iter++)
+			m_postings.push_back(std::get<2>(*iter));
+		list.m_postings_count = to_uint32(m_postings.size() - list.m_postings_index);
 	}
 
-	// success!
-	error_message.clear();
-	return true;
+	// finally sort the lists by type and key to facilitate lookups
+	std::sort(
+		m_posting_lists.begin(),
+		m_posting_lists.end(),
+		[this](const binaries::posting_list &a, const binaries::posting_list &b)
+		{
+			if (a.m_type != b.m_type)
+				return a.m_type < b.m_type;
+			string_table::SsoBuffer ssoBufferA, ssoBufferB;
+			std::u8string_view aText = m_strings.lookup(a.m_key_strindex, ssoBufferA);
+			std::u8string_view bText = m_strings.lookup(b.m_key_strindex, ssoBufferB);
+			return aText < bText;
+		});
 }
 
 
 //-------------------------------------------------
-//  emit_info
+//  emit_info - writes out the info DB; this only
+//	fails if spilling (or reading back what got
+//	spilled) fails
 //-------------------------------------------------
 
-void info::database_builder::emit_info(QIODevice &output) const noexcept
+bool info::database_builder::emit_info(QIODevice &output) const noexcept
 {
-	output.write((const char *) &m_salted_header, sizeof(m_salted_header));
-	writeContainerData(output, m_machines);
-	writeContainerData(output, m_biossets);
-	writeContainerData(output, m_roms);
-	writeContainerData(output, m_disks);
-	writeContainerData(output, m_devices);
-	writeContainerData(output, m_slots);
-	writeContainerData(output, m_slot_options);
-	writeContainerData(output, m_features);
-	writeContainerData(output, m_chips);
-	writeContainerData(output, m_displays);
-	writeContainerData(output, m_samples);
-	writeContainerData(output, m_configurations);
-	writeContainerData(output, m_configuration_settings);
-	writeContainerData(output, m_configuration_conditions);
-	writeContainerData(output, m_software_lists);
-	writeContainerData(output, m_ram_options);
-	writeContainerData(output, m_strings.data());
+	using info::binaries::section_type;
+	using info::binaries::section_compression;
+
+	// identify all sections; spilled tables (and their compressed forms) are read in blocks
+	struct section_data
+	{
+		std::function<bool(const BlockFunc &)>			m_read;
+		std::size_t										m_size = 0;
+		std::uint32_t									m_count = 0;
+		std::optional<spillable_table<std::uint8_t>>	m_compressed;
+	};
+	std::array<section_data, (int)section_type::COUNT> sections;
+	auto setSection = [&sections]<typename T>(section_type type, std::span<const T> container)
+	{
+		std::span<const std::uint8_t> data((const std::uint8_t *)container.data(), container.size() * sizeof(T));
+		sections[(int)type].m_read = [data](const BlockFunc &func)
+		{
+			if (!data.empty())
+				func(data);
+			return true;
+		};
+		sections[(int)type].m_size = data.size();
+		sections[(int)type].m_count = to_uint32(container.size());
+	};
+	auto setSpillableSection = [&sections]<typename T>(section_type type, const spillable_table<T> &table)
+	{
+		sections[(int)type].m_read = [&table](const BlockFunc &func) { return table.read(func); };
+		sections[(int)type].m_size = table.size() * sizeof(T);
+		sections[(int)type].m_count = to_uint32(table.size());
+	};
+	setSection(section_type::MACHINES,							std::span(m_machines));
+	setSection(section_type::MACHINE_SUMMARIES,					std::span(m_machine_summaries));
+	setSpillableSection(section_type::BIOSSETS,					m_biossets);
+	setSpillableSection(section_type::ROMS,						m_roms);
+	setSpillableSection(section_type::DISKS,					m_disks);
+	setSpillableSection(section_type::DEVICES,					m_devices);
+	setSpillableSection(section_type::SLOTS,					m_slots);
+	setSpillableSection(section_type::SLOT_OPTIONS,				m_slot_options);
+	setSpillableSection(section_type::FEATURES,					m_features);
+	setSection(section_type::CHIPS,								std::span(m_chips));
+	setSpillableSection(section_type::DISPLAYS,					m_displays);
+	setSpillableSection(section_type::SAMPLES,					m_samples);
+	setSpillableSection(section_type::CONFIGURATIONS,			m_configurations);
+	setSpillableSection(section_type::CONFIGURATION_SETTINGS,	m_configuration_settings);
+	setSpillableSection(section_type::CONFIGURATION_CONDITIONS,	m_configuration_conditions);
+	setSpillableSection(section_type::SOFTWARE_LISTS,			m_software_lists);
+	setSpillableSection(section_type::RAM_OPTIONS,				m_ram_options);
+	setSection(section_type::POSTING_LISTS,						std::span(m_posting_lists));
+	setSection(section_type::POSTINGS,							std::span(m_postings));
+	setSection(section_type::MACHINE_NAME_BUCKETS,				std::span(m_machine_name_buckets));
+	setSection(section_type::MACHINE_NAME_SLOTS,				std::span(m_machine_name_slots));
+	setSection(section_type::ROM_HASHES,						std::span(m_rom_hashes));
+	setSection(section_type::ROM_HASH_USES,						std::span(m_rom_hash_uses));
+	setSection(section_type::ROM_HASH_SLOTS,					std::span(m_rom_hash_slots));
+	setSection(section_type::STRINGS,							m_strings.data());
+
+	// deflates a section block by block; we favor speed over size because decompression speed
+	// hardly depends on this, and the output is the same as compressing it in one go
+	auto compressSection = [](const section_data &section, spillable_table<std::uint8_t> &compressed)
+	{
+		z_stream stream = { };
+		if (deflateInit(&stream, Z_BEST_SPEED) != Z_OK)
+			return false;
+
+		std::array<std::uint8_t, 65536> buffer;
+		int rc = Z_OK;
+		auto deflateBlock = [&stream, &buffer, &rc, &compressed](std::span<const std::uint8_t> block, int flush)
+		{
+			stream.next_in = const_cast<Bytef *>(block.data());
+			stream.avail_in = (uInt)block.size();
+			do
+			{
+				stream.next_out = buffer.data();
+				stream.avail_out = (uInt)buffer.size();
+				rc = deflate(&stream, flush);
+				compressed.append(std::span<const std::uint8_t>(buffer.data(), buffer.size() - stream.avail_out));
+			} while (rc == Z_OK && stream.avail_out == 0);
+		};
+		bool success = section.m_read([&deflateBlock](std::span<const std::uint8_t> block) { deflateBlock(block, Z_NO_FLUSH); });
+		deflateBlock({ }, Z_FINISH);
+		deflateEnd(&stream);
+		return success && rc == Z_STREAM_END && compressed.size() < section.m_size;
+	};
+
+	try
+	{
+		// compress the sections that aren't needed at startup; the machine list only needs machine
+		// summaries and strings, and the folder tree only needs posting lists (full machine records
+		// are left uncompressed, so that a mapped file only pages in the ones we look at)
+		if (m_compress_cold_sections)
+		{
+			for (section_type type : { section_type::BIOSSETS, section_type::ROMS, section_type::DISKS, section_type::DEVICES,
+				section_type::SLOTS, section_type::SLOT_OPTIONS, section_type::FEATURES, section_type::CHIPS, section_type::DISPLAYS,
+				section_type::SAMPLES, section_type::CONFIGURATIONS, section_type::CONFIGURATION_SETTINGS,
+				section_type::CONFIGURATION_CONDITIONS, section_type::SOFTWARE_LISTS, section_type::RAM_OPTIONS })
+			{
+				section_data &section = sections[(int)type];
+				if (section.m_size > 0)
+				{
+					section.m_compressed.emplace();
+					if (!m_spill_directory.isEmpty())
+						section.m_compressed->spill(m_spill_directory, m_spill_block_size);
+					if (!compressSection(section, *section.m_compressed))
+						section.m_compressed.reset();
+				}
+			}
+		}
+
+		// lay out the sections, keeping each one aligned
+		info::binaries::header header = m_header;
+		header.m_section_count = (std::uint32_t)section_type::COUNT;
+		std::uint32_t offset = 0;
+		for (int i = 0; i < (int)section_type::COUNT; i++)
+		{
+			offset = (offset + 7) & ~7;
+			bool compressed = sections[i].m_compressed.has_value();
+			header.m_sections[i].m_offset		= offset;
+			header.m_sections[i].m_stored_size	= to_uint32(compressed ? sections[i].m_compressed->size() : sections[i].m_size);
+			header.m_sections[i].m_size			= to_uint32(sections[i].m_size);
+			header.m_sections[i].m_count		= sections[i].m_count;
+			header.m_sections[i].m_compression	= (std::uint32_t)(compressed ? section_compression::ZLIB : section_compression::NONE);
+			offset += header.m_sections[i].m_stored_size;
+		}
+
+		// and write everything out
+		auto writeBlock = [&output](std::span<const std::uint8_t> block)
+		{
+			output.write((const char *)block.data(), block.size());
+		};
+		info::binaries::header salted_header = util::salt(header, info::binaries::salt());
+		output.write((const char *)&salted_header, sizeof(salted_header));
+		std::uint32_t position = 0;
+		for (int i = 0; i < (int)section_type::COUNT; i++)
+		{
+			static const char padding[8] = { 0, };
+			output.write(padding, header.m_sections[i].m_offset - position);
+			bool success = sections[i].m_compressed
+				? sections[i].m_compressed->read(writeBlock)
+				: sections[i].m_read(writeBlock);
+			if (!success)
+				return false;
+			position = header.m_sections[i].m_offset + header.m_sections[i].m_stored_size;
+		}
+	}
+	catch (std::exception &)
+	{
+		// we could not spill the compressed form of a section
+		return false;
+	}
+	return true;
 }
 
 
@@ -741,7 +2504,6 @@ void info::database_builder::dump() const noexcept
 	dumpTableSizes();
 	m_strings.dumpStringSizeDistribution();
 	m_strings.dumpPrimaryBucketDistribution();
-	m_strings.dumpSecondaryBucketDistribution();
 }
 
 
@@ -753,6 +2515,7 @@ void info::database_builder::dumpTableSizes() const noexcept
 {
 	printf("\nDump of info::database_builder state:\n");
 	printf("m_machines.size():                 %7lu\n", (unsigned long)m_machines.size());
+	printf("m_machine_summaries.size():        %7lu\n", (unsigned long)m_machine_summaries.size());
 	printf("m_biossets.size():                 %7lu\n", (unsigned long)m_biossets.size());
 	printf("m_roms.size():                     %7lu\n", (unsigned long)m_roms.size());
 	printf("m_disks.size():                    %7lu\n", (unsigned long)m_disks.size());
@@ -768,7 +2531,194 @@ void info::database_builder::dumpTableSizes() const noexcept
 	printf("m_configuration_conditions.size(): %7lu\n", (unsigned long)m_configuration_conditions.size());
 	printf("m_software_lists.size():           %7lu\n", (unsigned long)m_software_lists.size());
 	printf("m_ram_options.size():              %7lu\n", (unsigned long)m_ram_options.size());
+	printf("m_posting_lists.size():            %7lu\n", (unsigned long)m_posting_lists.size());
+	printf("m_postings.size():                 %7lu\n", (unsigned long)m_postings.size());
+	printf("m_machine_name_buckets.size():     %7lu\n", (unsigned long)m_machine_name_buckets.size());
+	printf("m_machine_name_slots.size():       %7lu\n", (unsigned long)m_machine_name_slots.size());
+	printf("m_rom_hashes.size():               %7lu\n", (unsigned long)m_rom_hashes.size());
+	printf("m_rom_hash_uses.size():            %7lu\n", (unsigned long)m_rom_hash_uses.size());
+	printf("m_rom_hash_slots.size():           %7lu\n", (unsigned long)m_rom_hash_slots.size());
 	printf("m_strings.data().size():           %7lu\n", (unsigned long)m_strings.data().size());
+
+	std::size_t spilledCount = m_biossets.spilled_count() + m_roms.spilled_count() + m_disks.spilled_count()
+		+ m_devices.spilled_count() + m_slots.spilled_count() + m_slot_options.spilled_count() + m_features.spilled_count()
+		+ m_displays.spilled_count() + m_samples.spilled_count() + m_configurations.spilled_count()
+		+ m_configuration_conditions.spilled_count() + m_configuration_settings.spilled_count()
+		+ m_software_lists.spilled_count() + m_ram_options.spilled_count();
+	printf("spilled records:                   %7lu\n", (unsigned long)spilledCount);
+	printf("peak memory usage (KB):            %7lu\n", (unsigned long)(m_peak_memory_usage / 1024));
+}
+
+
+//-------------------------------------------------
+//  memory_usage - the memory held by our tables
+//	and indexes; spilling keeps a lid on the former
+//-------------------------------------------------
+
+std::size_t info::database_builder::memory_usage() const noexcept
+{
+	auto usage = []<typename T>(const std::vector<T> &table)
+	{
+		return table.capacity() * sizeof(T);
+	};
+	return usage(m_machines) + usage(m_machine_summaries) + usage(m_chips) + usage(m_posting_lists)
+		+ usage(m_postings) + usage(m_machine_name_buckets) + usage(m_machine_name_slots)
+		+ usage(m_rom_hashes) + usage(m_rom_hash_uses) + usage(m_rom_hash_slots) + usage(m_rom_hash_indexes)
+		+ m_biossets.memory_usage() + m_roms.memory_usage() + m_disks.memory_usage() + m_devices.memory_usage()
+		+ m_slots.memory_usage() + m_slot_options.memory_usage() + m_features.memory_usage()
+		+ m_displays.memory_usage() + m_samples.memory_usage() + m_configurations.memory_usage()
+		+ m_configuration_conditions.memory_usage() + m_configuration_settings.memory_usage()
+		+ m_software_lists.memory_usage() + m_ram_options.memory_usage()
+		+ m_strings.memory_usage() + hashMemoryUsage(m_rom_hashes_by_crc32) + hashMemoryUsage(m_merged_machine_names);
+}
+
+
+//-------------------------------------------------
+//  update_peak_memory_usage - takes note of what
+//	we hold, plus anything held on our behalf (such
+//	as chunks yet to be merged)
+//-------------------------------------------------
+
+void info::database_builder::update_peak_memory_usage(std::size_t transient_usage) noexcept
+{
+	m_peak_memory_usage = std::max(m_peak_memory_usage, memory_usage() + transient_usage);
+}
+
+
+//-------------------------------------------------
+//  spill_file ctor
+//-------------------------------------------------
+
+info::database_builder::spill_file::spill_file(const QString &directory)
+	: m_file(std::make_unique<QTemporaryFile>(QDir(directory).filePath("infodb_XXXXXX.spill")))
+	, m_size(0)
+{
+	if (!m_file->open())
+		throw std::runtime_error(QString("Could not create temporary file in %1").arg(directory).toStdString());
+}
+
+
+//-------------------------------------------------
+//  spill_file::write
+//-------------------------------------------------
+
+void info::database_builder::spill_file::write(std::span<const std::uint8_t> data)
+{
+	qint64 length = (qint64)data.size();
+	if (m_file->write((const char *)data.data(), length) != length)
+		throw std::runtime_error(QString("Could not write to %1").arg(m_file->fileName()).toStdString());
+	m_size += data.size();
+}
+
+
+//-------------------------------------------------
+//  spill_file::read - reads everything back in
+//	blocks
+//-------------------------------------------------
+
+bool info::database_builder::spill_file::read(const BlockFunc &func) const
+{
+	if (!m_file->seek(0))
+		return false;
+
+	std::vector<std::uint8_t> buffer(std::min(m_size, (std::uint64_t)1048576));
+	for (std::uint64_t position = 0; position < m_size; )
+	{
+		qint64 length = m_file->read((char *)buffer.data(), (qint64)std::min(m_size - position, (std::uint64_t)buffer.size()));
+		if (length <= 0)
+			return false;
+		func(std::span<const std::uint8_t>(buffer.data(), (std::size_t)length));
+		position += (std::uint64_t)length;
+	}
+	return true;
+}
+
+
+//-------------------------------------------------
+//  spillable_table::spill - starts spilling in
+//	blocks of (roughly) the specified size; the
+//	spill file itself is created on demand
+//-------------------------------------------------
+
+template<typename T>
+void info::database_builder::spillable_table<T>::spill(const QString &directory, std::size_t blockSize)
+{
+	assert(size() == 0);
+	m_spill_directory = directory;
+	m_block_count = std::max(blockSize / sizeof(T), (std::size_t)1);
+	m_records = std::vector<T>();
+	m_records.reserve(m_block_count);
+}
+
+
+//-------------------------------------------------
+//  spillable_table::reserve
+//-------------------------------------------------
+
+template<typename T>
+void info::database_builder::spillable_table<T>::reserve(std::size_t count)
+{
+	// when spilling, we never hold on to more than a block
+	if (m_block_count == 0)
+		m_records.reserve(count);
+}
+
+
+//-------------------------------------------------
+//  spillable_table::emplace_back - the record stays
+//	put until the next one is appended
+//-------------------------------------------------
+
+template<typename T>
+T &info::database_builder::spillable_table<T>::emplace_back()
+{
+	if (m_block_count > 0 && m_records.size() >= m_block_count)
+		flush();
+	return m_records.emplace_back();
+}
+
+
+//-------------------------------------------------
+//  spillable_table::append
+//-------------------------------------------------
+
+template<typename T>
+void info::database_builder::spillable_table<T>::append(std::span<const T> records)
+{
+	m_records.insert(m_records.end(), records.begin(), records.end());
+	if (m_block_count > 0 && m_records.size() >= m_block_count)
+		flush();
+}
+
+
+//-------------------------------------------------
+//  spillable_table::read - reads the records back
+//	in blocks, spilled ones first
+//-------------------------------------------------
+
+template<typename T>
+bool info::database_builder::spillable_table<T>::read(const BlockFunc &func) const
+{
+	if (m_spill_file && !m_spill_file->read(func))
+		return false;
+	if (!m_records.empty())
+		func(std::span<const std::uint8_t>((const std::uint8_t *)m_records.data(), m_records.size() * sizeof(T)));
+	return true;
+}
+
+
+//-------------------------------------------------
+//  spillable_table::flush
+//-------------------------------------------------
+
+template<typename T>
+void info::database_builder::spillable_table<T>::flush()
+{
+	if (!m_spill_file)
+		m_spill_file.emplace(m_spill_directory);
+	m_spill_file->write(std::span<const std::uint8_t>((const std::uint8_t *)m_records.data(), m_records.size() * sizeof(T)));
+	m_spilled_count += m_records.size();
+	m_records.clear();
 }
 
 
@@ -784,10 +2734,10 @@ info::database_builder::string_table::string_table() noexcept
 	// embed the initial magic bytes
 	embed_value(info::binaries::MAGIC_STRINGTABLE_BEGIN);
 
-	// allocate the map buckets
-	m_primaryMapBuckets = std::make_unique<decltype(m_primaryMapBuckets)::element_type>();
-	std::ranges::fill(*m_primaryMapBuckets, 0);
-	m_secondaryMapBuckets.reserve(60000);
+	// allocate the map buckets; this needs to be a power of two and is big enough to hold
+	// all strings in the full -listxml output (~300k) without growing
+	m_buckets.resize(524288, Bucket{ 0, 0 });
+	m_bucketsUsed = 0;
 }
 
 
@@ -799,69 +2749,133 @@ void info::database_builder::string_table::shrinkToFit() noexcept
 {
 	// only actually done in unit tests
 	m_data.shrink_to_fit();
+
+	// shrink the map buckets to the smallest power of two honoring our load factor
+	std::size_t bucketCount = 16;
+	while ((m_bucketsUsed + 1) * 8 > bucketCount * 7)
+		bucketCount *= 2;
+	resizeBuckets(bucketCount);
 }
 
 
 //-------------------------------------------------
-//  string_table::findBucket
+//  string_table::memory_usage
 //-------------------------------------------------
 
-std::uint32_t &info::database_builder::string_table::findBucket(std::u8string_view s)
+std::size_t info::database_builder::string_table::memory_usage() const noexcept
 {
-	// hash the string to find the primary bucket
-	std::size_t stringHash = std::hash<std::u8string_view>{}(s);
-	std::uint32_t &primaryBucket = (*m_primaryMapBuckets)[stringHash % m_primaryMapBuckets->size()];
+	return m_data.capacity() + m_buckets.capacity() * sizeof(Bucket);
+}
 
-	// local function to determine if this ID is the target
-	const auto isTargetString = [this, &s](std::uint32_t candidateId)
-	{
-		return (size_t)candidateId + s.size() + 1 <= m_data.size()
-			&& !memcmp(s.data(), &m_data[candidateId], s.size())
-			&& m_data[candidateId + s.size()] == '\0';
-	};
 
-	SecondaryMapBucket *targetSecondaryBucket = nullptr;
-	std::uint32_t *targetBucket = nullptr;
-	if ((primaryBucket & 0xC0000000) == 0xC0000000)
+//-------------------------------------------------
+//  string_table::probeLength - how far the bucket
+//	at the specified position is from its home
+//-------------------------------------------------
+
+std::uint32_t info::database_builder::string_table::probeLength(std::size_t position) const noexcept
+{
+	std::size_t mask = m_buckets.size() - 1;
+	return to_uint32((position - (m_buckets[position].m_hash & mask)) & mask);
+}
+
+
+//-------------------------------------------------
+//  string_table::insertBucket - places a bucket
+//	into the map, starting at the specified position
+//	and displacing buckets closer to their home
+//-------------------------------------------------
+
+void info::database_builder::string_table::insertBucket(Bucket bucket, std::size_t position, std::uint32_t distance) noexcept
+{
+	std::size_t mask = m_buckets.size() - 1;
+	for (;;)
 	{
-		// this is a secondary bucket
-		SecondaryMapBucket &secondaryBucket = m_secondaryMapBuckets[primaryBucket & ~0xC0000000];
+		Bucket &currentBucket = m_buckets[position];
+		if (currentBucket.m_offset == 0)
+		{
+			currentBucket = bucket;
+			break;
+		}
 
-		// find the target
-		auto iter = std::ranges::find_if(secondaryBucket, isTargetString);
-		if (iter != secondaryBucket.end())
-			targetBucket = &*iter;
-		else
-			targetSecondaryBucket = &secondaryBucket;
+		// Robin Hood - take from the rich (buckets close to home) and give to the poor
+		std::uint32_t currentDistance = probeLength(position);
+		if (currentDistance < distance)
+		{
+			std::swap(currentBucket, bucket);
+			distance = currentDistance;
+		}
+
+		position = (position + 1) & mask;
+		distance++;
 	}
-	else if (primaryBucket == 0 || isTargetString(primaryBucket))
+	m_bucketsUsed++;
+}
+
+
+//-------------------------------------------------
+//  string_table::resizeBuckets
+//-------------------------------------------------
+
+void info::database_builder::string_table::resizeBuckets(std::size_t bucketCount)
+{
+	assert(std::has_single_bit(bucketCount));
+	std::vector<Bucket> oldBuckets(bucketCount, Bucket{ 0, 0 });
+	std::swap(oldBuckets, m_buckets);
+	m_bucketsUsed = 0;
+
+	std::size_t mask = m_buckets.size() - 1;
+	for (const Bucket &bucket : oldBuckets)
 	{
-		// the target is this primary bucket
-		targetBucket = &primaryBucket;
+		if (bucket.m_offset != 0)
+			insertBucket(bucket, bucket.m_hash & mask, 0);
 	}
-	else
-	{
-		// we need to change a primary bucket to a secondary bucket
-		std::uint32_t newPrimaryBucketValue = 0xC0000000 | to_uint32(m_secondaryMapBuckets.size());
+}
 
-		// add the secondary bucket
-		targetSecondaryBucket = &*m_secondaryMapBuckets.emplace(m_secondaryMapBuckets.end());
 
-		// perform the move
-		targetSecondaryBucket->push_front(primaryBucket);
-		primaryBucket = newPrimaryBucketValue;
-	}
+//-------------------------------------------------
+//  string_table::findOrInsert
+//-------------------------------------------------
+
+std::uint32_t info::database_builder::string_table::findOrInsert(std::span<const char8_t> string)
+{
+	std::u8string_view stringView(string.data(), string.size() - 1);
 
-	// do we need to add to the secondary bucket?
-	if (targetSecondaryBucket)
+	// keep the load factor below 7/8 so that probes stay short
+	if ((m_bucketsUsed + 1) * 8 > m_buckets.size() * 7)
+		resizeBuckets(m_buckets.size() * 2);
+
+	// probe for the string
+	std::uint32_t hash = (std::uint32_t)std::hash<std::u8string_view>{}(stringView);
+	std::size_t mask = m_buckets.size() - 1;
+	std::size_t position = hash & mask;
+	std::uint32_t distance = 0;
+	for (;;)
 	{
-		targetSecondaryBucket->push_front(0);
-		targetBucket = &targetSecondaryBucket->front();
+		const Bucket &bucket = m_buckets[position];
+
+		// an empty bucket, or one closer to its home than we are to ours, means that the
+		// string is not present
+		if (bucket.m_offset == 0 || probeLength(position) < distance)
+			break;
+
+		// is this the string?
+		if (bucket.m_hash == hash
+			&& (size_t)bucket.m_offset + string.size() <= m_data.size()
+			&& !memcmp(string.data(), &m_data[bucket.m_offset], string.size()))
+		{
+			return bucket.m_offset;
+		}
+
+		position = (position + 1) & mask;
+		distance++;
 	}
 
-	// and return
-	assert(targetBucket);
-	return *targetBucket;
+	// we're going to append the string; the current size becomes the position of the new string
+	Bucket newBucket = { hash, to_uint32(m_data.size()) };
+	m_data.insert(m_data.end(), string.begin(), string.end());
+	insertBucket(newBucket, position, distance);
+	return newBucket.m_offset;
 }
 
 
@@ -887,20 +2901,8 @@ std::uint32_t info::database_builder::string_table::internalGet(std::span<const
 	}
 	else
 	{
-		// find the bucket
-		std::uint32_t &bucket = findBucket(stringView);
-
-		// did we find it?
-		if (bucket == 0)
-		{
-			// we're going to append the string; the current size becomes the position of the new string
-			bucket = to_uint32(m_data.size());
-
-			// append the string to m_data (but keep track of where we are)
-			m_data.insert(m_data.end(), string.begin(), string.end());
-		}
-
-		result = bucket;
+		// find the string, appending it if it is not present
+		result = findOrInsert(string);
 	}
 
 	// and return
@@ -1052,47 +3054,32 @@ void info::database_builder::string_table::dumpStringSizeDistribution() const no
 
 void info::database_builder::string_table::dumpPrimaryBucketDistribution() const noexcept
 {
-	int singularBucketCount = 0;
-	int multiBucketCount = 0;
-	int totalBucketCount = (int)m_primaryMapBuckets->size();
+	int totalBucketCount = (int)m_buckets.size();
+	int usedBucketCount = 0;
+	std::uint64_t totalProbeLength = 0;
+	std::map<std::uint32_t, int> probeLengthCounts;
 
-	for (std::uint32_t bucket : *m_primaryMapBuckets)
+	for (std::size_t i = 0; i < m_buckets.size(); i++)
 	{
-		if ((bucket & 0xC0000000) == 0xC0000000)
-			multiBucketCount++;
-		else if (bucket > 0)
-			singularBucketCount++;
+		if (m_buckets[i].m_offset != 0)
+		{
+			std::uint32_t length = probeLength(i);
+			probeLengthCounts[length]++;
+			totalProbeLength += length;
+			usedBucketCount++;
+		}
 	}
-	int emptyBucketCount = totalBucketCount - singularBucketCount - multiBucketCount;
+	int emptyBucketCount = totalBucketCount - usedBucketCount;
 
-	printf("\nPrimary bucket distribution:\n");
+	printf("\nBucket distribution:\n");
 	printf("%8d empty buckets    (%2d%%)\n", emptyBucketCount, emptyBucketCount * 100 / totalBucketCount);
-	printf("%8d singular buckets (%2d%%)\n", singularBucketCount, singularBucketCount * 100 / totalBucketCount);
-	printf("%8d multi buckets    (%2d%%)\n", multiBucketCount, multiBucketCount * 100 / totalBucketCount);
+	printf("%8d used buckets     (%2d%%)\n", usedBucketCount, usedBucketCount * 100 / totalBucketCount);
 	printf("%8d total buckets\n", totalBucketCount);
-}
-
-
-//-------------------------------------------------
-//  string_table::dumpSecondaryBucketDistribution
-//-------------------------------------------------
-
-void info::database_builder::string_table::dumpSecondaryBucketDistribution() const noexcept
-{
-	int total = 0;
-	std::map<int, int> bucketSizeCounts;
 
-	for (const SecondaryMapBucket &bucket : m_secondaryMapBuckets)
+	if (usedBucketCount > 0)
 	{
-		int bucketSize = (int)std::ranges::count_if(bucket, [](const auto &) { return true; });
-		auto iter = bucketSizeCounts.find(bucketSize);
-		if (iter == bucketSizeCounts.end())
-			iter = bucketSizeCounts.emplace(bucketSize, 0).first;
-		iter->second++;
-		total++;
+		printf("\nProbe length distribution (average %.2f):\n", (double)totalProbeLength / usedBucketCount);
+		for (const auto &[length, count] : probeLengthCounts)
+			printf("%5u: %7d (%3d%%)\n", (unsigned)length, count, count * 100 / usedBucketCount);
 	}
-
-	printf("\nSecondary bucket size distribution (%d total):\n", (int)m_secondaryMapBuckets.size());
-	for (const auto &[size, count] : bucketSizeCounts)
-		printf("%5d: %7d (%3d%%)\n", size, count, count * 100 / total);
 }
@@ -15,8 +15,15 @@
 #include "info.h"
 #include "xmlparser.h"
 
+// Qt headers
+#include <QTemporaryFile>
+
 // standard headers
-#include <forward_list>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 class QDataStream;
 
@@ -28,7 +35,11 @@ namespace info
 	public:
 		class Test;
 
-		typedef std::function<void(int machineCount, std::u8string_view machineName, std::u8string_view machineDescription)> ProcessXmlCallback;
+		typedef std::function<void(int machineCount, int reusedMachineCount, std::u8string_view machineName, std::u8string_view machineDescription)> ProcessXmlCallback;
+
+		// opens the input of a shard, hands it to readFunc and cleans up afterwards; shard zero is
+		// read on the thread calling process_xml() and every other shard on a thread of its own
+		typedef std::function<void(int shard, const std::function<void(QIODevice &input)> &readFunc)> ShardFunc;
 
 		// ctors
 		database_builder() = default;
@@ -37,10 +48,84 @@ namespace info
 
 		// methods
 		bool process_xml(QIODevice &stream, QString &error_message, const ProcessXmlCallback &progressCallback = { }) noexcept;
-		void emit_info(QIODevice &stream) const noexcept;
+		bool process_xml(int shardCount, const ShardFunc &shardFunc, QString &error_message, const ProcessXmlCallback &progressCallback = { }) noexcept;
+		bool emit_info(QIODevice &stream) const noexcept;
 		void dump() const noexcept;
 
+		// the number of threads parsing machines alongside the thread calling process_xml(); if
+		// zero, everything is parsed on the calling thread (the default is one per extra core)
+		void set_worker_count(int worker_count) noexcept	{ m_worker_count = worker_count; }
+
+		// an info DB from a previous run; machines whose -listxml output did not change get copied
+		// from it rather than being parsed again (it has to outlive the call to process_xml())
+		void set_previous_database(const info::database &previous_db) noexcept	{ m_previous_db = &previous_db; }
+
+		// whether emit_info() compresses the tables that are not needed at startup (the default)
+		void set_compress_cold_sections(bool compress) noexcept	{ m_compress_cold_sections = compress; }
+
+		// a device that receives the -listxml output as it was merged (a single document, even when
+		// there are several shards); building from that yields an identical info DB
+		void set_xml_copy(QIODevice *xml_copy) noexcept	{ m_xml_copy = xml_copy; }
+
+		// a directory for temporary files; if set, the tables that nothing looks at again until
+		// emit_info() get written out there as machines are merged rather than being held in
+		// memory, which bounds what it takes to build an info DB (the output is identical)
+		void set_spill_directory(const QString &spill_directory) noexcept	{ m_spill_directory = spill_directory; }
+
+		// how machines are parsed; XmlParser::Backend::Tokenizer is quicker, and falls back to expat
+		// on anything unusual (either way, the info DB is identical)
+		void set_xml_backend(XmlParser::Backend xml_backend) noexcept	{ m_xml_backend = xml_backend; }
+
 	private:
+		class worker_pool;
+		class listxml_splitter;
+		class listxml_shard;
+		struct machine_chunk;
+		struct machine_tables;
+
+		typedef std::function<void(std::span<const std::uint8_t> block)> BlockFunc;
+
+		// ======================> spill_file
+		// bytes written out to a temporary file rather than held in memory
+		class spill_file
+		{
+		public:
+			spill_file(const QString &directory);
+			void write(std::span<const std::uint8_t> data);
+			bool read(const BlockFunc &func) const;
+			std::uint64_t size() const noexcept	{ return m_size; }
+
+		private:
+			std::unique_ptr<QTemporaryFile>	m_file;
+			std::uint64_t					m_size;
+		};
+
+		// ======================> spillable_table
+		// a table that is only appended to until emit_info() reads it back in blocks; once spilling,
+		// every block's worth of records gets written out to a spill_file
+		template<typename T>
+		class spillable_table
+		{
+		public:
+			void spill(const QString &directory, std::size_t blockSize);
+			void reserve(std::size_t count);
+			T &emplace_back();
+			void append(std::span<const T> records);
+			bool read(const BlockFunc &func) const;
+			std::size_t size() const noexcept			{ return m_spilled_count + m_records.size(); }
+			std::size_t spilled_count() const noexcept	{ return m_spilled_count; }
+			std::size_t memory_usage() const noexcept	{ return m_records.capacity() * sizeof(T); }
+
+		private:
+			std::vector<T>				m_records;			// whatever has not been spilled
+			QString						m_spill_directory;
+			std::optional<spill_file>	m_spill_file;
+			std::size_t					m_block_count = 0;	// records per block
+			std::size_t					m_spilled_count = 0;
+
+			void flush();
+		};
+
 		// ======================> string_table
 		class string_table
 		{
@@ -49,6 +134,7 @@ namespace info
 
 			string_table() noexcept;
 			void shrinkToFit() noexcept;
+			std::size_t memory_usage() const noexcept;
 			std::uint32_t get(const char8_t *string) noexcept;
 			std::uint32_t get(const std::u8string &string) noexcept;
 			std::uint32_t get(const XmlParser::Attribute &attribute) noexcept;
@@ -57,38 +143,78 @@ namespace info
 			template<typename T> void embed_value(T value) noexcept;
 			void dumpStringSizeDistribution() const noexcept;
 			void dumpPrimaryBucketDistribution() const noexcept;
-			void dumpSecondaryBucketDistribution() const noexcept;
 
 		private:
-			typedef std::forward_list<std::uint32_t> SecondaryMapBucket;
+			// open addressing (Robin Hood) map entry; an offset of zero (where the magic bytes
+			// are) denotes an empty bucket
+			struct Bucket
+			{
+				std::uint32_t	m_hash;
+				std::uint32_t	m_offset;
+			};
 
 			std::vector<char8_t>								m_data;
-			std::unique_ptr<std::array<std::uint32_t, 550007>>	m_primaryMapBuckets;
-			std::vector<SecondaryMapBucket>						m_secondaryMapBuckets;
+			std::vector<Bucket>									m_buckets;
+			std::size_t											m_bucketsUsed;
 
 			std::uint32_t internalGet(std::span<const char8_t> string);
-			std::uint32_t &findBucket(std::u8string_view string);
+			std::uint32_t findOrInsert(std::span<const char8_t> string);
+			void insertBucket(Bucket bucket, std::size_t position, std::uint32_t distance) noexcept;
+			void resizeBuckets(std::size_t bucketCount);
+			std::uint32_t probeLength(std::size_t position) const noexcept;
 		};
 
-		info::binaries::header									m_salted_header;
+		info::binaries::header									m_header;
 		std::vector<info::binaries::machine>					m_machines;
-		std::vector<info::binaries::biosset>					m_biossets;
-		std::vector<info::binaries::rom>						m_roms;
-		std::vector<info::binaries::disk>						m_disks;
-		std::vector<info::binaries::device>						m_devices;
-		std::vector<info::binaries::slot>						m_slots;
-		std::vector<info::binaries::slot_option>				m_slot_options;
-		std::vector<info::binaries::feature>					m_features;
+		std::vector<info::binaries::machine_summary>			m_machine_summaries;
+		spillable_table<info::binaries::biosset>				m_biossets;
+		spillable_table<info::binaries::rom>					m_roms;
+		spillable_table<info::binaries::disk>					m_disks;
+		spillable_table<info::binaries::device>					m_devices;
+		spillable_table<info::binaries::slot>					m_slots;
+		spillable_table<info::binaries::slot_option>			m_slot_options;
+		spillable_table<info::binaries::feature>				m_features;
 		std::vector<info::binaries::chip>						m_chips;
-		std::vector<info::binaries::display>					m_displays;
-		std::vector<info::binaries::sample>						m_samples;
-		std::vector<info::binaries::configuration>				m_configurations;
-		std::vector<info::binaries::configuration_condition>	m_configuration_conditions;
-		std::vector<info::binaries::configuration_setting>		m_configuration_settings;
-		std::vector<info::binaries::software_list>				m_software_lists;
-		std::vector<info::binaries::ram_option>					m_ram_options;
+		spillable_table<info::binaries::display>				m_displays;
+		spillable_table<info::binaries::sample>					m_samples;
+		spillable_table<info::binaries::configuration>			m_configurations;
+		spillable_table<info::binaries::configuration_condition>	m_configuration_conditions;
+		spillable_table<info::binaries::configuration_setting>	m_configuration_settings;
+		spillable_table<info::binaries::software_list>			m_software_lists;
+		spillable_table<info::binaries::ram_option>				m_ram_options;
+		std::vector<info::binaries::posting_list>				m_posting_lists;
+		std::vector<std::uint32_t>								m_postings;
+		std::vector<std::uint32_t>								m_machine_name_buckets;
+		std::vector<std::uint32_t>								m_machine_name_slots;
+		std::vector<info::binaries::rom_hash>					m_rom_hashes;
+		std::vector<info::binaries::rom_hash_use>				m_rom_hash_uses;
+		std::vector<std::uint32_t>								m_rom_hash_slots;
+		std::vector<std::uint32_t>								m_rom_hash_indexes;		// parallel to m_roms, which may be spilled
+		std::unordered_multimap<std::uint32_t, std::uint32_t>	m_rom_hashes_by_crc32;
 		string_table											m_strings;
-
+		std::optional<int>										m_worker_count;
+		std::size_t												m_chunk_size = 262144;
+		const info::database *									m_previous_db = nullptr;
+		QIODevice *												m_xml_copy = nullptr;
+		std::unordered_set<std::uint32_t>						m_merged_machine_names;
+		QString													m_spill_directory;
+		std::size_t												m_spill_block_size = 262144;
+		std::size_t												m_peak_memory_usage = 0;
+		int														m_reused_machine_count = 0;
+		bool													m_compress_cold_sections = true;
+		XmlParser::Backend										m_xml_backend = XmlParser::Backend::Expat;
+
+		void merge_chunk(machine_chunk &chunk, const machine_tables *previousTables);
+		template<typename TStringFunc, typename TMachineFunc> void append_machine(const info::binaries::machine &sourceMachine, const machine_tables &source, TStringFunc &&str, TMachineFunc &&machineFunc);
+		machine_tables previous_tables() const;
+		const char8_t *previous_string(std::uint32_t strindex) const noexcept;
+		void build_posting_lists();
+		void build_machine_summaries();
+		void build_machine_name_index();
+		std::uint32_t intern_rom_hash(const info::binaries::rom_hash &hash);
+		void build_rom_hash_index();
+		std::size_t memory_usage() const noexcept;
+		void update_peak_memory_usage(std::size_t transient_usage = 0) noexcept;
 		void dumpTableSizes() const noexcept;
 	};
 }
@@ -0,0 +1,82 @@
+/***************************************************************************
+
+    infodbloadtask.cpp
+
+    Task for loading the info DB in the background
+
+***************************************************************************/
+
+// bletchmame headers
+#include "infodbloadtask.h"
+#include "listxmlcache.h"
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+QEvent::Type InfoDbLoadResultEvent::s_eventId = (QEvent::Type)QEvent::registerEventType();
+
+//-------------------------------------------------
+//  InfoDbLoadResultEvent ctor
+//-------------------------------------------------
+
+InfoDbLoadResultEvent::InfoDbLoadResultEvent(int cookie, info::database::snapshot &&snapshot)
+	: QEvent(s_eventId)
+	, m_cookie(cookie)
+	, m_snapshot(std::move(snapshot))
+{
+}
+
+
+//-------------------------------------------------
+//  InfoDbLoadTask ctor
+//-------------------------------------------------
+
+InfoDbLoadTask::InfoDbLoadTask(QString &&fileName, QString &&cacheFileName, QString &&expectedVersion, int cookie, bool spillTables)
+	: m_fileName(std::move(fileName))
+	, m_cacheFileName(std::move(cacheFileName))
+	, m_expectedVersion(std::move(expectedVersion))
+	, m_cookie(cookie)
+	, m_spillTables(spillTables)
+{
+}
+
+
+//-------------------------------------------------
+//  run
+//-------------------------------------------------
+
+void InfoDbLoadTask::run()
+{
+	// load and validate the info DB; nothing is published until the host gets the event
+	info::database::snapshot snapshot = info::database::prepare(m_fileName, m_expectedVersion);
+
+	// if that failed (most likely because a new version of BletchMAME changed the info DB
+	// format), try rebuilding it from the -listxml cache before anybody resorts to running MAME
+	if (!snapshot && !m_cacheFileName.isEmpty()
+		&& ListXmlCache::rebuildInfoDb(m_cacheFileName, m_fileName, m_expectedVersion, m_spillTables, [this] { return isInterruptionRequested(); }))
+	{
+		snapshot = info::database::prepare(m_fileName, m_expectedVersion);
+	}
+
+	// the machine list is the first thing the host will want, so decode the strings it
+	// shows while we're still off the main thread
+	if (snapshot)
+	{
+		info::database db(info::database::snapshot { snapshot });
+		for (info::machine machine : db.machines())
+		{
+			if (isInterruptionRequested())
+				break;
+			machine.name();
+			machine.description();
+			machine.manufacturer();
+			machine.year();
+		}
+	}
+
+	// and post the results
+	auto evt = std::make_unique<InfoDbLoadResultEvent>(m_cookie, std::move(snapshot));
+	postEventToHost(std::move(evt));
+}
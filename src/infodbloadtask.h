@@ -0,0 +1,69 @@
+/***************************************************************************
+
+    infodbloadtask.h
+
+    Task for loading the info DB in the background
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef INFODBLOADTASK_H
+#define INFODBLOADTASK_H
+
+// bletchmame headers
+#include "info.h"
+#include "task.h"
+
+// Qt headers
+#include <QEvent>
+
+
+//**************************************************************************
+//  TYPES
+//**************************************************************************
+
+// ======================> InfoDbLoadResultEvent
+
+class InfoDbLoadResultEvent : public QEvent
+{
+public:
+	// ctor
+	InfoDbLoadResultEvent(int cookie, info::database::snapshot &&snapshot);
+
+	// accessors
+	static QEvent::Type eventId()				{ return s_eventId; }
+	int cookie() const							{ return m_cookie; }
+	info::database::snapshot &snapshot()		{ return m_snapshot; }
+
+private:
+	static QEvent::Type			s_eventId;
+	int							m_cookie;
+	info::database::snapshot	m_snapshot;
+};
+
+
+//**************************************************************************
+//  TYPE DEFINITIONS
+//**************************************************************************
+
+// ======================> InfoDbLoadTask
+
+class InfoDbLoadTask : public Task
+{
+public:
+	// ctor
+	InfoDbLoadTask(QString &&fileName, QString &&cacheFileName, QString &&expectedVersion, int cookie, bool spillTables = false);
+
+protected:
+	virtual void run() override final;
+
+private:
+	QString		m_fileName;
+	QString		m_cacheFileName;
+	QString		m_expectedVersion;
+	int			m_cookie;
+	bool		m_spillTables;
+};
+
+#endif // INFODBLOADTASK_H
@@ -0,0 +1,328 @@
+/***************************************************************************
+
+    listxmlcache.cpp
+
+    Compressed cache of the output of '-listxml', so that the info DB can
+    be rebuilt without invoking MAME
+
+***************************************************************************/
+
+// bletchmame headers
+#include "listxmlcache.h"
+#include "info_builder.h"
+#include "xmlparser.h"
+
+// Qt headers
+#include <QDir>
+#include <QFileInfo>
+
+// dependency headers
+#include <zlib.h>
+
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+// the cache is a plain gzip stream, so it can be inspected with everyday tools
+static const int GZIP_WINDOW_BITS = MAX_WBITS + 16;
+
+static const std::size_t BUFFER_SIZE = 65536;
+
+// how much of the cache we look at to find the MAME version; this needs to be enough to
+// get past the DTD
+static const qint64 VERSION_PEEK_SIZE = 262144;
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  version - peeks at the cache and returns the
+//	version of MAME that produced it
+//-------------------------------------------------
+
+QString ListXmlCache::version(const QString &fileName)
+{
+	// read the beginning of the XML
+	Reader reader(fileName);
+	if (!reader.open(QIODevice::ReadOnly))
+		return { };
+	QByteArray prologue(VERSION_PEEK_SIZE, '\0');
+	qint64 prologueSize = reader.read(prologue.data(), prologue.size());
+	prologue.resize(std::max(prologueSize, (qint64)0));
+
+	// and parse it; the document is truncated so we expect an error but the root element
+	// will have been seen by then
+	QString result;
+	XmlParser xml;
+	xml.onElementBegin({ "mame" }, [&result](const XmlParser::Attributes &attributes)
+	{
+		const auto [build] = attributes.get("build");
+		result = build.as<QString>().value_or(QString());
+	});
+	xml.parseBytes(prologue.constData(), prologue.size());
+	return result;
+}
+
+
+//-------------------------------------------------
+//  rebuildInfoDb - builds an info DB out of the
+//	cache; this is how we recover when our own
+//	info DB format changes
+//-------------------------------------------------
+
+bool ListXmlCache::rebuildInfoDb(const QString &fileName, const QString &infoDbFileName, const QString &expectedVersion, bool spillTables, std::function<bool()> &&interruptionCheck)
+{
+	// only bother if the cache came from the MAME we expect
+	if (!QFileInfo(fileName).isFile())
+		return false;
+	if (!expectedVersion.isEmpty() && version(fileName) != expectedVersion)
+		return false;
+
+	// process the cached XML; like ListXmlTask, we only spill the bulkier tables next to the
+	// info DB if asked to keep memory usage down
+	Reader reader(fileName, std::move(interruptionCheck));
+	if (!reader.open(QIODevice::ReadOnly))
+		return false;
+	QDir dir = QFileInfo(infoDbFileName).dir();
+	if (!dir.exists())
+		QDir().mkpath(dir.absolutePath());
+	info::database_builder builder;
+	builder.set_xml_backend(XmlParser::Backend::Tokenizer);
+	if (spillTables && dir.exists())
+		builder.set_spill_directory(dir.absolutePath());
+	QString errorMessage;
+	if (!builder.process_xml(reader, errorMessage))
+		return false;
+
+	// and write out the info DB
+	QSaveFile file(infoDbFileName);
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+	return builder.emit_info(file) && file.commit();
+}
+
+
+//-------------------------------------------------
+//  Writer ctor
+//-------------------------------------------------
+
+ListXmlCache::Writer::Writer(const QString &fileName)
+	: m_file(fileName)
+	, m_stream(std::make_unique<z_stream>())
+	, m_buffer(BUFFER_SIZE)
+	, m_ok(false)
+{
+	// zlib does its own buffering
+	open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+
+	// failing to create the cache is not fatal; we just won't have one
+	QDir dir = QFileInfo(fileName).dir();
+	if (!dir.exists())
+		QDir().mkpath(dir.absolutePath());
+	m_ok = m_file.open(QIODevice::WriteOnly)
+		&& deflateInit2(m_stream.get(), Z_BEST_SPEED, Z_DEFLATED, GZIP_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+}
+
+
+//-------------------------------------------------
+//  Writer dtor
+//-------------------------------------------------
+
+ListXmlCache::Writer::~Writer()
+{
+	deflateEnd(m_stream.get());
+}
+
+
+//-------------------------------------------------
+//  Writer::commit - finishes the cache and puts it
+//	in place; should only be called once all input
+//	has been successfully processed
+//-------------------------------------------------
+
+bool ListXmlCache::Writer::commit()
+{
+	if (!m_ok || !deflate(nullptr, 0, Z_FINISH))
+		return false;
+	m_ok = false;
+	return m_file.commit();
+}
+
+
+//-------------------------------------------------
+//  Writer::isSequential
+//-------------------------------------------------
+
+bool ListXmlCache::Writer::isSequential() const
+{
+	return true;
+}
+
+
+//-------------------------------------------------
+//  Writer::readData
+//-------------------------------------------------
+
+qint64 ListXmlCache::Writer::readData(char *, qint64)
+{
+	return -1;
+}
+
+
+//-------------------------------------------------
+//  Writer::writeData
+//-------------------------------------------------
+
+qint64 ListXmlCache::Writer::writeData(const char *data, qint64 maxSize)
+{
+	if (m_ok && !deflate(data, maxSize, Z_NO_FLUSH))
+	{
+		// we could not write the cache; carry on without it
+		m_ok = false;
+		m_file.cancelWriting();
+	}
+	return m_ok ? maxSize : -1;
+}
+
+
+//-------------------------------------------------
+//  Writer::deflate
+//-------------------------------------------------
+
+bool ListXmlCache::Writer::deflate(const char *data, qint64 size, int flush)
+{
+	m_stream->next_in = (Bytef *)data;
+	m_stream->avail_in = (uInt)size;
+	int rc;
+	do
+	{
+		m_stream->next_out = (Bytef *)m_buffer.data();
+		m_stream->avail_out = (uInt)m_buffer.size();
+		rc = ::deflate(m_stream.get(), flush);
+		if (rc == Z_STREAM_ERROR)
+			return false;
+
+		qint64 outSize = (qint64)(m_buffer.size() - m_stream->avail_out);
+		if (outSize > 0 && m_file.write(m_buffer.data(), outSize) != outSize)
+			return false;
+	} while (m_stream->avail_out == 0 || (flush == Z_FINISH && rc != Z_STREAM_END));
+	return true;
+}
+
+
+//-------------------------------------------------
+//  Reader ctor
+//-------------------------------------------------
+
+ListXmlCache::Reader::Reader(const QString &fileName, std::function<bool()> &&interruptionCheck)
+	: m_file(fileName)
+	, m_interruptionCheck(std::move(interruptionCheck))
+	, m_stream(std::make_unique<z_stream>())
+	, m_buffer(BUFFER_SIZE)
+	, m_done(true)
+{
+}
+
+
+//-------------------------------------------------
+//  Reader dtor
+//-------------------------------------------------
+
+ListXmlCache::Reader::~Reader()
+{
+	close();
+}
+
+
+//-------------------------------------------------
+//  Reader::open
+//-------------------------------------------------
+
+bool ListXmlCache::Reader::open(OpenMode mode)
+{
+	if ((mode & QIODevice::WriteOnly) || !m_file.open(QIODevice::ReadOnly))
+		return false;
+
+	*m_stream = z_stream();
+	if (inflateInit2(m_stream.get(), GZIP_WINDOW_BITS) != Z_OK)
+	{
+		m_file.close();
+		return false;
+	}
+	m_done = false;
+	return QIODevice::open(mode | QIODevice::Unbuffered);
+}
+
+
+//-------------------------------------------------
+//  Reader::close
+//-------------------------------------------------
+
+void ListXmlCache::Reader::close()
+{
+	if (m_file.isOpen())
+	{
+		inflateEnd(m_stream.get());
+		m_file.close();
+	}
+	m_done = true;
+	QIODevice::close();
+}
+
+
+//-------------------------------------------------
+//  Reader::isSequential
+//-------------------------------------------------
+
+bool ListXmlCache::Reader::isSequential() const
+{
+	return true;
+}
+
+
+//-------------------------------------------------
+//  Reader::readData
+//-------------------------------------------------
+
+qint64 ListXmlCache::Reader::readData(char *data, qint64 maxSize)
+{
+	// being interrupted looks like corruption to the reader, which is what we want
+	if (m_interruptionCheck && m_interruptionCheck())
+		return -1;
+
+	m_stream->next_out = (Bytef *)data;
+	m_stream->avail_out = (uInt)std::min(maxSize, (qint64)std::numeric_limits<uInt>::max());
+	while (!m_done && m_stream->avail_out > 0)
+	{
+		// refill the input if we have to
+		if (m_stream->avail_in == 0)
+		{
+			qint64 inSize = m_file.read(m_buffer.data(), m_buffer.size());
+			if (inSize <= 0)
+				return -1;
+			m_stream->next_in = (Bytef *)m_buffer.data();
+			m_stream->avail_in = (uInt)inSize;
+		}
+
+		// and inflate
+		int rc = ::inflate(m_stream.get(), Z_NO_FLUSH);
+		if (rc == Z_STREAM_END)
+			m_done = true;
+		else if (rc != Z_OK)
+			return -1;
+	}
+	return (qint64)((char *)m_stream->next_out - data);
+}
+
+
+//-------------------------------------------------
+//  Reader::writeData
+//-------------------------------------------------
+
+qint64 ListXmlCache::Reader::writeData(const char *, qint64)
+{
+	return -1;
+}
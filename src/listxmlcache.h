@@ -0,0 +1,110 @@
+/***************************************************************************
+
+    listxmlcache.h
+
+    Compressed cache of the output of '-listxml', so that the info DB can
+    be rebuilt without invoking MAME
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef LISTXMLCACHE_H
+#define LISTXMLCACHE_H
+
+// Qt headers
+#include <QFile>
+#include <QIODevice>
+#include <QSaveFile>
+
+// standard headers
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct z_stream_s;
+
+
+//**************************************************************************
+//  TYPE DEFINITIONS
+//**************************************************************************
+
+// ======================> ListXmlCache
+
+class ListXmlCache
+{
+public:
+	class Test;
+	class Writer;
+	class Reader;
+
+	// statics
+	static QString version(const QString &fileName);
+	static bool rebuildInfoDb(const QString &fileName, const QString &infoDbFileName, const QString &expectedVersion, bool spillTables = false, std::function<bool()> &&interruptionCheck = { });
+};
+
+
+// ======================> ListXmlCache::Writer
+// compresses whatever is written to it (in practice, the -listxml output as the info DB
+// builder merged it) into the cache; nothing replaces the existing cache until commit()
+
+class ListXmlCache::Writer : public QIODevice
+{
+public:
+	// ctor/dtor
+	Writer(const QString &fileName);
+	Writer(const Writer &) = delete;
+	Writer(Writer &&) = delete;
+	~Writer();
+
+	// methods
+	bool commit();
+
+	// QIODevice overrides
+	virtual bool isSequential() const override;
+
+protected:
+	virtual qint64 readData(char *data, qint64 maxSize) override;
+	virtual qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+	QSaveFile						m_file;
+	std::unique_ptr<z_stream_s>		m_stream;
+	std::vector<char>				m_buffer;
+	bool							m_ok;
+
+	bool deflate(const char *data, qint64 size, int flush);
+};
+
+
+// ======================> ListXmlCache::Reader
+// reads back the decompressed contents of the cache
+
+class ListXmlCache::Reader : public QIODevice
+{
+public:
+	// ctor/dtor
+	Reader(const QString &fileName, std::function<bool()> &&interruptionCheck = { });
+	Reader(const Reader &) = delete;
+	Reader(Reader &&) = delete;
+	~Reader();
+
+	// QIODevice overrides
+	virtual bool open(OpenMode mode) override;
+	virtual void close() override;
+	virtual bool isSequential() const override;
+
+protected:
+	virtual qint64 readData(char *data, qint64 maxSize) override;
+	virtual qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+	QFile							m_file;
+	std::function<bool()>			m_interruptionCheck;
+	std::unique_ptr<z_stream_s>		m_stream;
+	std::vector<char>				m_buffer;
+	bool							m_done;
+};
+
+
+#endif // LISTXMLCACHE_H
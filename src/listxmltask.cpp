@@ -8,6 +8,7 @@
 
 // bletchmame headers
 #include "listxmltask.h"
+#include "listxmlcache.h"
 #include "perfprofiler.h"
 #include "xmlparser.h"
 #include "utility.h"
@@ -17,10 +18,14 @@
 // Qt headers
 #include <QCoreApplication>
 #include <QDir>
+#include <QProcess>
+#include <QSaveFile>
 
 // standard headers
+#include <algorithm>
 #include <unordered_map>
 #include <exception>
+#include <thread>
 
 
 //**************************************************************************
@@ -29,25 +34,64 @@
 
 QEvent::Type ListXmlProgressEvent::s_eventId = (QEvent::Type)QEvent::registerEventType();
 QEvent::Type ListXmlResultEvent::s_eventId = (QEvent::Type) QEvent::registerEventType();
+QEvent::Type ListXmlReleaseInfoDbEvent::s_eventId = (QEvent::Type)QEvent::registerEventType();
 
 
 //-------------------------------------------------
 //  ctor
 //-------------------------------------------------
 
-ListXmlTask::ListXmlTask(QString &&outputFilename)
+ListXmlTask::ListXmlTask(QString &&outputFilename, QString &&cacheFilename, int shardCount, bool spillTables)
 	: m_outputFilename(std::move(outputFilename))
+	, m_cacheFilename(std::move(cacheFilename))
+	, m_shardCount(shardCount)
+	, m_spillTables(spillTables)
 {
 }
 
 
+//-------------------------------------------------
+//  defaultShardCount - MAME generates -listxml
+//	output on a single core, so we run several MAME
+//	processes on different drivers; there is little
+//	point in going much further because each of them
+//	lists every device
+//-------------------------------------------------
+
+int ListXmlTask::defaultShardCount()
+{
+	return std::clamp((int)std::thread::hardware_concurrency() / 2, 1, 8);
+}
+
+
+//-------------------------------------------------
+//  shardPatterns - the -listxml patterns for a
+//	shard; driver names start with a letter or a digit
+//	and those get dealt out to the shards
+//-------------------------------------------------
+
+QStringList ListXmlTask::shardPatterns(int shardCount, int shard)
+{
+	const std::string_view firstCharacters = "abcdefghijklmnopqrstuvwxyz0123456789";
+
+	QStringList result;
+	for (std::size_t i = shard; i < firstCharacters.size(); i += shardCount)
+		result << QString("%1*").arg(QChar(firstCharacters[i]));
+	return result;
+}
+
+
 //-------------------------------------------------
 //  getArguments
 //-------------------------------------------------
 
 QStringList ListXmlTask::getArguments(const Preferences &) const
 {
-	return { "-listxml" };
+	// this is the first shard; run() starts the rest
+	QStringList result = { "-listxml" };
+	if (m_shardCount > 1)
+		result << shardPatterns(m_shardCount, 0);
+	return result;
 }
 
 
@@ -62,9 +106,9 @@ void ListXmlTask::run(std::optional<QProcess> &process)
 	ProfilerScope prof(CURRENT_FUNCTION);
 
 	// callback
-	auto progressCallback = [this](int count, std::u8string_view machineName, std::u8string_view machineDescription)
+	auto progressCallback = [this](int count, int reusedCount, std::u8string_view machineName, std::u8string_view machineDescription)
 	{
-		auto evt = std::make_unique<ListXmlProgressEvent>(count, util::toQString(machineName), util::toQString(machineDescription));
+		auto evt = std::make_unique<ListXmlProgressEvent>(count, reusedCount, util::toQString(machineName), util::toQString(machineDescription));
 		postEventToHost(std::move(evt));
 	};
 
@@ -72,8 +116,40 @@ void ListXmlTask::run(std::optional<QProcess> &process)
 	QString errorMessage;
 	if (process)
 	{
+		// the first shard is the process we were handed, and each of the others gets a process of
+		// its own; MAME lists all devices regardless of the patterns, so between them they cover everything
+		auto shardFunc = [this, &process](int shard, const std::function<void(QIODevice &)> &readFunc)
+		{
+			if (shard == 0)
+			{
+				readFunc(*process);
+			}
+			else
+			{
+				QStringList arguments = { "-listxml" };
+				arguments << shardPatterns(m_shardCount, shard);
+
+				// if this fails, the builder sees an empty document and reports an error
+				QProcess shardProcess;
+				startEmuProcess(shardProcess, arguments);
+				readFunc(shardProcess);
+
+				// if the builder gave up early, this MAME may be blocked writing to us
+				shardProcess.close();
+			}
+		};
+
 		// process
-		std::optional<ListXmlError> result = internalRun(*process, progressCallback);
+		std::optional<ListXmlError> result = internalRun(m_shardCount, shardFunc, progressCallback);
+
+		// should something have gone wrong with the shards, fall back to a single process
+		if (result && result->status() == ListXmlResultEvent::Status::ERROR && m_shardCount > 1 && !isInterruptionRequested())
+		{
+			QProcess fallbackProcess;
+			if (startEmuProcess(fallbackProcess, { "-listxml" }))
+				result = internalRun(fallbackProcess, progressCallback);
+		}
+
 		if (result)
 		{
 			// an exception has occurred
@@ -103,12 +179,54 @@ void ListXmlTask::run(std::optional<QProcess> &process)
 //-------------------------------------------------
 
 std::optional<ListXmlTask::ListXmlError> ListXmlTask::internalRun(QIODevice &process, const info::database_builder::ProcessXmlCallback &progressCallback)
+{
+	auto shardFunc = [&process](int, const std::function<void(QIODevice &)> &readFunc)
+	{
+		readFunc(process);
+	};
+	return internalRun(1, shardFunc, progressCallback);
+}
+
+
+//-------------------------------------------------
+//  internalRun
+//-------------------------------------------------
+
+std::optional<ListXmlTask::ListXmlError> ListXmlTask::internalRun(int shardCount, const info::database_builder::ShardFunc &shardFunc, const info::database_builder::ProcessXmlCallback &progressCallback)
 {
 	info::database_builder builder;
+	builder.set_xml_backend(XmlParser::Backend::Tokenizer);
+
+	// try creating the directory if its not present
+	QDir dir = QFileInfo(m_outputFilename).dir();
+	if (!dir.exists())
+		QDir().mkpath(dir.absolutePath());
+
+	// if asked to keep memory usage down, the bulkier tables get spilled next to the info DB rather
+	// than held in memory for the duration; unlike the temp directory, that is not liable to be
+	// backed by memory itself (this costs disk I/O, so it is not something we do by default)
+	if (m_spillTables && dir.exists())
+		builder.set_spill_directory(dir.absolutePath());
+
+	// if we have an info DB from a previous run, machines that have not changed can be copied
+	// from it; this has to be let go of before we replace the file
+	std::optional<info::database> previousDb(std::in_place);
+	if (previousDb->load(m_outputFilename))
+		builder.set_previous_database(*previousDb);
+
+	// if appropriate, keep a compressed copy of the XML; this lets us rebuild the info DB
+	// without invoking MAME when our own format changes
+	std::optional<ListXmlCache::Writer> cacheWriter;
+	if (!m_cacheFilename.isEmpty())
+	{
+		cacheWriter.emplace(m_cacheFilename);
+		builder.set_xml_copy(&*cacheWriter);
+	}
 
 	// first process the XML
 	QString error_message;
-	bool success = builder.process_xml(process, error_message, progressCallback);
+	bool success = builder.process_xml(shardCount, shardFunc, error_message, progressCallback);
+	previousDb.reset();
 
 	// before we check to see if there is a parsing error, check for an abort - under which
 	// scenario a parsing error is expected
@@ -119,30 +237,63 @@ std::optional<ListXmlTask::ListXmlError> ListXmlTask::internalRun(QIODevice &pro
 	if (!success)
 		return ListXmlError(ListXmlResultEvent::Status::ERROR, QString("Error parsing XML from MAME -listxml: %1").arg(error_message));
 
-	// try creating the directory if its not present
-	QDir dir = QFileInfo(m_outputFilename).dir();
-	if (!dir.exists())
-		QDir().mkpath(dir.absolutePath());
-
 	// we finally have all of the info accumulated; now we can get to business with writing
-	// to the actual file
-	QFile file(m_outputFilename);
+	// to the actual file - we write to a separate file and rename it into place because the
+	// existing info DB may be memory mapped and must not be truncated underneath the reader
+	QSaveFile file(m_outputFilename);
 	if (!file.open(QIODevice::WriteOnly))
 		return ListXmlError(ListXmlResultEvent::Status::ERROR, QString("Could not open file: %1").arg(m_outputFilename));
 
-	// emit the data and return
-	builder.emit_info(file);
+	// emit the data
+	if (!builder.emit_info(file))
+		return ListXmlError(ListXmlResultEvent::Status::ERROR, QString("Could not write file: %1").arg(m_outputFilename));
+
+	// and rename it into place, once the host has let go of the existing info DB if need be
+	if (!releaseInfoDb())
+		return ListXmlError(ListXmlResultEvent::Status::ABORTED);
+	if (!file.commit())
+		return ListXmlError(ListXmlResultEvent::Status::ERROR, QString("Could not write file: %1").arg(m_outputFilename));
+
+	// the cache is a nicety; failing to write it is not an error
+	if (cacheWriter)
+		cacheWriter->commit();
 	return { };
 }
 
 
+//-------------------------------------------------
+//  releaseInfoDb - the host keeps the existing info
+//	DB memory mapped while we run, and on Windows
+//	that precludes the file from being replaced; so
+//	there we ask the host to release it and wait
+//	until it has (or has dropped the request)
+//-------------------------------------------------
+
+bool ListXmlTask::releaseInfoDb()
+{
+#ifdef Q_OS_WINDOWS
+	using namespace std::chrono_literals;
+	std::promise<void> released;
+	std::future<void> future = released.get_future();
+	postEventToHost(std::make_unique<ListXmlReleaseInfoDbEvent>(std::move(released)));
+	while (future.wait_for(100ms) != std::future_status::ready)
+	{
+		if (isInterruptionRequested())
+			return false;
+	}
+#endif // Q_OS_WINDOWS
+	return true;
+}
+
+
 //-------------------------------------------------
 //  ListXmlProgressEvent ctor
 //-------------------------------------------------
 
-ListXmlProgressEvent::ListXmlProgressEvent(int machineCount, QString &&machineName, QString &&machineDescription)
+ListXmlProgressEvent::ListXmlProgressEvent(int machineCount, int reusedMachineCount, QString &&machineName, QString &&machineDescription)
 	: QEvent(eventId())
 	, m_machineCount(machineCount)
+	, m_reusedMachineCount(reusedMachineCount)
 	, m_machineName(std::move(machineName))
 	, m_machineDescription(std::move(machineDescription))
 {
@@ -162,6 +313,28 @@ ListXmlResultEvent::ListXmlResultEvent(Status status, QString &&errorMessage)
 }
 
 
+//-------------------------------------------------
+//  ListXmlReleaseInfoDbEvent ctor
+//-------------------------------------------------
+
+ListXmlReleaseInfoDbEvent::ListXmlReleaseInfoDbEvent(std::promise<void> &&released)
+	: QEvent(eventId())
+	, m_released(std::move(released))
+{
+}
+
+
+//-------------------------------------------------
+//  ListXmlReleaseInfoDbEvent::released - lets the
+//	task know that the info DB has been released
+//-------------------------------------------------
+
+void ListXmlReleaseInfoDbEvent::released()
+{
+	m_released.set_value();
+}
+
+
 //-------------------------------------------------
 //  ListXmlError ctor
 //-------------------------------------------------
@@ -18,6 +18,9 @@
 // Qt headers
 #include <QEvent>
 
+// standard headers
+#include <future>
+
 
 //**************************************************************************
 //  MACROS
@@ -39,17 +42,19 @@ class ListXmlProgressEvent : public QEvent
 {
 public:
 	// ctor
-	ListXmlProgressEvent(int machineCount, QString &&machineName, QString &&machineDescription);
+	ListXmlProgressEvent(int machineCount, int reusedMachineCount, QString &&machineName, QString &&machineDescription);
 
 	// accessors
 	static QEvent::Type eventId() { return s_eventId; }
 	int machineCount() const { return m_machineCount; }
+	int reusedMachineCount() const { return m_reusedMachineCount; }
 	const QString &machineName() const { return m_machineName; }
 	const QString &machineDescription() const { return m_machineDescription; }
 
 private:
 	static QEvent::Type	s_eventId;
 	int					m_machineCount;
+	int					m_reusedMachineCount;
 	QString				m_machineName;
 	QString				m_machineDescription;
 };
@@ -82,6 +87,26 @@ private:
 };
 
 
+// ======================> ListXmlReleaseInfoDbEvent
+
+class ListXmlReleaseInfoDbEvent : public QEvent
+{
+public:
+	// ctor
+	ListXmlReleaseInfoDbEvent(std::promise<void> &&released);
+
+	// accessors
+	static QEvent::Type eventId()			{ return s_eventId; }
+
+	// methods
+	void released();
+
+private:
+	static QEvent::Type	s_eventId;
+	std::promise<void>	m_released;
+};
+
+
 //**************************************************************************
 //  TYPE DEFINITIONS
 //**************************************************************************
@@ -94,7 +119,10 @@ public:
 	class Test;
 
 	// ctor
-	ListXmlTask(QString &&outputFilename);
+	ListXmlTask(QString &&outputFilename, QString &&cacheFilename = QString(), int shardCount = 1, bool spillTables = false);
+
+	// statics
+	static int defaultShardCount();
 
 protected:
 	virtual QStringList getArguments(const Preferences &) const override final;
@@ -117,8 +145,14 @@ private:
 	};
 
 	QString			m_outputFilename;
+	QString			m_cacheFilename;
+	int				m_shardCount;
+	bool			m_spillTables;
 
 	std::optional<ListXmlError> internalRun(QIODevice &process, const info::database_builder::ProcessXmlCallback &progressCallback = { });
+	std::optional<ListXmlError> internalRun(int shardCount, const info::database_builder::ShardFunc &shardFunc, const info::database_builder::ProcessXmlCallback &progressCallback);
+	static QStringList shardPatterns(int shardCount, int shard);
+	bool releaseInfoDb();
 };
 
 #endif // LISTXMLTASK_H
@@ -165,21 +165,6 @@ void MachineFolderTreeModel::refresh()
 }
 
 
-//-------------------------------------------------
-//  getBiosMachine
-//-------------------------------------------------
-
-static std::optional<info::machine> getBiosMachine(info::machine machine)
-{
-	std::optional<info::machine> cloneOf;
-	while (bool(cloneOf = machine.clone_of()))
-		machine = *cloneOf;
-
-	std::optional<info::machine> romOf = machine.rom_of();
-	return romOf && romOf->is_bios() ? romOf : std::nullopt;
-}
-
-
 //-------------------------------------------------
 //  containsDisplayType
 //-------------------------------------------------
@@ -249,72 +234,47 @@ void MachineFolderTreeModel::populateVariableFolders()
 		}
 	}
 
-	// sort function for machines
-	auto compareMachineDesc = [](const info::machine &lhs, const info::machine &rhs)
+	// the BIOS, CPU, manufacturer, sound, source and year folders come straight from the
+	// posting lists in the info DB; we only need to skip lists without runnable machines
+	auto hasRunnableMachines = [this](const info::posting_list &list)
 	{
-		return lhs.description() < rhs.description();
+		return std::ranges::any_of(list.machine_indexes(), [this](std::uint32_t machineIndex)
+		{
+			return m_infoDb.machines()[machineIndex].runnable();
+		});
 	};
-
-	// iterate through all machines and accumulate the pertinent data; because
-	// this can be expensive we're using reference wrappers
-	std::set<info::machine, decltype(compareMachineDesc)> bioses;
-	std::set<std::reference_wrapper<const QString>> cpus;
-	std::set<std::reference_wrapper<const QString>> manufacturers;
-	std::set<std::reference_wrapper<const QString>> sounds;
-	std::set<std::reference_wrapper<const QString>> sourceFiles;
-	std::set<std::reference_wrapper<const QString>> years;
-	for (info::machine machine : m_infoDb.machines())
+	auto populatePostingListFolders = [this, &hasRunnableMachines](std::vector<FolderEntry> &folders, info::posting_list::type_t type, FolderIcon icon)
 	{
-		if (machine.runnable())
+		folders.clear();
+		for (info::posting_list list : m_infoDb.posting_lists(type))
 		{
-			// manufacturer/source/year folders
-			manufacturers.emplace(machine.manufacturer());
-			sourceFiles.emplace(machine.sourcefile());
-			years.emplace(machine.year());
-
-			// cpu/sound folders
-			for (info::chip chip : machine.chips())
-			{
-				switch (chip.type())
-				{
-				case info::chip::type_t::CPU:
-					cpus.emplace(chip.name());
-					break;
-
-				case info::chip::type_t::AUDIO:
-					sounds.emplace(chip.name());
-					break;
-
-				default:
-					// ignore anything we don't know about
-					break;
-				}
-			}
-
-			// bios folder
-			std::optional<info::machine> biosMachine = getBiosMachine(machine);
-			if (biosMachine)
-				bioses.emplace(*biosMachine);
+			if (hasRunnableMachines(list))
+				folders.emplace_back(list.key(), icon, list.key(), info::posting_list::id{ type, list.key() });
 		}
-	}
+		folders.shrink_to_fit();
+	};
 
-	// set up the BIOSes folder
+	// set up the BIOSes folder; these are keyed by name but sorted by description
+	std::vector<info::machine> bioses;
+	for (info::posting_list list : m_infoDb.posting_lists(info::posting_list::type_t::BIOS))
+	{
+		std::optional<info::machine> bios = hasRunnableMachines(list)
+			? m_infoDb.find_machine(list.key())
+			: std::nullopt;
+		if (bios)
+			bioses.push_back(*bios);
+	}
+	std::sort(bioses.begin(), bioses.end(), [](const info::machine &lhs, const info::machine &rhs)
+	{
+		return lhs.description() < rhs.description();
+	});
 	m_bios.clear();
 	m_bios.reserve(bioses.size());
 	for (const info::machine &bios : bioses)
-	{
-		auto predicate = [bios](const info::machine &machine) { return getBiosMachine(machine) == bios; };
-		m_bios.emplace_back(bios.name(), FolderIcon::Folder, bios.description(), std::move(predicate));
-	}
+		m_bios.emplace_back(bios.name(), FolderIcon::Folder, bios.description(), info::posting_list::id{ info::posting_list::type_t::BIOS, bios.name() });
 
 	// set up the CPUs folder
-	m_cpu.clear();
-	m_cpu.reserve(cpus.size());
-	for (const QString &cpu : cpus)
-	{
-		auto predicate = [&cpu](const info::machine &machine) { return (bool) machine.find_chip(cpu); };
-		m_cpu.emplace_back(cpu, FolderIcon::Cpu, cpu, std::move(predicate));
-	}
+	populatePostingListFolders(m_cpu, info::posting_list::type_t::CPU, FolderIcon::Cpu);
 
 	// set up the custom folder
 	const auto &customFolders = m_prefs.getCustomFolders();
@@ -328,41 +288,11 @@ void MachineFolderTreeModel::populateVariableFolders()
 		m_custom.emplace_back(folderName, FolderIcon::Folder, folderName, std::move(predicate));
 	}	
 
-	// set up the manufacturers folder
-	m_manufacturer.clear();
-	m_manufacturer.reserve(manufacturers.size());
-	for (const QString &manufacturer : manufacturers)
-	{
-		auto predicate = [&manufacturer](const info::machine &machine) { return machine.manufacturer() == manufacturer; };
-		m_manufacturer.emplace_back(manufacturer, FolderIcon::Manufacturer, manufacturer, std::move(predicate));
-	}
-
-	// set up the CPUs folder
-	m_sound.clear();
-	m_sound.reserve(sounds.size());
-	for (const QString &sound : sounds)
-	{
-		auto predicate = [&sound](const info::machine &machine) { return (bool) machine.find_chip(sound); };
-		m_sound.emplace_back(sound, FolderIcon::Sound, sound, std::move(predicate));
-	}
-
-	// set up the sources folder
-	m_source.clear();
-	m_source.reserve(sourceFiles.size());
-	for (const QString &sourceFile : sourceFiles)
-	{
-		auto predicate = [&sourceFile](const info::machine &machine) { return machine.sourcefile() == sourceFile; };
-		m_source.emplace_back(sourceFile, FolderIcon::Source, sourceFile, std::move(predicate));
-	}
-
-	// set up the years folder
-	m_year.clear();
-	m_year.reserve(years.size());
-	for (const QString &year : years)
-	{
-		auto predicate = [&year](const info::machine &machine) { return machine.year() == year; };
-		m_year.emplace_back(year, FolderIcon::Year, year, std::move(predicate));
-	}
+	// set up the manufacturers, sounds, sources and years folders
+	populatePostingListFolders(m_manufacturer, info::posting_list::type_t::MANUFACTURER, FolderIcon::Manufacturer);
+	populatePostingListFolders(m_sound, info::posting_list::type_t::SOUND, FolderIcon::Sound);
+	populatePostingListFolders(m_source, info::posting_list::type_t::SOURCEFILE, FolderIcon::Source);
+	populatePostingListFolders(m_year, info::posting_list::type_t::YEAR, FolderIcon::Year);
 }
 
 
@@ -404,6 +334,24 @@ std::function<bool(const info::machine &machine)> MachineFolderTreeModel::getMac
 }
 
 
+//-------------------------------------------------
+//  getMachineCandidates - returns the posting list
+//	that machines must be in for the filter to even
+//	be considered, if any
+//-------------------------------------------------
+
+std::optional<info::posting_list::id> MachineFolderTreeModel::getMachineCandidates(const QModelIndex &index)
+{
+	std::optional<info::posting_list::id> result;
+	if (index.isValid())
+	{
+		const FolderEntry &entry = folderEntryFromModelIndex(index);
+		result = entry.machineCandidates();
+	}
+	return result;
+}
+
+
 //-------------------------------------------------
 //  pathFromModelIndex
 //-------------------------------------------------
@@ -624,16 +572,30 @@ MachineFolderTreeModel::FolderEntry::FolderEntry(const QString &id, FolderIcon i
 }
 
 
+//-------------------------------------------------
+//  FolderEntry ctor - for folders that come from a
+//	posting list; these lists cover every machine,
+//	so like any other folder we only show runnable
+//	machines
+//-------------------------------------------------
+
+MachineFolderTreeModel::FolderEntry::FolderEntry(const QString &id, FolderIcon icon, const QString &text, info::posting_list::id &&machineCandidates)
+	: FolderEntry(id, icon, text, [](const info::machine &machine) { return machine.runnable(); }, nullptr, std::move(machineCandidates))
+{
+}
+
+
 //-------------------------------------------------
 //  FolderEntry ctor
 //-------------------------------------------------
 
-MachineFolderTreeModel::FolderEntry::FolderEntry(const QString &id, FolderIcon icon, const QString &text, std::function<bool(const info::machine &machine)> &&filter, const std::vector<FolderEntry> *children)
+MachineFolderTreeModel::FolderEntry::FolderEntry(const QString &id, FolderIcon icon, const QString &text, std::function<bool(const info::machine &machine)> &&filter, const std::vector<FolderEntry> *children, std::optional<info::posting_list::id> &&machineCandidates)
 	: m_id(id)
 	, m_icon(icon)
 	, m_text(text)
 	, m_filter(filter)
 	, m_children(children)
+	, m_machineCandidates(std::move(machineCandidates))
 {
 }
 
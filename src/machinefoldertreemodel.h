@@ -18,6 +18,7 @@
 // standard headers
 #include <array>
 #include <functional>
+#include <optional>
 
 class Preferences;
 class FolderPrefs;
@@ -52,6 +53,7 @@ public:
 
 	// methods
 	std::function<bool(const info::machine &machine)> getMachineFilter(const QModelIndex &index);
+	std::optional<info::posting_list::id> getMachineCandidates(const QModelIndex &index);
 	QString pathFromModelIndex(const QModelIndex &index) const;
 	QModelIndex modelIndexFromPath(const QString &path) const;
 	QString customFolderForModelIndex(const QModelIndex &index) const;
@@ -91,6 +93,7 @@ private:
 		// ctor
 		template<typename TFunc> FolderEntry(const QString &id, FolderIcon icon, const QString &text, TFunc filter);
 		FolderEntry(const QString &id, FolderIcon icon, const QString &text, const std::vector<FolderEntry> &children);
+		FolderEntry(const QString &id, FolderIcon icon, const QString &text, info::posting_list::id &&machineCandidates);
 
 		// accessors
 		const QString &id() const { return m_id; }
@@ -98,9 +101,10 @@ private:
 		const QString &text() const { return m_text; }
 		const std::vector<FolderEntry> *children() const { return m_children; }
 		const std::function<bool(const info::machine &machine)> &filter() const { return m_filter; }
+		const std::optional<info::posting_list::id> &machineCandidates() const { return m_machineCandidates; }
 
 	private:
-		FolderEntry(const QString &id, FolderIcon icon, const QString &text, std::function<bool(const info::machine &machine)> &&filter, const std::vector<FolderEntry> *children);
+		FolderEntry(const QString &id, FolderIcon icon, const QString &text, std::function<bool(const info::machine &machine)> &&filter, const std::vector<FolderEntry> *children, std::optional<info::posting_list::id> &&machineCandidates = { });
 
 		// variables
 		QString												m_id;
@@ -108,6 +112,7 @@ private:
 		QString												m_text;
 		std::function<bool(const info::machine &machine)>	m_filter;
 		const std::vector<FolderEntry> *					m_children;
+		std::optional<info::posting_list::id>				m_machineCandidates;	// when set, the filter only applies to machines in this posting list
 	};
 
 	typedef std::array<const char *, util::enum_count<FolderIcon>()> FolderIconResourceNameArray;
@@ -59,9 +59,10 @@ info::machine MachineListItemModel::machineFromIndex(const QModelIndex &index) c
 //  setMachineFilter
 //-------------------------------------------------
 
-void MachineListItemModel::setMachineFilter(std::function<bool(const info::machine &machine)> &&machineFilter)
+void MachineListItemModel::setMachineFilter(std::function<bool(const info::machine &machine)> &&machineFilter, std::optional<info::posting_list::id> &&machineCandidates)
 {
 	m_machineFilter = std::move(machineFilter);
+	m_machineCandidatesId = std::move(machineCandidates);
 	populateIndexes();
 }
 
@@ -72,7 +73,8 @@ void MachineListItemModel::setMachineFilter(std::function<bool(const info::machi
 
 bool MachineListItemModel::isMachinePresent(const info::machine &machine) const
 {
-	return !m_machineFilter || m_machineFilter(machine);
+	return (!m_machineCandidatesId || (m_machineCandidates && m_machineCandidates->contains(machine)))
+		&& (!m_machineFilter || m_machineFilter(machine));
 }
 
 
@@ -130,23 +132,38 @@ void MachineListItemModel::populateIndexes()
 	ProfilerScope prof(CURRENT_FUNCTION);
 	beginResetModel();
 
+	// look up the posting list every time, because the info DB may have changed underneath us
+	m_machineCandidates = m_machineCandidatesId
+		? m_infoDb.find_posting_list(*m_machineCandidatesId)
+		: std::nullopt;
+
 	// prep the indexes
 	m_indexes.clear();
-	m_indexes.reserve(m_infoDb.machines().size());
+	m_indexes.reserve(m_machineCandidates ? m_machineCandidates->machine_indexes().size() : m_infoDb.machines().size());
 	m_reverseIndexes.clear();
 	m_reverseIndexes.reserve(m_indexes.size());
 
-	// add all indexes
-	for (int i = 0; i < m_infoDb.machines().size(); i++)
+	// we need to apply a filter (if we have one)
+	auto addIndex = [this](int index)
 	{
-		info::machine machine = m_infoDb.machines()[i];
-
-		// we need to apply a filter (if we have one)
-		if (isMachinePresent(machine))
+		info::machine machine = m_infoDb.machines()[index];
+		if (!m_machineFilter || m_machineFilter(machine))
 		{
 			m_reverseIndexes.insert({ std::reference_wrapper<const QString>(machine.name()), util::safe_static_cast<int>(m_indexes.size()) });
-			m_indexes.push_back(i);
+			m_indexes.push_back(index);
 		}
+	};
+
+	// add all indexes; if we have a posting list, we only need to look at the machines within it
+	if (m_machineCandidates)
+	{
+		for (std::uint32_t index : m_machineCandidates->machine_indexes())
+			addIndex(util::safe_static_cast<int>(index));
+	}
+	else if (!m_machineCandidatesId)
+	{
+		for (int i = 0; i < m_infoDb.machines().size(); i++)
+			addIndex(i);
 	}
 	m_indexes.shrink_to_fit();
 
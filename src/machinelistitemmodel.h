@@ -42,7 +42,7 @@ public:
 
 	// methods
 	info::machine machineFromIndex(const QModelIndex &index) const;
-	void setMachineFilter(std::function<bool(const info::machine &machine)> &&machineFilter);
+	void setMachineFilter(std::function<bool(const info::machine &machine)> &&machineFilter, std::optional<info::posting_list::id> &&machineCandidates = { });
 	void auditStatusChanged(const MachineIdentifier &identifier);
 	void allAuditStatusesChanged();
 
@@ -62,6 +62,8 @@ private:
 	info::database &									m_infoDb;
 	IconLoader *										m_iconLoader;
 	std::function<bool(const info::machine &machine)>	m_machineFilter;
+	std::optional<info::posting_list::id>				m_machineCandidatesId;
+	std::optional<info::posting_list>					m_machineCandidates;
 	std::vector<int>									m_indexes;
 	ReverseIndexMap										m_reverseIndexes;
 	std::function<void(info::machine)>					m_machineIconAccessedCallback;
@@ -961,7 +961,8 @@ void MainPanel::machineFoldersTreeViewSelectionChanged(const QItemSelection &new
 
 	// and configure the filter
 	auto machineFilter = machineFolderTreeModel().getMachineFilter(selectedIndex);
-	machineListItemModel().setMachineFilter(std::move(machineFilter));
+	auto machineCandidates = machineFolderTreeModel().getMachineCandidates(selectedIndex);
+	machineListItemModel().setMachineFilter(std::move(machineFilter), std::move(machineCandidates));
 
 	// update preferences
 	QString path = machineFolderTreeModel().pathFromModelIndex(selectedIndex);
@@ -1128,24 +1129,30 @@ void MainPanel::runAuditDialog(const Audit &audit, const QString &name, const QS
 
 
 //-------------------------------------------------
-//  setAuditStatuses
+//  setAuditStatuses - records audit results,
+//	returning how many machines are no longer of
+//	unknown status
 //-------------------------------------------------
 
-void MainPanel::setAuditStatuses(const std::vector<AuditResult> &results)
+std::size_t MainPanel::setAuditStatuses(const std::vector<AuditResult> &results)
 {
 	// update all statuses
+	std::size_t machinesNoLongerUnknown = 0;
 	for (const AuditResult &result : results)
 	{
 		// determine the type of audit
 		std::visit(util::overloaded
 		{
-			[this, &result](const MachineIdentifier &identifier)
+			[this, &result, &machinesNoLongerUnknown](const MachineIdentifier &identifier)
 			{
 				// does this machine audit result represent a change?
 				QString machineName = util::toQString(identifier.machineName());
-				if (m_prefs.getMachineAuditStatus(machineName) != result.status())
+				AuditStatus oldStatus = m_prefs.getMachineAuditStatus(machineName);
+				if (oldStatus != result.status())
 				{
 					// if so, record it
+					if (oldStatus == AuditStatus::Unknown)
+						machinesNoLongerUnknown++;
 					m_prefs.setMachineAuditStatus(machineName, result.status());
 					machineListItemModel().auditStatusChanged(identifier);
 				}
@@ -1164,6 +1171,7 @@ void MainPanel::setAuditStatuses(const std::vector<AuditResult> &results)
 			}
 		}, result.identifier());
 	}
+	return machinesNoLongerUnknown;
 }
 
 
@@ -80,7 +80,7 @@ public:
 	virtual void setVisible(bool visible) override;
 
 	// auditing
-	void setAuditStatuses(const std::vector<AuditResult> &results);
+	std::size_t setAuditStatuses(const std::vector<AuditResult> &results);
 	void machineAuditStatusesChanged();
 	void softwareAuditStatusesChanged();
 	void manualAudit(const info::machine &machine);
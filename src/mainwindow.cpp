@@ -15,6 +15,7 @@
 #include "audittask.h"
 #include "filedlgs.h"
 #include "focuswatchinghook.h"
+#include "infodbloadtask.h"
 #include "listxmltask.h"
 #include "runmachinetask.h"
 #include "versiontask.h"
@@ -596,10 +597,17 @@ MainWindow::MainWindow(QWidget *parent)
 	, m_mainPanel(nullptr)
 	, m_prefs(QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)))
 	, m_taskDispatcher(*this, m_prefs)
+	, m_infoDbLoadCookie(0)
+	, m_infoDbReleased(false)
+	, m_refreshInfoDbOnLoadFailure(false)
 	, m_auditQueue(m_prefs, m_info_db, m_auditSoftwareListCollection, 20)
+	, m_auditEngine([this](std::unique_ptr<QEvent> &&event) { QCoreApplication::postEvent(this, event.release()); }, &m_hashCache)
 	, m_auditTimer(nullptr)
-	, m_maximumConcurrentAuditTasks(std::thread::hardware_concurrency() * 3 + 8)
+	, m_maximumPendingAuditBatches(std::thread::hardware_concurrency() + 4)
 	, m_auditCursor(m_prefs)
+	, m_fullAuditInProgress(false)
+	, m_fullAuditCompleted(false)
+	, m_fullAuditUnknownCount(0)
 #if USE_PROFILER
 	, m_auditThroughputTracker(QCoreApplication::applicationDirPath() + "/auditthroughput.txt")
 #endif // USE_PROFILER
@@ -620,6 +628,11 @@ MainWindow::MainWindow(QWidget *parent)
 	// initial preferences read
 	m_prefs.load();
 
+	// load up the hashes of assets we've audited before; its fine if there are none
+	QString hashCachePath = m_prefs.getHashCachePath(false);
+	if (!hashCachePath.isEmpty())
+		m_hashCache.load(hashCachePath);
+
 	// set up the MainPanel - the UX code that is active outside the emulation
 	m_mainPanel = new MainPanel(
 		m_info_db,
@@ -767,6 +780,10 @@ MainWindow::MainWindow(QWidget *parent)
 	{
 		m_mainPanel->updateTabContents();
 		m_auditQueue.bumpCookie();
+
+		// the machines a full audit has to get to may have changed
+		if (m_fullAuditInProgress)
+			countFullAuditUnknowns();
 	});
 
 	// monitor general state
@@ -819,6 +836,8 @@ MainWindow::MainWindow(QWidget *parent)
 	// monitor bulk audit changes
 	connect(&m_prefs, &Preferences::bulkDroppedMachineAuditStatuses, this, [this]()
 	{
+		if (m_fullAuditInProgress)
+			countFullAuditUnknowns();
 		m_mainPanel->machineAuditStatusesChanged();
 		updateAuditTimer();
 	});
@@ -865,6 +884,18 @@ MainWindow::MainWindow(QWidget *parent)
 MainWindow::~MainWindow()
 {
 	m_prefs.save();
+
+	// stop auditing, so that nothing is added to the hash cache while we save it
+	m_auditEngine.stop();
+
+	// if everything was audited, whatever was not looked up is of no further use
+	if (m_fullAuditCompleted)
+		m_hashCache.prune();
+
+	// save the hash cache, if we've learned anything
+	QString hashCachePath = m_prefs.getHashCachePath();
+	if (m_hashCache.isDirty() && !hashCachePath.isEmpty())
+		m_hashCache.save(hashCachePath);
 }
 
 
@@ -1246,6 +1277,12 @@ void MainWindow::on_actionResetAuditingStatuses_triggered()
 	// reset machines and software
 	m_prefs.bulkDropMachineAuditStatuses();
 	m_prefs.bulkDropSoftwareAuditStatuses();
+
+	// everything is going to get audited again; take note of which hashes get used
+	m_hashCache.beginSweep();
+	m_fullAuditInProgress = true;
+	m_fullAuditCompleted = false;
+	countFullAuditUnknowns();
 }
 
 
@@ -1532,6 +1569,14 @@ bool MainWindow::event(QEvent *event)
 	{
 		result = onListXmlCompleted(static_cast<ListXmlResultEvent &>(*event));
 	}
+	else if (event->type() == ListXmlReleaseInfoDbEvent::eventId())
+	{
+		result = onListXmlReleaseInfoDb(static_cast<ListXmlReleaseInfoDbEvent &>(*event));
+	}
+	else if (event->type() == InfoDbLoadResultEvent::eventId())
+	{
+		result = onInfoDbLoadCompleted(static_cast<InfoDbLoadResultEvent &>(*event));
+	}
 	else if (event->type() == RunMachineCompletedEvent::eventId())
 	{
 		result = onRunMachineCompleted(static_cast<RunMachineCompletedEvent &>(*event));
@@ -1611,25 +1656,27 @@ void MainWindow::launchVersionCheck(bool promptIfMameNotFound)
 
 
 //-------------------------------------------------
-//  loadInfoDb
+//  loadInfoDb - kicks off loading the info DB on
+//	a worker thread; it gets published when the
+//	task completes
 //-------------------------------------------------
 
-bool MainWindow::loadInfoDb()
+void MainWindow::loadInfoDb(bool refreshOnFailure)
 {
 	// sanity check; bail if we're running
 	if (m_state)
-		return false;
-
-	// load the info DB
-	QString dbPath = m_prefs.getMameXmlDatabasePath();
-	bool success = m_info_db.load(dbPath, m_mameVersion? m_mameVersion->toString() : "");
+		return;
 
-	// special case for when we're starting up - if we successfully load Info DB but we have
-	// not determined the MAME version yet, lets assume that Info DB is correct
-	if (success && !m_mameVersion)
-		m_mameVersion = MameVersion(m_info_db.version());
+	// supersede any load that might already be in flight
+	m_infoDbLoadCookie++;
+	m_refreshInfoDbOnLoadFailure = refreshOnFailure;
 
-	return success;
+	// and launch the task
+	QString dbPath = m_prefs.getMameXmlDatabasePath();
+	QString cachePath = m_prefs.getListXmlCachePath();
+	QString expectedVersion = m_mameVersion ? m_mameVersion->toString() : "";
+	Task::ptr task = std::make_shared<InfoDbLoadTask>(std::move(dbPath), std::move(cachePath), std::move(expectedVersion), m_infoDbLoadCookie, m_prefs.getLowMemoryInfoDbRebuild());
+	m_taskDispatcher.launch(std::move(task));
 }
 
 
@@ -1660,9 +1707,15 @@ bool MainWindow::refreshMameInfoDatabase()
 	if (!IsMameExecutablePresent())
 		return false;
 
+	// the current info DB stays up while the task is running; the task asks for it to be
+	// released (which also disregards any load in flight) if that is necessary to replace
+	// the file
+	m_infoDbReleased = false;
+
 	// list XML
 	QString dbPath = m_prefs.getMameXmlDatabasePath();
-	Task::ptr task = std::make_shared<ListXmlTask>(std::move(dbPath));
+	QString cachePath = m_prefs.getListXmlCachePath();
+	Task::ptr task = std::make_shared<ListXmlTask>(std::move(dbPath), std::move(cachePath), ListXmlTask::defaultShardCount(), m_prefs.getLowMemoryInfoDbRebuild());
 	m_taskDispatcher.launch(task);
 
 	// callback to request interruptions when an emulation is running
@@ -1680,13 +1733,16 @@ bool MainWindow::refreshMameInfoDatabase()
 		dlg.exec();
 		if (dlg.result() != QDialog::DialogCode::Accepted)
 		{
+			// restore whatever DB we had before, if we had to let go of it
 			task->requestInterruption();
+			if (m_infoDbReleased)
+				loadInfoDb();
 			return false;
 		}
 	}
 
-	// we've succeeded; load the DB
-	return loadInfoDb();
+	// we've succeeded; onListXmlCompleted() has already started loading the DB
+	return true;
 }
 
 
@@ -2196,6 +2252,7 @@ bool MainWindow::onVersionCompleted(VersionResultEvent &event)
 	if (!m_mameVersion)
 	{
 		// no MAME found - reset the database
+		m_infoDbLoadCookie++;
 		m_info_db.reset();
 
 		// and prompt if that is in the plan
@@ -2204,12 +2261,8 @@ bool MainWindow::onVersionCompleted(VersionResultEvent &event)
 	}
 	else if (m_mameVersion->toString() != m_info_db.version())		
 	{
-		// we have MAME but need to load the database
-		if (!loadInfoDb())
-		{
-			// time to refresh the database
-			refreshMameInfoDatabase();
-		}
+		// we have MAME but need to load the database; if that fails it is time to refresh
+		loadInfoDb(true);
 	}
 
 	// we're done!
@@ -2217,6 +2270,35 @@ bool MainWindow::onVersionCompleted(VersionResultEvent &event)
 }
 
 
+//-------------------------------------------------
+//  onInfoDbLoadCompleted
+//-------------------------------------------------
+
+bool MainWindow::onInfoDbLoadCompleted(InfoDbLoadResultEvent &event)
+{
+	// ignore loads that have been superseded, or that finished after an emulation started
+	if (event.cookie() != m_infoDbLoadCookie || m_state)
+		return true;
+
+	if (event.snapshot())
+	{
+		// special case for when we're starting up - if we successfully load Info DB but we have
+		// not determined the MAME version yet, lets assume that Info DB is correct
+		if (!m_mameVersion)
+			m_mameVersion = MameVersion(event.snapshot().version());
+
+		// and publish it; the snapshot was fully loaded on the task, so this is just a swap
+		m_info_db.publish(std::move(event.snapshot()));
+	}
+	else if (m_refreshInfoDbOnLoadFailure)
+	{
+		// time to refresh the database
+		refreshMameInfoDatabase();
+	}
+	return true;
+}
+
+
 //-------------------------------------------------
 //  onListXmlProgress
 //-------------------------------------------------
@@ -2224,7 +2306,24 @@ bool MainWindow::onVersionCompleted(VersionResultEvent &event)
 bool MainWindow::onListXmlProgress(const ListXmlProgressEvent &event)
 {
 	if (m_currentLoadingDialog)
-		m_currentLoadingDialog->progress(event.machineName(), event.machineDescription());
+		m_currentLoadingDialog->progress(event.machineName(), event.machineDescription(), event.machineCount(), event.reusedMachineCount());
+	return true;
+}
+
+
+//-------------------------------------------------
+//  onListXmlReleaseInfoDb
+//-------------------------------------------------
+
+bool MainWindow::onListXmlReleaseInfoDb(ListXmlReleaseInfoDbEvent &event)
+{
+	// the info DB is memory mapped, and on some platforms (Windows) that precludes the
+	// file from being replaced; release it (and disregard any load in flight) so that
+	// the task can put the new one in place
+	m_infoDbLoadCookie++;
+	m_info_db.reset();
+	m_infoDbReleased = true;
+	event.released();
 	return true;
 }
 
@@ -2670,8 +2769,9 @@ void MainWindow::waitForStatusUpdate()
 
 void MainWindow::invokePing()
 {
-	// only issue a ping if there is an active session, and there is no ping in flight
-	if (!m_pinging && m_state)
+	// only issue a ping if there is an active session, and there is no ping in flight; and
+	// there is no need to ping plugins that push status changes on their own
+	if (!m_pinging && m_state && !m_currentRunMachineTask->statusPushEnabled())
 	{
 		m_pinging = true;
 		issue({ "ping" });
@@ -2927,6 +3027,7 @@ void MainWindow::auditDialogStarted(AuditDialog &auditDialog, std::shared_ptr<Au
 	m_currentAuditDialog.track(auditDialog);
 
 	// and dispatch the task
+	auditTask->setHashCache(&m_hashCache);
 	m_taskDispatcher.launch(std::move(auditTask));
 }
 
@@ -2958,15 +3059,16 @@ void MainWindow::auditTimerProc()
 
 void MainWindow::dispatchAuditTasks()
 {
-	// find out how many active tasks are present
-	std::size_t activeTaskCount = m_taskDispatcher.countActiveTasksByType<AuditTask>();
+	// find out how many batches the audit engine has on its plate
+	std::size_t pendingBatchCount = m_auditEngine.pendingBatchCount();
 
-	// spin up tasks
-	AuditTask::ptr auditTask;
-	while (activeTaskCount < m_maximumConcurrentAuditTasks && (auditTask = m_auditQueue.tryCreateAuditTask()) != nullptr)
+	// and feed it more; we only want to keep it busy enough that it is never idle, because
+	// anything we hand off can't be reprioritized
+	AuditBatch::ptr auditBatch;
+	while (pendingBatchCount < m_maximumPendingAuditBatches && (auditBatch = m_auditQueue.tryCreateAuditBatch()) != nullptr)
 	{
-		m_taskDispatcher.launch(std::move(auditTask));
-		activeTaskCount++;
+		m_auditEngine.submit(std::move(auditBatch));
+		pendingBatchCount++;
 	}
 
 	updateAuditTimer();
@@ -3106,6 +3208,41 @@ void MainWindow::addLowPriorityAudits()
 }
 
 
+//-------------------------------------------------
+//  countFullAuditUnknowns - counts the machines a
+//	full audit still has to get to; audit results
+//	keep the count up to date from there
+//-------------------------------------------------
+
+void MainWindow::countFullAuditUnknowns()
+{
+	m_fullAuditUnknownCount = 0;
+	for (info::machine machine : m_info_db.machines())
+	{
+		if (m_prefs.getMachineAuditStatus(machine.name()) == AuditStatus::Unknown)
+			m_fullAuditUnknownCount++;
+	}
+}
+
+
+//-------------------------------------------------
+//  checkFullAuditCompleted - a full audit is over
+//	once every machine has been audited again since
+//	the statuses were reset
+//-------------------------------------------------
+
+void MainWindow::checkFullAuditCompleted()
+{
+	if (!m_fullAuditInProgress || !m_auditCursor.isComplete() || m_auditQueue.hasUndispatched() || m_auditEngine.pendingBatchCount() > 0)
+		return;
+	if (m_info_db.machines().empty() || m_fullAuditUnknownCount > 0)
+		return;
+
+	m_fullAuditInProgress = false;
+	m_fullAuditCompleted = true;
+}
+
+
 //-------------------------------------------------
 //  onAuditResult
 //-------------------------------------------------
@@ -3116,11 +3253,17 @@ bool MainWindow::onAuditResult(const AuditResultEvent &event)
 	if (event.cookie() < 0 || event.cookie() == m_auditQueue.currentCookie())
 	{
 		// they do in fact match; update the statuses
-		m_mainPanel->setAuditStatuses(event.results());
+		std::size_t machinesNoLongerUnknown = m_mainPanel->setAuditStatuses(event.results());
+
+		// a full audit has that many fewer machines to get to
+		m_fullAuditUnknownCount -= std::min(machinesNoLongerUnknown, m_fullAuditUnknownCount);
 
 		// and report the results in the status bar
 		reportAuditResults(event.results());
 
+		// this might have been the last of a full audit
+		checkFullAuditCompleted();
+
 		// and measure throughput (if enabled)
 #if USE_PROFILER
 		m_auditThroughputTracker.mark(event.results().size());
@@ -11,8 +11,10 @@
 
 // bletchmame headers
 #include "auditcursor.h"
+#include "auditengine.h"
 #include "auditqueue.h"
 #include "devstatusdisplay.h"
+#include "hashcache.h"
 #include "imagemenu.h"
 #include "info.h"
 #include "mainpanel.h"
@@ -54,6 +56,8 @@ class MainPanel;
 class VersionResultEvent;
 class ListXmlProgressEvent;
 class ListXmlResultEvent;
+class ListXmlReleaseInfoDbEvent;
+class InfoDbLoadResultEvent;
 class AuditDialog;
 class LoadingDialog;
 class RunMachineCompletedEvent;
@@ -166,6 +170,9 @@ private:
 
 	// information retrieved by -listxml
 	info::database						m_info_db;
+	int									m_infoDbLoadCookie;
+	bool								m_infoDbReleased;
+	bool								m_refreshInfoDbOnLoadFailure;
 
 	// software lists
 	std::optional<software_list_collection>	m_runningSoftwareListCollection;
@@ -176,10 +183,15 @@ private:
 
 	// auditing
 	AuditQueue							m_auditQueue;
+	HashCache							m_hashCache;
+	AuditEngine							m_auditEngine;
 	software_list_collection			m_auditSoftwareListCollection;
 	QTimer *							m_auditTimer;
-	unsigned int						m_maximumConcurrentAuditTasks;
+	unsigned int						m_maximumPendingAuditBatches;
 	AuditCursor							m_auditCursor;
+	bool								m_fullAuditInProgress;
+	bool								m_fullAuditCompleted;
+	std::size_t							m_fullAuditUnknownCount;
 #if USE_PROFILER
 	ThroughputTracker					m_auditThroughputTracker;
 #endif // USE_PROFILER
@@ -201,6 +213,8 @@ private:
 	bool onVersionCompleted(VersionResultEvent &event);
 	bool onListXmlProgress(const ListXmlProgressEvent &event);
 	bool onListXmlCompleted(const ListXmlResultEvent &event);
+	bool onListXmlReleaseInfoDb(ListXmlReleaseInfoDbEvent &event);
+	bool onInfoDbLoadCompleted(InfoDbLoadResultEvent &event);
 	bool onRunMachineCompleted(const RunMachineCompletedEvent &event);
 	bool onStatusUpdate(StatusUpdateEvent &event);
 	bool onAuditResult(const AuditResultEvent &event);
@@ -221,7 +235,7 @@ private:
 	bool IsMameExecutablePresent() const;
 	void onGlobalPathEmuExecutableChanged(const QString& newPath);
 	void launchVersionCheck(bool promptIfMameNotFound);
-	bool loadInfoDb();
+	void loadInfoDb(bool refreshOnFailure = false);
 	bool promptForMameExecutable();
 	bool refreshMameInfoDatabase();
 	bool showStopEmulationWarning(StopWarningDialog::WarningType warningType);
@@ -278,6 +292,8 @@ private:
 	const QString *auditIdentifierString(const Identifier &identifier) const;
 	static QString auditStatusString(AuditStatus status);
 	void addLowPriorityAudits();
+	void countFullAuditUnknowns();
+	void checkFullAuditCompleted();
 };
 
 #endif // MAINWINDOW_H
@@ -78,8 +78,8 @@ void MameTask::prepare(Preferences &prefs, EventHandlerFunc &&eventHandler)
 	m_arguments = getArguments(prefs);
 
 	// slap on any extra arguments
-	const QString &extraArguments = prefs.getMameExtraArguments();
-	appendExtraArguments(m_arguments, extraArguments);
+	m_extraArguments = prefs.getMameExtraArguments();
+	appendExtraArguments(m_arguments, m_extraArguments);
 
 	// log the command line (if appropriate)
 	if (LOG_LAUNCH_COMMAND)
@@ -203,7 +203,7 @@ void MameTask::run()
 			waitingComplete = true;
 		});
 		while (!waitingComplete)
-			QCoreApplication::processEvents();
+			QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
 	}
 	else
 	{
@@ -216,6 +216,27 @@ void MameTask::run()
 }
 
 
+//-------------------------------------------------
+//  startEmuProcess
+//-------------------------------------------------
+
+bool MameTask::startEmuProcess(QProcess &process, const QStringList &arguments) const
+{
+	QStringList argv = arguments;
+	appendExtraArguments(argv, m_extraArguments);
+
+	process.setReadChannel(QProcess::StandardOutput);
+	process.start(m_program, argv);
+
+	// no PID? no process
+	qint64 processId = process.processId();
+	if (processId == 0)
+		return false;
+	s_job.addProcess(processId);
+	return true;
+}
+
+
 //-------------------------------------------------
 //  killActiveEmuProcess
 //-------------------------------------------------
@@ -76,12 +76,17 @@ protected:
 	// accesses the exit code
 	const std::optional<EmuExitCode> &emuExitCode() const { return m_emuExitCode; }
 
+	// starts an additional MAME process with the specified arguments (and the user's extra
+	// arguments) for tasks that want more than one; the process belongs to the calling thread
+	bool startEmuProcess(QProcess &process, const QStringList &arguments) const;
+
 private:
 	class ProcessLocker;
 
 	static Job					s_job;
 	QString						m_program;
 	QStringList					m_arguments;
+	QString						m_extraArguments;
 	QProcess *					m_activeProcess;
 	QMutex						m_activeProcessMutex;
 	std::optional<EmuExitCode>	m_emuExitCode;
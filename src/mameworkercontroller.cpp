@@ -11,7 +11,6 @@
 
 // Qt headers
 #include <QBuffer>
-#include <QDateTime>
 #include <QProcess>
 
 
@@ -28,46 +27,202 @@
 //  ctor
 //-------------------------------------------------
 
-MameWorkerController::MameWorkerController(QProcess &process, std::function<void(ChatterType, const QString &)> &&chatterCallback)
+MameWorkerController::MameWorkerController(QProcess &process, std::function<void(ChatterType, const QString &)> &&chatterCallback,
+	std::function<void(status::update &&)> &&statusPushCallback)
     : m_process(process)
 	, m_chatterCallback(std::move(chatterCallback))
+	, m_statusPushCallback(std::move(statusPushCallback))
+	, m_outstandingResponses(1)
+	, m_readingStatus(false)
 	, m_timedOut(false)
 {
+	// we are waiting for the inaugural response; if MAME goes quiet on us for too long while
+	// we are waiting for anything, we consider this to be irrecoverable
+	m_timeoutTimer.setSingleShot(true);
+	m_timeoutTimer.setInterval(TIMEOUT_SECONDS * 1000);
+	m_timeoutTimer.start();
+	QObject::connect(&m_timeoutTimer, &QTimer::timeout, &m_timeoutTimer, [this]()
+	{
+		m_timedOut = true;
+	});
+
+	// parse what MAME emits as it arrives; the timer is the context object, so this goes
+	// away with us
+	QObject::connect(&m_process, &QProcess::readyReadStandardOutput, &m_timeoutTimer, [this]()
+	{
+		readAvailableLines();
+	});
+}
+
+
+//-------------------------------------------------
+//  takeResponse - returns the next response if we
+//	have one (or if we never will), without blocking
+//-------------------------------------------------
+
+std::optional<MameWorkerController::Response> MameWorkerController::takeResponse()
+{
+	// pick up anything that arrived without us being told
+	readAvailableLines();
+
+	std::optional<Response> result;
+	if (!m_responses.empty())
+	{
+		result = std::move(m_responses.front());
+		m_responses.pop();
+	}
+	else if (m_timedOut)
+	{
+		result.emplace();
+		result->m_type = Response::Type::Error;
+		result->m_text = "Timeout waiting for response from MAME";
+	}
+	else if (m_process.state() != QProcess::ProcessState::Running)
+	{
+		result.emplace();
+		result->m_type = Response::Type::EndOfFile;
+	}
+	return result;
 }
 
 
 //-------------------------------------------------
-//  receiveResponse
+//  receiveResponse - blocks until the next response
 //-------------------------------------------------
 
 MameWorkerController::Response MameWorkerController::receiveResponse()
 {
-	static const util::enum_parser<Response::Type> s_response_type_parser =
+	// waitForReadyRead() emits readyReadStandardOutput, which feeds readAvailableLines()
+	std::optional<Response> response;
+	while (!(response = takeResponse()))
 	{
-		{ "@OK", Response::Type::Ok, },
-		{ "@ERROR", Response::Type::Error }
-	};
-	Response response;
+		if (!m_process.waitForReadyRead(m_timeoutTimer.remainingTime())
+			&& m_process.state() == QProcess::ProcessState::Running
+			&& m_timeoutTimer.remainingTime() == 0)
+		{
+			m_timedOut = true;
+		}
+	}
+	return std::move(*response);
+}
+
+
+//-------------------------------------------------
+//  negotiateProtocol - asks the plugin to speak
+//	PROTOCOL_VERSION; returns false if the plugin
+//	is too old to do so
+//-------------------------------------------------
+
+bool MameWorkerController::negotiateProtocol()
+{
+	issueCommand(QString("protocol %1\r\n").arg(PROTOCOL_VERSION));
+	Response response = receiveResponse();
+	return response.m_type == Response::Type::Ok;
+}
+
+
+//-------------------------------------------------
+//  isStatusPush
+//-------------------------------------------------
+
+bool MameWorkerController::isStatusPush(const QByteArray &line)
+{
+	return line.startsWith("@STATUS");
+}
+
+
+//-------------------------------------------------
+//  readAvailableLines
+//-------------------------------------------------
+
+void MameWorkerController::readAvailableLines()
+{
+	if (!m_process.canReadLine())
+		return;
+
+	// MAME is talking to us, so we are not timing out
+	if (m_outstandingResponses > 0)
+		m_timeoutTimer.start();
+
+	while (m_process.canReadLine())
+		processLine(m_process.readLine());
+}
+
+
+//-------------------------------------------------
+//  processLine
+//-------------------------------------------------
 
+void MameWorkerController::processLine(const QByteArray &line)
+{
 	// This logic is complicated for two reasons:
 	//
 	//	1.  MAME has a pesky habit of emitting human readable messages to standard output, therefore
 	//		we have a convention with the worker_ui plugin by which actual messages are preceeded with
 	//		an at-sign
 	//
-	//	2.  Qt's stream classes are weird, hence the existance of reallyReadLineFromProcess()
-	QString str;
-	do
+	//	2.  Status XML follows both some responses and status pushes (which can arrive at any time,
+	//		including ahead of the response we are waiting for)
+	if (m_readingStatus)
 	{
-		str = reallyReadLineFromProcess();
-	} while (!str.isEmpty() && str[0] != '@');
-
-	// special case; check for EOF
-	if (str.isEmpty())
+		// because XmlParser::parse() is not smart enough to read until XML ends, we are using this
+		// crude mechanism to find where the XML ends
+		m_statusXml += line;
+		if (line.startsWith("</"))
+		{
+			m_readingStatus = false;
+			status::update update = readStatus();
+			if (m_statusResponse)
+			{
+				m_statusResponse->m_update.emplace(std::move(update));
+				pushResponse(std::move(*m_statusResponse));
+				m_statusResponse.reset();
+			}
+			else if (m_statusPushCallback)
+			{
+				m_statusPushCallback(std::move(update));
+			}
+		}
+	}
+	else if (isStatusPush(line))
+	{
+		if (LOG_RESPONSES)
+			qDebug("MameWorkerController::processLine(): received status push '%s'", line.trimmed().constData());
+		callChatterCallback(ChatterType::GoodResponse, QString::fromUtf8(line));
+		m_readingStatus = true;
+	}
+	else if (line.startsWith('@'))
 	{
-		response.m_type = Response::Type::EndOfFile;
-		return response;
+		// did we get a status reponse?  if so we need to read the status before it is complete
+		Response response = parseResponse(line);
+		if (response.m_update)
+		{
+			m_statusResponse = std::move(response);
+			m_readingStatus = true;
+		}
+		else
+		{
+			pushResponse(std::move(response));
+		}
 	}
+}
+
+
+//-------------------------------------------------
+//  parseResponse - parses a response line; if the
+//	response has a status, an empty update is
+//	emplaced as a placeholder
+//-------------------------------------------------
+
+MameWorkerController::Response MameWorkerController::parseResponse(const QByteArray &line)
+{
+	static const util::enum_parser<Response::Type> s_response_type_parser =
+	{
+		{ "@OK", Response::Type::Ok, },
+		{ "@ERROR", Response::Type::Error }
+	};
+	Response response;
+	QString str = QString::fromUtf8(line);
 
 	// start interpreting the response; first get the text
 	int index = str.indexOf('#');
@@ -94,112 +249,45 @@ MameWorkerController::Response MameWorkerController::receiveResponse()
 
 	// logging and chatter
 	if (LOG_RESPONSES)
-		qDebug("RunMachineTask::receiveResponse(): received '%s'", str.trimmed().toStdString().c_str());
+		qDebug("MameWorkerController::parseResponse(): received '%s'", str.trimmed().toStdString().c_str());
 	callChatterCallback(
 		response.m_type == Response::Type::Ok ? ChatterType::GoodResponse : ChatterType::ErrorResponse,
 		str);
 
 	// did we get a status reponse
 	if (response.m_type == Response::Type::Ok && args.size() >= 2 && args[1] == "STATUS")
-		readStatusIntoResponse(response);
+		response.m_update.emplace();
 
 	return response;
 }
 
 
 //-------------------------------------------------
-//  readStatusIntoResponse
+//  pushResponse
 //-------------------------------------------------
 
-void MameWorkerController::readStatusIntoResponse(Response &response)
+void MameWorkerController::pushResponse(Response &&response)
 {
-	// read the status
-	status::update update = readStatus();
+	m_responses.push(std::move(response));
 
-	// if we timed out, report that error
-	if (m_timedOut)
-	{
-		response.m_type = Response::Type::Error;
-		response.m_text = "Timeout waiting for status update from MAME";
-		return;
-	}
-
-	// emplace the status update into the response
-	response.m_update.emplace(std::move(update));
+	// stop the clock if we are not waiting for anything else
+	if (m_outstandingResponses > 0 && --m_outstandingResponses == 0)
+		m_timeoutTimer.stop();
 }
 
 
 //-------------------------------------------------
-//  readStatus - read status XML from a process
+//  readStatus - read the status XML that we have
+//	accumulated
 //-------------------------------------------------
 
 status::update MameWorkerController::readStatus()
 {
-	bool done = false;
-	QBuffer buffer;
-
-	// open the buffer
-	buffer.open(QIODevice::ReadWrite);
-
-	// because XmlParser::parse() is not smart enough to read until XML ends, we are using this
-	// crude mechanism to read the XML while leaving everything else intact
-	while (!done)
-	{
-		QString line = reallyReadLineFromProcess();
-		buffer.write(line.toUtf8());
-
-		if (line.isEmpty() || line.startsWith("</"))
-			done = true;
-	}
-
-	// now that we have our own private buffer, read it
-	buffer.seek(0);
-	return status::update::read(buffer);
-}
-
-
-//-------------------------------------------------
-//  reallyReadLineFromProcess - read a line from
-//	a QProcess, all the while attempting to accomodate
-//	the behavior of QProcess
-//-------------------------------------------------
-
-QString MameWorkerController::reallyReadLineFromProcess()
-{
-	QDateTime readStartDateTime = QDateTime::currentDateTime();
-	QDateTime timeoutDateTime = readStartDateTime.addSecs(TIMEOUT_SECONDS);
-
-	// Qt's stream classes are very clunky.  There seems to be an assumption that the caller
-	// wants something very simple (e.g. - read all input from a process), or wants something
-	// very asynchronous event driven
-	//
-	// The consequence is that there are a bunch of unwanted behaviors from our perspective (as
-	// a thread synchronously interacting with MAME) and this method is an attempt to isolate
-	// these behaviors to provide an illusion of a simple, blocking text reader
-
-	// loop while the process is running - because readLine() can return an empty string we
-	// need to keep on tryin'
-	QString result;
-	while (result.isEmpty() && !m_timedOut && m_process.state() == QProcess::ProcessState::Running)
-	{
-		if (!m_process.canReadLine())
-		{
-			// yes Qt, we _really_ want to block!  whole heartedly!  but at the same time we
-			// don't want to block forever without any escape
-			m_process.waitForReadyRead(50);
-		}
-
-		// read a line if we can
-		if (m_process.canReadLine())
-		{
-			result = m_process.readLine();
-		}
-		else if (QDateTime::currentDateTime() >= timeoutDateTime)
-		{
-			// bummer, we've timed out!  we consider this to be irrecoverable
-			m_timedOut = true;
-		}
-	}
+	QBuffer buffer(&m_statusXml);
+	buffer.open(QIODevice::ReadOnly);
+	status::update result = status::update::read(buffer);
+	buffer.close();
+	m_statusXml.clear();
 	return result;
 }
 
@@ -214,6 +302,10 @@ void MameWorkerController::issueCommand(const QString &command)
 		qDebug("MameWorkerController::issueCommand(): command='%s'", command.trimmed().toStdString().c_str());
 	callChatterCallback(ChatterType::Command, command);
 
+	// start the clock if we were not already waiting for something
+	if (m_outstandingResponses++ == 0)
+		m_timeoutTimer.start();
+
 	m_process.write(command.toUtf8());
 }
 
@@ -14,9 +14,11 @@
 
 // Qt headers
 #include <QString>
+#include <QTimer>
 
 // standard headers
 #include <optional>
+#include <queue>
 
 
 QT_BEGIN_NAMESPACE
@@ -25,6 +27,8 @@ QT_END_NAMESPACE
 
 
 // ======================> MameWorkerController
+// parses what MAME emits as it arrives (readyRead drives this), so callers that run an event
+// loop can pick up responses with takeResponse() without ever blocking
 
 class MameWorkerController
 {
@@ -51,23 +55,42 @@ public:
 		ErrorResponse
 	};
 
+	// the protocol version that we ask the worker_ui plugin for; version 2 plugins push
+	// status changes (and only the changes) on their own, older ones have to be pinged
+	static const int PROTOCOL_VERSION = 2;
+
 	// ctor
-	MameWorkerController(QProcess &process, std::function<void(ChatterType, const QString &)> &&chatterCallback);
+	MameWorkerController(QProcess &process, std::function<void(ChatterType, const QString &)> &&chatterCallback,
+		std::function<void(status::update &&)> &&statusPushCallback = { });
+	MameWorkerController(const MameWorkerController &) = delete;
+	MameWorkerController(MameWorkerController &&) = delete;
 
 	// methods
+	std::optional<Response> takeResponse();
 	Response receiveResponse();
+	bool negotiateProtocol();
 	void issueCommand(const QString &command);
 	QString scrapeMameStartupError();
 
 private:
     QProcess &											m_process;
 	std::function<void(ChatterType, const QString &)>	m_chatterCallback;
+	std::function<void(status::update &&)>				m_statusPushCallback;
+	QTimer												m_timeoutTimer;
+	int													m_outstandingResponses;
+	std::queue<Response>								m_responses;
+	std::optional<Response>								m_statusResponse;
+	bool												m_readingStatus;
+	QByteArray											m_statusXml;
 	bool												m_timedOut;
 
 	// private methods
-	void readStatusIntoResponse(Response &response);
+	static bool isStatusPush(const QByteArray &line);
+	void readAvailableLines();
+	void processLine(const QByteArray &line);
+	Response parseResponse(const QByteArray &line);
+	void pushResponse(Response &&response);
 	status::update readStatus();
-	QString reallyReadLineFromProcess();
 	void callChatterCallback(ChatterType chatterType, const QString &text) const;
 };
 
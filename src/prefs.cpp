@@ -346,6 +346,7 @@ void Preferences::setGlobalInfo(Preferences::GlobalUiInfo &&globalInfo)
 	setWindowBarsShown(globalInfo.m_windowBarsShown);
 	setAuditingState(globalInfo.m_auditingState);
 	setShowStopEmulationWarning(globalInfo.m_showStopEmulationWarning);
+	setLowMemoryInfoDbRebuild(globalInfo.m_lowMemoryInfoDbRebuild);
 }
 
 
@@ -939,11 +940,12 @@ bool Preferences::load(QIODevice &input)
 	xml.onElementBegin({ "preferences" }, [&](const XmlParser::Attributes &attributes)
 	{
 		// windowBarsShown is called menu_bar_shown in the XML for purely historical reasons
-		const auto [windowBarsShown, windowStateAttr, selectedTabAttr, auditing, showStopEmulationWarning] = attributes.get("menu_bar_shown", "window_state", "selected_tab", "auditing", "show_stop_emulation_warning");
+		const auto [windowBarsShown, windowStateAttr, selectedTabAttr, auditing, showStopEmulationWarning, lowMemoryInfoDbRebuild] = attributes.get("menu_bar_shown", "window_state", "selected_tab", "auditing", "show_stop_emulation_warning", "low_memory_info_db_rebuild");
 
 		globalUiInfo.m_windowBarsShown = windowBarsShown.as<bool>().value_or(globalUiInfo.m_windowBarsShown);
 		globalUiInfo.m_auditingState = auditing.as<AuditingState>(s_auditingStateParser).value_or(globalUiInfo.m_auditingState);
 		globalUiInfo.m_showStopEmulationWarning = showStopEmulationWarning.as<bool>().value_or(globalUiInfo.m_showStopEmulationWarning);
+		globalUiInfo.m_lowMemoryInfoDbRebuild = lowMemoryInfoDbRebuild.as<bool>().value_or(globalUiInfo.m_lowMemoryInfoDbRebuild);
 
 		std::optional<WindowState> windowState = windowStateAttr.as<WindowState>(s_windowState_parser);
 		if (windowState)
@@ -1176,6 +1178,7 @@ void Preferences::save(QIODevice &output)
 	writer.writeAttribute("selected_tab", s_list_view_type_parser[getSelectedTab()]);
 	writer.writeAttribute("auditing", s_auditingStateParser[getAuditingState()]);
 	writer.writeAttribute("show_stop_emulation_warning", QString::number(getShowStopEmulationWarning() ? 1 : 0));
+	writer.writeAttribute("low_memory_info_db_rebuild", QString::number(getLowMemoryInfoDbRebuild() ? 1 : 0));
 
 	// paths
 	writer.writeComment("Paths");
@@ -1446,6 +1449,45 @@ QString Preferences::getMameXmlDatabasePath(bool ensure_directory_exists) const
 }
 
 
+//-------------------------------------------------
+//  getListXmlCachePath - the compressed -listxml
+//	output that the info DB was built from
+//-------------------------------------------------
+
+QString Preferences::getListXmlCachePath() const
+{
+	// do we have a config directory?
+	if (!m_configDirectory)
+		return "";
+
+	// like the info DB, this is specific to the emulator executable
+	const QString &emuExecutablePath = getGlobalPath(Preferences::global_path_type::EMU_EXECUTABLE);
+	if (emuExecutablePath.isEmpty())
+		return "";
+	QString emuExecutableBaseName = QFileInfo(emuExecutablePath).baseName();
+	return m_configDirectory->filePath(emuExecutableBaseName + ".listxml.gz");
+}
+
+
+//-------------------------------------------------
+//  getHashCachePath
+//-------------------------------------------------
+
+QString Preferences::getHashCachePath(bool ensureDirectoryExists) const
+{
+	// do we have a config directory?
+	if (!m_configDirectory)
+		return "";
+
+	// if appropriate, ensure the directory is present
+	if (ensureDirectoryExists && !m_configDirectory->exists())
+		m_configDirectory->mkpath(".");
+
+	// the hash cache is shared by all emulators
+	return m_configDirectory->filePath("hashcache.bin");
+}
+
+
 //-------------------------------------------------
 //  getPreferencesFileName
 //-------------------------------------------------
@@ -1476,6 +1518,7 @@ Preferences::GlobalUiInfo::GlobalUiInfo()
 	: m_windowBarsShown(true)
 	, m_auditingState(AuditingState::Default)
 	, m_showStopEmulationWarning(true)
+	, m_lowMemoryInfoDbRebuild(false)
 {
 }
 
@@ -213,6 +213,9 @@ public:
 	bool getShowStopEmulationWarning() const															{ return m_globalUiInfo.m_showStopEmulationWarning;	}
 	void setShowStopEmulationWarning(bool show)															{ m_globalUiInfo.m_showStopEmulationWarning = show;	}
 
+	bool getLowMemoryInfoDbRebuild() const																{ return m_globalUiInfo.m_lowMemoryInfoDbRebuild; }
+	void setLowMemoryInfoDbRebuild(bool lowMemory)														{ m_globalUiInfo.m_lowMemoryInfoDbRebuild = lowMemory; }
+
 	const QString &getMachinePath(const QString &machine_name, machine_path_type path_type) const;
 	void setMachinePath(const QString &machine_name, machine_path_type path_type, QString &&path);
 
@@ -231,6 +234,8 @@ public:
 	void setMameIniImportActionPreference(global_path_type type, const std::optional<MameIniImportActionPreference> &importActionPreference);
 
 	QString getMameXmlDatabasePath(bool ensure_directory_exists = true) const;
+	QString getListXmlCachePath() const;
+	QString getHashCachePath(bool ensureDirectoryExists = true) const;
 	QString applySubstitutions(const QString &path) const;
 	static QString internalApplySubstitutions(const QString &src, std::function<QString(const QString &)> func);
 
@@ -277,6 +282,7 @@ private:
 		bool																					m_windowBarsShown;
 		AuditingState																			m_auditingState;
 		bool																					m_showStopEmulationWarning;
+		bool																					m_lowMemoryInfoDbRebuild;
 	};
 
 	// info pertinent to global paths state
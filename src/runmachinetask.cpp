@@ -13,6 +13,7 @@
 #include "prefs.h"
 
 // Qt headers
+#include <QAbstractEventDispatcher>
 #include <QTextStream>
 #include <QWidget>
 #include <QCoreApplication>
@@ -48,33 +49,6 @@
 #endif
 
 
-//**************************************************************************
-//  TYPES
-//**************************************************************************
-
-namespace
-{
-	// ======================> IssueCommandEvent
-
-	class IssueCommandEvent : public QEvent
-	{
-	public:
-		IssueCommandEvent(QString &&command)
-			: QEvent(s_eventId)
-			, m_command(std::move(command))
-		{
-		}
-
-		static QEvent::Type eventId() { return s_eventId; }
-		QString &command() { return m_command; }
-
-	private:
-		static QEvent::Type		s_eventId;
-		QString					m_command;
-	};
-}
-
-
 //**************************************************************************
 //  VARIABLES
 //**************************************************************************
@@ -82,7 +56,6 @@ namespace
 QEvent::Type RunMachineCompletedEvent::s_eventId = (QEvent::Type) QEvent::registerEventType();
 QEvent::Type StatusUpdateEvent::s_eventId = (QEvent::Type) QEvent::registerEventType();
 QEvent::Type ChatterEvent::s_eventId = (QEvent::Type) QEvent::registerEventType();
-QEvent::Type IssueCommandEvent::s_eventId = (QEvent::Type)QEvent::registerEventType();
 
 
 //**************************************************************************
@@ -99,6 +72,7 @@ RunMachineTask::RunMachineTask(info::machine machine, QString &&software, std::m
 	, m_slotOptions(std::move(slotOptions))
     , m_attachWindowParameter(std::move(attachWindowParameter))
 	, m_chatterEnabled(false)
+	, m_statusPushEnabled(false)
 	, m_startedWithHashPaths(false)
 {
 }
@@ -202,9 +176,12 @@ void RunMachineTask::internalIssueCommand(QString &&command)
 	if (LOG_POST)
 		qDebug("RunMachineTask::internalIssueCommand(): command='%s'", command.trimmed().toStdString().c_str());
 
-	// post this event to the task
-	auto evt = std::make_unique<IssueCommandEvent>(std::move(command));
-	postEventToTask(std::move(evt));
+	// queue the command, and wake up the task if it is waiting for events
+	std::unique_lock lock(m_commandQueueMutex);
+	m_commandQueue.push(std::move(command));
+	QAbstractEventDispatcher *dispatcher = eventDispatcher();
+	if (dispatcher)
+		dispatcher->wakeUp();
 }
 
 
@@ -239,26 +216,6 @@ QString RunMachineTask::buildCommand(const std::vector<QString> &args)
 //  CLIENT THREAD OPERATIONS
 //**************************************************************************
 
-//-------------------------------------------------
-//  event
-//-------------------------------------------------
-
-bool RunMachineTask::event(QEvent *event)
-{
-	std::optional<bool> result = { };
-	if (event->type() == IssueCommandEvent::eventId())
-	{
-		IssueCommandEvent &issueCommandEvent = *static_cast<IssueCommandEvent *>(event);
-		m_commandQueue.push(std::move(issueCommandEvent.command()));
-		result = true;
-	}
-
-	return result
-		? *result
-		: MameTask::event(event);
-}
-
-
 //-------------------------------------------------
 //  run
 //-------------------------------------------------
@@ -278,6 +235,11 @@ void RunMachineTask::run(std::optional<QProcess> &process)
 				auto evt = std::make_unique<ChatterEvent>(type, text);
 				postEventToHost(std::move(evt));
 			}
+		},
+		[this](status::update &&update)
+		{
+			auto evt = std::make_unique<StatusUpdateEvent>(std::move(update));
+			postEventToHost(std::move(evt));
 		});
 
 		// receive the inaugural response from MAME; we want to call it quits if this doesn't work
@@ -295,19 +257,48 @@ void RunMachineTask::run(std::optional<QProcess> &process)
 		}
 		else
 		{
-			// loop until the process terminates
-			QString command;
-			while (!(command = getNextCommand()).isEmpty())
-			{
-				// we've received a command
-				if (LOG_RECEIVE)
-					qDebug() << "RunMachineTask::run(): received command: " << command;
+			// if the plugin is new enough to push status changes, the host can stop pinging
+			m_statusPushEnabled = controller.negotiateProtocol();
 
-				// emit this command to MAME
-				controller.issueCommand(command);
-
-				// and receive a response from MAME
-				response = receiveResponseAndHandleUpdates(controller);
+			// loop until the process terminates; commands, MAME's output and MAME exiting all
+			// wake us up, so we can otherwise wait without burning any CPU
+			bool awaitingResponse = false;
+			for (;;)
+			{
+				// has the response to our last command arrived?
+				if (awaitingResponse)
+				{
+					std::optional<MameWorkerController::Response> commandResponse = controller.takeResponse();
+					if (commandResponse)
+					{
+						handleUpdates(*commandResponse);
+						awaitingResponse = false;
+					}
+				}
+
+				// if we are not waiting on MAME, do we have another command?
+				if (!awaitingResponse)
+				{
+					QString command = takeNextCommand();
+					if (!command.isEmpty())
+					{
+						// we've received a command
+						if (LOG_RECEIVE)
+							qDebug() << "RunMachineTask::run(): received command: " << command;
+
+						// emit this command to MAME (the response may well be here already)
+						controller.issueCommand(command);
+						awaitingResponse = true;
+						continue;
+					}
+
+					// nothing to do; should we bail?
+					if (isInterruptionRequested() || emuExitCode())
+						break;
+				}
+
+				// wait for something to happen
+				QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
 			}
 
 			// if we didn't get a MAME status code, sounds like we need to bump off MAME
@@ -315,7 +306,7 @@ void RunMachineTask::run(std::optional<QProcess> &process)
 			{
 				killActiveEmuProcess();
 				while (!emuExitCode())
-					QCoreApplication::processEvents();
+					QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
 			}
 
 			// was there an error?
@@ -343,14 +334,12 @@ void RunMachineTask::run(std::optional<QProcess> &process)
 
 
 //-------------------------------------------------
-//  getNextCommand
+//  takeNextCommand
 //-------------------------------------------------
 
-QString RunMachineTask::getNextCommand()
+QString RunMachineTask::takeNextCommand()
 {
-	// process events until we have something in the queue, or until we need to bail
-	while(m_commandQueue.empty() && !isInterruptionRequested() && !emuExitCode())
-		QCoreApplication::processEvents();
+	std::unique_lock lock(m_commandQueueMutex);
 
 	// get the command if we have one
 	QString result;
@@ -371,16 +360,25 @@ MameWorkerController::Response RunMachineTask::receiveResponseAndHandleUpdates(M
 {
 	// get the response
 	MameWorkerController::Response response = controller.receiveResponse();
+	handleUpdates(response);
 
+	// return it either way
+	return response;
+}
+
+
+//-------------------------------------------------
+//  handleUpdates
+//-------------------------------------------------
+
+void RunMachineTask::handleUpdates(MameWorkerController::Response &response)
+{
 	// did we get a status update
 	if (response.m_update)
 	{
 		auto evt = std::make_unique<StatusUpdateEvent>(std::move(*response.m_update));
 		postEventToHost(std::move(evt));
 	}
-
-	// return it either way
-	return response;
 }
 
 
@@ -20,6 +20,7 @@
 #include <QEvent>
 
 // standard headers
+#include <mutex>
 #include <optional>
 #include <queue>
 
@@ -106,9 +107,7 @@ public:
 	const info::machine &getMachine() const { return m_machine; }
 	void setChatterEnabled(bool enabled) { m_chatterEnabled = enabled; }
 	bool startedWithHashPaths() const { return m_startedWithHashPaths; }
-
-	// virtuals
-	virtual bool event(QEvent *event) override;
+	bool statusPushEnabled() const { return m_statusPushEnabled; }
 
 protected:
 	virtual QStringList getArguments(const Preferences &prefs) const override;
@@ -119,8 +118,10 @@ private:
 	QString							m_software;
 	std::map<QString, QString>		m_slotOptions;
 	QString							m_attachWindowParameter;
+	std::mutex						m_commandQueueMutex;
 	std::queue<QString>				m_commandQueue;
 	volatile bool					m_chatterEnabled;
+	volatile bool					m_statusPushEnabled;
 	mutable bool					m_startedWithHashPaths;
 
 	// main thread methods
@@ -128,8 +129,9 @@ private:
 	void internalIssueCommand(QString &&command);
 
 	// task thread methods
-	QString getNextCommand();
+	QString takeNextCommand();
 	MameWorkerController::Response receiveResponseAndHandleUpdates(MameWorkerController &controller);
+	void handleUpdates(MameWorkerController::Response &response);
 };
 
 
@@ -12,6 +12,7 @@
 #include "utility.h"
 
 // Qt headers
+#include <QAbstractEventDispatcher>
 #include <QCoreApplication>
 #include <QDebug>
 #include <QThread>
@@ -45,9 +46,15 @@ TaskDispatcher::TaskDispatcher(QObject &eventHandler, Preferences &prefs)
 
 TaskDispatcher::~TaskDispatcher()
 {
-	// if we have any outstanding tasks, instruct all of them to abort
+	// if we have any outstanding tasks, instruct all of them to abort (and wake up the ones
+	// that are waiting for events)
 	for (const Task::ptr &task : m_activeTasks)
+	{
 		task->requestInterruption();
+		QAbstractEventDispatcher *dispatcher = task->eventDispatcher();
+		if (dispatcher)
+			dispatcher->wakeUp();
+	}
 
 	// now join all tasks
 	for (const Task::ptr &task : m_activeTasks)
@@ -0,0 +1,211 @@
+/***************************************************************************
+
+	archivecache_test.cpp
+
+	Unit tests for archivecache.cpp
+
+***************************************************************************/
+
+// bletchmame headers
+#include "archivecache.h"
+#include "test.h"
+
+
+// ======================> ArchiveCache::Test
+
+class ArchiveCache::Test : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void directory_zip()			{ directory(":/resources/sample_archive.zip"); }
+	void directory_7zip()			{ directory(":/resources/sample_archive.7z"); }
+	void directory_garbage();
+	void sharedDirectory();
+	void pooledHandles_zip()		{ pooledHandles(":/resources/sample_archive.zip"); }
+	void pooledHandles_7zip()		{ pooledHandles(":/resources/sample_archive.7z"); }
+	void handleBudget();
+	void memoryBudget();
+
+private:
+	void directory(const QString &fileName);
+	void pooledHandles(const QString &fileName);
+	static QByteArray extractMember(ArchiveCache &cache, const std::shared_ptr<const Directory> &directory, const QString &fileName);
+};
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  extractMember
+//-------------------------------------------------
+
+QByteArray ArchiveCache::Test::extractMember(ArchiveCache &cache, const std::shared_ptr<const Directory> &directory, const QString &fileName)
+{
+	std::optional<int> index = directory->find(fileName, { });
+	std::unique_ptr<QIODevice> stream = index ? cache.extract(directory, *index) : nullptr;
+	return stream && stream->open(QIODevice::ReadOnly)
+		? stream->readAll()
+		: QByteArray();
+}
+
+
+//-------------------------------------------------
+//  directory
+//-------------------------------------------------
+
+void ArchiveCache::Test::directory(const QString &fileName)
+{
+	ArchiveCache cache;
+	std::shared_ptr<const Directory> directory = cache.getDirectory(fileName);
+	QVERIFY(directory);
+	for (const char *memberName : { "alpha.txt", "bravo.txt", "charlie.txt", "subdir/delta.txt", "verybig/big1.bin", "verybig/big2.bin", "verybig/big3.bin" })
+		QVERIFY(directory->find(memberName, { }));
+
+	// lookups by name are case insensitive
+	std::optional<int> index = directory->find("CHaRLie.TXT", { });
+	QVERIFY(index);
+	QVERIFY(directory->members()[*index].m_name == "charlie.txt");
+	QVERIFY(directory->members()[*index].m_size == 5);
+	QVERIFY(directory->members()[*index].m_crc32 == 0xAFAB3DEB);
+
+	// CRC-32 wins over the name
+	index = directory->find("alpha.txt", 0xA11B7929);
+	QVERIFY(index);
+	QVERIFY(directory->members()[*index].m_name == "subdir/delta.txt");
+
+	// but the name is used if the CRC-32 is not found
+	index = directory->find("bravo.txt", 0xBAADF00D);
+	QVERIFY(index);
+	QVERIFY(directory->members()[*index].m_name == "bravo.txt");
+
+	// unknown files
+	QVERIFY(!directory->find("unknown.txt", { }));
+	QVERIFY(!directory->find("UNKNOWN_CRC", 0xBAADF00D));
+}
+
+
+//-------------------------------------------------
+//  directory_garbage
+//-------------------------------------------------
+
+void ArchiveCache::Test::directory_garbage()
+{
+	ArchiveCache cache;
+	QVERIFY(!cache.getDirectory(":/resources/garbage.bin"));
+	QVERIFY(!cache.getDirectory(":/resources/nonexistant.zip"));
+	QVERIFY(cache.statistics().m_cachedArchives == 0);
+	QVERIFY(cache.statistics().m_openHandles == 0);
+}
+
+
+//-------------------------------------------------
+//  sharedDirectory
+//-------------------------------------------------
+
+void ArchiveCache::Test::sharedDirectory()
+{
+	// asking for the same archive repeatedly should only read it once
+	ArchiveCache cache;
+	std::shared_ptr<const Directory> directory1 = cache.getDirectory(":/resources/sample_archive.zip");
+	std::shared_ptr<const Directory> directory2 = cache.getDirectory(":/resources/sample_archive.zip");
+	std::shared_ptr<const Directory> directory3 = cache.getDirectory(":/resources/sample_archive.7z");
+	QVERIFY(directory1);
+	QVERIFY(directory1 == directory2);
+	QVERIFY(directory1 != directory3);
+
+	Statistics statistics = cache.statistics();
+	QVERIFY(statistics.m_directoryReads == 2);
+	QVERIFY(statistics.m_handleOpens == 2);
+	QVERIFY(statistics.m_cachedArchives == 2);
+	QVERIFY(statistics.m_memoryUsage > 0);
+}
+
+
+//-------------------------------------------------
+//  pooledHandles
+//-------------------------------------------------
+
+void ArchiveCache::Test::pooledHandles(const QString &fileName)
+{
+	ArchiveCache cache;
+	std::shared_ptr<const Directory> directory = cache.getDirectory(fileName);
+	QVERIFY(directory);
+
+	// extracting should reuse the handle that read the directory
+	QVERIFY(extractMember(cache, directory, "alpha.txt") == "11111");
+	QVERIFY(extractMember(cache, directory, "charlie.txt") == "33333");
+	QVERIFY(extractMember(cache, directory, "subdir/delta.txt") == "4444444444");
+	QVERIFY(extractMember(cache, directory, "verybig/big2.bin").size() == 110000);
+	QVERIFY(cache.statistics().m_handleOpens == 1);
+	QVERIFY(cache.statistics().m_openHandles == 1);
+
+	// closing idle handles keeps the directory
+	cache.closeIdleHandles();
+	QVERIFY(cache.statistics().m_openHandles == 0);
+	QVERIFY(cache.getDirectory(fileName) == directory);
+	QVERIFY(extractMember(cache, directory, "bravo.txt") == "22222");
+	QVERIFY(cache.statistics().m_directoryReads == 1);
+	QVERIFY(cache.statistics().m_handleOpens == 2);
+}
+
+
+//-------------------------------------------------
+//  handleBudget
+//-------------------------------------------------
+
+void ArchiveCache::Test::handleBudget()
+{
+	ArchiveCache cache(1);
+	std::shared_ptr<const Directory> directory = cache.getDirectory(":/resources/sample_archive.zip");
+	QVERIFY(directory);
+
+	// reading two members at once needs two handles, regardless of the budget
+	std::unique_ptr<QIODevice> stream1 = cache.extract(directory, *directory->find("alpha.txt", { }));
+	std::unique_ptr<QIODevice> stream2 = cache.extract(directory, *directory->find("bravo.txt", { }));
+	QVERIFY(stream1 && stream1->open(QIODevice::ReadOnly));
+	QVERIFY(stream2 && stream2->open(QIODevice::ReadOnly));
+	QVERIFY(stream1->readAll() == "11111");
+	QVERIFY(stream2->readAll() == "22222");
+	QVERIFY(cache.statistics().m_openHandles == 2);
+
+	// but only one is kept once we're done
+	stream1.reset();
+	stream2.reset();
+	QVERIFY(cache.statistics().m_openHandles == 1);
+
+	// handles are also closed to make room for other archives
+	QVERIFY(cache.getDirectory(":/resources/sample_archive.7z"));
+	QVERIFY(cache.statistics().m_openHandles == 1);
+	QVERIFY(cache.statistics().m_cachedArchives == 2);
+}
+
+
+//-------------------------------------------------
+//  memoryBudget
+//-------------------------------------------------
+
+void ArchiveCache::Test::memoryBudget()
+{
+	// with a tiny budget, only the most recently used directory is kept
+	ArchiveCache cache(32, 1);
+	std::shared_ptr<const Directory> zipDirectory = cache.getDirectory(":/resources/sample_archive.zip");
+	std::shared_ptr<const Directory> sevenZipDirectory = cache.getDirectory(":/resources/sample_archive.7z");
+	QVERIFY(zipDirectory);
+	QVERIFY(sevenZipDirectory);
+	QVERIFY(cache.statistics().m_cachedArchives == 1);
+	QVERIFY(cache.statistics().m_memoryUsage == sevenZipDirectory->memoryUsage());
+
+	// evicted directories still work for their holders, but have to be read again for anybody else
+	QVERIFY(extractMember(cache, zipDirectory, "charlie.txt") == "33333");
+	QVERIFY(cache.getDirectory(":/resources/sample_archive.zip") != zipDirectory);
+	QVERIFY(cache.statistics().m_directoryReads == 3);
+}
+
+
+//-------------------------------------------------
+
+static TestFixture<ArchiveCache::Test> fixture;
+#include "archivecache_test.moc"
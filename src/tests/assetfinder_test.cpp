@@ -31,11 +31,14 @@ namespace
 		void loadByCrc_zip_1()			{ loadByCrc(":/resources/sample_archive.zip", "verybig/big1.bin"); }
 		void loadByCrc_zip_2()			{ loadByCrc(":/resources/sample_archive.zip", "verybig/big2.bin"); }
 		void loadByCrc_zip_3()			{ loadByCrc(":/resources/sample_archive.zip", "verybig/big3.bin"); }
+		void identity_zip()				{ identity(":/resources/sample_archive.zip"); }
+		void identity_7zip()			{ identity(":/resources/sample_archive.7z"); }
 
 	private:
 		void isValidArchive(const char *path, bool expectedResult);
 		void archive(const QString &fileName);
 		void loadByCrc(const QString &fileName, const QString &member);
+		void identity(const QString &fileName);
 	};
 }
 
@@ -131,6 +134,33 @@ void Test::loadByCrc(const QString &fileName, const QString &member)
 }
 
 
+//-------------------------------------------------
+//  identity
+//-------------------------------------------------
+
+void Test::identity(const QString &fileName)
+{
+	AssetFinder assetFinder;
+	assetFinder.setPaths({ fileName });
+
+	// archives know the size and CRC-32 of their members without extracting them
+	std::optional<AssetFinder::Identity> identity = assetFinder.findAssetIdentity("charlie.txt");
+	QVERIFY(identity);
+	QVERIFY(identity->m_member == "charlie.txt");
+	QVERIFY(identity->m_size == 5);
+	QVERIFY(identity->m_crc32 == 0xAFAB3DEB);
+
+	// lookups by CRC-32 work too
+	identity = assetFinder.findAssetIdentity("FIND_DELTA_BY_CRC", 0xA11B7929);
+	QVERIFY(identity);
+	QVERIFY(identity->m_member == "subdir/delta.txt");
+	QVERIFY(identity->m_size == 10);
+
+	// unknown files
+	QVERIFY(!assetFinder.findAssetIdentity("unknown.txt"));
+}
+
+
 //-------------------------------------------------
 
 static TestFixture<Test> fixture;
@@ -8,6 +8,8 @@
 
 // bletchmame headers
 #include "audit.h"
+#include "assetfinder.h"
+#include "hashcache.h"
 #include "test.h"
 
 // ======================> AuditTask::Test
@@ -24,9 +26,14 @@ private slots:
 	void general_5()				{ general(true,  false, false, false, AuditStatus::Missing); }
 	void general_6()				{ general(true,  true,  true,  true,  AuditStatus::Found); }
 	void addMediaForMachine();
+	void hashCache();
+	void fastMode_match()			{ fastMode(Audit::Mode::Fast,		0xAFAB3DEB, 0); }
+	void fastMode_mismatch()		{ fastMode(Audit::Mode::Fast,		0xBAADF00D, 1); }
+	void fastMode_thorough()		{ fastMode(Audit::Mode::Thorough,	0xAFAB3DEB, 1); }
 
 private:
 	void general(bool hasRom, bool hasNoDumpRom, bool hasSample, bool hasDisk, AuditStatus expectedResult);
+	void fastMode(Audit::Mode mode, std::uint32_t expectedCrc32, int expectedHashCount);
 };
 
 
@@ -174,6 +181,97 @@ void Audit::Test::addMediaForMachine()
 }
 
 
+//-------------------------------------------------
+//  hashCache
+//-------------------------------------------------
+
+void Audit::Test::hashCache()
+{
+	// create a temporary directory with all of the media
+	QTemporaryDir tempDir;
+	QVERIFY(tempDir.isValid());
+	QString romDir = QDir(tempDir.path()).filePath("./rom");
+	QString sampleDir = QDir(tempDir.path()).filePath("./sample");
+	QDir().mkdir(romDir);
+	QDir().mkdir(romDir + "/fake");
+	QDir().mkdir(sampleDir);
+	QDir().mkdir(sampleDir + "/fake");
+	QFile::copy(":/resources/garbage.bin", romDir + "/fake/garbage.bin");
+	QFile::copy(":/resources/garbage.bin", romDir + "/fake/nodump.bin");
+	QFile::copy(":/resources/garbage.bin", sampleDir + "/fake/fakesample.wav");
+	QFile::copy(":/resources/samplechd.chd", romDir + "/fake/samplechd.chd");
+
+	// set up preferences, an info DB and the audit
+	Preferences prefs;
+	prefs.setGlobalPath(Preferences::global_path_type::ROMS, romDir);
+	prefs.setGlobalPath(Preferences::global_path_type::SAMPLES, sampleDir);
+	info::database db;
+	QVERIFY(db.load(buildInfoDatabase(":/resources/listxml_fake.xml", false)));
+	Audit audit;
+	audit.addMediaForMachine(prefs, *db.find_machine("fake"));
+
+	// run the audit; everything but the CHD should be cached
+	HashCache hashCache;
+	std::vector<Audit::Verdict> verdicts;
+	MockAuditCallback callback(verdicts);
+	QVERIFY(audit.run(callback, &hashCache) == AuditStatus::Found);
+	QVERIFY(hashCache.size() == 3);
+
+	// poison the cache entry for garbage.bin; the next audit should believe it
+	AssetFinder assetFinder({ romDir + "/fake" });
+	std::optional<AssetFinder::Identity> identity = assetFinder.findAssetIdentity("garbage.bin");
+	QVERIFY(identity);
+	hashCache.add(*identity, Hash(0x12345678U));
+	verdicts.clear();
+	QVERIFY(audit.run(callback, &hashCache) == AuditStatus::Missing);
+	QVERIFY(verdicts[0].type() == Audit::Verdict::Type::Mismatch);
+
+	// change the file; the cache entry should no longer apply
+	QFile file(romDir + "/fake/garbage.bin");
+	QVERIFY(file.open(QIODevice::Append));
+	file.write("x");
+	file.close();
+	verdicts.clear();
+	QVERIFY(audit.run(callback, &hashCache) == AuditStatus::Missing);
+	QVERIFY(verdicts[0].type() == Audit::Verdict::Type::IncorrectSize);
+	QVERIFY(hashCache.size() == 3);
+}
+
+
+//-------------------------------------------------
+//  fastMode - in fast mode, archived assets whose
+//	size and CRC-32 match should not be hashed
+//-------------------------------------------------
+
+void Audit::Test::fastMode(Audit::Mode mode, std::uint32_t expectedCrc32, int expectedHashCount)
+{
+	static int hashCount;
+	auto calculateHash = [](QIODevice &stream, const Hash::CalculateCallback &callback, Hash &result)
+	{
+		hashCount++;
+		result = Hash::calculate(stream, callback).value_or(Hash());
+		return Audit::Entry::CalculateHashStatus::Success;
+	};
+
+	// set up an audit for a single member of an archive
+	Audit audit;
+	int pathsPos = audit.appendPaths({ ":/resources/sample_archive.zip" });
+	audit.m_entries.emplace_back(Entry::Type::Rom, "charlie.txt", pathsPos, calculateHash, info::rom::dump_status_t::GOOD, 5, Hash(expectedCrc32), false);
+
+	// run the audit
+	hashCount = 0;
+	std::vector<Audit::Verdict> verdicts;
+	MockAuditCallback callback(verdicts);
+	std::optional<AuditStatus> result = audit.run(callback, nullptr, mode);
+
+	// validate the results
+	QVERIFY(hashCount == expectedHashCount);
+	QVERIFY(verdicts.size() == 1);
+	QVERIFY(verdicts[0].type() == (expectedCrc32 == 0xAFAB3DEB ? Audit::Verdict::Type::Ok : Audit::Verdict::Type::Mismatch));
+	QVERIFY(result == (expectedCrc32 == 0xAFAB3DEB ? AuditStatus::Found : AuditStatus::Missing));
+}
+
+
 //-------------------------------------------------
 
 static TestFixture<Audit::Test> fixture;
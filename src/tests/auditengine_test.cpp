@@ -0,0 +1,175 @@
+/***************************************************************************
+
+	auditengine_test.cpp
+
+	Unit tests for auditengine.cpp
+
+***************************************************************************/
+
+// bletchmame headers
+#include "auditengine.h"
+#include "test.h"
+
+// standard headers
+#include <chrono>
+
+
+// ======================> AuditEngine::Test
+
+class AuditEngine::Test : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void generalWithAssets()			{ general(true, 64 * 1024 * 1024, AuditStatus::Found); }
+	void generalWithoutAssets()			{ general(false, 64 * 1024 * 1024, AuditStatus::Missing); }
+	void generalNoReadAhead()			{ general(true, 1, AuditStatus::Found); }
+	void emptyBatch();
+
+private:
+	void general(bool hasMedia, qint64 readAheadBudget, AuditStatus expectedResult);
+};
+
+
+// ======================> EventCollector
+
+namespace
+{
+	class EventCollector
+	{
+	public:
+		AuditEngine::EventHandlerFunc handler()
+		{
+			return [this](std::unique_ptr<QEvent> &&event)
+			{
+				{
+					std::unique_lock lock(m_mutex);
+					m_events.push_back(std::move(event));
+				}
+				m_condition.notify_all();
+			};
+		}
+
+		std::vector<std::unique_ptr<QEvent>> waitForEvents(std::size_t count)
+		{
+			using namespace std::chrono_literals;
+
+			std::unique_lock lock(m_mutex);
+			m_condition.wait_for(lock, 30s, [this, count] { return m_events.size() >= count; });
+			return std::move(m_events);
+		}
+
+	private:
+		std::mutex								m_mutex;
+		std::condition_variable					m_condition;
+		std::vector<std::unique_ptr<QEvent>>	m_events;
+	};
+}
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  general
+//-------------------------------------------------
+
+void AuditEngine::Test::general(bool hasMedia, qint64 readAheadBudget, AuditStatus expectedResult)
+{
+	const int BATCH_COUNT = 8;
+
+	// create a temporary directory
+	QTemporaryDir tempDir;
+	QVERIFY(tempDir.isValid());
+	QString tempDirPath = tempDir.path();
+
+	// create a directory structure under that directory
+	QString romDir = QDir(tempDirPath).filePath("./rom");
+	QString sampleDir = QDir(tempDirPath).filePath("./sample");
+
+	// and set up media (if we have it)
+	if (hasMedia)
+	{
+		QDir().mkdir(romDir);
+		QDir().mkdir(romDir + "/fake");
+		QDir().mkdir(sampleDir);
+		QDir().mkdir(sampleDir + "/fake");
+		QFile::copy(":/resources/garbage.bin", romDir + "/fake/garbage.bin");
+		QFile::copy(":/resources/garbage.bin", romDir + "/fake/nodump.bin");
+		QFile::copy(":/resources/garbage.bin", sampleDir + "/fake/fakesample.wav");
+		QFile::copy(":/resources/samplechd.chd", romDir + "/fake/samplechd.chd");
+	}
+
+	// set up preferences pointing at the fake directory
+	Preferences prefs;
+	prefs.setGlobalPath(Preferences::global_path_type::ROMS, romDir);
+	prefs.setGlobalPath(Preferences::global_path_type::SAMPLES, sampleDir);
+
+	// set up an info DB
+	info::database db;
+	QVERIFY(db.load(buildInfoDatabase(":/resources/listxml_fake.xml", false)));
+	info::machine machine = *db.find_machine("fake");
+
+	// submit a number of batches, so that they get mixed together by the I/O scheduler
+	EventCollector eventCollector;
+	std::vector<std::unique_ptr<QEvent>> events;
+	{
+		AuditEngine auditEngine(eventCollector.handler(), nullptr, Audit::Mode::Fast, 3, readAheadBudget);
+		for (int i = 0; i < BATCH_COUNT; i++)
+		{
+			auto batch = std::make_unique<AuditBatch>(100 + i);
+			batch->addMachineAudit(prefs, machine);
+			batch->addMachineAudit(prefs, machine);
+			auditEngine.submit(std::move(batch));
+		}
+		events = eventCollector.waitForEvents(BATCH_COUNT);
+		QVERIFY(auditEngine.pendingBatchCount() == 0);
+	}
+
+	// validate the result events; they can come in any order
+	QVERIFY(events.size() == BATCH_COUNT);
+	std::vector<int> cookies;
+	for (const std::unique_ptr<QEvent> &event : events)
+	{
+		AuditResultEvent *auditResultEvent = dynamic_cast<AuditResultEvent *>(event.get());
+		QVERIFY(auditResultEvent);
+		QVERIFY(auditResultEvent->results().size() == 2);
+		QVERIFY(auditResultEvent->results()[0].identifier() == Identifier(MachineIdentifier("fake")));
+		QVERIFY(auditResultEvent->results()[0].status() == expectedResult);
+		QVERIFY(auditResultEvent->results()[1].status() == expectedResult);
+		cookies.push_back(auditResultEvent->cookie());
+	}
+	std::ranges::sort(cookies);
+	for (int i = 0; i < BATCH_COUNT; i++)
+		QVERIFY(cookies[i] == 100 + i);
+}
+
+
+//-------------------------------------------------
+//  emptyBatch - a batch with nothing to read should
+//	still get results
+//-------------------------------------------------
+
+void AuditEngine::Test::emptyBatch()
+{
+	EventCollector eventCollector;
+	std::vector<std::unique_ptr<QEvent>> events;
+	{
+		AuditEngine auditEngine(eventCollector.handler());
+		auditEngine.submit(std::make_unique<AuditBatch>(123));
+		events = eventCollector.waitForEvents(1);
+	}
+
+	QVERIFY(events.size() == 1);
+	AuditResultEvent *auditResultEvent = dynamic_cast<AuditResultEvent *>(events[0].get());
+	QVERIFY(auditResultEvent);
+	QVERIFY(auditResultEvent->cookie() == 123);
+	QVERIFY(auditResultEvent->results().empty());
+}
+
+
+//-------------------------------------------------
+
+static TestFixture<AuditEngine::Test> fixture;
+#include "auditengine_test.moc"
@@ -59,32 +59,32 @@ void AuditQueue::Test::test1()
 	QVERIFY(*iter++ == Identifier(MachineIdentifier("coco2")));
 	QVERIFY(iter == auditQueue.m_undispatchedAudits.cend());
 
-	// create a task
-	AuditTask::ptr auditTask = auditQueue.tryCreateAuditTask();
-	QVERIFY(auditTask);
+	// create a batch
+	AuditBatch::ptr auditBatch = auditQueue.tryCreateAuditBatch();
+	QVERIFY(auditBatch);
 
-	// validate that the audit task has what we expect
-	auto auditTaskIdentifiers = auditTask->getIdentifiers();
-	QVERIFY(auditTaskIdentifiers.size() == 3);
-	QVERIFY(auditTaskIdentifiers[0] == Identifier(MachineIdentifier("coco")));
-	QVERIFY(auditTaskIdentifiers[1] == Identifier(MachineIdentifier("coco3")));
-	QVERIFY(auditTaskIdentifiers[2] == Identifier(MachineIdentifier("coco2b")));
+	// validate that the audit batch has what we expect
+	auto auditBatchIdentifiers = auditBatch->getIdentifiers();
+	QVERIFY(auditBatchIdentifiers.size() == 3);
+	QVERIFY(auditBatchIdentifiers[0] == Identifier(MachineIdentifier("coco")));
+	QVERIFY(auditBatchIdentifiers[1] == Identifier(MachineIdentifier("coco3")));
+	QVERIFY(auditBatchIdentifiers[2] == Identifier(MachineIdentifier("coco2b")));
 
 	// validate that the audit queue's collections are in the expected state
 	QVERIFY(auditQueue.m_auditTaskMap.size() == 4);
 	QVERIFY(auditQueue.m_undispatchedAudits.size() == 1);
 	QVERIFY(auditQueue.m_undispatchedAudits.front() == Identifier(MachineIdentifier("coco2")));
 
-	// create another task
-	AuditTask::ptr auditTask2 = auditQueue.tryCreateAuditTask();
-	QVERIFY(auditTask2);
+	// create another batch
+	AuditBatch::ptr auditBatch2 = auditQueue.tryCreateAuditBatch();
+	QVERIFY(auditBatch2);
 	QVERIFY(auditQueue.m_auditTaskMap.size() == 4);
 	QVERIFY(auditQueue.m_undispatchedAudits.empty());
-	QVERIFY(auditTask2->getIdentifiers().size() == 1);
+	QVERIFY(auditBatch2->getIdentifiers().size() == 1);
 
-	// try to create another task, because the queue is emptied out we should not get one
-	AuditTask::ptr auditTask3 = auditQueue.tryCreateAuditTask();
-	QVERIFY(!auditTask3);
+	// try to create another batch, because the queue is emptied out we should not get one
+	AuditBatch::ptr auditBatch3 = auditQueue.tryCreateAuditBatch();
+	QVERIFY(!auditBatch3);
 }
 
 
@@ -0,0 +1,162 @@
+/***************************************************************************
+
+	hashbackend_test.cpp
+
+	Unit tests for hashbackend.cpp
+
+***************************************************************************/
+
+// bletchmame headers
+#include "hashbackend.h"
+#include "test.h"
+
+// standard headers
+#include <cstring>
+#include <random>
+
+
+namespace
+{
+	class Test : public QObject
+	{
+		Q_OBJECT
+
+	private slots:
+		void crc32_bytewise()				{ crc32(Crc32::Implementation::Bytewise); }
+		void crc32_sliceBy16()				{ crc32(Crc32::Implementation::SliceBy16); }
+		void crc32_pclmul()					{ crc32(Crc32::Implementation::Pclmul); }
+		void crc32_armv8()					{ crc32(Crc32::Implementation::Armv8); }
+		void sha1_qt()						{ sha1(Sha1::Implementation::Qt); }
+		void sha1_shaNi()					{ sha1(Sha1::Implementation::ShaNi); }
+
+		// these compare the throughput of the original implementation (bytewise CRC-32 and
+		// QCryptographicHash) against what the CPU we're running on can do
+		void benchmark_original()			{ benchmark(Crc32::Implementation::Bytewise, Sha1::Implementation::Qt); }
+		void benchmark_sliceBy16()			{ benchmark(Crc32::Implementation::SliceBy16, Sha1::Implementation::Qt); }
+		void benchmark_best()				{ benchmark(Crc32::bestImplementation(), Sha1::bestImplementation()); }
+
+	private:
+		void crc32(Crc32::Implementation implementation);
+		void sha1(Sha1::Implementation implementation);
+		void benchmark(Crc32::Implementation crc32Implementation, Sha1::Implementation sha1Implementation);
+
+		static QByteArray randomBytes(int length);
+	};
+}
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  randomBytes
+//-------------------------------------------------
+
+QByteArray Test::randomBytes(int length)
+{
+	std::mt19937 random(12345);
+	QByteArray result(length, '\0');
+	for (char &ch : result)
+		ch = (char)random();
+	return result;
+}
+
+
+//-------------------------------------------------
+//  crc32
+//-------------------------------------------------
+
+void Test::crc32(Crc32::Implementation implementation)
+{
+	if (!Crc32::isSupported(implementation))
+		QSKIP("Not supported on this CPU");
+
+	// the standard check value
+	Crc32 checkCrc32(implementation);
+	checkCrc32.update("123456789", 9);
+	QVERIFY(checkCrc32.result() == 0xCBF43926);
+
+	// lengths and alignments that exercise all of the edge cases, fed in uneven pieces
+	QByteArray bytes = randomBytes(10000);
+	for (int offset = 0; offset < 16; offset++)
+	{
+		for (int length : { 0, 1, 15, 16, 17, 63, 64, 65, 127, 128, 129, 1000, 4096, 9000 })
+		{
+			Crc32 expected(Crc32::Implementation::Bytewise);
+			expected.update(bytes.constData() + offset, length);
+
+			Crc32 actual(implementation);
+			int position = 0;
+			for (int chunkLength = 1; position < length; chunkLength = chunkLength * 3 + 1)
+			{
+				int thisLength = std::min(chunkLength, length - position);
+				actual.update(bytes.constData() + offset + position, thisLength);
+				position += thisLength;
+			}
+			QVERIFY(actual.result() == expected.result());
+		}
+	}
+}
+
+
+//-------------------------------------------------
+//  sha1
+//-------------------------------------------------
+
+void Test::sha1(Sha1::Implementation implementation)
+{
+	if (!Sha1::isSupported(implementation))
+		QSKIP("Not supported on this CPU");
+
+	// known answers from FIPS 180
+	Sha1 abc(implementation);
+	abc.update("abc", 3);
+	QVERIFY(QByteArray((const char *)abc.result().data(), 20).toHex() == "a9993e364706816aba3e25717850c26c9cd0d89d");
+
+	const char *longMessage = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+	Sha1 abcLong(implementation);
+	abcLong.update(longMessage, strlen(longMessage));
+	QVERIFY(QByteArray((const char *)abcLong.result().data(), 20).toHex() == "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+
+	// lengths around the block and padding boundaries, fed in uneven pieces
+	QByteArray bytes = randomBytes(10000);
+	for (int length : { 0, 1, 55, 56, 63, 64, 65, 119, 120, 128, 1000, 9999 })
+	{
+		QByteArray expected = QCryptographicHash::hash(bytes.left(length), QCryptographicHash::Algorithm::Sha1);
+
+		Sha1 actual(implementation);
+		int position = 0;
+		for (int chunkLength = 1; position < length; chunkLength = chunkLength * 3 + 1)
+		{
+			int thisLength = std::min(chunkLength, length - position);
+			actual.update(bytes.constData() + position, thisLength);
+			position += thisLength;
+		}
+		QVERIFY(QByteArray((const char *)actual.result().data(), 20) == expected);
+	}
+}
+
+
+//-------------------------------------------------
+//  benchmark
+//-------------------------------------------------
+
+void Test::benchmark(Crc32::Implementation crc32Implementation, Sha1::Implementation sha1Implementation)
+{
+	QByteArray bytes = randomBytes(16 * 1024 * 1024);
+	QBENCHMARK
+	{
+		Crc32 crc32(crc32Implementation);
+		Sha1 sha1(sha1Implementation);
+		crc32.update(bytes.constData(), bytes.size());
+		sha1.update(bytes.constData(), bytes.size());
+		sha1.result();
+	}
+}
+
+
+//-------------------------------------------------
+
+static TestFixture<Test> fixture;
+#include "hashbackend_test.moc"
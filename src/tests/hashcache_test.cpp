@@ -0,0 +1,232 @@
+/***************************************************************************
+
+	hashcache_test.cpp
+
+	Unit tests for hashcache.cpp
+
+***************************************************************************/
+
+// bletchmame headers
+#include "hashcache.h"
+#include "test.h"
+
+// Qt headers
+#include <QBuffer>
+
+
+// ======================> HashCache::Test
+
+class HashCache::Test : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void addAndFind();
+	void invalidation();
+	void saveAndLoad();
+	void loadCorrupt();
+	void prune();
+	void pruneKeepsSoftware();
+
+private:
+	static AssetFinder::Identity identity(const QString &path, const QString &member, std::uint64_t size, qint64 lastModified);
+	static Hash hash(const char *sha1);
+};
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  identity
+//-------------------------------------------------
+
+AssetFinder::Identity HashCache::Test::identity(const QString &path, const QString &member, std::uint64_t size, qint64 lastModified)
+{
+	return AssetFinder::Identity { path, member, size, lastModified };
+}
+
+
+//-------------------------------------------------
+//  hash
+//-------------------------------------------------
+
+Hash HashCache::Test::hash(const char *sha1)
+{
+	return Hash(std::nullopt, QByteArray::fromHex(sha1));
+}
+
+
+//-------------------------------------------------
+//  addAndFind
+//-------------------------------------------------
+
+void HashCache::Test::addAndFind()
+{
+	HashCache cache;
+	QVERIFY(!cache.isDirty());
+
+	cache.add(identity("/roms/alienar.zip", "aarom10", 4096, 1000), hash("6aec3ba4a80d3bbfd4b6c0d65bdb3b4fc4e6c2a6"));
+	cache.add(identity("/roms/alienar.zip", "aarom11", 4096, 1000), hash("9b5b9bb8e3e8ba9a6e4cd5c1b7cd0b38cb3abf7e"));
+	cache.add(identity("/roms/alienar/aarom10", "", 4096, 1000), hash("0123456789abcdef0123456789abcdef01234567"));
+	QVERIFY(cache.isDirty());
+	QVERIFY(cache.size() == 3);
+
+	std::optional<Hash> result = cache.find(identity("/roms/alienar.zip", "aarom11", 4096, 1000));
+	QVERIFY(result);
+	QVERIFY(*result == hash("9b5b9bb8e3e8ba9a6e4cd5c1b7cd0b38cb3abf7e"));
+
+	result = cache.find(identity("/roms/alienar/aarom10", "", 4096, 1000));
+	QVERIFY(result);
+	QVERIFY(*result == hash("0123456789abcdef0123456789abcdef01234567"));
+
+	QVERIFY(!cache.find(identity("/roms/alienar.zip", "aarom12", 4096, 1000)));
+	QVERIFY(!cache.find(identity("/roms/alienar.7z", "aarom10", 4096, 1000)));
+}
+
+
+//-------------------------------------------------
+//  invalidation
+//-------------------------------------------------
+
+void HashCache::Test::invalidation()
+{
+	HashCache cache;
+	cache.add(identity("/roms/fake/garbage.bin", "", 1234, 1000), hash("6aec3ba4a80d3bbfd4b6c0d65bdb3b4fc4e6c2a6"));
+
+	// if the file changes, the entry no longer applies
+	QVERIFY(cache.find(identity("/roms/fake/garbage.bin", "", 1234, 1000)));
+	QVERIFY(!cache.find(identity("/roms/fake/garbage.bin", "", 1235, 1000)));
+	QVERIFY(!cache.find(identity("/roms/fake/garbage.bin", "", 1234, 2000)));
+
+	// and is replaced when rehashed
+	cache.add(identity("/roms/fake/garbage.bin", "", 1235, 2000), hash("9b5b9bb8e3e8ba9a6e4cd5c1b7cd0b38cb3abf7e"));
+	QVERIFY(cache.size() == 1);
+	QVERIFY(!cache.find(identity("/roms/fake/garbage.bin", "", 1234, 1000)));
+	QVERIFY(cache.find(identity("/roms/fake/garbage.bin", "", 1235, 2000)) == hash("9b5b9bb8e3e8ba9a6e4cd5c1b7cd0b38cb3abf7e"));
+}
+
+
+//-------------------------------------------------
+//  saveAndLoad
+//-------------------------------------------------
+
+void HashCache::Test::saveAndLoad()
+{
+	// build a cache, with a mix of complete and partial hashes
+	HashCache cache;
+	cache.add(identity("/roms/alienar.zip", "aarom10", 4096, 1000), Hash(0x6a2a1f9aU, hash("6aec3ba4a80d3bbfd4b6c0d65bdb3b4fc4e6c2a6").sha1()));
+	cache.add(identity("/roms/alienar.zip", "aarom11", 4096, 1000), Hash(0x12345678U));
+	cache.add(identity("/samples/fake/fakesample.wav", "", 15, -1), hash("9b5b9bb8e3e8ba9a6e4cd5c1b7cd0b38cb3abf7e"));
+
+	// save it
+	QBuffer buffer;
+	QVERIFY(buffer.open(QIODevice::ReadWrite));
+	cache.save(buffer);
+	QVERIFY(!cache.isDirty());
+
+	// and load it back
+	HashCache loadedCache;
+	buffer.seek(0);
+	QVERIFY(loadedCache.load(buffer));
+	QVERIFY(!loadedCache.isDirty());
+	QVERIFY(loadedCache.size() == 3);
+	QVERIFY(loadedCache.find(identity("/roms/alienar.zip", "aarom10", 4096, 1000)) == Hash(0x6a2a1f9aU, hash("6aec3ba4a80d3bbfd4b6c0d65bdb3b4fc4e6c2a6").sha1()));
+	QVERIFY(loadedCache.find(identity("/roms/alienar.zip", "aarom11", 4096, 1000)) == Hash(0x12345678U));
+	QVERIFY(loadedCache.find(identity("/samples/fake/fakesample.wav", "", 15, -1)) == hash("9b5b9bb8e3e8ba9a6e4cd5c1b7cd0b38cb3abf7e"));
+}
+
+
+//-------------------------------------------------
+//  loadCorrupt
+//-------------------------------------------------
+
+void HashCache::Test::loadCorrupt()
+{
+	// prepare a cache with an entry in it
+	HashCache cache;
+	cache.add(identity("/roms/fake/garbage.bin", "", 1234, 1000), hash("6aec3ba4a80d3bbfd4b6c0d65bdb3b4fc4e6c2a6"));
+	QBuffer buffer;
+	QVERIFY(buffer.open(QIODevice::ReadWrite));
+	cache.save(buffer);
+
+	// truncated input should be rejected without disturbing what we have
+	QByteArray truncatedBytes = buffer.data().left(buffer.data().size() - 4);
+	QBuffer truncatedBuffer(&truncatedBytes);
+	QVERIFY(truncatedBuffer.open(QIODevice::ReadOnly));
+	QVERIFY(!cache.load(truncatedBuffer));
+	QVERIFY(cache.size() == 1);
+
+	// as should garbage
+	QByteArray garbageBytes("this is not a hash cache");
+	QBuffer garbageBuffer(&garbageBytes);
+	QVERIFY(garbageBuffer.open(QIODevice::ReadOnly));
+	QVERIFY(!cache.load(garbageBuffer));
+	QVERIFY(cache.size() == 1);
+
+	// the file starts with its magic bytes
+	QVERIFY(buffer.data().startsWith("BSHC"));
+}
+
+
+//-------------------------------------------------
+//  prune
+//-------------------------------------------------
+
+void HashCache::Test::prune()
+{
+	HashCache cache;
+	cache.add(identity("/roms/alienar.zip", "aarom10", 4096, 1000), hash("6aec3ba4a80d3bbfd4b6c0d65bdb3b4fc4e6c2a6"));
+	cache.add(identity("/roms/alienar.zip", "aarom11", 4096, 1000), hash("9b5b9bb8e3e8ba9a6e4cd5c1b7cd0b38cb3abf7e"));
+	cache.add(identity("/roms/alienar/aarom10", "", 4096, 1000), hash("0123456789abcdef0123456789abcdef01234567"));
+
+	// without a sweep, nothing gets pruned
+	QVERIFY(cache.prune() == 0);
+	QVERIFY(cache.size() == 3);
+
+	// during a sweep, only what gets looked up (and found) or added is kept
+	cache.beginSweep();
+	QVERIFY(cache.find(identity("/roms/alienar.zip", "aarom10", 4096, 1000)));
+	QVERIFY(!cache.find(identity("/roms/alienar.zip", "aarom11", 4096, 2000)));
+	cache.add(identity("/roms/alienar.zip", "aarom12", 4096, 1000), hash("9b5b9bb8e3e8ba9a6e4cd5c1b7cd0b38cb3abf7e"));
+	QVERIFY(cache.prune() == 2);
+	QVERIFY(cache.size() == 2);
+	QVERIFY(cache.find(identity("/roms/alienar.zip", "aarom10", 4096, 1000)));
+	QVERIFY(cache.find(identity("/roms/alienar.zip", "aarom12", 4096, 1000)));
+}
+
+
+//-------------------------------------------------
+//  pruneKeepsSoftware
+//-------------------------------------------------
+
+void HashCache::Test::pruneKeepsSoftware()
+{
+	HashCache cache;
+	cache.add(identity("/roms/alienar.zip", "aarom10", 4096, 1000), hash("6aec3ba4a80d3bbfd4b6c0d65bdb3b4fc4e6c2a6"));
+	cache.add(identity("/roms/a2600/adventur.zip", "adventur.bin", 4096, 1000), hash("9b5b9bb8e3e8ba9a6e4cd5c1b7cd0b38cb3abf7e"), true);
+	cache.add(identity("/roms/a2600/combat.zip", "combat.bin", 2048, 1000), hash("0123456789abcdef0123456789abcdef01234567"));
+	QVERIFY(cache.find(identity("/roms/a2600/combat.zip", "combat.bin", 2048, 1000), true));
+
+	// software list entries survive the round trip
+	QBuffer buffer;
+	QVERIFY(buffer.open(QIODevice::ReadWrite));
+	cache.save(buffer);
+	HashCache loadedCache;
+	buffer.seek(0);
+	QVERIFY(loadedCache.load(buffer));
+
+	// a machine sweep does not cover software lists, so their entries are kept
+	loadedCache.beginSweep();
+	QVERIFY(loadedCache.prune() == 1);
+	QVERIFY(loadedCache.size() == 2);
+	QVERIFY(loadedCache.find(identity("/roms/a2600/adventur.zip", "adventur.bin", 4096, 1000)));
+	QVERIFY(loadedCache.find(identity("/roms/a2600/combat.zip", "combat.bin", 2048, 1000)));
+}
+
+
+//-------------------------------------------------
+
+static TestFixture<HashCache::Test> fixture;
+#include "hashcache_test.moc"
@@ -12,6 +12,11 @@
 
 // Qt headers
 #include <QBuffer>
+#include <QDir>
+#include <QTemporaryDir>
+
+// standard headers
+#include <thread>
 
 using namespace std::literals;
 
@@ -24,9 +29,19 @@ class info::database_builder::Test : public QObject
 
 private slots:
     void general();
-	void compareBinaries_alienar()	{ compareBinaries(":/resources/listxml_alienar.xml"); }
-	void compareBinaries_coco()		{ compareBinaries(":/resources/listxml_coco.xml"); }
-	void compareBinaries_fake()		{ compareBinaries(":/resources/listxml_fake.xml"); }
+	void compareBinaries_alienar()	{ compareBinaries(":/resources/listxml_alienar.xml", XmlParser::Backend::Expat); }
+	void compareBinaries_coco()		{ compareBinaries(":/resources/listxml_coco.xml", XmlParser::Backend::Expat); }
+	void compareBinaries_fake()		{ compareBinaries(":/resources/listxml_fake.xml", XmlParser::Backend::Expat); }
+	void compareBinaries_alienar_tokenizer()	{ compareBinaries(":/resources/listxml_alienar.xml", XmlParser::Backend::Tokenizer); }
+	void compareBinaries_coco_tokenizer()		{ compareBinaries(":/resources/listxml_coco.xml", XmlParser::Backend::Tokenizer); }
+	void compareBinaries_fake_tokenizer()		{ compareBinaries(":/resources/listxml_fake.xml", XmlParser::Backend::Tokenizer); }
+	void chunkedBuild();
+	void truncatedInput();
+	void incrementalBuild();
+	void shardedBuild();
+	void spilledBuild();
+	void compressedSections();
+	void machineNameIndex();
 	void stringTable();
 	void singleString1()			{ singleString<const char8_t *>(u8""); }
 	void singleString2()			{ singleString<const char8_t *>(u8"A"); }
@@ -51,9 +66,12 @@ private slots:
 	void singleString21()			{ singleString<std::u8string>(u8"ABCD"); }
 	void singleString22()			{ singleString<std::u8string>(u8"***another very_big_STRING!!!!"); }
 	void xmlAttributeParsing();
+	void benchmark_build_coco()				{ benchmarkBuild(":/resources/listxml_coco.xml", XmlParser::Backend::Expat); }
+	void benchmark_build_coco_tokenizer()	{ benchmarkBuild(":/resources/listxml_coco.xml", XmlParser::Backend::Tokenizer); }
 
 private:
-	void compareBinaries(const QString &fileName);
+	void compareBinaries(const QString &fileName, XmlParser::Backend xmlBackend);
+	void benchmarkBuild(const QString &fileName, XmlParser::Backend xmlBackend);
 	template<class T> void singleString(T s);
 };
 
@@ -66,10 +84,11 @@ private:
 //  buildInfoDatabase
 //-------------------------------------------------
 
-static QByteArray buildInfoDatabase(QIODevice &stream, QString &errorMessage)
+static QByteArray buildInfoDatabase(QIODevice &stream, QString &errorMessage, XmlParser::Backend xmlBackend = XmlParser::Backend::Expat)
 {
 	// process the results
 	info::database_builder builder;
+	builder.set_xml_backend(xmlBackend);
 	bool success = builder.process_xml(stream, errorMessage);
 
 	// get the stream
@@ -140,12 +159,16 @@ void info::database_builder::Test::general()
 //	about are little endian
 //-------------------------------------------------
 
-void info::database_builder::Test::compareBinaries(const QString &fileName)
+void info::database_builder::Test::compareBinaries(const QString &fileName, XmlParser::Backend xmlBackend)
 {
 	const bool dumpBinaries = false;
 
 	// get the binaries
-	QByteArray byteArray = buildInfoDatabase(fileName);
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QString errorMessage;
+	QByteArray byteArray = buildInfoDatabase(file, errorMessage, xmlBackend);
+	QVERIFY(errorMessage.isEmpty());
 	QVERIFY(byteArray.size() > 0);
 
 	// get the binary file name
@@ -188,6 +211,392 @@ void info::database_builder::Test::compareBinaries(const QString &fileName)
 }
 
 
+//-------------------------------------------------
+//  chunkedBuild - regardless of how the input is
+//	split up and how many workers there are, we
+//	should build the same thing
+//-------------------------------------------------
+
+void info::database_builder::Test::chunkedBuild()
+{
+	const QString fileName = ":/resources/listxml_coco.xml";
+	QByteArray expected = buildInfoDatabase(fileName);
+	QVERIFY(expected.size() > 0);
+
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QByteArray xml = file.readAll();
+
+	for (int workerCount : { 0, 1, 4 })
+	{
+		for (std::size_t chunkSize : { 1, 4096, 262144 })
+		{
+			QBuffer input(&xml);
+			QVERIFY(input.open(QIODevice::ReadOnly));
+
+			database_builder builder;
+			builder.set_worker_count(workerCount);
+			builder.m_chunk_size = chunkSize;
+			QString errorMessage;
+			QVERIFY(builder.process_xml(input, errorMessage));
+			QVERIFY(errorMessage.isEmpty());
+
+			QByteArray result;
+			QBuffer output(&result);
+			QVERIFY(output.open(QIODevice::WriteOnly));
+			builder.emit_info(output);
+			QVERIFY(result == expected);
+		}
+	}
+}
+
+
+//-------------------------------------------------
+//  truncatedInput - an aborted -listxml should fail
+//-------------------------------------------------
+
+void info::database_builder::Test::truncatedInput()
+{
+	QFile file(":/resources/listxml_coco.xml");
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QByteArray xml = file.readAll();
+
+	for (qsizetype length : { xml.size() / 4, xml.size() / 2, xml.size() - 10 })
+	{
+		QByteArray truncatedXml = xml.left(length);
+		QBuffer input(&truncatedXml);
+		QVERIFY(input.open(QIODevice::ReadOnly));
+
+		database_builder builder;
+		builder.set_worker_count(4);
+		builder.m_chunk_size = 4096;
+		QString errorMessage;
+		QVERIFY(!builder.process_xml(input, errorMessage));
+		QVERIFY(!errorMessage.isEmpty());
+	}
+}
+
+
+//-------------------------------------------------
+//  incrementalBuild - machines reused from a previous
+//	info DB should make no difference to what we build
+//-------------------------------------------------
+
+void info::database_builder::Test::incrementalBuild()
+{
+	QFile file(":/resources/listxml_coco.xml");
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QByteArray xml = file.readAll();
+
+	auto build = [](QByteArray xml, const info::database *previousDb, int &reusedMachineCount)
+	{
+		QByteArray result;
+		QBuffer input(&xml);
+		if (input.open(QIODevice::ReadOnly))
+		{
+			database_builder builder;
+			builder.m_chunk_size = 4096;
+			if (previousDb)
+				builder.set_previous_database(*previousDb);
+
+			QString errorMessage;
+			QBuffer output(&result);
+			if (builder.process_xml(input, errorMessage) && output.open(QIODevice::WriteOnly))
+				builder.emit_info(output);
+			reusedMachineCount = builder.m_reused_machine_count;
+		}
+		return result;
+	};
+
+	// build from scratch
+	int reusedMachineCount = -1;
+	QByteArray expected = build(xml, nullptr, reusedMachineCount);
+	QVERIFY(expected.size() > 0);
+	QVERIFY(reusedMachineCount == 0);
+	info::database previousDb;
+	QVERIFY(previousDb.load(expected));
+	const int machineCount = (int)previousDb.machines().size();
+
+	// nothing has changed; every machine should be reused
+	QVERIFY(build(xml, &previousDb, reusedMachineCount) == expected);
+	QVERIFY(reusedMachineCount == machineCount);
+
+	// a new MAME build, with the same machines
+	int fullBuildReusedMachineCount;
+	QByteArray newBuildXml = QByteArray(xml).replace("build=\"0.229 (mame0229)\"", "build=\"0.230 (mame0230)\"");
+	QVERIFY(newBuildXml != xml);
+	QVERIFY(build(newBuildXml, &previousDb, reusedMachineCount) == build(newBuildXml, nullptr, fullBuildReusedMachineCount));
+	QVERIFY(reusedMachineCount == machineCount);
+
+	// one machine has changed
+	QByteArray changedXml = QByteArray(xml).replace("<description>MC6850 ACIA</description>", "<description>Motorola MC6850 ACIA</description>");
+	QVERIFY(changedXml != xml);
+	QVERIFY(build(changedXml, &previousDb, reusedMachineCount) == build(changedXml, nullptr, fullBuildReusedMachineCount));
+	QVERIFY(reusedMachineCount == machineCount - 1);
+
+	// the DTD has changed; we can't trust anything
+	QByteArray changedDtdXml = QByteArray(xml).replace("<!ATTLIST machine name CDATA #REQUIRED>", "<!ATTLIST machine name CDATA #REQUIRED>\n\t\t<!-- changed -->");
+	QVERIFY(changedDtdXml != xml);
+	QVERIFY(build(changedDtdXml, &previousDb, reusedMachineCount) == build(changedDtdXml, nullptr, fullBuildReusedMachineCount));
+	QVERIFY(reusedMachineCount == 0);
+}
+
+
+//-------------------------------------------------
+//  shardedBuild - splitting the drivers between
+//	several inputs (each of which lists every device,
+//	like MAME does when given driver patterns) should
+//	build the same machines as a single input
+//-------------------------------------------------
+
+void info::database_builder::Test::shardedBuild()
+{
+	const int shardCount = 3;
+	QFile file(":/resources/listxml_coco.xml");
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QByteArray xml = file.readAll();
+
+	// carve up the document; drivers are dealt out to the shards and devices go to all of them
+	qsizetype bodyStart = xml.indexOf('>', xml.indexOf("<mame ")) + 1;
+	qsizetype bodyEnd = xml.lastIndexOf("</mame>");
+	QVERIFY(bodyStart > 0 && bodyEnd > bodyStart);
+	std::vector<QByteArray> shardXml(shardCount, xml.left(bodyStart) + "\n");
+	int driverCount = 0;
+	for (qsizetype machineStart = xml.indexOf("<machine ", bodyStart); machineStart >= 0 && machineStart < bodyEnd; )
+	{
+		qsizetype machineEnd = xml.indexOf("<machine ", machineStart + 1);
+		if (machineEnd < 0 || machineEnd > bodyEnd)
+			machineEnd = bodyEnd;
+		QByteArray machineXml = xml.mid(machineStart, machineEnd - machineStart);
+		bool isDevice = machineXml.left(machineXml.indexOf('>')).contains("isdevice=\"yes\"");
+		for (int i = 0; i < shardCount; i++)
+		{
+			if (isDevice || i == driverCount % shardCount)
+				shardXml[i] += "\t" + machineXml;
+		}
+		if (!isDevice)
+			driverCount++;
+		machineStart = machineEnd;
+	}
+	for (QByteArray &document : shardXml)
+		document += xml.mid(bodyEnd);
+	QVERIFY(driverCount > shardCount);
+
+	// builds from the shards, each of which is read on its own thread (apart from the first)
+	auto build = [&shardXml](int workerCount, QIODevice *xmlCopy)
+	{
+		auto shardFunc = [&shardXml](int shard, const std::function<void(QIODevice &)> &readFunc)
+		{
+			QBuffer input(&shardXml[shard]);
+			if (input.open(QIODevice::ReadOnly))
+				readFunc(input);
+		};
+
+		database_builder builder;
+		builder.set_worker_count(workerCount);
+		builder.m_chunk_size = 4096;
+		builder.set_xml_copy(xmlCopy);
+		QString errorMessage;
+		QByteArray result;
+		QBuffer output(&result);
+		if (builder.process_xml(shardCount, shardFunc, errorMessage) && output.open(QIODevice::WriteOnly))
+			builder.emit_info(output);
+		return result;
+	};
+
+	// the shards are merged in order, so the results should not depend on timing
+	QByteArray xmlCopy;
+	QBuffer xmlCopyBuffer(&xmlCopy);
+	QVERIFY(xmlCopyBuffer.open(QIODevice::WriteOnly));
+	QByteArray sharded = build(4, &xmlCopyBuffer);
+	QVERIFY(sharded.size() > 0);
+	QVERIFY(build(0, nullptr) == sharded);
+	QVERIFY(build(1, nullptr) == sharded);
+
+	// the copy of the XML is a single document that builds the very same thing
+	xmlCopyBuffer.close();
+	QVERIFY(xmlCopyBuffer.open(QIODevice::ReadOnly));
+	QString errorMessage;
+	QVERIFY(buildInfoDatabase(xmlCopyBuffer, errorMessage) == sharded);
+	QVERIFY(errorMessage.isEmpty());
+
+	// and each machine (devices included) should be there once, with its cross references intact
+	info::database expectedDb, shardedDb;
+	QVERIFY(expectedDb.load(buildInfoDatabase()));
+	QVERIFY(shardedDb.load(sharded));
+	QVERIFY(shardedDb.machines().size() == expectedDb.machines().size());
+	for (info::machine expectedMachine : expectedDb.machines())
+	{
+		std::optional<info::machine> shardedMachine = shardedDb.find_machine(expectedMachine.name());
+		QVERIFY(shardedMachine);
+		QVERIFY(shardedMachine->description() == expectedMachine.description());
+		QVERIFY(shardedMachine->is_device() == expectedMachine.is_device());
+		QVERIFY(shardedMachine->clone_of().has_value() == expectedMachine.clone_of().has_value());
+		QVERIFY(!expectedMachine.clone_of() || shardedMachine->clone_of()->name() == expectedMachine.clone_of()->name());
+		QVERIFY(shardedMachine->rom_of().has_value() == expectedMachine.rom_of().has_value());
+		QVERIFY(!expectedMachine.rom_of() || shardedMachine->rom_of()->name() == expectedMachine.rom_of()->name());
+		QVERIFY(shardedMachine->roms().size() == expectedMachine.roms().size());
+		QVERIFY(shardedMachine->devices().size() == expectedMachine.devices().size());
+	}
+}
+
+
+//-------------------------------------------------
+//  spilledBuild - spilling tables to disk should
+//	make no difference to what we build, but should
+//	hold on to less memory
+//-------------------------------------------------
+
+void info::database_builder::Test::spilledBuild()
+{
+	QFile file(":/resources/listxml_coco.xml");
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QByteArray xml = file.readAll();
+
+	QTemporaryDir spillDir;
+	QVERIFY(spillDir.isValid());
+
+	auto build = [&xml, &spillDir](bool compress, std::optional<std::size_t> spillBlockSize, std::size_t &spilledCount, std::size_t &peakMemoryUsage)
+	{
+		QByteArray result;
+		QBuffer input(&xml);
+		if (input.open(QIODevice::ReadOnly))
+		{
+			database_builder builder;
+			builder.m_chunk_size = 4096;
+			builder.set_compress_cold_sections(compress);
+			if (spillBlockSize)
+			{
+				builder.set_spill_directory(spillDir.path());
+				builder.m_spill_block_size = *spillBlockSize;
+			}
+
+			QString errorMessage;
+			QBuffer output(&result);
+			if (!builder.process_xml(input, errorMessage) || !output.open(QIODevice::WriteOnly) || !builder.emit_info(output))
+				result.clear();
+			spilledCount = builder.m_roms.spilled_count() + builder.m_configuration_settings.spilled_count();
+			peakMemoryUsage = builder.m_peak_memory_usage;
+		}
+		return result;
+	};
+
+	for (bool compress : { true, false })
+	{
+		std::size_t spilledCount, inMemoryPeak;
+		QByteArray expected = build(compress, { }, spilledCount, inMemoryPeak);
+		QVERIFY(expected.size() > 0);
+		QVERIFY(spilledCount == 0);
+
+		// tiny blocks exercise spilling one record at a time
+		for (std::size_t spillBlockSize : { 1, 1000, 262144 })
+		{
+			std::size_t spilledPeak;
+			QByteArray result = build(compress, spillBlockSize, spilledCount, spilledPeak);
+			QVERIFY(result == expected);
+			QVERIFY(spilledPeak > 0);
+			QVERIFY(spilledPeak < inMemoryPeak);
+			if (spillBlockSize < 262144)
+				QVERIFY(spilledCount > 0);
+		}
+	}
+
+	// the spill files go away with the builder
+	QVERIFY(QDir(spillDir.path()).isEmpty());
+}
+
+
+//-------------------------------------------------
+//  compressedSections - compressing the cold
+//	sections should make the info DB smaller without
+//	changing its contents
+//-------------------------------------------------
+
+void info::database_builder::Test::compressedSections()
+{
+	QFile file(":/resources/listxml_coco.xml");
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QByteArray xml = file.readAll();
+
+	auto build = [&xml](bool compress)
+	{
+		QByteArray result;
+		QBuffer input(&xml);
+		if (input.open(QIODevice::ReadOnly))
+		{
+			database_builder builder;
+			builder.set_compress_cold_sections(compress);
+
+			QString errorMessage;
+			QBuffer output(&result);
+			if (builder.process_xml(input, errorMessage) && output.open(QIODevice::WriteOnly))
+				builder.emit_info(output);
+		}
+		return result;
+	};
+
+	QByteArray compressed = build(true);
+	QByteArray uncompressed = build(false);
+	QVERIFY(compressed.size() > 0);
+	QVERIFY(compressed.size() < uncompressed.size());
+
+	info::database compressedDb, uncompressedDb;
+	QVERIFY(compressedDb.load(compressed));
+	QVERIFY(uncompressedDb.load(uncompressed));
+
+	// the uncompressed DB has everything paged in from the get go
+	QVERIFY(uncompressedDb.is_section_paged_in(info::binaries::section_type::ROMS));
+	QVERIFY(!compressedDb.is_section_paged_in(info::binaries::section_type::ROMS));
+
+	// but the contents are the same
+	QVERIFY(compressedDb.roms().size() == uncompressedDb.roms().size());
+	for (std::size_t i = 0; i < compressedDb.roms().size(); i++)
+	{
+		QVERIFY(compressedDb.roms()[i].name() == uncompressedDb.roms()[i].name());
+		QVERIFY(compressedDb.roms()[i].crc32() == uncompressedDb.roms()[i].crc32());
+		QVERIFY(compressedDb.roms()[i].size() == uncompressedDb.roms()[i].size());
+	}
+	QVERIFY(compressedDb.devices().size() == uncompressedDb.devices().size());
+	for (std::size_t i = 0; i < compressedDb.devices().size(); i++)
+		QVERIFY(compressedDb.devices()[i].tag() == uncompressedDb.devices()[i].tag());
+	QVERIFY(compressedDb.configuration_settings().size() == uncompressedDb.configuration_settings().size());
+	QVERIFY(compressedDb.is_section_paged_in(info::binaries::section_type::ROMS));
+}
+
+
+//-------------------------------------------------
+//  machineNameIndex - the machine name index should
+//	be a minimal perfect hash
+//-------------------------------------------------
+
+void info::database_builder::Test::machineNameIndex()
+{
+	QFile file(":/resources/listxml_coco.xml");
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	database_builder builder;
+	QString errorMessage;
+	QVERIFY(builder.process_xml(file, errorMessage));
+
+	// every machine should have exactly one slot
+	QVERIFY(builder.m_machine_name_buckets.size() > 0);
+	QVERIFY(builder.m_machine_name_slots.size() == builder.m_machines.size());
+	std::vector<std::uint32_t> sortedSlots = builder.m_machine_name_slots;
+	std::sort(sortedSlots.begin(), sortedSlots.end());
+	for (std::uint32_t i = 0; i < sortedSlots.size(); i++)
+		QVERIFY(sortedSlots[i] == i);
+
+	// and that slot should be where the hash leads us
+	for (std::uint32_t machineIndex = 0; machineIndex < builder.m_machines.size(); machineIndex++)
+	{
+		string_table::SsoBuffer ssoBuffer;
+		std::uint64_t hash = info::database::machine_name_hash(builder.m_strings.lookup(builder.m_machines[machineIndex].m_name_strindex, ssoBuffer));
+		std::uint32_t displacement = builder.m_machine_name_buckets[hash % builder.m_machine_name_buckets.size()];
+		std::uint32_t slot = info::database::machine_name_slot(hash, displacement, (std::uint32_t)builder.m_machine_name_slots.size());
+		QVERIFY(builder.m_machine_name_slots[slot] == machineIndex);
+	}
+}
+
+
 //-------------------------------------------------
 //  stringTable
 //-------------------------------------------------
@@ -230,6 +639,17 @@ void info::database_builder::Test::stringTable()
 	QVERIFY(std::u8string_view(stringTable.lookup(bravo1, sso)) == u8"BravoBravo"sv);
 	QVERIFY(std::u8string_view(stringTable.lookup(charlie1, sso)) == u8"Charlie"sv);
 	QVERIFY(std::u8string_view(stringTable.lookup(delta1, sso)) == u8"DeltaDelta"sv);
+
+	// add enough strings to require more map buckets, and make sure nothing got lost
+	std::vector<std::uint32_t> manyStrings;
+	for (int i = 0; i < 1000; i++)
+		manyStrings.push_back(stringTable.get(u8"String #" + util::toU8String(QString::number(i))));
+	for (int i = 0; i < 1000; i++)
+	{
+		QVERIFY(stringTable.get(u8"String #" + util::toU8String(QString::number(i))) == manyStrings[i]);
+		QVERIFY(std::u8string_view(stringTable.lookup(manyStrings[i], sso)) == u8"String #" + util::toU8String(QString::number(i)));
+	}
+	QVERIFY(stringTable.get(u8"BravoBravo") == bravo1);
 }
 
 
@@ -289,6 +709,32 @@ void info::database_builder::Test::xmlAttributeParsing()
 }
 
 
+//-------------------------------------------------
+//  benchmarkBuild - builds an info DB on a single
+//	thread, so that parsing is not hidden behind
+//	the workers
+//-------------------------------------------------
+
+void info::database_builder::Test::benchmarkBuild(const QString &fileName, XmlParser::Backend xmlBackend)
+{
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QByteArray xml = file.readAll();
+
+	QBENCHMARK
+	{
+		QBuffer input(&xml);
+		QVERIFY(input.open(QIODevice::ReadOnly));
+
+		database_builder builder;
+		builder.set_worker_count(0);
+		builder.set_xml_backend(xmlBackend);
+		QString errorMessage;
+		QVERIFY(builder.process_xml(input, errorMessage));
+	}
+}
+
+
 //-------------------------------------------------
 
 static TestFixture<info::database_builder::Test> fixture;
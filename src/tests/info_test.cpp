@@ -12,6 +12,13 @@
 
 // Qt headers
 #include <QBuffer>
+#include <QTemporaryFile>
+
+// standard headers
+#include <cstring>
+#include <thread>
+
+using namespace std::literals;
 
 
 namespace
@@ -41,11 +48,21 @@ namespace
 		void loadGarbage_1000_1000()		{ loadGarbage(1000, 1000); }
 		void loadFailuresDontMutate();
 		void readsAllBytes();
+		void loadFromFile();
+		void concurrentStrings();
 		void sortable();
 		void localeSensitivity();
 		void scrutinize_alienar();
 		void scrutinize_coco();
 		void scrutinize_coco2b();
+		void postingLists_coco()			{ postingLists(":/resources/listxml_coco.xml"); }
+		void postingLists_alienar()			{ postingLists(":/resources/listxml_alienar.xml"); }
+		void romHashes_coco()				{ romHashes(":/resources/listxml_coco.xml", true); }
+		void romHashes_alienar()			{ romHashes(":/resources/listxml_alienar.xml", false); }
+		void lazySections();
+		void utf8Accessors();
+		void corruptSection();
+		void snapshots();
 
 	private:
 		void general(const QString &fileName, bool skipDtd, int expectedMachineCount, int expectedRunnableMachineCount, int expectedSettingCount, int expectedSoftwareListCount,
@@ -54,7 +71,10 @@ namespace
 		void deviceLookup(const QString &fileName, const QString &machineName);
 		void loadGarbage(int legitBytes, int garbageBytes);
 		void loadExpectedVersion(const QString &fileName, const QString &expectedVersion);
+		void postingLists(const QString &fileName);
+		void romHashes(const QString &fileName, bool expectSharedRoms);
 		static void garbagifyByteArray(QByteArray &byteArray, int garbageStart, int garbageCount);
+		static QStringList postingListKeys(const info::machine &machine, info::posting_list::type_t type);
 	};
 }
 
@@ -482,6 +502,92 @@ void Test::readsAllBytes()
 }
 
 
+//-------------------------------------------------
+//  loadFromFile - loading by file name maps the
+//	file rather than reading it into a buffer
+//-------------------------------------------------
+
+void Test::loadFromFile()
+{
+	// write the DB out to a file
+	QByteArray byteArray = buildInfoDatabase();
+	QVERIFY(byteArray.size() > 0);
+	QTemporaryFile file;
+	QVERIFY(file.open());
+	QVERIFY(file.write(byteArray) == byteArray.size());
+	file.close();
+
+	// load the db from the file, validating we've done so successfully
+	info::database db;
+	bool dbChanged = false;
+	db.addOnChangedHandler([&dbChanged]() { dbChanged = true; });
+	QVERIFY(db.load(file.fileName()));
+	QVERIFY(dbChanged);
+
+	// compare against loading the same bytes from a buffer
+	info::database bufferDb;
+	QVERIFY(bufferDb.load(byteArray));
+	QVERIFY(db.version() == bufferDb.version());
+	QVERIFY(db.machines().size() == bufferDb.machines().size());
+	for (size_t i = 0; i < db.machines().size(); i++)
+	{
+		QVERIFY(db.machines()[i].name() == bufferDb.machines()[i].name());
+		QVERIFY(db.machines()[i].description() == bufferDb.machines()[i].description());
+		QVERIFY(db.machines()[i].roms().size() == bufferDb.machines()[i].roms().size());
+	}
+}
+
+
+//-------------------------------------------------
+//  concurrentStrings - strings can be retrieved
+//	from multiple threads at once, and every thread
+//	sees the same decoded instance
+//-------------------------------------------------
+
+void Test::concurrentStrings()
+{
+	info::database db;
+	QVERIFY(db.load(buildInfoDatabase()));
+	QVERIFY(db.machines().size() > 0);
+
+	// hammer the string cache from a number of threads
+	const int threadCount = 8;
+	std::vector<std::vector<const QString *>> results(threadCount);
+	std::vector<std::thread> threads;
+	for (int i = 0; i < threadCount; i++)
+	{
+		threads.emplace_back([&db, &result = results[i]]
+		{
+			for (info::machine machine : db.machines())
+			{
+				result.push_back(&machine.name());
+				result.push_back(&machine.description());
+				result.push_back(&machine.year());
+				result.push_back(&machine.manufacturer());
+			}
+		});
+	}
+	for (std::thread &thread : threads)
+		thread.join();
+
+	// every thread should have gotten the very same strings
+	for (int i = 1; i < threadCount; i++)
+		QVERIFY(results[i] == results[0]);
+
+	// and they should match what a fresh database decodes
+	info::database freshDb;
+	QVERIFY(freshDb.load(buildInfoDatabase()));
+	for (size_t i = 0; i < freshDb.machines().size(); i++)
+	{
+		info::machine machine = freshDb.machines()[i];
+		QVERIFY(*results[0][i * 4 + 0] == machine.name());
+		QVERIFY(*results[0][i * 4 + 1] == machine.description());
+		QVERIFY(*results[0][i * 4 + 2] == machine.year());
+		QVERIFY(*results[0][i * 4 + 3] == machine.manufacturer());
+	}
+}
+
+
 //-------------------------------------------------
 //  sortable - not really about sorting but rather
 //	ensuring that the info/bindata copy/move/assignment
@@ -604,6 +710,353 @@ void Test::scrutinize_coco2b()
 }
 
 
+//-------------------------------------------------
+//  postingListKeys - determines which posting
+//	lists a machine should be in the hard way
+//-------------------------------------------------
+
+QStringList Test::postingListKeys(const info::machine &machine, info::posting_list::type_t type)
+{
+	QStringList result;
+	switch (type)
+	{
+	case info::posting_list::type_t::CPU:
+	case info::posting_list::type_t::SOUND:
+		for (info::chip chip : machine.chips())
+		{
+			if (chip.type() == (type == info::posting_list::type_t::CPU ? info::chip::type_t::CPU : info::chip::type_t::AUDIO))
+				result.push_back(chip.name());
+		}
+		break;
+
+	case info::posting_list::type_t::MANUFACTURER:
+		result.push_back(machine.manufacturer());
+		break;
+
+	case info::posting_list::type_t::YEAR:
+		result.push_back(machine.year());
+		break;
+
+	case info::posting_list::type_t::SOURCEFILE:
+		result.push_back(machine.sourcefile());
+		break;
+
+	case info::posting_list::type_t::BIOS:
+		{
+			info::machine root = machine;
+			while (root.clone_of())
+				root = *root.clone_of();
+			std::optional<info::machine> romOf = root.rom_of();
+			if (romOf && romOf->is_bios() == true)
+				result.push_back(romOf->name());
+		}
+		break;
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  postingLists
+//-------------------------------------------------
+
+void Test::postingLists(const QString &fileName)
+{
+	info::database db;
+	QVERIFY(db.load(buildInfoDatabase(fileName)));
+	QVERIFY(db.posting_lists().size() > 0);
+
+	// every posting list should have exactly the machines we expect, in order
+	for (info::posting_list list : db.posting_lists())
+	{
+		std::vector<std::uint32_t> expected;
+		for (std::uint32_t i = 0; i < db.machines().size(); i++)
+		{
+			if (postingListKeys(db.machines()[i], list.type()).contains(list.key()))
+				expected.push_back(i);
+		}
+		QVERIFY(std::ranges::equal(list.machine_indexes(), expected));
+
+		// and we should be able to find it
+		std::optional<info::posting_list> foundList = db.find_posting_list({ list.type(), list.key() });
+		QVERIFY(foundList);
+		QVERIFY(foundList->machine_indexes().data() == list.machine_indexes().data());
+	}
+
+	// conversely, every machine should be in the posting lists for all of its keys (and not others)
+	const info::posting_list::type_t types[] =
+	{
+		info::posting_list::type_t::CPU,
+		info::posting_list::type_t::SOUND,
+		info::posting_list::type_t::MANUFACTURER,
+		info::posting_list::type_t::YEAR,
+		info::posting_list::type_t::SOURCEFILE,
+		info::posting_list::type_t::BIOS
+	};
+	for (info::posting_list::type_t type : types)
+	{
+		for (info::posting_list list : db.posting_lists(type))
+			QVERIFY(list.type() == type);
+
+		for (info::machine machine : db.machines())
+		{
+			QStringList keys = postingListKeys(machine, type);
+			for (const QString &key : keys)
+			{
+				std::optional<info::posting_list> list = db.find_posting_list({ type, key });
+				QVERIFY(list);
+				QVERIFY(list->contains(machine));
+			}
+			for (info::posting_list list : db.posting_lists(type))
+				QVERIFY(list.contains(machine) == keys.contains(list.key()));
+		}
+	}
+
+	// bogus lookups
+	QVERIFY(!db.find_posting_list({ info::posting_list::type_t::CPU, "this_is_an_invalid_cpu" }));
+	QVERIFY(!db.find_posting_list({ info::posting_list::type_t::BIOS, "" }));
+}
+
+
+//-------------------------------------------------
+//  romHashes
+//-------------------------------------------------
+
+void Test::romHashes(const QString &fileName, bool expectSharedRoms)
+{
+	info::database db;
+	QVERIFY(db.load(buildInfoDatabase(fileName)));
+	QVERIFY(db.rom_hashes().size() > 0);
+
+	// every ROM with a hash should be found by its CRC-32, and listed as a use of that hash
+	std::uint32_t hashedRomCount = 0;
+	for (std::uint32_t machineIndex = 0; machineIndex < db.machines().size(); machineIndex++)
+	{
+		for (info::rom rom : db.machines()[machineIndex].roms())
+		{
+			std::optional<info::rom_hash> hash = rom.hash();
+			if (!hash)
+				continue;
+			hashedRomCount++;
+
+			std::vector<info::rom_hash> foundHashes = db.find_rom_hashes(rom.crc32());
+			auto iter = std::ranges::find_if(foundHashes, [&rom](const info::rom_hash &x) { return x.sha1() == rom.sha1(); });
+			QVERIFY(iter != foundHashes.end());
+			QVERIFY(iter->crc32() == rom.crc32());
+
+			QVERIFY(std::ranges::any_of(iter->uses(), [&](const info::binaries::rom_hash_use &use)
+			{
+				return use.m_machine_index == machineIndex && db.roms()[use.m_rom_index].name() == rom.name();
+			}));
+		}
+	}
+
+	// conversely, every use should point back at a ROM with that hash
+	std::uint32_t useCount = 0;
+	for (info::rom_hash hash : db.rom_hashes())
+	{
+		QVERIFY(!hash.uses().empty());
+		for (const info::binaries::rom_hash_use &use : hash.uses())
+		{
+			info::rom rom = db.roms()[use.m_rom_index];
+			QVERIFY(rom.crc32() == hash.crc32());
+			QVERIFY(rom.sha1() == hash.sha1());
+			QVERIFY(std::ranges::any_of(db.machines()[use.m_machine_index].roms(), [&rom](info::rom x) { return x.name() == rom.name() && x.crc32() == rom.crc32(); }));
+			useCount++;
+		}
+	}
+	QVERIFY(useCount == hashedRomCount);
+
+	// clones share most of their parents' ROMs, and those should only be stored once
+	QVERIFY(expectSharedRoms
+		? db.rom_hashes().size() < hashedRomCount
+		: db.rom_hashes().size() == hashedRomCount);
+
+	// bogus lookups
+	QVERIFY(db.find_rom_hashes(0xBAADF00D).empty());
+}
+
+
+//-------------------------------------------------
+//  lazySections - startup should only touch the
+//	machines and the strings
+//-------------------------------------------------
+
+void Test::lazySections()
+{
+	info::database db;
+	QVERIFY(db.load(buildInfoDatabase()));
+	QVERIFY(db.is_section_paged_in(info::binaries::section_type::MACHINES));
+	QVERIFY(db.is_section_paged_in(info::binaries::section_type::POSTING_LISTS));
+	QVERIFY(!db.is_section_paged_in(info::binaries::section_type::ROMS));
+	QVERIFY(!db.is_section_paged_in(info::binaries::section_type::DEVICES));
+
+	// what the machine list shows should not page anything else in
+	for (info::machine machine : db.machines())
+	{
+		QVERIFY(!machine.name().isEmpty());
+		machine.description();
+		machine.year();
+		machine.manufacturer();
+	}
+	QVERIFY(!db.is_section_paged_in(info::binaries::section_type::ROMS));
+	QVERIFY(!db.is_section_paged_in(info::binaries::section_type::DEVICES));
+
+	// but asking for ROMs should
+	std::optional<info::machine> machine = db.find_machine("coco2b");
+	QVERIFY(machine);
+	QVERIFY(machine->roms().size() > 0);
+	QVERIFY(db.is_section_paged_in(info::binaries::section_type::ROMS));
+	QVERIFY(!db.is_section_paged_in(info::binaries::section_type::DEVICES));
+}
+
+
+//-------------------------------------------------
+//  utf8Accessors - the *_u8() accessors should agree
+//	with their QString counterparts
+//-------------------------------------------------
+
+void Test::utf8Accessors()
+{
+	info::database db;
+	QVERIFY(db.load(buildInfoDatabase()));
+
+	int smallStringCount = 0;
+	for (info::machine machine : db.machines())
+	{
+		info::sso_buffer buffer;
+		QVERIFY(util::toQString(machine.name_u8(buffer)) == machine.name());
+		QVERIFY(util::toQString(machine.description_u8(buffer)) == machine.description());
+		QVERIFY(util::toQString(machine.year_u8(buffer)) == machine.year());
+		QVERIFY(util::toQString(machine.manufacturer_u8(buffer)) == machine.manufacturer());
+		QVERIFY(util::toQString(machine.sourcefile_u8(buffer)) == machine.sourcefile());
+		for (info::device device : machine.devices())
+			QVERIFY(util::toQString(device.tag_u8(buffer)) == device.tag());
+		for (info::rom rom : machine.roms())
+			QVERIFY(util::toQString(rom.name_u8(buffer)) == rom.name());
+
+		// keep track of whether we've seen any small strings (which get decoded into the buffer)
+		if (machine.name_u8(buffer).data() == buffer.data())
+			smallStringCount++;
+
+		// lookups by UTF-8 name should find the same machine
+		std::optional<info::machine> foundMachine = db.find_machine(machine.name_u8(buffer));
+		QVERIFY(foundMachine);
+		QVERIFY(*foundMachine == machine);
+	}
+	QVERIFY(smallStringCount > 0);
+
+	// device and chip lookups
+	std::optional<info::machine> coco2b = db.find_machine(u8"coco2b"sv);
+	QVERIFY(coco2b);
+	std::optional<info::device> device = coco2b->find_device(u8"ext"sv);
+	QVERIFY(device);
+	QVERIFY(device->tag() == "ext");
+	QVERIFY(!coco2b->find_device(u8"this_is_an_invalid_tag"sv));
+	std::optional<info::chip> chip = coco2b->find_chip(u8"Motorola MC6809E"sv);
+	QVERIFY(chip);
+	QVERIFY(chip->tag() == "maincpu");
+	QVERIFY(!coco2b->find_chip(u8"this_is_an_invalid_chip"sv));
+	QVERIFY(!db.find_machine(u8"this_is_an_invalid_machine"sv));
+}
+
+
+//-------------------------------------------------
+//  corruptSection - a compressed section that does
+//	not decompress should fail when paged in
+//-------------------------------------------------
+
+void Test::corruptSection()
+{
+	QByteArray byteArray = buildInfoDatabase();
+	info::database db;
+	QVERIFY(db.load(byteArray));
+
+	// find the ROMs section and trash its compressed data
+	info::binaries::header hdr;
+	std::memcpy(&hdr, byteArray.constData(), sizeof(hdr));
+	hdr = util::salt(hdr, info::binaries::salt());
+	const info::binaries::section &section = hdr.m_sections[(int)info::binaries::section_type::ROMS];
+	QVERIFY(section.m_compression == (std::uint32_t)info::binaries::section_compression::ZLIB);
+	for (std::uint32_t i = 0; i < section.m_stored_size; i++)
+		byteArray[(qsizetype)(sizeof(hdr) + section.m_offset + i)] = (char)0xDB;
+
+	// the DB still loads (we don't look at the ROMs yet), but paging them in fails
+	QVERIFY(db.load(byteArray));
+	bool caught = false;
+	try
+	{
+		db.roms().size();
+	}
+	catch (bool)
+	{
+		caught = true;
+	}
+	QVERIFY(caught);
+}
+
+
+//-------------------------------------------------
+//  snapshots - preparing a snapshot should not
+//	affect the database until it is published, and
+//	readers holding the old snapshot should not be
+//	affected by the publish
+//-------------------------------------------------
+
+void Test::snapshots()
+{
+	int changedCount = 0;
+	info::database db;
+	db.addOnChangedHandler([&changedCount] { changedCount++; });
+	QVERIFY(db.load(buildInfoDatabase(":/resources/listxml_coco.xml")));
+	QVERIFY(changedCount == 1);
+	QVERIFY(db.machines().size() == 104);
+
+	// prepare a snapshot on another thread
+	info::database::snapshot snap;
+	std::thread([&snap] { snap = info::database::prepare(buildInfoDatabase(":/resources/listxml_alienar.xml"), "0.229 (mame0229)"); }).join();
+	QVERIFY(snap);
+	QVERIFY(snap.version() == "0.229 (mame0229)");
+	QVERIFY(changedCount == 1);
+	QVERIFY(db.machines().size() == 104);
+
+	// snapshots that fail to load are empty
+	QVERIFY(!info::database::prepare(QByteArray("garbage")));
+	QVERIFY(!info::database::prepare(buildInfoDatabase(":/resources/listxml_alienar.xml"), "0.999 (bogus)"));
+
+	// read the current snapshot from a number of threads while we publish the new one
+	const int threadCount = 4;
+	std::vector<int> results(threadCount);
+	std::vector<std::thread> threads;
+	for (int i = 0; i < threadCount; i++)
+	{
+		threads.emplace_back([&result = results[i], readerSnap = db.current()]() mutable
+		{
+			info::database reader(std::move(readerSnap));
+			for (int pass = 0; pass < 20; pass++)
+			{
+				std::optional<info::machine> machine = reader.find_machine("coco2b");
+				if (reader.machines().size() == 104 && machine && machine->description() == "Color Computer 2B")
+					result++;
+			}
+		});
+	}
+	db.publish(std::move(snap));
+	db.reset();
+	for (std::thread &thread : threads)
+		thread.join();
+
+	// every reader should have seen the old database throughout
+	for (int result : results)
+		QVERIFY(result == 20);
+
+	// whereas the database itself has moved on
+	QVERIFY(changedCount == 3);
+	QVERIFY(db.machines().size() == 0);
+	QVERIFY(db.version().isEmpty());
+}
+
+
 //-------------------------------------------------
 
 static TestFixture<Test> fixture;
@@ -0,0 +1,186 @@
+/***************************************************************************
+
+	listxmlcache_test.cpp
+
+	Unit tests for listxmlcache.cpp
+
+***************************************************************************/
+
+// bletchmame headers
+#include "listxmlcache.h"
+#include "info.h"
+#include "test.h"
+
+// Qt headers
+#include <QTemporaryDir>
+
+
+class ListXmlCache::Test : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void roundTrip();
+	void version();
+	void rebuildInfoDb();
+	void rebuildInfoDb_wrongVersion();
+	void rebuildInfoDb_corrupt();
+
+private:
+	static QByteArray readTestAsset();
+	static void writeCache(const QString &fileName, const QByteArray &contents);
+};
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  readTestAsset
+//-------------------------------------------------
+
+QByteArray ListXmlCache::Test::readTestAsset()
+{
+	QFile file(":/resources/listxml_coco.xml");
+	return file.open(QFile::ReadOnly)
+		? file.readAll()
+		: QByteArray();
+}
+
+
+//-------------------------------------------------
+//  writeCache - writes data through a Writer in
+//	pieces, the same way the builder does
+//-------------------------------------------------
+
+void ListXmlCache::Test::writeCache(const QString &fileName, const QByteArray &contents)
+{
+	ListXmlCache::Writer writer(fileName);
+	for (qsizetype position = 0; position < contents.size(); position += 1000)
+	{
+		qsizetype length = std::min(contents.size() - position, (qsizetype)1000);
+		QVERIFY(writer.write(contents.constData() + position, length) == length);
+	}
+	QVERIFY(writer.commit());
+}
+
+
+//-------------------------------------------------
+//  roundTrip
+//-------------------------------------------------
+
+void ListXmlCache::Test::roundTrip()
+{
+	QTemporaryDir tempDir;
+	QString cachePath = tempDir.filePath("subdir/foo.listxml.gz");
+	QByteArray contents = readTestAsset();
+	QVERIFY(!contents.isEmpty());
+	writeCache(cachePath, contents);
+
+	// the cache should be compressed...
+	QVERIFY(QFileInfo(cachePath).size() > 0);
+	QVERIFY(QFileInfo(cachePath).size() < contents.size() / 4);
+
+	// ...and read back identically
+	ListXmlCache::Reader reader(cachePath);
+	QVERIFY(reader.open(QIODevice::ReadOnly));
+	QByteArray readBack;
+	char buffer[777];
+	qint64 lastRead;
+	while ((lastRead = reader.read(buffer, sizeof(buffer))) > 0)
+		readBack.append(buffer, lastRead);
+	QVERIFY(lastRead == 0);
+	QVERIFY(readBack == contents);
+}
+
+
+//-------------------------------------------------
+//  version
+//-------------------------------------------------
+
+void ListXmlCache::Test::version()
+{
+	QTemporaryDir tempDir;
+	QString cachePath = tempDir.filePath("foo.listxml.gz");
+	writeCache(cachePath, readTestAsset());
+	QVERIFY(ListXmlCache::version(cachePath) == "0.229 (mame0229)");
+	QVERIFY(ListXmlCache::version(tempDir.filePath("nonexistant.listxml.gz")).isEmpty());
+}
+
+
+//-------------------------------------------------
+//  rebuildInfoDb
+//-------------------------------------------------
+
+void ListXmlCache::Test::rebuildInfoDb()
+{
+	QTemporaryDir tempDir;
+	QString cachePath = tempDir.filePath("foo.listxml.gz");
+	QString infoDbPath = tempDir.filePath("foo.infodb");
+	writeCache(cachePath, readTestAsset());
+
+	// rebuild the info DB without MAME
+	QVERIFY(ListXmlCache::rebuildInfoDb(cachePath, infoDbPath, "0.229 (mame0229)"));
+
+	// and it should match what we would have gotten from MAME
+	QFile infoDbFile(infoDbPath);
+	QVERIFY(infoDbFile.open(QIODevice::ReadOnly));
+	QVERIFY(infoDbFile.readAll() == buildInfoDatabase());
+	info::database db;
+	QVERIFY(db.load(infoDbPath, "0.229 (mame0229)"));
+	QVERIFY(db.find_machine("coco2b"));
+}
+
+
+//-------------------------------------------------
+//  rebuildInfoDb_wrongVersion
+//-------------------------------------------------
+
+void ListXmlCache::Test::rebuildInfoDb_wrongVersion()
+{
+	QTemporaryDir tempDir;
+	QString cachePath = tempDir.filePath("foo.listxml.gz");
+	QString infoDbPath = tempDir.filePath("foo.infodb");
+	writeCache(cachePath, readTestAsset());
+
+	// a cache from another version of MAME is useless
+	QVERIFY(!ListXmlCache::rebuildInfoDb(cachePath, infoDbPath, "0.999 (mame0999)"));
+	QVERIFY(!QFileInfo(infoDbPath).exists());
+}
+
+
+//-------------------------------------------------
+//  rebuildInfoDb_corrupt
+//-------------------------------------------------
+
+void ListXmlCache::Test::rebuildInfoDb_corrupt()
+{
+	QTemporaryDir tempDir;
+	QString cachePath = tempDir.filePath("foo.listxml.gz");
+	QString infoDbPath = tempDir.filePath("foo.infodb");
+	writeCache(cachePath, readTestAsset());
+
+	// lop off the end of the cache
+	QByteArray cacheBytes;
+	{
+		QFile file(cachePath);
+		QVERIFY(file.open(QIODevice::ReadOnly));
+		cacheBytes = file.readAll();
+	}
+	{
+		QFile file(cachePath);
+		QVERIFY(file.open(QIODevice::WriteOnly));
+		file.write(cacheBytes.left(cacheBytes.size() / 2));
+	}
+
+	// a truncated cache should not produce an info DB
+	QVERIFY(!ListXmlCache::rebuildInfoDb(cachePath, infoDbPath, ""));
+	QVERIFY(!QFileInfo(infoDbPath).exists());
+}
+
+
+//-------------------------------------------------
+
+static TestFixture<ListXmlCache::Test> fixture;
+#include "listxmlcache_test.moc"
@@ -16,6 +16,7 @@
 #include <QProcess>
 
 // standard headers
+#include <chrono>
 #include <iostream>
 #include <stdexcept>
 
@@ -26,22 +27,22 @@
 
 namespace
 {
+	// measures wall clock time; CPU time would overstate anything done on multiple threads
 	class Stopwatch
 	{
 	public:
 		Stopwatch()
 		{
-			_start = std::clock();
+			_start = std::chrono::steady_clock::now();
 		}
 
 		auto elapsedDuration() const
 		{
-			std::clock_t current = std::clock();
-			return std::chrono::duration<std::clock_t, std::ratio<1, CLOCKS_PER_SEC>>(current - _start);
+			return std::chrono::steady_clock::now() - _start;
 		}
 
 	private:
-		std::clock_t _start;
+		std::chrono::steady_clock::time_point _start;
 	};
 }
 
@@ -73,7 +74,7 @@ static std::string toLocal8BitString(std::u8string_view s)
 //  processXmlCallback
 //-------------------------------------------------
 
-static void processXmlCallback(int machineCount, std::u8string_view machineName, std::u8string_view machineDescription)
+static void processXmlCallback(int machineCount, int reusedMachineCount, std::u8string_view machineName, std::u8string_view machineDescription)
 {
 	std::string localMachineName = toLocal8BitString(machineName);
 	std::string localMachineDescription = toLocal8BitString(machineDescription);
@@ -129,38 +130,55 @@ static void internalRunAndExcerciseListXml(const QString &program, bool sequenti
 		listXmlSource = std::move(process);
 	}
 
+	// if we have the -listxml output in hand, we can benchmark against a single threaded build
+	std::vector<std::pair<const char *, std::optional<int>>> builderConfigurations;
+	if (sequential)
+		builderConfigurations.emplace_back("single threaded", 0);
+	builderConfigurations.emplace_back("pipelined", std::nullopt);
+
 	// report that MAME has started
 	std::cout << "Processing started...\r";
-	Stopwatch buildInfoDbStopwatch;
 	QByteArray infoDbBytes;
 	std::optional<info::database_builder> builder;
-	for (int run = 0; run < run_count; run++)
+	std::vector<std::chrono::milliseconds> buildInfoDbDurations;
+	for (const auto &[configurationName, workerCount] : builderConfigurations)
 	{
-		infoDbBytes.clear();
-		if (run > 0)
-			listXmlSource->seek(0);
-
-		// process the output
-		QString errorMessage;
-		builder.emplace();
-		QVERIFY(builder->process_xml(*listXmlSource, errorMessage, processXmlCallback));
-		QVERIFY(errorMessage.isEmpty());
-
-		// and put it in the byte array
-		QBuffer buffer(&infoDbBytes);
-		QVERIFY(buffer.open(QIODevice::WriteOnly));
-		builder->emit_info(buffer);
+		QByteArray previousInfoDbBytes = std::move(infoDbBytes);
+		Stopwatch buildInfoDbStopwatch;
+		for (int run = 0; run < run_count; run++)
+		{
+			infoDbBytes.clear();
+			if (sequential)
+				listXmlSource->seek(0);
+
+			// process the output
+			QString errorMessage;
+			builder.emplace();
+			if (workerCount)
+				builder->set_worker_count(*workerCount);
+			QVERIFY(builder->process_xml(*listXmlSource, errorMessage, processXmlCallback));
+			QVERIFY(errorMessage.isEmpty());
+
+			// and put it in the byte array
+			QBuffer buffer(&infoDbBytes);
+			QVERIFY(buffer.open(QIODevice::WriteOnly));
+			builder->emit_info(buffer);
+		}
+
+		// report our status and sanity checks
+		auto buildInfoDbDuration = std::chrono::duration_cast<std::chrono::milliseconds>(buildInfoDbStopwatch.elapsedDuration()) / run_count;
+		buildInfoDbDurations.push_back(buildInfoDbDuration);
+		std::cout << "Info DB build complete (" << configurationName << "; database size " << infoDbBytes.size() << " bytes; ";
+		if (run_count > 1)
+			std::cout << run_count << " total runs; average ";
+		std::cout << "elapsed duration " << buildInfoDbDuration.count() << "ms)" << std::endl;
+		QVERIFY(infoDbBytes.size() > 0);
+
+		// every configuration has to build the very same thing
+		QVERIFY(previousInfoDbBytes.isEmpty() || previousInfoDbBytes == infoDbBytes);
 	}
 	listXmlSource.reset();
 
-	// report our status and sanity checks
-	auto buildInfoDbDuration = std::chrono::duration_cast<std::chrono::milliseconds>(buildInfoDbStopwatch.elapsedDuration()) / run_count;
-	std::cout << "Info DB build complete (database size " << infoDbBytes.size() << " bytes; ";
-	if (run_count > 1)
-		std::cout << run_count << " total runs; average ";
-	std::cout << "elapsed duration " << buildInfoDbDuration.count() << "ms)" << std::endl;
-	QVERIFY(infoDbBytes.size() > 0);
-
 	// prepare buffer for reading
 	QBuffer buffer(&infoDbBytes);
 	QVERIFY(buffer.open(QIODevice::ReadOnly));
@@ -180,6 +198,14 @@ static void internalRunAndExcerciseListXml(const QString &program, bool sequenti
 	std::cout << "Info DB read complete (" << db.machines().size() << " total machines; elapsed duration " << readInfoDbDuration.count() << "ms)" << std::endl;
 	QVERIFY(db.machines().size() > 0);
 
+	// now that we know how many machines there are, report the throughput of each build
+	for (size_t i = 0; i < builderConfigurations.size(); i++)
+	{
+		double seconds = std::max(buildInfoDbDurations[i].count(), (std::chrono::milliseconds::rep) 1) / 1000.0;
+		std::cout << "Info DB build throughput (" << builderConfigurations[i].first << "): "
+			<< (int)(db.machines().size() / seconds) << " machines/sec" << std::endl;
+	}
+
 	// dump if we're asked to
 	if (dump && builder)
 		builder->dump();
@@ -8,6 +8,7 @@
 
 // bletchmame headers
 #include "listxmltask.h"
+#include "listxmlcache.h"
 #include "test.h"
 
 // Qt headers
@@ -20,6 +21,8 @@ class ListXmlTask::Test : public QObject
 
 private slots:
 	void internalRun();
+	void internalRunWithCache();
+	void shardPatterns();
 	void pathWithFile();
 };
 
@@ -54,6 +57,59 @@ void ListXmlTask::Test::internalRun()
 }
 
 
+//-------------------------------------------------
+//  internalRunWithCache
+//-------------------------------------------------
+
+void ListXmlTask::Test::internalRunWithCache()
+{
+	QTemporaryDir tempDir;
+	QString outputPath = tempDir.filePath("foo.infodb");
+	QString cachePath = tempDir.filePath("foo.listxml.gz");
+
+	// process with a cache
+	auto task = ListXmlTask(QString(outputPath), QString(cachePath));
+	QFile testAsset(":/resources/listxml_coco.xml");
+	QVERIFY(testAsset.open(QFile::ReadOnly));
+	QVERIFY(!task.internalRun(testAsset));
+
+	// the cache should be there, and should rebuild the very same info DB
+	QVERIFY(QFileInfo(cachePath).isFile());
+	QVERIFY(ListXmlCache::version(cachePath) == "0.229 (mame0229)");
+	QString rebuiltPath = tempDir.filePath("rebuilt.infodb");
+	QVERIFY(ListXmlCache::rebuildInfoDb(cachePath, rebuiltPath, "0.229 (mame0229)"));
+
+	QFile output(outputPath), rebuilt(rebuiltPath);
+	QVERIFY(output.open(QFile::ReadOnly));
+	QVERIFY(rebuilt.open(QFile::ReadOnly));
+	QVERIFY(output.readAll() == rebuilt.readAll());
+}
+
+
+//-------------------------------------------------
+//  shardPatterns - between them the shards should
+//	cover every driver exactly once
+//-------------------------------------------------
+
+void ListXmlTask::Test::shardPatterns()
+{
+	for (int shardCount : { 1, 2, 7, 8 })
+	{
+		QStringList allPatterns;
+		for (int shard = 0; shard < shardCount; shard++)
+		{
+			QStringList patterns = ListXmlTask::shardPatterns(shardCount, shard);
+			QVERIFY(!patterns.isEmpty());
+			allPatterns << patterns;
+		}
+		QVERIFY(allPatterns.size() == 36);
+		QVERIFY(allPatterns.removeDuplicates() == 0);
+		QVERIFY(allPatterns.contains("c*"));
+		QVERIFY(allPatterns.contains("1*"));
+	}
+}
+
+
 //-------------------------------------------------
 //  pathWithFile
 //-------------------------------------------------
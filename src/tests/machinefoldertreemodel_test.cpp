@@ -19,6 +19,7 @@ class MachineFolderTreeModel::Test : public QObject
 private slots:
     void createAndRefresh();
     void allIconsLoad();
+    void postingListFoldersOnlyHaveRunnableMachines();
 };
 
 
@@ -56,5 +57,48 @@ void MachineFolderTreeModel::Test::allIconsLoad()
 }
 
 
+//-------------------------------------------------
+//  postingListFoldersOnlyHaveRunnableMachines - the
+//	posting lists cover every machine, but like all
+//	other folders, the CPU, manufacturer, sound,
+//	source and year folders only show the runnable
+//	ones
+//-------------------------------------------------
+
+void MachineFolderTreeModel::Test::postingListFoldersOnlyHaveRunnableMachines()
+{
+    // prerequisites
+    info::database db;
+    QVERIFY(db.load(buildInfoDatabase()));
+    Preferences prefs;
+    MachineFolderTreeModel model(nullptr, db, prefs);
+    model.refresh();
+
+    // check every machine against every folder that comes from a posting list
+    bool sawNonRunnableCandidate = false;
+    for (const std::vector<FolderEntry> *folders : { &model.m_cpu, &model.m_manufacturer, &model.m_sound, &model.m_source, &model.m_year })
+    {
+        for (const FolderEntry &folder : *folders)
+        {
+            QVERIFY(folder.machineCandidates());
+            std::optional<info::posting_list> list = db.find_posting_list(*folder.machineCandidates());
+            QVERIFY(list);
+
+            for (info::machine machine : db.machines())
+            {
+                bool candidate = list->contains(machine);
+                sawNonRunnableCandidate = sawNonRunnableCandidate || (candidate && !machine.runnable());
+                QVERIFY((candidate && folder.filter()(machine)) == (candidate && machine.runnable()));
+            }
+        }
+    }
+
+    // and make sure that we have actually checked something interesting
+    QVERIFY(sawNonRunnableCandidate);
+}
+
+
+//-------------------------------------------------
+
 static TestFixture<MachineFolderTreeModel::Test> fixture;
 #include "machinefoldertreemodel_test.moc"
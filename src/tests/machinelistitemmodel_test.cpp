@@ -12,6 +12,10 @@
 
 // Qt headers
 #include <QBuffer>
+#include <QTemporaryFile>
+
+// standard headers
+#include <cstring>
 
 
 namespace
@@ -24,6 +28,17 @@ namespace
 		void general();
 		void auditStatusChanged();
 		void allAuditStatusesChanged();
+		void machineCandidates();
+
+		// populating the machine list only needs the machine summaries; filters that look
+		// beyond them (as all filters did before the summaries were split out) have to drag
+		// the full machine records through the cache
+		void benchmark_populateIndexes()			{ benchmarkPopulateIndexes([](const info::machine &machine) { return machine.runnable(); }); }
+		void benchmark_populateIndexes_details()	{ benchmarkPopulateIndexes([](const info::machine &machine) { return machine.runnable() && machine.sound_channels() != 0; }); }
+
+	private:
+		void benchmarkPopulateIndexes(std::function<bool(const info::machine &machine)> &&machineFilter);
+		static QByteArray buildLargeInfoDatabase(int copies);
 	};
 }
 
@@ -149,6 +164,99 @@ void Test::allAuditStatusesChanged()
 }
 
 
+//-------------------------------------------------
+//  machineCandidates
+//-------------------------------------------------
+
+void Test::machineCandidates()
+{
+	// create a MachineListItemModel and load an info DB
+	info::database db;
+	MachineListItemModel model(nullptr, db, nullptr, { });
+	QVERIFY(db.load(buildInfoDatabase(":/resources/listxml_coco.xml")));
+
+	// restrict ourselves to the machines of a particular manufacturer
+	info::posting_list::id id = { info::posting_list::type_t::MANUFACTURER, "Tandy Radio Shack" };
+	model.setMachineFilter({ }, info::posting_list::id(id));
+	int expectedRowCount = util::safe_static_cast<int>(std::ranges::count_if(db.machines(), [](const info::machine &machine)
+	{
+		return machine.manufacturer() == "Tandy Radio Shack";
+	}));
+	QVERIFY(expectedRowCount > 0);
+	QVERIFY(model.rowCount(QModelIndex()) == expectedRowCount);
+	for (int row = 0; row < model.rowCount(QModelIndex()); row++)
+		QVERIFY(model.machineFromIndex(model.index(row, 0)).manufacturer() == "Tandy Radio Shack");
+
+	// filters still apply on top of the posting list
+	model.setMachineFilter([](const info::machine &machine) { return machine.name() == "coco2b"; }, info::posting_list::id(id));
+	QVERIFY(model.rowCount(QModelIndex()) == 1);
+	QVERIFY(model.machineFromIndex(model.index(0, 0)).name() == "coco2b");
+
+	// and the posting list gets looked up again when the info DB changes
+	QVERIFY(db.load(buildInfoDatabase(":/resources/listxml_alienar.xml")));
+	QVERIFY(model.rowCount(QModelIndex()) == 0);
+}
+
+
+//-------------------------------------------------
+//  buildLargeInfoDatabase - builds an info DB with
+//	many copies of the machines in listxml_coco.xml,
+//	to get closer to the size of the real thing
+//-------------------------------------------------
+
+QByteArray Test::buildLargeInfoDatabase(int copies)
+{
+	QFile file(":/resources/listxml_coco.xml");
+	if (!file.open(QIODevice::ReadOnly))
+		return QByteArray();
+	QByteArray xml = file.readAll();
+
+	// split the -listxml output into the machines, and what comes before and after them
+	qsizetype machinesBegin = xml.indexOf("<machine ");
+	qsizetype machinesEnd = xml.lastIndexOf("</machine>") + strlen("</machine>");
+	if (machinesBegin < 0 || machinesEnd < machinesBegin)
+		return QByteArray();
+	QByteArray machines = xml.mid(machinesBegin, machinesEnd - machinesBegin);
+
+	// and repeat the machines, giving each copy (and its references to machines) unique names
+	QByteArray largeXml = xml.left(machinesBegin);
+	for (int i = 0; i < copies; i++)
+	{
+		QByteArray prefix = QString("copy%1_").arg(i).toUtf8();
+		largeXml += QByteArray(machines)
+			.replace("<machine name=\"", "<machine name=\"" + prefix)
+			.replace("cloneof=\"", "cloneof=\"" + prefix)
+			.replace("romof=\"", "romof=\"" + prefix)
+			.replace("<device_ref name=\"", "<device_ref name=\"" + prefix)
+			.replace("devname=\"", "devname=\"" + prefix);
+	}
+	largeXml += xml.mid(machinesEnd);
+
+	QTemporaryFile largeXmlFile;
+	if (!largeXmlFile.open() || largeXmlFile.write(largeXml) != largeXml.size() || !largeXmlFile.flush())
+		return QByteArray();
+	return buildInfoDatabase(largeXmlFile.fileName());
+}
+
+
+//-------------------------------------------------
+//  benchmarkPopulateIndexes
+//-------------------------------------------------
+
+void Test::benchmarkPopulateIndexes(std::function<bool(const info::machine &machine)> &&machineFilter)
+{
+	info::database db;
+	MachineListItemModel model(nullptr, db, nullptr, { });
+	QVERIFY(db.load(buildLargeInfoDatabase(100)));
+	QVERIFY(db.machines().size() == 104 * 100);
+
+	QBENCHMARK
+	{
+		model.setMachineFilter(std::function(machineFilter));
+	}
+}
+
+
 //-------------------------------------------------
 
 static TestFixture<Test> fixture;
@@ -25,6 +25,7 @@ namespace
         void statusUpdateRead_mame0227()    { statusUpdateRead(":/resources/status_mame0227_coco2b_1.xml"); }
         void statusUpdateReadError_1()      { statusUpdateReadError(""); }
         void statusUpdateReadError_2()      { statusUpdateReadError("<bogusxml/>"); }
+        void statusUpdatePush();
 
     private:
         void statusUpdateRead(const char *resourceName);
@@ -66,5 +67,36 @@ void Test::statusUpdateReadError(const char *bogusXmlString)
 }
 
 
+//-------------------------------------------------
+//  statusUpdatePush - status pushes only have what
+//  has changed, and the state must keep the rest
+//-------------------------------------------------
+
+void Test::statusUpdatePush()
+{
+    QFile statusUpdateFile(":/resources/status_mame0227_coco2b_1.xml");
+    QVERIFY(statusUpdateFile.open(QIODevice::ReadOnly));
+    status::state state;
+    state.update(status::update::read(statusUpdateFile));
+    QVERIFY(!state.paused().get());
+    QVERIFY(state.images().get().size() == 11);
+
+    QByteArray pushXmlBytes = QString("<status time=\"2\" paused=\"true\">\n\t<video speed_percent=\"0.5\"/>\n</status>\n").toUtf8();
+    QBuffer pushFile(&pushXmlBytes);
+    QVERIFY(pushFile.open(QIODevice::ReadOnly));
+    status::update push = status::update::read(pushFile);
+    QVERIFY(push.m_success);
+    QVERIFY(!push.m_phase);
+    QVERIFY(!push.m_images);
+    state.update(std::move(push));
+
+    QVERIFY(state.paused().get());
+    QVERIFY(state.speed_percent().get() == 0.5f);
+    QVERIFY(state.phase().get() == status::machine_phase::RUNNING);
+    QVERIFY(state.images().get().size() == 11);
+    QVERIFY(state.throttled());
+}
+
+
 static TestFixture<Test> fixture;
 #include "status_test.moc"
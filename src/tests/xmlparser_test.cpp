@@ -10,6 +10,10 @@
 #include "xmlparser.h"
 #include "test.h"
 
+// Qt headers
+#include <QBuffer>
+#include <QTemporaryFile>
+
 
 class XmlParser::Test : public QObject
 {
@@ -22,8 +26,12 @@ private slots:
 	void skipping();
 	void multiple();
 	void recursive();
+	void attributeLookups();
+	void parseFile();
+	void parseBufferAtPosition();
 	void localeSensitivity();
 	void xmlParsingError();
+	void tokenizerBackend();
 
 	void attributeParsingError_int_1()		{ attributeParsingError<int>("<alpha><bravo value=\"NOT_AN_INTEGER\"/></alpha>"); }
 	void attributeParsingError_int_2()		{ attributeParsingError<int>("<alpha><bravo value=\"42_NOT_AN_INTEGER_42\"/></alpha>"); }
@@ -32,8 +40,15 @@ private slots:
 	void attributeParsingError_float_1()	{ attributeParsingError<float>("<alpha><bravo value=\"NOT_A_FLOAT\"/></alpha>"); }
 	void attributeParsingError_float_2()	{ attributeParsingError<float>("<alpha><bravo value=\"42_NOT_A_FLOAT_42\"/></alpha>"); }
 
+	void benchmark_listxml_alienar()			{ benchmarkListXml(":/resources/listxml_alienar.xml", Backend::Expat); }
+	void benchmark_listxml_coco()				{ benchmarkListXml(":/resources/listxml_coco.xml", Backend::Expat); }
+	void benchmark_listxml_alienar_tokenizer()	{ benchmarkListXml(":/resources/listxml_alienar.xml", Backend::Tokenizer); }
+	void benchmark_listxml_coco_tokenizer()		{ benchmarkListXml(":/resources/listxml_coco.xml", Backend::Tokenizer); }
+
 private:
 	template<class T> void attributeParsingError(const char *xml);
+	static std::u8string callbackTrace(const QByteArray &xmlText, Backend backend, bool &success);
+	void benchmarkListXml(const QString &fileName, Backend backend);
 };
 
 
@@ -281,6 +296,95 @@ void XmlParser::Test::recursive()
 }
 
 
+//-------------------------------------------------
+//  attributeLookups - multiple get() calls on the
+//	same element, with names never seen before
+//-------------------------------------------------
+
+void XmlParser::Test::attributeLookups()
+{
+	XmlParser xml;
+	QString values;
+	xml.onElementBegin({ "alpha", "bravo" }, [&](const XmlParser::Attributes &attributes)
+	{
+		const auto [charlieAttr, deltaAttr] = attributes.get("charlie", "delta");
+		const auto [echoAttr, charlieAttr2] = attributes.get("echo", "charlie");
+		const auto [foxtrotAttr] = attributes.get(std::string("fox") + "trot");
+		for (const Attribute &attr : { charlieAttr, deltaAttr, echoAttr, charlieAttr2, foxtrotAttr })
+			values += attr.as<QString>().value_or("-");
+		values += "|";
+	});
+
+	const char *xmlText =
+		"<alpha>"
+		"<bravo charlie=\"C\" echo=\"E\"/>"
+		"<bravo delta=\"D\" foxtrot=\"F\"/>"
+		"<bravo/>"
+		"<bravo foxtrot=\"f\" echo=\"e\" delta=\"d\" charlie=\"c\"/>"
+		"</alpha>";
+	bool result = xml.parseBytes(xmlText, strlen(xmlText));
+	QVERIFY(result);
+	QVERIFY(values == "C-EC-|-D--F|-----|cdecf|");
+}
+
+
+//-------------------------------------------------
+//  parseFile - files are mapped into memory rather
+//	than read
+//-------------------------------------------------
+
+void XmlParser::Test::parseFile()
+{
+	// create a file big enough to span several buffers
+	QTemporaryFile file;
+	QVERIFY(file.open());
+	const int ENTRY_COUNT = 100000;
+	file.write("<alpha>");
+	for (int i = 0; i < ENTRY_COUNT; i++)
+		file.write(QString("<bravo value=\"%1\" padding=\"ABCDEFGHIJKLMNOPQRSTUVWXYZ\"/>\n").arg(i).toUtf8());
+	file.write("</alpha>");
+	file.close();
+
+	XmlParser xml;
+	std::int64_t total = 0;
+	xml.onElementBegin({ "alpha", "bravo" }, [&](const XmlParser::Attributes &attributes)
+	{
+		const auto [valueAttr] = attributes.get("value");
+		total += *valueAttr.as<int>();
+	});
+	bool result = xml.parse(file.fileName());
+	QVERIFY(result);
+	QVERIFY(total == (std::int64_t)ENTRY_COUNT * (ENTRY_COUNT - 1) / 2);
+}
+
+
+//-------------------------------------------------
+//  parseBufferAtPosition - buffers are parsed in
+//	place from their current position, and are left
+//	where reading would have left them
+//-------------------------------------------------
+
+void XmlParser::Test::parseBufferAtPosition()
+{
+	QByteArray byteArray = "GARBAGE<alpha><bravo value=\"42\"/></alpha>";
+	QBuffer buffer(&byteArray);
+	QVERIFY(buffer.open(QIODevice::ReadOnly));
+	QVERIFY(buffer.seek(7));
+
+	XmlParser xml;
+	std::optional<int> value;
+	xml.onElementBegin({ "alpha", "bravo" }, [&](const XmlParser::Attributes &attributes)
+	{
+		const auto [valueAttr] = attributes.get("value");
+		value = valueAttr.as<int>();
+	});
+	bool result = xml.parse(buffer);
+	QVERIFY(result);
+	QVERIFY(value == 42);
+	QVERIFY(buffer.atEnd());
+}
+
+
 //-------------------------------------------------
 //  localeSensitivity - checks to see if we have
 //	problems due to sensitivity on the current locale
@@ -355,6 +459,174 @@ void XmlParser::Test::attributeParsingError(const char *xmlText)
 }
 
 
+//-------------------------------------------------
+//  tokenizerBackend - the tokenizer backend has to
+//	produce exactly the same callbacks and errors as
+//	expat, whether it tokenizes a document itself or
+//	falls back to expat
+//-------------------------------------------------
+
+void XmlParser::Test::tokenizerBackend()
+{
+	std::vector<QByteArray> xmlTexts =
+	{
+		// documents the tokenizer takes
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<!DOCTYPE mame [\n"
+		"<!ELEMENT mame (machine+)>\n"
+		"<!ATTLIST mame build CDATA #IMPLIED>\n"
+		"<!ATTLIST machine name CDATA #REQUIRED isbios (yes|no) \"no\">\n"
+		"]>\n"
+		"<mame build=\"0.229\">\n"
+		"\t<machine name=\"alpha\" isbios=\"yes\"><description>Alpha &amp; Bravo &#x263A;</description></machine>\n"
+		"\t<!-- a comment -->\n"
+		"\t<machine name='bravo'><description>Line\r\nEnding</description><rom name=\"tab\there\" size=\"64\"/></machine>\n"
+		"\t<machine name=\"\xC3\xA9\"><rom name=\"x\" size=\"NOT_A_NUMBER\"/></machine>\n"
+		"</mame>\n",
+
+		// documents the tokenizer leaves to expat
+		"<mame><machine name=\"alpha\"><description><![CDATA[<Alpha>]]></description></machine></mame>",
+		"<!DOCTYPE mame [<!ENTITY bravo \"Bravo\">]><mame><machine name=\"alpha\"><description>&bravo;</description></machine></mame>",
+		"<mame><machine name=\"alpha\"><?pi?><rom name=\"x\" size=\"NOT_A_NUMBER\"/></machine></mame>",
+
+		// documents nobody takes
+		"<mame><machine name=\"alpha\"><rom size=\"NOT_A_NUMBER\"/></machine></mame",
+		"<mame><machine name=\"alpha\"></mame>",
+		"<mame><machine name=\"alpha\" name=\"bravo\"/></mame>",
+		"<mame><machine name=\"alpha\">\x01</machine></mame>"
+	};
+
+	for (const QByteArray &xmlText : xmlTexts)
+	{
+		bool expatSuccess, tokenizerSuccess;
+		std::u8string expatTrace = callbackTrace(xmlText, Backend::Expat, expatSuccess);
+		std::u8string tokenizerTrace = callbackTrace(xmlText, Backend::Tokenizer, tokenizerSuccess);
+		QVERIFY(expatTrace == tokenizerTrace);
+		QVERIFY(expatSuccess == tokenizerSuccess);
+	}
+}
+
+
+//-------------------------------------------------
+//  callbackTrace
+//-------------------------------------------------
+
+std::u8string XmlParser::Test::callbackTrace(const QByteArray &xmlText, Backend backend, bool &success)
+{
+	std::u8string result;
+	XmlParser xml;
+	xml.setBackend(backend);
+	xml.onElementBegin({ "mame" }, [&](const XmlParser::Attributes &attributes)
+	{
+		const auto [buildAttr] = attributes.get("build");
+		result += u8"mame build=" + std::u8string(buildAttr.as<std::u8string_view>().value_or(u8"(none)")) + u8"\n";
+	});
+	xml.onElementBegin({ "mame", "machine" }, [&](const XmlParser::Attributes &attributes)
+	{
+		const auto [nameAttr, isBiosAttr] = attributes.get("name", "isbios");
+		result += u8"machine name=" + std::u8string(nameAttr.as<std::u8string_view>().value_or(u8"(none)"))
+			+ u8" isbios=" + (isBiosAttr.as<bool>().value_or(false) ? u8"yes" : u8"no") + u8"\n";
+	});
+	xml.onElementEnd({ "mame", "machine", "description" }, [&](std::u8string &&content)
+	{
+		result += u8"description=" + content + u8"\n";
+	});
+	xml.onElementBegin({ "mame", "machine", "rom" }, [&](const XmlParser::Attributes &attributes)
+	{
+		const auto [nameAttr, sizeAttr] = attributes.get("name", "size");
+		result += u8"rom name=" + std::u8string(nameAttr.as<std::u8string_view>().value_or(u8"(none)"))
+			+ u8" size=" + (const char8_t *)std::to_string(sizeAttr.as<std::uint32_t>().value_or(0)).c_str() + u8"\n";
+	});
+	xml.onElementEnd({ "mame", "machine" }, [&]()
+	{
+		result += u8"end machine\n";
+	});
+
+	success = xml.parseBytes(xmlText.constData(), xmlText.size());
+	for (const Error &error : xml.m_errors)
+	{
+		QString errorText = QString("error %1:%2: %3\n%4\n").arg(
+			QString::number(error.m_lineNumber),
+			QString::number(error.m_columnNumber),
+			error.m_message,
+			error.m_context);
+		result += (const char8_t *)errorText.toUtf8().constData();
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  benchmarkListXml - parses -listxml output with
+//	its machines repeated to a more realistic size,
+//	requesting roughly what info::database_builder
+//	requests
+//-------------------------------------------------
+
+void XmlParser::Test::benchmarkListXml(const QString &fileName, Backend backend)
+{
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QByteArray listXml = file.readAll();
+	qsizetype machinesBegin = listXml.indexOf("<machine ");
+	qsizetype machinesEnd = listXml.lastIndexOf("</mame>");
+	QVERIFY(machinesBegin > 0 && machinesEnd > machinesBegin);
+
+	QByteArray xmlText = listXml.left(machinesBegin);
+	while (xmlText.size() < 64 * 1024 * 1024)
+		xmlText += listXml.mid(machinesBegin, machinesEnd - machinesBegin);
+	xmlText += "</mame>";
+
+	QBENCHMARK
+	{
+		XmlParser xml;
+		xml.setBackend(backend);
+		std::size_t total = 0;
+		xml.onElementBegin({ "mame", "machine" }, [&](const XmlParser::Attributes &attributes)
+		{
+			const auto [nameAttr, sourceFileAttr, cloneOfAttr, romOfAttr, isBiosAttr, isDeviceAttr, runnableAttr] = attributes.get(
+				"name", "sourcefile", "cloneof", "romof", "isbios", "isdevice", "runnable");
+			total += nameAttr.as<std::u8string_view>().value_or(u8"").size() + bool(cloneOfAttr);
+		});
+		xml.onElementEnd({ { "mame", "machine", "description" },
+						   { "mame", "machine", "year" },
+						   { "mame", "machine", "manufacturer" } }, [&](std::u8string &&content)
+		{
+			total += content.size();
+		});
+		xml.onElementBegin({ "mame", "machine", "rom" }, [&](const XmlParser::Attributes &attributes)
+		{
+			const auto [name, bios, size, crc, sha1, merge, region, offset, status, optional] = attributes.get(
+				"name", "bios", "size", "crc", "sha1", "merge", "region", "offset", "status", "optional");
+			total += size.as<std::uint32_t>().value_or(0) + bool(crc) + bool(sha1);
+		});
+		xml.onElementBegin({ { "mame", "machine", "device_ref" },
+							 { "mame", "machine", "sample" } }, [&](const XmlParser::Attributes &attributes)
+		{
+			const auto [nameAttr] = attributes.get("name");
+			total += bool(nameAttr);
+		});
+		xml.onElementBegin({ "mame", "machine", "chip" }, [&](const XmlParser::Attributes &attributes)
+		{
+			const auto [typeAttr, tagAttr, nameAttr, clockAttr] = attributes.get("type", "tag", "name", "clock");
+			total += clockAttr.as<std::uint64_t>().value_or(0) != 0;
+		});
+		xml.onElementBegin({ "mame", "machine", "device" }, [&](const XmlParser::Attributes &attributes)
+		{
+			const auto [typeAttr, tagAttr, mandatoryAttr, interfaceAttr] = attributes.get("type", "tag", "mandatory", "interface");
+			total += bool(typeAttr);
+		});
+		xml.onElementBegin({ "mame", "machine", "slot", "slotoption" }, [&](const XmlParser::Attributes &attributes)
+		{
+			const auto [nameAttr, devNameAttr, defaultAttr] = attributes.get("name", "devname", "default");
+			total += bool(nameAttr);
+		});
+		QVERIFY(xml.parseBytes(xmlText.constData(), xmlText.size()));
+		QVERIFY(total > 0);
+	}
+}
+
+
 //-------------------------------------------------
 
 static TestFixture<XmlParser::Test> fixture;
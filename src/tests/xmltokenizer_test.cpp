@@ -0,0 +1,228 @@
+/***************************************************************************
+
+    xmltokenizer_test.cpp
+
+    Unit tests for xmltokenizer.cpp
+
+***************************************************************************/
+
+// bletchmame headers
+#include "xmltokenizer.h"
+#include "test.h"
+
+
+class XmlTokenizer::Test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+	void tokens();
+	void references();
+	void lineEndings();
+	void attributeDefaults();
+	void longText();
+	void anomalies();
+
+private:
+	static std::string trace(const XmlTokenizer &tokenizer);
+	static bool tokenize(XmlTokenizer &tokenizer, std::string_view xmlText);
+};
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  tokens
+//-------------------------------------------------
+
+void XmlTokenizer::Test::tokens()
+{
+	const char *xmlText =
+		"<?xml version=\"1.0\"?>\n"
+		"<!-- comment -->\n"
+		"<alpha bravo=\"charlie\" delta = 'echo'>\n"
+		"\t<foxtrot/>\n"
+		"\t<golf hotel=\"\">india</golf>\n"
+		"</alpha>\n";
+
+	XmlTokenizer tokenizer;
+	QVERIFY(tokenize(tokenizer, xmlText));
+	QVERIFY(trace(tokenizer) ==
+		"<alpha bravo=charlie delta=echo>"
+		"[\n\t]<foxtrot></foxtrot>[\n\t]"
+		"<golf hotel=>[india]</golf>[\n]"
+		"</alpha>");
+
+	// offsets are where things are in the original document
+	const Token &startToken = tokenizer.tokens()[0];
+	QVERIFY(startToken.m_type == TokenType::StartElement);
+	QVERIFY(std::string_view(xmlText).substr(startToken.m_offset - 1, 6) == "<alpha");
+}
+
+
+//-------------------------------------------------
+//  references
+//-------------------------------------------------
+
+void XmlTokenizer::Test::references()
+{
+	XmlTokenizer tokenizer;
+	QVERIFY(tokenize(tokenizer, "<a b=\"&lt;&gt;&amp;&quot;&apos;\">&#65;&#x42;&#xE9;&#x263A;&#x1F600;</a>"));
+	QVERIFY(trace(tokenizer) == "<a b=<>&\"'>[AB\xC3\xA9\xE2\x98\xBA\xF0\x9F\x98\x80]</a>");
+}
+
+
+//-------------------------------------------------
+//  lineEndings
+//-------------------------------------------------
+
+void XmlTokenizer::Test::lineEndings()
+{
+	XmlTokenizer tokenizer;
+	QVERIFY(tokenize(tokenizer, "<a b=\"1\t2\n3\r\n4\r5&#13;6\">1\r\n2\r3&#13;4</a>"));
+	QVERIFY(trace(tokenizer) == "<a b=1 2 3 4 5\r6>[1\n2\n3\r4]</a>");
+}
+
+
+//-------------------------------------------------
+//  attributeDefaults
+//-------------------------------------------------
+
+void XmlTokenizer::Test::attributeDefaults()
+{
+	const char *xmlText =
+		"<!DOCTYPE alpha [\n"
+		"<!ELEMENT alpha (bravo*)>\n"
+		"<!ELEMENT bravo EMPTY>\n"
+		"<!ATTLIST bravo\n"
+		"\tcharlie CDATA #REQUIRED\n"
+		"\tdelta (yes|no) \"no\"\n"
+		"\techo CDATA \"foxtrot &amp; golf\"\n"
+		"\tdelta (yes|no) \"ignored\">\n"
+		"]>\n"
+		"<alpha><bravo charlie=\"1\"/><bravo delta=\"yes\" charlie=\"2\"/></alpha>";
+
+	XmlTokenizer tokenizer;
+	QVERIFY(tokenize(tokenizer, xmlText));
+	QVERIFY(trace(tokenizer) ==
+		"<alpha>"
+		"<bravo charlie=1 delta=no echo=foxtrot & golf></bravo>"
+		"<bravo delta=yes charlie=2 echo=foxtrot & golf></bravo>"
+		"</alpha>");
+}
+
+
+//-------------------------------------------------
+//  longText - text and attributes long enough to
+//	be scanned a vector at a time
+//-------------------------------------------------
+
+void XmlTokenizer::Test::longText()
+{
+	std::string text;
+	for (int i = 0; i < 100; i++)
+		text += "0123456789abcdef";
+	std::string xmlText = "<a b=\"" + text + "&amp;" + text + "\">" + text + "&amp;" + text + "\r\n" + text + "</a>";
+
+	XmlTokenizer tokenizer;
+	QVERIFY(tokenize(tokenizer, xmlText));
+	QVERIFY(trace(tokenizer) == "<a b=" + text + "&" + text + ">[" + text + "&" + text + "\n" + text + "]</a>");
+}
+
+
+//-------------------------------------------------
+//  anomalies - anything that we cannot tokenize
+//	exactly as expat would has to be refused
+//-------------------------------------------------
+
+void XmlTokenizer::Test::anomalies()
+{
+	const char *xmlTexts[] =
+	{
+		// things that expat takes but we leave to it
+		"<a><![CDATA[b]]></a>",
+		"<a><?b c?></a>",
+		"<!DOCTYPE a [<!ENTITY b \"c\">]><a>&b;</a>",
+		"<!DOCTYPE a [<!ATTLIST a b NMTOKENS #IMPLIED>]><a b=\" c  d \"/>",
+		"<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?><a/>",
+		"<\xC3\xA9/>",
+
+		// things that are not well formed
+		"",
+		"<a>",
+		"<a></b>",
+		"<a></ab>",
+		"<a/><b/>",
+		"b<a/>",
+		"<a/>b",
+		"<a b=\"1\" b=\"2\"/>",
+		"<a b=\"1\"c=\"2\"/>",
+		"<a b=\"<\"/>",
+		"<a>]]></a>",
+		"<a>&b;</a>",
+		"<a>&#0;</a>",
+		"<a>&#xD800;</a>",
+		"<a><!-- b -- c --></a>",
+		"<a>\x01</a>",
+		"<a>\xC0\x80</a>",
+		"<a>\xED\xA0\x80</a>",
+		"<a>\xEF\xBF\xBE</a>",
+		"<a>\xE2\x82</a>",
+		"<?xml encoding=\"UTF-8\"?><a/>",
+		"<!DOCTYPE a [<!ELEMENT a (b,c|d)>]><a/>",
+		"<!DOCTYPE a [<!ATTLIST a b (c|) \"c\">]><a/>"
+	};
+
+	XmlTokenizer tokenizer;
+	for (const char *xmlText : xmlTexts)
+		QVERIFY(!tokenize(tokenizer, xmlText));
+}
+
+
+//-------------------------------------------------
+//  trace - renders the tokens as text
+//-------------------------------------------------
+
+std::string XmlTokenizer::Test::trace(const XmlTokenizer &tokenizer)
+{
+	std::string result;
+	for (const Token &token : tokenizer.tokens())
+	{
+		switch (token.m_type)
+		{
+		case TokenType::StartElement:
+			result += std::string("<") + tokenizer.string(token.m_offset);
+			for (std::size_t i = 0; i < tokenizer.attributes(token).size(); i += 2)
+				result += std::string(" ") + tokenizer.string(tokenizer.attributes(token)[i + 0]) + "=" + tokenizer.string(tokenizer.attributes(token)[i + 1]);
+			result += ">";
+			break;
+
+		case TokenType::EndElement:
+			result += std::string("</") + tokenizer.string(token.m_offset) + ">";
+			break;
+
+		case TokenType::Text:
+			result += "[" + std::string(tokenizer.string(token.m_offset), token.m_count) + "]";
+			break;
+		}
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  tokenize
+//-------------------------------------------------
+
+bool XmlTokenizer::Test::tokenize(XmlTokenizer &tokenizer, std::string_view xmlText)
+{
+	return tokenizer.tokenize(std::span<const char>(xmlText.data(), xmlText.size()));
+}
+
+
+//-------------------------------------------------
+
+static TestFixture<XmlTokenizer::Test> fixture;
+#include "xmltokenizer_test.moc"
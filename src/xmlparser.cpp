@@ -9,6 +9,7 @@
 // bletchmame headers
 #include "xmlparser.h"
 #include "perfprofiler.h"
+#include "throughputtracker.h"
 
 // dependency headers
 #include <expat.h>
@@ -16,8 +17,10 @@
 // Qt headers
 #include <QBuffer>
 #include <QCoreApplication>
+#include <QFileDevice>
 
 // standard headers
+#include <algorithm>
 #include <charconv>
 #include <inttypes.h>
 #include <string>
@@ -31,8 +34,12 @@
 //  CONSTANTS
 //**************************************************************************
 
-#define LOG_XML_PARSING	0
-#define LOG_XML_DATA	0
+#define LOG_XML_PARSING		0
+#define LOG_XML_DATA		0
+#define LOG_XML_THROUGHPUT	0
+
+// large reads keep the per-read overhead (and expat's per-buffer overhead) negligible
+static const std::size_t BUFFER_SIZE = 1024 * 1024;
 
 
 //**************************************************************************
@@ -166,6 +173,12 @@ thread_local XmlParser *XmlParser::s_currentParser;
 
 XmlParser::XmlParser()
 	: m_root(std::make_unique<Node>())
+	, m_compiled(false)
+	, m_attributeGeneration(0)
+	, m_attributeSlotsGeneration(0)
+	, m_attributeSlotsNameCount(0)
+	, m_backend(Backend::Expat)
+	, m_tokenizerPosition(0)
 {
 	m_parser = XML_ParserCreate(nullptr);
 
@@ -191,18 +204,37 @@ XmlParser::~XmlParser()
 
 bool XmlParser::parse(QIODevice &input) noexcept
 {
-	// push the initial node onto the stack
-	assert(m_currentNodeStack.empty());
-	m_currentNodeStack.push(m_root.get());
+	// inputs that are already in memory (or that can be mapped into memory) are fed to
+	// expat directly rather than being read
+	std::span<const char> memory;
+	bool inMemory = false;
+	uchar *mapping = nullptr;
+	QFileDevice *file = dynamic_cast<QFileDevice *>(&input);
+	if (QBuffer *buffer = dynamic_cast<QBuffer *>(&input); buffer && buffer->isReadable() && buffer->pos() <= buffer->data().size())
+	{
+		memory = std::span<const char>(buffer->data().constData() + buffer->pos(), util::safe_static_cast<std::size_t>(buffer->data().size() - buffer->pos()));
+		inMemory = true;
+	}
+	else if (file && file->isReadable() && !file->isSequential() && file->size() > file->pos())
+	{
+		mapping = file->map(file->pos(), file->size() - file->pos());
+		if (mapping)
+		{
+			memory = std::span<const char>((const char *)mapping, util::safe_static_cast<std::size_t>(file->size() - file->pos()));
+			inMemory = true;
+		}
+	}
 
 	// parse all the things!
-	s_currentParser = this;
-	bool success = internalParse(input);
-	s_currentParser = nullptr;
-
-	// clear out the node stack and return
-	assert(!success || m_currentNodeStack.size() == 1);
-	m_currentNodeStack = decltype(m_currentNodeStack)();
+	bool success = inMemory
+		? internalParse(nullptr, memory)
+		: internalParse(&input, { });
+
+	// if we bypassed reading, leave the input where reading would have left it
+	if (inMemory)
+		input.seek(input.pos() + memory.size());
+	if (mapping)
+		file->unmap(mapping);
 	return success;
 }
 
@@ -226,77 +258,101 @@ bool XmlParser::parse(const QString &file_name) noexcept
 
 bool XmlParser::parseBytes(const void *ptr, size_t sz) noexcept
 {
-	QByteArray byteArray((const char *) ptr, (int)sz);
-	QBuffer input(&byteArray);
-	return input.open(QIODevice::ReadOnly)
-		&& parse(input);
+	return internalParse(nullptr, std::span<const char>((const char *)ptr, sz));
 }
 
 
 //-------------------------------------------------
-//  internalParse
+//  internalParse - parses either from an input
+//	device or from memory
 //-------------------------------------------------
 
-bool XmlParser::internalParse(QIODevice &input) noexcept
+bool XmlParser::internalParse(QIODevice *input, std::span<const char> memory) noexcept
 {
 	ProfilerScope prof(CURRENT_FUNCTION);
 
-	bool done = false;
-
 	if (LOG_XML_PARSING)
 		qDebug("XmlParser::internalParse(): beginning parse");
 
-	// if appropriate, log the XML data
+	// freeze the registered element paths into the dispatch table if we have not already
+	if (!m_compiled)
+		compile();
+
+	// push the initial state onto the stack
+	assert(m_stateStack.empty());
+	m_stateStack.push_back(0);
+
+	// if appropriate, log the XML data and/or the throughput
 	std::optional<QFile> xmlDataLog;
-	if (LOG_XML_DATA)
+	std::optional<ThroughputTracker> throughputTracker;
+	QString appDirPath = LOG_XML_DATA || LOG_XML_THROUGHPUT
+		? QCoreApplication::applicationDirPath()
+		: QString();
+	if (LOG_XML_DATA && !appDirPath.isEmpty())
 	{
-		QString appDirPath = QCoreApplication::applicationDirPath();
-		if (!appDirPath.isEmpty())
-		{
-			xmlDataLog.emplace(QString("%1/parsedxml.xml").arg(appDirPath));
-			if (!xmlDataLog->open(QIODeviceBase::WriteOnly))
-				xmlDataLog.reset();
-		}
+		xmlDataLog.emplace(QString("%1/parsedxml.xml").arg(appDirPath));
+		if (!xmlDataLog->open(QIODeviceBase::WriteOnly))
+			xmlDataLog.reset();
 	}
+	if (LOG_XML_THROUGHPUT && !appDirPath.isEmpty())
+		throughputTracker.emplace(QString("%1/xmlthroughput.txt").arg(appDirPath));
 
-	while (!done)
+	// parse all the things!
+	s_currentParser = this;
+	if (input)
 	{
-		// this seems to be necssary when reading from a QProcess
-		input.waitForReadyRead(-1);
-
-		// parse one buffer
-		if (!parseSingleBuffer(input, xmlDataLog, done))
+		bool done = false;
+		while (!done)
 		{
-			// an error happened; append the error and bail out
-			appendCurrentXmlError();
-			done = true;
+			// this seems to be necssary when reading from a QProcess
+			input->waitForReadyRead(-1);
+
+			// parse one buffer
+			if (!parseSingleBuffer(*input, xmlDataLog, throughputTracker, done))
+			{
+				// an error happened; append the error and bail out
+				appendCurrentXmlError();
+				done = true;
+			}
 		}
 	}
+	else
+	{
+		bool success = m_backend == Backend::Tokenizer
+			? parseTokenized(memory, xmlDataLog, throughputTracker)
+			: parseMemory(memory, xmlDataLog, throughputTracker);
+		if (!success)
+			appendCurrentXmlError();
+	}
+	s_currentParser = nullptr;
 
 	bool success = m_errors.size() == 0;
 	if (LOG_XML_PARSING)
 		qDebug("XmlParser::internalParse(): ending parse (success=%s)", success ? "true" : "false");
+
+	// clear out the state stack and return
+	assert(!success || m_stateStack.size() == 1);
+	m_stateStack.clear();
 	return success;
 }
 
 
 //-------------------------------------------------
-//  parseSingleBuffer
+//  parseSingleBuffer - reads directly into expat's
+//	buffer
 //-------------------------------------------------
 
-bool XmlParser::parseSingleBuffer(QIODevice &input, std::optional<QFile> &xmlDataLog, bool &done) noexcept
+bool XmlParser::parseSingleBuffer(QIODevice &input, std::optional<QFile> &xmlDataLog, std::optional<ThroughputTracker> &throughputTracker, bool &done) noexcept
 {
-	const int bufferSize = 131072;
-
 	// get expat's buffer
-	void *buffer = XML_GetBuffer(m_parser, bufferSize);
+	void *buffer = XML_GetBuffer(m_parser, (int)BUFFER_SIZE);
 	if (!buffer)
 		return false;
 
 	// read data
-	int lastRead = input.read((char *) buffer, bufferSize);
+	qint64 lastRead = input.read((char *) buffer, BUFFER_SIZE);
 	if (LOG_XML_PARSING)
-		qDebug("XmlParser::parseSingleBuffer(): input.read() returned %d", lastRead);
+		qDebug("XmlParser::parseSingleBuffer(): input.read() returned %d", (int)lastRead);
 
 	// figure out if we're done (note that with read(), while the documentation states that
 	// '0' signifies end of input and a negative number signifies an error condition such
@@ -307,9 +363,93 @@ bool XmlParser::parseSingleBuffer(QIODevice &input, std::optional<QFile> &xmlDat
 	// log the XML data if appropriate
 	if (xmlDataLog && lastRead > 0)
 		xmlDataLog->write((const char *) buffer, lastRead);
+	if (throughputTracker && lastRead > 0)
+		throughputTracker->mark((double)lastRead);
 
 	// and feed this into expat
-	return XML_ParseBuffer(m_parser, done ? 0 : lastRead, done) != XML_STATUS_ERROR;
+	return XML_ParseBuffer(m_parser, done ? 0 : (int)lastRead, done) != XML_STATUS_ERROR;
+}
+
+
+//-------------------------------------------------
+//  parseMemory - feeds memory to expat in slices;
+//	expat is normally built with XML_CONTEXT_BYTES,
+//	in which case it copies each slice into its own
+//	buffer, but that is the only copy made
+//-------------------------------------------------
+
+bool XmlParser::parseMemory(std::span<const char> memory, std::optional<QFile> &xmlDataLog, std::optional<ThroughputTracker> &throughputTracker) noexcept
+{
+	bool done = false;
+	while (!done)
+	{
+		std::span<const char> slice = memory.first(std::min(memory.size(), BUFFER_SIZE));
+		memory = memory.subspan(slice.size());
+		done = memory.empty();
+
+		// log the XML data if appropriate
+		if (xmlDataLog)
+			xmlDataLog->write(slice.data(), slice.size());
+		if (throughputTracker)
+			throughputTracker->mark((double)slice.size());
+
+		if (XML_Parse(m_parser, slice.data(), (int)slice.size(), done) == XML_STATUS_ERROR)
+			return false;
+	}
+	return true;
+}
+
+
+//-------------------------------------------------
+//  parseTokenized - tokenizes the whole document
+//	and then dispatches the tokens; if XmlTokenizer
+//	balks, nothing has been dispatched yet and we
+//	can hand the document to expat instead
+//-------------------------------------------------
+
+bool XmlParser::parseTokenized(std::span<const char> memory, std::optional<QFile> &xmlDataLog, std::optional<ThroughputTracker> &throughputTracker) noexcept
+{
+	if (!m_tokenizer.tokenize(memory))
+	{
+		if (LOG_XML_PARSING)
+			qDebug("XmlParser::parseTokenized(): falling back to expat");
+		return parseMemory(memory, xmlDataLog, throughputTracker);
+	}
+
+	// log the XML data if appropriate
+	if (xmlDataLog)
+		xmlDataLog->write(memory.data(), memory.size());
+
+	m_tokenizerSource = memory;
+	for (const XmlTokenizer::Token &token : m_tokenizer.tokens())
+	{
+		switch (token.m_type)
+		{
+		case XmlTokenizer::TokenType::StartElement:
+			m_tokenizerPosition = token.m_offset - 1;
+			m_tokenizerAttributes.clear();
+			for (std::uint32_t offset : m_tokenizer.attributes(token))
+				m_tokenizerAttributes.push_back(m_tokenizer.string(offset));
+			m_tokenizerAttributes.push_back(nullptr);
+			startElement(m_tokenizer.string(token.m_offset), m_tokenizerAttributes.data());
+			break;
+
+		case XmlTokenizer::TokenType::EndElement:
+			m_tokenizerPosition = token.m_index;
+			endElement(m_tokenizer.string(token.m_offset));
+			break;
+
+		case XmlTokenizer::TokenType::Text:
+			m_tokenizerPosition = token.m_offset;
+			characterData(m_tokenizer.string(token.m_offset), (int)token.m_count);
+			break;
+		}
+	}
+	m_tokenizerSource = { };
+
+	if (throughputTracker)
+		throughputTracker->mark((double)memory.size());
+	return true;
 }
 
 
@@ -332,10 +472,38 @@ ATTR_COLD void XmlParser::appendCurrentXmlError() noexcept
 ATTR_COLD void XmlParser::appendError(QString &&message) noexcept
 {
 	Error &error = m_errors.emplace_back();
-	error.m_lineNumber = XML_GetCurrentLineNumber(m_parser);
-	error.m_columnNumber = XML_GetCurrentColumnNumber(m_parser);
 	error.m_message = std::move(message);
-	error.m_context = errorContext();
+	if (m_tokenizerSource.empty())
+	{
+		error.m_lineNumber = XML_GetCurrentLineNumber(m_parser);
+		error.m_columnNumber = XML_GetCurrentColumnNumber(m_parser);
+		error.m_context = errorContext();
+	}
+	else
+	{
+		// we are dispatching tokens, so expat has no idea where we are; count lines and
+		// columns the way it does (columns are in characters, not bytes)
+		error.m_lineNumber = 1;
+		error.m_columnNumber = 0;
+		for (std::size_t i = 0; i < m_tokenizerPosition; i++)
+		{
+			char ch = m_tokenizerSource[i];
+			if (ch == '\n' || (ch == '\r' && (i + 1 >= m_tokenizerSource.size() || m_tokenizerSource[i + 1] != '\n')))
+			{
+				error.m_lineNumber++;
+				error.m_columnNumber = 0;
+			}
+			else if (ch != '\r' && ((std::uint8_t)ch & 0xC0) != 0x80)
+			{
+				error.m_columnNumber++;
+			}
+		}
+
+		// and take a window of context much like expat's
+		std::size_t contextBegin = m_tokenizerPosition - std::min<std::size_t>(m_tokenizerPosition, 1024);
+		std::size_t contextEnd = std::min<std::size_t>(m_tokenizerSource.size(), m_tokenizerPosition + 1024);
+		error.m_context = errorContext(m_tokenizerSource.data() + contextBegin, (int)(m_tokenizerPosition - contextBegin), (int)(contextEnd - contextBegin));
+	}
 }
 
 
@@ -481,6 +649,9 @@ void XmlParser::onElementEnd(const std::initializer_list<const std::initializer_
 
 XmlParser::Node &XmlParser::getNode(const std::initializer_list<const char *> &elements) noexcept
 {
+	// any registration invalidates the dispatch table
+	m_compiled = false;
+
 	Node *node = m_root.get();
 
 	for (auto iter = elements.begin(); iter != elements.end(); iter++)
@@ -507,51 +678,83 @@ XmlParser::Node &XmlParser::getNode(const std::initializer_list<const char *> &e
 
 
 //-------------------------------------------------
-//  startElement
+//  compile - flattens the tree of nodes into a
+//	table of states, with transitions indexed by
+//	element name ID
 //-------------------------------------------------
 
-void XmlParser::startElement(const char *element, const char **attributes) noexcept
+void XmlParser::compile() noexcept
 {
-	ProfilerScope prof(CURRENT_FUNCTION);
-
-	// only try to find this node in our tables if we are not skipping
-	const Node *currentNode = m_currentNodeStack.top();
-	const Node *childNode;
-	if (currentNode)
+	// assign state indexes breadth first, so that the root is state zero
+	std::unordered_map<const Node *, std::uint32_t> stateIndexes;
+	m_states.clear();
+	m_states.push_back(m_root.get());
+	stateIndexes.emplace(m_root.get(), 0);
+	for (std::size_t i = 0; i < m_states.size(); i++)
 	{
-		// we're in a node - find the child element
-		auto iter = currentNode->m_map.find(element);
-		if (iter != currentNode->m_map.end())
+		for (const auto &[elementName, child] : m_states[i]->m_map)
 		{
-			// we've found the child (which could be the current node if we're recursing)
-			childNode = iter->second ? iter->second.get() : currentNode;
+			m_elementNames.intern(elementName);
+			if (child && stateIndexes.emplace(child.get(), (std::uint32_t)m_states.size()).second)
+				m_states.push_back(child.get());
 		}
-		else
+	}
+
+	// and fill in the transitions; a null child signifies recursion into the same node
+	std::size_t width = m_elementNames.size();
+	m_transitions.assign(m_states.size() * width, NameTable::npos);
+	for (std::size_t i = 0; i < m_states.size(); i++)
+	{
+		for (const auto &[elementName, child] : m_states[i]->m_map)
 		{
-			// this child is unknown - we have to ignore it
-			childNode = nullptr;
+			std::uint32_t elementId = m_elementNames.find(elementName);
+			m_transitions[i * width + elementId] = child ? stateIndexes[child.get()] : (std::uint32_t)i;
 		}
 	}
-	else
+	m_compiled = true;
+}
+
+
+//-------------------------------------------------
+//  startElement
+//-------------------------------------------------
+
+void XmlParser::startElement(const char *element, const char **attributes) noexcept
+{
+	ProfilerScope prof(CURRENT_FUNCTION);
+
+	// only try to find this element in our table if we are not skipping; unknown children
+	// (and children of anything we are ignoring) have to be ignored
+	std::uint32_t currentState = m_stateStack.back();
+	std::uint32_t childState = NameTable::npos;
+	if (currentState != NameTable::npos)
 	{
-		// we're currently in an unknown node and we're ignoring it - so we need to ignore the child too
-		childNode = nullptr;
+		std::uint32_t elementId = m_elementNames.find(element);
+		if (elementId != NameTable::npos)
+			childState = m_transitions[currentState * m_elementNames.size() + elementId];
 	}
+	const Node *childNode = childState != NameTable::npos
+		? m_states[childState]
+		: nullptr;
 
 	// do we have a callback function for beginning this node?
 	if (childNode && childNode->m_beginFunc)
 	{
 		// we do - call it
-		Attributes attributesObject(attributes);
+		m_attributeGeneration++;
+		Attributes attributesObject(*this, attributes);
 		ElementResult result = childNode->m_beginFunc(attributesObject);
 
 		// were we instructed to skip?
 		if (result == ElementResult::Skip)
+		{
+			childState = NameTable::npos;
 			childNode = nullptr;
+		}
 	}
 
 	// and push this onto the stack
-	m_currentNodeStack.push(childNode);
+	m_stateStack.push_back(childState);
 
 	// set up content, but only if we expect to emit it later
 	if (childNode && childNode->m_endFunc)
@@ -566,6 +769,29 @@ void XmlParser::startElement(const char *element, const char **attributes) noexc
 }
 
 
+//-------------------------------------------------
+//  fillAttributeSlots - a single pass over the
+//	attributes of the current element, noting the
+//	value of each attribute whose name has ever
+//	been asked for
+//-------------------------------------------------
+
+void XmlParser::fillAttributeSlots(const char **attributes) noexcept
+{
+	if (m_attributeSlots.size() < m_attributeNames.size())
+		m_attributeSlots.resize(m_attributeNames.size(), AttributeSlot{ 0, nullptr });
+
+	for (auto i = 0; attributes[i]; i += 2)
+	{
+		std::uint32_t id = m_attributeNames.find(attributes[i + 0]);
+		if (id != NameTable::npos)
+			m_attributeSlots[id] = AttributeSlot{ m_attributeGeneration, &attributes[i + 1] };
+	}
+	m_attributeSlotsGeneration = m_attributeGeneration;
+	m_attributeSlotsNameCount = m_attributeNames.size();
+}
+
+
 //-------------------------------------------------
 //  endElement
 //-------------------------------------------------
@@ -575,7 +801,10 @@ void XmlParser::endElement(const char *) noexcept
 	ProfilerScope prof(CURRENT_FUNCTION);
 
 	// call back the end func, if appropriate
-	const Node *currentNode = m_currentNodeStack.top();
+	std::uint32_t currentState = m_stateStack.back();
+	const Node *currentNode = currentState != NameTable::npos
+		? m_states[currentState]
+		: nullptr;
 	if (currentNode && currentNode->m_endFunc)
 	{
 		currentNode->m_endFunc(m_currentContent ? std::move(*m_currentContent) : std::u8string());
@@ -583,7 +812,7 @@ void XmlParser::endElement(const char *) noexcept
 	}
 
 	// and go up the tree
-	m_currentNodeStack.pop();
+	m_stateStack.pop_back();
 }
 
 
@@ -804,8 +1033,142 @@ ATTR_COLD void XmlParser::Attribute::reportAttributeParsingError(const char *att
 //  Attributes ctor
 //-------------------------------------------------
 
-XmlParser::Attributes::Attributes(const char **attributes)
-	: m_attributes(attributes)
+XmlParser::Attributes::Attributes(XmlParser &parser, const char **attributes)
+	: m_parser(parser)
+	, m_attributes(attributes)
 	, m_zero(nullptr)
 {
 }
+
+
+//-------------------------------------------------
+//  Attributes::lookup
+//-------------------------------------------------
+
+void XmlParser::Attributes::lookup(std::span<const std::string_view> names, std::span<std::uint32_t> ids, std::span<Attribute> results) const noexcept
+{
+	// resolve the names first; this is usually a memo hit
+	for (std::size_t i = 0; i < names.size(); i++)
+		ids[i] = m_parser.m_attributeNames.intern(names[i]);
+
+	// the slots are filled at most once per element, unless a name we have never seen
+	// before came along after they were filled
+	if (m_parser.m_attributeSlotsGeneration != m_parser.m_attributeGeneration
+		|| m_parser.m_attributeSlotsNameCount != m_parser.m_attributeNames.size())
+	{
+		m_parser.fillAttributeSlots(m_attributes);
+	}
+
+	for (std::size_t i = 0; i < names.size(); i++)
+	{
+		const AttributeSlot &slot = m_parser.m_attributeSlots[ids[i]];
+		results[i] = slot.m_generation == m_parser.m_attributeGeneration
+			? Attribute(slot.m_valuePtr)
+			: Attribute((const char **)&m_zero);
+	}
+}
+
+
+//-------------------------------------------------
+//  nameHash - 64-bit FNV-1a
+//-------------------------------------------------
+
+static std::size_t nameHash(std::string_view name) noexcept
+{
+	std::uint64_t result = 0xCBF29CE484222325ULL;
+	for (char ch : name)
+		result = (result ^ (std::uint8_t)ch) * 0x100000001B3ULL;
+	return (std::size_t)result;
+}
+
+
+//-------------------------------------------------
+//  memoIndex
+//-------------------------------------------------
+
+static std::size_t memoIndex(const char *ptr, std::size_t memoSize) noexcept
+{
+	return (std::size_t)(((std::uint64_t)(std::uintptr_t)ptr * 0x9E3779B97F4A7C15ULL) >> 32) & (memoSize - 1);
+}
+
+
+//-------------------------------------------------
+//  NameTable ctor
+//-------------------------------------------------
+
+XmlParser::NameTable::NameTable()
+	: m_buckets(64, npos)
+{
+	std::ranges::fill(m_memo, MemoEntry{ nullptr, ~(std::size_t)0, npos });
+}
+
+
+//-------------------------------------------------
+//  NameTable::find
+//-------------------------------------------------
+
+std::uint32_t XmlParser::NameTable::find(std::string_view name) const noexcept
+{
+	// try the memo first; the same pointer could be reused for a different name, so the
+	// name itself has to be checked
+	const MemoEntry &memo = m_memo[memoIndex(name.data(), m_memo.size())];
+	if (memo.m_ptr == name.data() && memo.m_length == name.size() && m_names[memo.m_id] == name)
+		return memo.m_id;
+
+	std::uint32_t id = m_buckets[findBucket(name)];
+	if (id != npos)
+		memoize(name, id);
+	return id;
+}
+
+
+//-------------------------------------------------
+//  NameTable::intern
+//-------------------------------------------------
+
+std::uint32_t XmlParser::NameTable::intern(std::string_view name) noexcept
+{
+	std::uint32_t id = find(name);
+	if (id != npos)
+		return id;
+
+	// keep the buckets at least half empty
+	if ((m_names.size() + 1) * 2 > m_buckets.size())
+	{
+		m_buckets.assign(m_buckets.size() * 2, npos);
+		for (std::uint32_t i = 0; i < m_names.size(); i++)
+			m_buckets[findBucket(m_names[i])] = i;
+	}
+
+	id = (std::uint32_t)m_names.size();
+	m_names.emplace_back(name);
+	m_buckets[findBucket(name)] = id;
+	memoize(name, id);
+	return id;
+}
+
+
+//-------------------------------------------------
+//  NameTable::findBucket - linear probing; returns
+//	either the bucket holding this name or the empty
+//	bucket where it belongs
+//-------------------------------------------------
+
+std::size_t XmlParser::NameTable::findBucket(std::string_view name) const noexcept
+{
+	std::size_t mask = m_buckets.size() - 1;
+	std::size_t bucket = nameHash(name) & mask;
+	while (m_buckets[bucket] != npos && m_names[m_buckets[bucket]] != name)
+		bucket = (bucket + 1) & mask;
+	return bucket;
+}
+
+
+//-------------------------------------------------
+//  NameTable::memoize
+//-------------------------------------------------
+
+void XmlParser::NameTable::memoize(std::string_view name, std::uint32_t id) const noexcept
+{
+	m_memo[memoIndex(name.data(), m_memo.size())] = MemoEntry{ name.data(), name.size(), id };
+}
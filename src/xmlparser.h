@@ -13,6 +13,7 @@
 
 // bletchmame headers
 #include "utility.h"
+#include "xmltokenizer.h"
 
 // Qt headers
 #include <QIODevice>
@@ -22,10 +23,14 @@
 #include <initializer_list>
 #include <memory>
 #include <optional>
-#include <stack>
+#include <span>
+#include <string>
+#include <string_view>
 #include <type_traits>
+#include <vector>
 
 struct XML_ParserStruct;
+class ThroughputTracker;
 
 QT_BEGIN_NAMESPACE
 class QDataStream;
@@ -44,6 +49,14 @@ public:
 		Skip
 	};
 
+	// how documents are parsed; XmlTokenizer only handles documents that are in memory (or
+	// that can be mapped into memory), and anything it does not like goes to expat instead
+	enum class Backend
+	{
+		Expat,
+		Tokenizer
+	};
+
 
 	// ======================> XmlParser
 
@@ -111,7 +124,7 @@ public:
 	class Attributes
 	{
 	public:
-		Attributes(const char **attributes);
+		Attributes(XmlParser &parser, const char **attributes);
 
 		// bulk attribute retrieval
 		template<typename... TArgs>
@@ -120,30 +133,19 @@ public:
 			// convert attributes to an array
 			const std::array<std::string_view, sizeof...(attrs)> attrsArray = { std::forward<TArgs>(attrs)... };
 
-			// prepare an array of results
+			// look them all up in a single pass
+			std::array<std::uint32_t, attrsArray.size()> attrIds;
 			std::array<Attribute, attrsArray.size()> results;
-			std::ranges::fill(results, Attribute((const char **)&m_zero));
-
-			// loop through all attributes
-			for (auto i = 0; m_attributes[i]; i += 2)
-			{
-				std::string_view attrName = m_attributes[i + 0];
-
-				auto iter = std::ranges::find_if(attrsArray, [attrName](std::string_view x)
-				{
-					return attrName == x;
-				});
-				if (iter != attrsArray.end())
-					results[iter - attrsArray.begin()] = Attribute(&m_attributes[i + 1]);
-			}
-
-			// and return
+			lookup(attrsArray, attrIds, results);
 			return results;
 		}
 
 	private:
+		XmlParser &		m_parser;
 		const char **	m_attributes;
 		const char *	m_zero;
+
+		void lookup(std::span<const std::string_view> names, std::span<std::uint32_t> ids, std::span<Attribute> results) const noexcept;
 	};
 
 	// ctor/dtor
@@ -196,6 +198,10 @@ public:
 	bool parseBytes(const void *ptr, size_t sz) noexcept;
 	QString errorMessagesSingleString() const noexcept;
 
+	// accessors
+	Backend backend() const noexcept				{ return m_backend; }
+	void setBackend(Backend backend) noexcept		{ m_backend = backend; }
+
 private:
 	struct Node
 	{
@@ -214,17 +220,79 @@ private:
 		Map							m_map;
 	};
 
-	typedef std::stack<const Node *> NodeStack;
+	// interns element and attribute names into small integer IDs; lookups of the same
+	// pointer (expat interns attribute names, and callers tend to use string literals)
+	// are usually answered by a small direct mapped memo without hashing the name
+	class NameTable
+	{
+	public:
+		static constexpr std::uint32_t npos = ~0;
+
+		NameTable();
+
+		std::uint32_t find(std::string_view name) const noexcept;
+		std::uint32_t intern(std::string_view name) noexcept;
+		std::uint32_t size() const noexcept { return (std::uint32_t)m_names.size(); }
+
+	private:
+		struct MemoEntry
+		{
+			const char *	m_ptr;
+			std::size_t		m_length;
+			std::uint32_t	m_id;
+		};
+
+		std::vector<std::string>		m_names;
+		std::vector<std::uint32_t>		m_buckets;
+		mutable std::array<MemoEntry, 64>	m_memo;
+
+		std::size_t findBucket(std::string_view name) const noexcept;
+		void memoize(std::string_view name, std::uint32_t id) const noexcept;
+	};
+
+	struct AttributeSlot
+	{
+		std::uint64_t	m_generation;
+		const char **	m_valuePtr;
+	};
 
 	thread_local static XmlParser *	s_currentParser;
 	struct XML_ParserStruct *		m_parser;
 	Node::ptr						m_root;
-	NodeStack						m_currentNodeStack;
+	bool							m_compiled;
+
+	// the compiled dispatch table; states are nodes, and each has a row of transitions
+	// indexed by element name ID
+	std::vector<const Node *>		m_states;
+	std::vector<std::uint32_t>		m_transitions;
+	NameTable						m_elementNames;
+	std::vector<std::uint32_t>		m_stateStack;
+
+	// attribute values for the current element, indexed by attribute name ID; slots from
+	// previous elements are recognized by their generation and never need to be cleared
+	NameTable						m_attributeNames;
+	std::vector<AttributeSlot>		m_attributeSlots;
+	std::uint64_t					m_attributeGeneration;
+	std::uint64_t					m_attributeSlotsGeneration;
+	std::uint32_t					m_attributeSlotsNameCount;
+
 	std::optional<std::u8string>	m_currentContent;
 	std::vector<Error>				m_errors;
 
-	bool internalParse(QIODevice &input) noexcept;
-	bool parseSingleBuffer(QIODevice &input, std::optional<QFile> &xmlDataLog, bool &done) noexcept;
+	// the tokenizer backend; while dispatching its tokens, m_tokenizerSource is the document
+	// and m_tokenizerPosition is where in it we are (for reporting errors)
+	Backend							m_backend;
+	XmlTokenizer					m_tokenizer;
+	std::vector<const char *>		m_tokenizerAttributes;
+	std::span<const char>			m_tokenizerSource;
+	std::size_t						m_tokenizerPosition;
+
+	void compile() noexcept;
+	void fillAttributeSlots(const char **attributes) noexcept;
+	bool internalParse(QIODevice *input, std::span<const char> memory) noexcept;
+	bool parseSingleBuffer(QIODevice &input, std::optional<QFile> &xmlDataLog, std::optional<ThroughputTracker> &throughputTracker, bool &done) noexcept;
+	bool parseMemory(std::span<const char> memory, std::optional<QFile> &xmlDataLog, std::optional<ThroughputTracker> &throughputTracker) noexcept;
+	bool parseTokenized(std::span<const char> memory, std::optional<QFile> &xmlDataLog, std::optional<ThroughputTracker> &throughputTracker) noexcept;
 	void startElement(const char *name, const char **attributes) noexcept;
 	void endElement(const char *name) noexcept;
 	void characterData(const char *s, int len) noexcept;
@@ -0,0 +1,1194 @@
+/***************************************************************************
+
+	xmltokenizer.cpp
+
+	Pre-tokenizer for machine generated XML (principally -listxml output);
+	XmlParser can use this as a faster alternative to expat
+
+***************************************************************************/
+
+// bletchmame headers
+#include "xmltokenizer.h"
+#include "perfprofiler.h"
+
+// standard headers
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define XMLTOKENIZER_SSE2	1
+#include <emmintrin.h>
+#else // !SSE2
+#define XMLTOKENIZER_SSE2	0
+#endif // SSE2
+
+#if !XMLTOKENIZER_SSE2 && (defined(__aarch64__) || defined(_M_ARM64))
+#define XMLTOKENIZER_NEON	1
+#include <arm_neon.h>
+#else // !NEON
+#define XMLTOKENIZER_NEON	0
+#endif // NEON
+
+
+//**************************************************************************
+//  LOCALS
+//**************************************************************************
+
+namespace
+{
+	// ======================> ByteScanner
+	// finds the first of up to four particular characters, and optionally the first control
+	// character; sixteen bytes at a time where we have SIMD
+
+	class ByteScanner
+	{
+	public:
+		ByteScanner(char c1, char c2, char c3, char c4, bool controls)
+			: m_chars{ c1, c2, c3, c4 }
+			, m_controls(controls)
+		{
+#if XMLTOKENIZER_SSE2
+			for (int i = 0; i < 4; i++)
+				m_vectors[i] = _mm_set1_epi8(m_chars[i]);
+#elif XMLTOKENIZER_NEON
+			for (int i = 0; i < 4; i++)
+				m_vectors[i] = vdupq_n_u8((std::uint8_t)m_chars[i]);
+#endif
+		}
+
+		char *find(char *p, char *end) const noexcept
+		{
+#if XMLTOKENIZER_SSE2
+			const __m128i controlMax = _mm_set1_epi8(0x1F);
+			while (end - p >= 16)
+			{
+				__m128i chunk = _mm_loadu_si128((const __m128i *)p);
+				__m128i hits = _mm_or_si128(
+					_mm_or_si128(_mm_cmpeq_epi8(chunk, m_vectors[0]), _mm_cmpeq_epi8(chunk, m_vectors[1])),
+					_mm_or_si128(_mm_cmpeq_epi8(chunk, m_vectors[2]), _mm_cmpeq_epi8(chunk, m_vectors[3])));
+				if (m_controls)
+					hits = _mm_or_si128(hits, _mm_cmpeq_epi8(_mm_max_epu8(chunk, controlMax), controlMax));
+				unsigned int mask = (unsigned int)_mm_movemask_epi8(hits);
+				if (mask != 0)
+					return p + std::countr_zero(mask);
+				p += 16;
+			}
+#elif XMLTOKENIZER_NEON
+			const uint8x16_t controlMax = vdupq_n_u8(0x1F);
+			while (end - p >= 16)
+			{
+				uint8x16_t chunk = vld1q_u8((const std::uint8_t *)p);
+				uint8x16_t hits = vorrq_u8(
+					vorrq_u8(vceqq_u8(chunk, m_vectors[0]), vceqq_u8(chunk, m_vectors[1])),
+					vorrq_u8(vceqq_u8(chunk, m_vectors[2]), vceqq_u8(chunk, m_vectors[3])));
+				if (m_controls)
+					hits = vorrq_u8(hits, vcleq_u8(chunk, controlMax));
+				if (vmaxvq_u8(hits) != 0)
+					break;		// the scalar loop below pinpoints it
+				p += 16;
+			}
+#endif
+			while (p < end && !matches(*p))
+				p++;
+			return p;
+		}
+
+	private:
+		std::array<char, 4>		m_chars;
+		bool					m_controls;
+#if XMLTOKENIZER_SSE2
+		__m128i					m_vectors[4];
+#elif XMLTOKENIZER_NEON
+		uint8x16_t				m_vectors[4];
+#endif
+
+		bool matches(char c) const noexcept
+		{
+			return c == m_chars[0] || c == m_chars[1] || c == m_chars[2] || c == m_chars[3]
+				|| (m_controls && (std::uint8_t)c <= 0x1F);
+		}
+	};
+}
+
+
+//**************************************************************************
+//  LOCAL VARIABLES
+//**************************************************************************
+
+// control characters end up in text and attribute values verbatim unless they are
+// whitespace, which we handle ourselves
+static const ByteScanner s_textScanner('<', '&', '\r', ']', false);
+static const ByteScanner s_doubleQuoteScanner('"', '&', '<', '"', true);
+static const ByteScanner s_singleQuoteScanner('\'', '&', '<', '\'', true);
+
+// names are restricted to ASCII; anything else falls back to expat
+static const auto s_nameChars = []
+{
+	std::array<std::uint8_t, 256> result = { };
+	for (int c = 0; c < 256; c++)
+	{
+		bool isNameStartChar = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_' || c == ':';
+		bool isNameChar = isNameStartChar || (c >= '0' && c <= '9') || c == '-' || c == '.';
+		result[c] = (isNameStartChar ? 1 : 0) | (isNameChar ? 2 : 0);
+	}
+	return result;
+}();
+
+
+//**************************************************************************
+//  HELPERS
+//**************************************************************************
+
+//-------------------------------------------------
+//  isSpace
+//-------------------------------------------------
+
+static bool isSpace(char c) noexcept
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+
+//-------------------------------------------------
+//  skipSpace - returns whether there was any
+//-------------------------------------------------
+
+static bool skipSpace(char *&p, char *end) noexcept
+{
+	char *start = p;
+	while (p < end && isSpace(*p))
+		p++;
+	return p != start;
+}
+
+
+//-------------------------------------------------
+//  startsWith
+//-------------------------------------------------
+
+static bool startsWith(const char *p, const char *end, std::string_view s) noexcept
+{
+	return (std::size_t)(end - p) >= s.size() && !memcmp(p, s.data(), s.size());
+}
+
+
+//-------------------------------------------------
+//  scanName - returns the end of the name at p, or
+//	nullptr if there is not one
+//-------------------------------------------------
+
+static char *scanName(char *p, char *end) noexcept
+{
+	if (p >= end || !(s_nameChars[(std::uint8_t)*p] & 1))
+		return nullptr;
+	do
+	{
+		p++;
+	} while (p < end && (s_nameChars[(std::uint8_t)*p] & 2));
+	return p;
+}
+
+
+//-------------------------------------------------
+//  isXmlChar - the characters the XML 1.0 spec
+//	allows in documents at all
+//-------------------------------------------------
+
+static bool isXmlChar(char32_t ch) noexcept
+{
+	return ch == 0x09 || ch == 0x0A || ch == 0x0D
+		|| (ch >= 0x20 && ch <= 0xD7FF)
+		|| (ch >= 0xE000 && ch <= 0xFFFD)
+		|| (ch >= 0x10000 && ch <= 0x10FFFF);
+}
+
+
+//-------------------------------------------------
+//  validateUtf8Sequence - validates a multi byte
+//	UTF-8 sequence and advances past it
+//-------------------------------------------------
+
+static bool validateUtf8Sequence(const char *&p, const char *end) noexcept
+{
+	static const char32_t minimums[] = { 0, 0, 0x80, 0x800, 0x10000 };
+
+	std::uint8_t c = (std::uint8_t)*p;
+	int length;
+	char32_t ch;
+	if ((c & 0xE0) == 0xC0)
+	{
+		length = 2;
+		ch = c & 0x1F;
+	}
+	else if ((c & 0xF0) == 0xE0)
+	{
+		length = 3;
+		ch = c & 0x0F;
+	}
+	else if ((c & 0xF8) == 0xF0)
+	{
+		length = 4;
+		ch = c & 0x07;
+	}
+	else
+	{
+		return false;
+	}
+
+	if (end - p < length)
+		return false;
+	for (int i = 1; i < length; i++)
+	{
+		std::uint8_t b = (std::uint8_t)p[i];
+		if ((b & 0xC0) != 0x80)
+			return false;
+		ch = (ch << 6) | (b & 0x3F);
+	}
+	if (ch < minimums[length] || !isXmlChar(ch))
+		return false;
+
+	p += length;
+	return true;
+}
+
+
+//-------------------------------------------------
+//  validateDocument - checks that the document is
+//	valid UTF-8 with nothing XML disallows; most
+//	documents are nothing but printable ASCII and
+//	whitespace, which we skip over quickly
+//-------------------------------------------------
+
+static bool validateDocument(const char *p, const char *end) noexcept
+{
+#if XMLTOKENIZER_SSE2
+	const __m128i space = _mm_set1_epi8(0x20);
+	const __m128i tab = _mm_set1_epi8('\t');
+	const __m128i lineFeed = _mm_set1_epi8('\n');
+	const __m128i carriageReturn = _mm_set1_epi8('\r');
+#elif XMLTOKENIZER_NEON
+	const uint8x16_t space = vdupq_n_u8(0x20);
+	const uint8x16_t highBit = vdupq_n_u8(0x80);
+	const uint8x16_t tab = vdupq_n_u8('\t');
+	const uint8x16_t lineFeed = vdupq_n_u8('\n');
+	const uint8x16_t carriageReturn = vdupq_n_u8('\r');
+#endif
+
+	while (p < end)
+	{
+#if XMLTOKENIZER_SSE2
+		while (end - p >= 16)
+		{
+			// a signed comparison flags both control characters and bytes with the high bit set
+			__m128i chunk = _mm_loadu_si128((const __m128i *)p);
+			__m128i whitespace = _mm_or_si128(_mm_cmpeq_epi8(chunk, tab), _mm_or_si128(_mm_cmpeq_epi8(chunk, lineFeed), _mm_cmpeq_epi8(chunk, carriageReturn)));
+			__m128i unusual = _mm_andnot_si128(whitespace, _mm_cmplt_epi8(chunk, space));
+			unsigned int mask = (unsigned int)_mm_movemask_epi8(unusual);
+			if (mask != 0)
+			{
+				p += std::countr_zero(mask);
+				break;
+			}
+			p += 16;
+		}
+#elif XMLTOKENIZER_NEON
+		while (end - p >= 16)
+		{
+			uint8x16_t chunk = vld1q_u8((const std::uint8_t *)p);
+			uint8x16_t whitespace = vorrq_u8(vceqq_u8(chunk, tab), vorrq_u8(vceqq_u8(chunk, lineFeed), vceqq_u8(chunk, carriageReturn)));
+			uint8x16_t unusual = vbicq_u8(vorrq_u8(vcltq_u8(chunk, space), vcgeq_u8(chunk, highBit)), whitespace);
+			if (vmaxvq_u8(unusual) != 0)
+				break;
+			p += 16;
+		}
+#endif
+		if (p >= end)
+			break;
+
+		std::uint8_t c = (std::uint8_t)*p;
+		if (c >= 0x80)
+		{
+			if (!validateUtf8Sequence(p, end))
+				return false;
+		}
+		else if (c >= 0x20 || isSpace((char)c))
+		{
+			p++;
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+//-------------------------------------------------
+//  decodeReference - decodes a character or entity
+//	reference at r, writing the UTF-8 at w; this
+//	never writes past the reference itself
+//-------------------------------------------------
+
+static bool decodeReference(char *&r, char *end, char *&w) noexcept
+{
+	using namespace std::literals;
+
+	// find the semicolon; we do not bother with references that are absurdly long
+	char *semicolon = (char *)memchr(r, ';', std::min<std::size_t>(end - r, 12));
+	if (!semicolon)
+		return false;
+	std::string_view name(r + 1, semicolon - r - 1);
+
+	char32_t ch = 0;
+	if (name == "lt"sv)
+		ch = '<';
+	else if (name == "gt"sv)
+		ch = '>';
+	else if (name == "amp"sv)
+		ch = '&';
+	else if (name == "quot"sv)
+		ch = '\"';
+	else if (name == "apos"sv)
+		ch = '\'';
+	else if (name.size() >= 2 && name[0] == '#')
+	{
+		// character reference
+		bool isHex = name[1] == 'x';
+		std::string_view digits = name.substr(isHex ? 2 : 1);
+		if (digits.empty() || digits.size() > 8)
+			return false;
+		std::uint64_t value = 0;
+		for (char digit : digits)
+		{
+			int digitValue;
+			if (digit >= '0' && digit <= '9')
+				digitValue = digit - '0';
+			else if (isHex && digit >= 'a' && digit <= 'f')
+				digitValue = digit - 'a' + 10;
+			else if (isHex && digit >= 'A' && digit <= 'F')
+				digitValue = digit - 'A' + 10;
+			else
+				return false;
+			value = value * (isHex ? 16 : 10) + digitValue;
+		}
+		if (value > 0x10FFFF || !isXmlChar((char32_t)value))
+			return false;
+		ch = (char32_t)value;
+	}
+	else
+	{
+		// an entity that would have to be declared in the DTD
+		return false;
+	}
+
+	// encode as UTF-8
+	if (ch < 0x80)
+	{
+		*w++ = (char)ch;
+	}
+	else if (ch < 0x800)
+	{
+		*w++ = (char)(0xC0 | (ch >> 6));
+		*w++ = (char)(0x80 | (ch & 0x3F));
+	}
+	else if (ch < 0x10000)
+	{
+		*w++ = (char)(0xE0 | (ch >> 12));
+		*w++ = (char)(0x80 | ((ch >> 6) & 0x3F));
+		*w++ = (char)(0x80 | (ch & 0x3F));
+	}
+	else
+	{
+		*w++ = (char)(0xF0 | (ch >> 18));
+		*w++ = (char)(0x80 | ((ch >> 12) & 0x3F));
+		*w++ = (char)(0x80 | ((ch >> 6) & 0x3F));
+		*w++ = (char)(0x80 | (ch & 0x3F));
+	}
+	r = semicolon + 1;
+	return true;
+}
+
+
+//-------------------------------------------------
+//  skipComment - p is just past the "<!--"
+//-------------------------------------------------
+
+static bool skipComment(char *&p, char *end) noexcept
+{
+	for (;;)
+	{
+		char *dash = (char *)memchr(p, '-', end - p);
+		if (!dash || end - dash < 3)
+			return false;
+		if (dash[1] == '-')
+		{
+			// "--" can only appear at the end of a comment
+			if (dash[2] != '>')
+				return false;
+			p = dash + 3;
+			return true;
+		}
+		p = dash + 1;
+	}
+}
+
+
+//-------------------------------------------------
+//  skipEnumeration - an attribute type listing
+//	names (for NOTATION) or name tokens
+//-------------------------------------------------
+
+static bool skipEnumeration(char *&p, char *end, bool names) noexcept
+{
+	if (p >= end || *p != '(')
+		return false;
+	p++;
+	for (;;)
+	{
+		skipSpace(p, end);
+		char *tokenEnd = p;
+		if (names)
+			tokenEnd = scanName(p, end);
+		else
+			while (tokenEnd < end && (s_nameChars[(std::uint8_t)*tokenEnd] & 2))
+				tokenEnd++;
+		if (!tokenEnd || tokenEnd == p)
+			return false;
+		p = tokenEnd;
+		skipSpace(p, end);
+		if (p >= end)
+			return false;
+		if (*p++ == ')')
+			return true;
+		if (p[-1] != '|')
+			return false;
+	}
+}
+
+
+//-------------------------------------------------
+//  skipContentParticle - a name, or a choice or
+//	sequence of content particles, with an optional
+//	occurrence indicator
+//-------------------------------------------------
+
+static bool skipContentParticle(char *&p, char *end, int depth) noexcept
+{
+	if (p < end && *p == '(')
+	{
+		if (depth > 32)
+			return false;
+		p++;
+
+		// choices and sequences cannot be mixed within the same parentheses
+		char separator = '\0';
+		for (;;)
+		{
+			skipSpace(p, end);
+			if (!skipContentParticle(p, end, depth + 1))
+				return false;
+			skipSpace(p, end);
+			if (p >= end)
+				return false;
+			if (*p == ')')
+				break;
+			if ((*p != '|' && *p != ',') || (separator && *p != separator))
+				return false;
+			separator = *p++;
+		}
+		p++;
+	}
+	else
+	{
+		char *nameEnd = scanName(p, end);
+		if (!nameEnd)
+			return false;
+		p = nameEnd;
+	}
+
+	if (p < end && (*p == '?' || *p == '*' || *p == '+'))
+		p++;
+	return true;
+}
+
+
+//-------------------------------------------------
+//  skipElementDecl - p is just past "<!ELEMENT";
+//	nothing in an element declaration matters to
+//	us, but expat checks that it is well formed
+//-------------------------------------------------
+
+static bool skipElementDecl(char *&p, char *end) noexcept
+{
+	using namespace std::literals;
+
+	skipSpace(p, end);
+	char *nameEnd = scanName(p, end);
+	if (!nameEnd)
+		return false;
+	p = nameEnd;
+	if (!skipSpace(p, end) || p >= end)
+		return false;
+
+	char *contentSpec = p;
+	char *keywordEnd = scanName(p, end);
+	if (keywordEnd && (std::string_view(p, keywordEnd - p) == "EMPTY"sv || std::string_view(p, keywordEnd - p) == "ANY"sv))
+	{
+		p = keywordEnd;
+	}
+	else if (*p == '(' && (skipSpace(++p, end), startsWith(p, end, "#PCDATA")))
+	{
+		// mixed content; if any element names are listed, this has to end with ")*"
+		p += 7;
+		bool anyNames = false;
+		for (;;)
+		{
+			skipSpace(p, end);
+			if (p >= end || *p != '|')
+				break;
+			p++;
+			skipSpace(p, end);
+			char *elementNameEnd = scanName(p, end);
+			if (!elementNameEnd)
+				return false;
+			p = elementNameEnd;
+			anyNames = true;
+		}
+		if (p >= end || *p++ != ')')
+			return false;
+		if (p < end && *p == '*')
+			p++;
+		else if (anyNames)
+			return false;
+	}
+	else
+	{
+		// element content
+		p = contentSpec;
+		if (*p != '(' || !skipContentParticle(p, end, 0))
+			return false;
+	}
+
+	skipSpace(p, end);
+	if (p >= end || *p != '>')
+		return false;
+	p++;
+	return true;
+}
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  tokenize
+//-------------------------------------------------
+
+bool XmlTokenizer::tokenize(std::span<const char> document) noexcept
+{
+	ProfilerScope prof(CURRENT_FUNCTION);
+
+	m_tokens.clear();
+	m_attributes.clear();
+	m_openElements.clear();
+	m_attributeDecls.clear();
+
+	// everything is an offset into the buffer, which never gets reallocated after this
+	if (document.size() >= (std::size_t)~(std::uint32_t)0)
+		return false;
+	if (!validateDocument(document.data(), document.data() + document.size()))
+		return false;
+	m_buffer.assign(document.begin(), document.end());
+	char *p = m_buffer.data();
+	char *end = p + m_buffer.size();
+
+	// byte order mark and XML declaration
+	if (startsWith(p, end, "\xEF\xBB\xBF"))
+		p += 3;
+	if (startsWith(p, end, "<?xml") && end - p > 5 && isSpace(p[5]))
+	{
+		p += 5;
+		if (!parseXmlDeclaration(p, end))
+			return false;
+	}
+
+	// comments and the DOCTYPE, before the root element
+	bool doctypeSeen = false;
+	for (;;)
+	{
+		skipSpace(p, end);
+		if (startsWith(p, end, "<!--"))
+		{
+			p += 4;
+			if (!skipComment(p, end))
+				return false;
+		}
+		else if (!doctypeSeen && startsWith(p, end, "<!DOCTYPE"))
+		{
+			p += 9;
+			if (!parseDoctype(p, end))
+				return false;
+			doctypeSeen = true;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	// and the root element
+	bool rootSeen = false;
+	for (;;)
+	{
+		if (!m_openElements.empty())
+		{
+			// character data up to the next markup
+			if (!parseText(p, end) || p >= end)
+				return false;
+		}
+		else
+		{
+			// only whitespace and comments can be outside the root element
+			skipSpace(p, end);
+			if (p >= end)
+				return rootSeen;
+		}
+
+		if (*p != '<' || ++p >= end)
+			return false;
+		if (*p == '/')
+		{
+			p++;
+			if (!parseEndTag(p, end))
+				return false;
+		}
+		else if (*p == '!')
+		{
+			// comments are the only thing we take from this family
+			if (!startsWith(p, end, "!--"))
+				return false;
+			p += 3;
+			if (!skipComment(p, end))
+				return false;
+		}
+		else
+		{
+			// a start tag; there can only be one root element
+			if (rootSeen && m_openElements.empty())
+				return false;
+			rootSeen = true;
+			if (!parseStartTag(p, end))
+				return false;
+		}
+	}
+}
+
+
+//-------------------------------------------------
+//  parseXmlDeclaration - p is just past "<?xml";
+//	we only take what we can read as UTF-8
+//-------------------------------------------------
+
+bool XmlTokenizer::parseXmlDeclaration(char *&p, char *end) noexcept
+{
+	using namespace std::literals;
+
+	// version (which is required), encoding and standalone, in that order
+	static const std::array<std::string_view, 3> pseudoAttributeNames = { "version"sv, "encoding"sv, "standalone"sv };
+	std::size_t nextPseudoAttribute = 0;
+	for (;;)
+	{
+		bool sawSpace = skipSpace(p, end);
+		if (startsWith(p, end, "?>"))
+		{
+			p += 2;
+			return nextPseudoAttribute > 0;
+		}
+		if (!sawSpace)
+			return false;
+
+		// pseudo attribute
+		char *nameEnd = scanName(p, end);
+		if (!nameEnd)
+			return false;
+		std::string_view name(p, nameEnd - p);
+		auto iter = std::find(pseudoAttributeNames.begin() + nextPseudoAttribute, pseudoAttributeNames.end(), name);
+		if (iter == pseudoAttributeNames.end() || (nextPseudoAttribute == 0 && iter != pseudoAttributeNames.begin()))
+			return false;
+		nextPseudoAttribute = iter - pseudoAttributeNames.begin() + 1;
+		p = nameEnd;
+		skipSpace(p, end);
+		if (p >= end || *p != '=')
+			return false;
+		p++;
+		skipSpace(p, end);
+		if (p >= end || (*p != '\"' && *p != '\''))
+			return false;
+		char *valueEnd = (char *)memchr(p + 1, *p, end - p - 1);
+		if (!valueEnd)
+			return false;
+		std::string_view value(p + 1, valueEnd - p - 1);
+		p = valueEnd + 1;
+
+		auto equalsIgnoreCase = [](std::string_view a, std::string_view b)
+		{
+			return std::ranges::equal(a, b, [](char x, char y) { return tolower((unsigned char)x) == tolower((unsigned char)y); });
+		};
+		if (name == "version"sv && value != "1.0"sv)
+			return false;
+		if (name == "encoding"sv && !equalsIgnoreCase(value, "UTF-8"sv) && !equalsIgnoreCase(value, "US-ASCII"sv))
+			return false;
+		if (name == "standalone"sv && value != "yes"sv && value != "no"sv)
+			return false;
+	}
+}
+
+
+//-------------------------------------------------
+//  parseDoctype - p is just past "<!DOCTYPE"; we
+//	take the internal subset's ATTLIST declarations
+//	because expat applies their defaults
+//-------------------------------------------------
+
+bool XmlTokenizer::parseDoctype(char *&p, char *end) noexcept
+{
+	if (!skipSpace(p, end))
+		return false;
+	char *nameEnd = scanName(p, end);
+	if (!nameEnd)
+		return false;
+	p = nameEnd;
+	skipSpace(p, end);
+
+	// external DTDs are identified but (like expat) we do not read them
+	auto skipLiteral = [&p, end]
+	{
+		if (!skipSpace(p, end) || p >= end || (*p != '\"' && *p != '\''))
+			return false;
+		char *closeQuote = (char *)memchr(p + 1, *p, end - p - 1);
+		if (!closeQuote)
+			return false;
+		p = closeQuote + 1;
+		return true;
+	};
+	if (startsWith(p, end, "SYSTEM"))
+	{
+		p += 6;
+		if (!skipLiteral())
+			return false;
+		skipSpace(p, end);
+	}
+	else if (startsWith(p, end, "PUBLIC"))
+	{
+		p += 6;
+		if (!skipLiteral() || !skipLiteral())
+			return false;
+		skipSpace(p, end);
+	}
+
+	if (p < end && *p == '[')
+	{
+		p++;
+		for (;;)
+		{
+			skipSpace(p, end);
+			if (p >= end)
+				return false;
+			if (*p == ']')
+			{
+				p++;
+				break;
+			}
+
+			if (startsWith(p, end, "<!--"))
+			{
+				p += 4;
+				if (!skipComment(p, end))
+					return false;
+			}
+			else if (startsWith(p, end, "<!ELEMENT") && end - p > 9 && isSpace(p[9]))
+			{
+				p += 9;
+				if (!skipElementDecl(p, end))
+					return false;
+			}
+			else if (startsWith(p, end, "<!ATTLIST") && end - p > 9 && isSpace(p[9]))
+			{
+				p += 9;
+				if (!parseAttlist(p, end))
+					return false;
+			}
+			else
+			{
+				// entity and notation declarations, parameter entity references, processing
+				// instructions...
+				return false;
+			}
+		}
+		skipSpace(p, end);
+	}
+
+	if (p >= end || *p != '>')
+		return false;
+	p++;
+	return true;
+}
+
+
+//-------------------------------------------------
+//  parseAttlist - p is just past "<!ATTLIST"
+//-------------------------------------------------
+
+bool XmlTokenizer::parseAttlist(char *&p, char *end) noexcept
+{
+	using namespace std::literals;
+
+	skipSpace(p, end);
+	char *elementNameEnd = scanName(p, end);
+	if (!elementNameEnd)
+		return false;
+	std::vector<AttributeDecl> &attributeDecls = m_attributeDecls[std::string_view(p, elementNameEnd - p)];
+	p = elementNameEnd;
+
+	for (;;)
+	{
+		bool sawSpace = skipSpace(p, end);
+		if (p >= end)
+			return false;
+		if (*p == '>')
+		{
+			p++;
+			return true;
+		}
+		if (!sawSpace)
+			return false;
+
+		// attribute name
+		char *attributeName = p;
+		char *attributeNameEnd = scanName(p, end);
+		if (!attributeNameEnd)
+			return false;
+		p = attributeNameEnd;
+		if (!skipSpace(p, end) || p >= end)
+			return false;
+
+		// attribute type; expat normalizes the values of anything but CDATA
+		bool isCdata = false;
+		if (*p == '(')
+		{
+			if (!skipEnumeration(p, end, false))
+				return false;
+		}
+		else
+		{
+			char *typeEnd = scanName(p, end);
+			if (!typeEnd)
+				return false;
+			std::string_view type(p, typeEnd - p);
+			p = typeEnd;
+			if (type == "CDATA"sv)
+			{
+				isCdata = true;
+			}
+			else if (type == "NOTATION"sv)
+			{
+				if (!skipSpace(p, end) || !skipEnumeration(p, end, true))
+					return false;
+			}
+			else if (type != "ID"sv && type != "IDREF"sv && type != "IDREFS"sv && type != "ENTITY"sv
+				&& type != "ENTITIES"sv && type != "NMTOKEN"sv && type != "NMTOKENS"sv)
+			{
+				return false;
+			}
+		}
+		if (!skipSpace(p, end) || p >= end)
+			return false;
+
+		// default
+		std::uint32_t defaultOffset = NO_DEFAULT;
+		bool hasDefault = true;
+		if (*p == '#')
+		{
+			char *keywordEnd = scanName(p + 1, end);
+			if (!keywordEnd)
+				return false;
+			std::string_view keyword(p + 1, keywordEnd - p - 1);
+			p = keywordEnd;
+			if (keyword == "REQUIRED"sv || keyword == "IMPLIED"sv)
+				hasDefault = false;
+			else if (keyword != "FIXED"sv || !skipSpace(p, end))
+				return false;
+		}
+		if (hasDefault)
+		{
+			if (p >= end || (*p != '\"' && *p != '\''))
+				return false;
+			char *value = p + 1;
+			if (!parseAttributeValue(p, end))
+				return false;
+			if (!isCdata && strchr(value, ' '))
+				return false;
+			defaultOffset = offset(value);
+		}
+
+		// the first declaration of an attribute is the binding one
+		*attributeNameEnd = '\0';
+		bool alreadyDeclared = std::ranges::any_of(attributeDecls, [this, attributeName](const AttributeDecl &decl)
+		{
+			return !strcmp(string(decl.m_nameOffset), attributeName);
+		});
+		if (!alreadyDeclared)
+			attributeDecls.push_back(AttributeDecl{ offset(attributeName), defaultOffset, isCdata });
+	}
+}
+
+
+//-------------------------------------------------
+//  parseStartTag - p is just past the '<'
+//-------------------------------------------------
+
+bool XmlTokenizer::parseStartTag(char *&p, char *end) noexcept
+{
+	char *name = p;
+	char *nameEnd = scanName(p, end);
+	if (!nameEnd)
+		return false;
+	p = nameEnd;
+
+	// attributes
+	std::uint32_t attributesIndex = (std::uint32_t)m_attributes.size();
+	bool isEmptyElement;
+	for (;;)
+	{
+		bool sawSpace = skipSpace(p, end);
+		if (p >= end)
+			return false;
+		if (*p == '>')
+		{
+			p++;
+			isEmptyElement = false;
+			break;
+		}
+		if (*p == '/')
+		{
+			if (end - p < 2 || p[1] != '>')
+				return false;
+			p += 2;
+			isEmptyElement = true;
+			break;
+		}
+		if (!sawSpace)
+			return false;
+
+		char *attributeName = p;
+		char *attributeNameEnd = scanName(p, end);
+		if (!attributeNameEnd)
+			return false;
+		p = attributeNameEnd;
+		skipSpace(p, end);
+		if (p >= end || *p != '=')
+			return false;
+		p++;
+		skipSpace(p, end);
+		if (p >= end || (*p != '\"' && *p != '\''))
+			return false;
+
+		// we are past the end of the name, so we can terminate it
+		*attributeNameEnd = '\0';
+		char *value = p + 1;
+		if (!parseAttributeValue(p, end))
+			return false;
+
+		// attributes cannot be specified twice
+		for (std::size_t i = attributesIndex; i < m_attributes.size(); i += 2)
+		{
+			if (!strcmp(string(m_attributes[i]), attributeName))
+				return false;
+		}
+		m_attributes.push_back(offset(attributeName));
+		m_attributes.push_back(offset(value));
+	}
+
+	// likewise, we are past the end of the element name
+	*nameEnd = '\0';
+	if (!m_attributeDecls.empty() && !applyAttributeDecls(std::string_view(name, nameEnd - name), attributesIndex))
+		return false;
+
+	// and emit the tokens
+	std::uint32_t nameOffset = offset(name);
+	m_tokens.push_back(Token{ TokenType::StartElement, nameOffset, (std::uint32_t)(m_attributes.size() - attributesIndex) / 2, attributesIndex });
+	if (isEmptyElement)
+		m_tokens.push_back(Token{ TokenType::EndElement, nameOffset, 0, nameOffset - 1 });
+	else
+		m_openElements.push_back(nameOffset);
+	return true;
+}
+
+
+//-------------------------------------------------
+//  applyAttributeDecls - adds defaulted attributes
+//	after the specified ones (as expat does), and
+//	bails on values that expat would normalize
+//-------------------------------------------------
+
+bool XmlTokenizer::applyAttributeDecls(std::string_view elementName, std::uint32_t attributesIndex) noexcept
+{
+	auto iter = m_attributeDecls.find(elementName);
+	if (iter == m_attributeDecls.end())
+		return true;
+
+	std::uint32_t specifiedEnd = (std::uint32_t)m_attributes.size();
+	for (const AttributeDecl &decl : iter->second)
+	{
+		if (decl.m_isCdata && decl.m_defaultOffset == NO_DEFAULT)
+			continue;
+
+		const char *declName = string(decl.m_nameOffset);
+		std::uint32_t i = attributesIndex;
+		while (i < specifiedEnd && strcmp(string(m_attributes[i]), declName))
+			i += 2;
+
+		if (i < specifiedEnd)
+		{
+			// specified; expat would trim and collapse spaces in anything but CDATA
+			if (!decl.m_isCdata && strchr(string(m_attributes[i + 1]), ' '))
+				return false;
+		}
+		else if (decl.m_defaultOffset != NO_DEFAULT)
+		{
+			// not specified, but there is a default
+			m_attributes.push_back(decl.m_nameOffset);
+			m_attributes.push_back(decl.m_defaultOffset);
+		}
+	}
+	return true;
+}
+
+
+//-------------------------------------------------
+//  parseEndTag - p is just past the "</"
+//-------------------------------------------------
+
+bool XmlTokenizer::parseEndTag(char *&p, char *end) noexcept
+{
+	if (m_openElements.empty())
+		return false;
+
+	char *name = p;
+	char *nameEnd = scanName(p, end);
+	if (!nameEnd)
+		return false;
+	p = nameEnd;
+	skipSpace(p, end);
+	if (p >= end || *p != '>')
+		return false;
+	p++;
+
+	// this has to match the open element
+	std::uint32_t openName = m_openElements.back();
+	std::size_t nameLength = nameEnd - name;
+	if (strncmp(string(openName), name, nameLength) || string(openName)[nameLength] != '\0')
+		return false;
+
+	m_tokens.push_back(Token{ TokenType::EndElement, openName, 0, offset(name - 2) });
+	m_openElements.pop_back();
+	return true;
+}
+
+
+//-------------------------------------------------
+//  parseText - character data up to the next '<',
+//	decoded in place
+//-------------------------------------------------
+
+bool XmlTokenizer::parseText(char *&p, char *end) noexcept
+{
+	char *start = p;
+	char *w = p;
+	for (;;)
+	{
+		// skip (or once we have decoded something, move) everything uneventful
+		char *r = s_textScanner.find(p, end);
+		if (w != p)
+			memmove(w, p, r - p);
+		w += r - p;
+		p = r;
+		if (p >= end || *p == '<')
+			break;
+
+		switch (*p)
+		{
+		case '&':
+			if (!decodeReference(p, end, w))
+				return false;
+			break;
+
+		case '\r':
+			// line endings are normalized to '\n'
+			*w++ = '\n';
+			p++;
+			if (p < end && *p == '\n')
+				p++;
+			break;
+
+		case ']':
+			// "]]>" is not allowed in character data
+			if (startsWith(p, end, "]]>"))
+				return false;
+			*w++ = *p++;
+			break;
+		}
+	}
+
+	if (w != start)
+		m_tokens.push_back(Token{ TokenType::Text, offset(start), (std::uint32_t)(w - start), 0 });
+	return true;
+}
+
+
+//-------------------------------------------------
+//  parseAttributeValue - p is at the opening quote;
+//	decodes and terminates the value in place, and
+//	leaves p past the closing quote
+//-------------------------------------------------
+
+bool XmlTokenizer::parseAttributeValue(char *&p, char *end) noexcept
+{
+	char quote = *p++;
+	const ByteScanner &scanner = quote == '\"' ? s_doubleQuoteScanner : s_singleQuoteScanner;
+	char *w = p;
+	for (;;)
+	{
+		char *r = scanner.find(p, end);
+		if (w != p)
+			memmove(w, p, r - p);
+		w += r - p;
+		p = r;
+		if (p >= end || *p == '<')
+			return false;
+		if (*p == quote)
+			break;
+
+		if (*p == '&')
+		{
+			if (!decodeReference(p, end, w))
+				return false;
+		}
+		else
+		{
+			// literal whitespace (a line ending counting once) is normalized to spaces
+			if (*p == '\r' && end - p > 1 && p[1] == '\n')
+				p++;
+			p++;
+			*w++ = ' ';
+		}
+	}
+
+	*w = '\0';
+	p++;
+	return true;
+}
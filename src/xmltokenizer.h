@@ -0,0 +1,96 @@
+/***************************************************************************
+
+	xmltokenizer.h
+
+	Pre-tokenizer for machine generated XML (principally -listxml output);
+	XmlParser can use this as a faster alternative to expat
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef XMLTOKENIZER_H
+#define XMLTOKENIZER_H
+
+// standard headers
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+//**************************************************************************
+//  TYPE DEFINITIONS
+//**************************************************************************
+
+// ======================> XmlTokenizer
+// tokenizes a whole document up front, scanning with SIMD where it can; anything that is
+// not expected in machine generated XML (CDATA sections, processing instructions, entities
+// other than the predefined ones, DTD declarations other than ELEMENT and ATTLIST, invalid
+// UTF-8...) makes tokenize() fail, so the caller can fall back to expat before anything
+// has been reported to anybody
+
+class XmlTokenizer
+{
+public:
+	class Test;
+
+	enum class TokenType : std::uint8_t
+	{
+		StartElement,		// m_offset is the name; m_count attribute name/value pairs are at m_index in attributes()
+		EndElement,			// m_offset is the name; m_index is where the end tag is
+		Text				// m_offset is the text; m_count is its length
+	};
+
+	struct Token
+	{
+		TokenType		m_type;
+		std::uint32_t	m_offset;
+		std::uint32_t	m_count;
+		std::uint32_t	m_index;
+	};
+
+	// ctor
+	XmlTokenizer() = default;
+	XmlTokenizer(const XmlTokenizer &) = delete;
+	XmlTokenizer(XmlTokenizer &&) = delete;
+
+	// methods
+	bool tokenize(std::span<const char> document) noexcept;
+
+	// accessors; the strings are decoded in place in a copy of the document, so offsets are
+	// also where these are in the original document (which is handy for reporting errors)
+	const std::vector<Token> &tokens() const noexcept		{ return m_tokens; }
+	std::span<const std::uint32_t> attributes(const Token &token) const noexcept { return std::span<const std::uint32_t>(m_attributes).subspan(token.m_index, token.m_count * 2); }
+	const char *string(std::uint32_t offset) const noexcept	{ return m_buffer.data() + offset; }
+
+private:
+	static const std::uint32_t NO_DEFAULT = ~0;
+
+	struct AttributeDecl
+	{
+		std::uint32_t	m_nameOffset;
+		std::uint32_t	m_defaultOffset;
+		bool			m_isCdata;
+	};
+
+	std::vector<char>										m_buffer;
+	std::vector<Token>										m_tokens;
+	std::vector<std::uint32_t>								m_attributes;
+	std::vector<std::uint32_t>								m_openElements;
+	std::unordered_map<std::string_view, std::vector<AttributeDecl>>	m_attributeDecls;
+
+	std::uint32_t offset(const char *ptr) const noexcept	{ return (std::uint32_t)(ptr - m_buffer.data()); }
+	bool parseXmlDeclaration(char *&p, char *end) noexcept;
+	bool parseDoctype(char *&p, char *end) noexcept;
+	bool parseAttlist(char *&p, char *end) noexcept;
+	bool parseStartTag(char *&p, char *end) noexcept;
+	bool parseEndTag(char *&p, char *end) noexcept;
+	bool parseText(char *&p, char *end) noexcept;
+	bool parseAttributeValue(char *&p, char *end) noexcept;
+	bool applyAttributeDecls(std::string_view elementName, std::uint32_t attributesIndex) noexcept;
+};
+
+
+#endif // XMLTOKENIZER_H